@@ -40,5 +40,24 @@ namespace X2 {
 		}
 	};
 
+	// Result of AssetManager::GetAssetAsync. Until IsReady, Asset is a placeholder (or null if the type has none)
+	template<typename T>
+	struct AsyncAssetResult
+	{
+		Ref<T> Asset;
+		bool IsReady = false;
+
+		AsyncAssetResult() = default;
+		AsyncAssetResult(const Ref<T>& asset, bool isReady = false)
+			: Asset(asset), IsReady(isReady) {}
+
+		template<typename T2>
+		AsyncAssetResult(const AsyncAssetResult<T2>& other)
+			: Asset(std::dynamic_pointer_cast<T>(other.Asset)), IsReady(other.IsReady) {}
+
+		operator Ref<T>() const { return Asset; }
+		operator bool() const { return IsReady; }
+	};
+
 
 }
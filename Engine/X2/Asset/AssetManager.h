@@ -40,14 +40,25 @@ namespace X2 {
 			return std::dynamic_pointer_cast<T>(asset);
 		}
 
+		// Does not block, see AssetManagerBase::GetAssetAsync
+		template<typename T>
+		static AsyncAssetResult<T> GetAssetAsync(AssetHandle assetHandle, float priority = 0.0f)
+		{
+			return AsyncAssetResult<T>(Project::GetAssetManager()->GetAssetAsync(assetHandle, priority));
+		}
+
+		// Starts streaming an asset ahead of the first GetAsset/GetAssetAsync
+		static void RequestAsset(AssetHandle assetHandle, float priority = 0.0f) { Project::GetAssetManager()->GetAssetAsync(assetHandle, priority); }
+
 		template<typename T>
 		static std::unordered_set<AssetHandle> GetAllAssetsWithType()
 		{
 			return Project::GetAssetManager()->GetAllAssetsWithType(T::GetStaticType());
 		}
 
-		static const std::unordered_map<AssetHandle, Ref<Asset>>& GetLoadedAssets() { return Project::GetAssetManager()->GetLoadedAssets(); }
-		static const std::unordered_map<AssetHandle, Ref<Asset>>& GetMemoryOnlyAssets() { return Project::GetAssetManager()->GetMemoryOnlyAssets(); }
+		static std::unordered_map<AssetHandle, Ref<Asset>> GetLoadedAssets() { return Project::GetAssetManager()->GetLoadedAssets(); }
+		static uint32_t GetLoadedAssetsVersion() { return Project::GetAssetManager()->GetLoadedAssetsVersion(); }
+		static std::unordered_map<AssetHandle, Ref<Asset>> GetMemoryOnlyAssets() { return Project::GetAssetManager()->GetMemoryOnlyAssets(); }
 
 		template<typename TAsset, typename... TArgs>
 		static AssetHandle CreateMemoryOnlyAsset(TArgs&&... args)
@@ -0,0 +1,67 @@
+#include "Precompiled.h"
+#include "AssetManagerBase.h"
+
+#include "X2/Renderer/Renderer.h"
+
+namespace X2 {
+
+	namespace Utils {
+
+		// Types whose loaders only defer GPU work through Renderer::Submit, so they can run on the streaming workers
+		static bool IsStreamedAssetType(AssetType type)
+		{
+			switch (type)
+			{
+				case AssetType::Mesh:
+				case AssetType::StaticMesh:
+				case AssetType::MeshSource:
+				case AssetType::Texture:
+					return true;
+			}
+			return false;
+		}
+
+		// Meshes have no placeholder, they are simply not drawn until they arrive
+		static Ref<Asset> GetPlaceholderAsset(AssetType type)
+		{
+			if (type == AssetType::Texture)
+				return Renderer::GetWhiteTexture();
+
+			return nullptr;
+		}
+
+	}
+
+	AssetManagerBase::AssetManagerBase()
+	{
+		m_AssetStreamer = CreateScope<AssetStreamer>([this](AssetHandle assetHandle) { return LoadAsset(assetHandle); });
+	}
+
+	AssetManagerBase::~AssetManagerBase()
+	{
+		StopStreaming();
+	}
+
+	AsyncAssetResult<Asset> AssetManagerBase::GetAssetAsync(AssetHandle assetHandle, float priority)
+	{
+		if (IsMemoryAsset(assetHandle) || IsAssetLoaded(assetHandle))
+			return { GetAsset(assetHandle), true };
+
+		AssetType type = GetAssetType(assetHandle);
+		if (!Utils::IsStreamedAssetType(type) || !m_AssetStreamer)
+			return { GetAsset(assetHandle), true };
+
+		if (m_AssetStreamer->HasFailed(assetHandle))
+			return { nullptr, true };
+
+		m_AssetStreamer->Request(assetHandle, priority);
+		return { Utils::GetPlaceholderAsset(type), false };
+	}
+
+	void AssetManagerBase::StopStreaming()
+	{
+		if (m_AssetStreamer)
+			m_AssetStreamer->Stop();
+	}
+
+}
@@ -2,7 +2,9 @@
 
 #include "X2/Asset/Asset.h"
 #include "X2/Asset/AssetTypes.h"
+#include "AssetStreamer.h"
 
+#include <atomic>
 #include <unordered_set>
 #include <unordered_map>
 
@@ -17,8 +19,8 @@ namespace X2 {
 	class AssetManagerBase 
 	{
 	public:
-		AssetManagerBase() = default;
-		virtual ~AssetManagerBase() = default;
+		AssetManagerBase();
+		virtual ~AssetManagerBase();
 
 		virtual AssetType GetAssetType(AssetHandle assetHandle) = 0;
 		virtual Ref<Asset> GetAsset(AssetHandle assetHandle) = 0;
@@ -29,8 +31,24 @@ namespace X2 {
 		virtual bool IsAssetLoaded(AssetHandle handle) = 0;
 
 		virtual std::unordered_set<AssetHandle> GetAllAssetsWithType(AssetType type) = 0;
-		virtual const std::unordered_map<AssetHandle, Ref<Asset>>& GetLoadedAssets() = 0;
-		virtual const std::unordered_map<AssetHandle, Ref<Asset>>& GetMemoryOnlyAssets() = 0;
+		// Snapshots, the maps themselves change while streaming workers load assets
+		virtual std::unordered_map<AssetHandle, Ref<Asset>> GetLoadedAssets() = 0;
+		virtual std::unordered_map<AssetHandle, Ref<Asset>> GetMemoryOnlyAssets() = 0;
+
+		// Returns immediately, queueing the load on the streaming workers if the asset is not loaded yet.
+		// Higher priority loads first. Types that are not streamed load synchronously and come back ready
+		AsyncAssetResult<Asset> GetAssetAsync(AssetHandle assetHandle, float priority = 0.0f);
+		// Has to run before the manager is released, workers may still call back into AssetManager
+		void StopStreaming();
+
+		// Moves whenever a loaded asset is added, reloaded or dropped, caches that hold on to assets compare it
+		uint32_t GetLoadedAssetsVersion() const { return m_LoadedAssetsVersion.load(); }
+	protected:
+		// Loads on the calling thread, this is also what the streaming workers run
+		virtual Ref<Asset> LoadAsset(AssetHandle assetHandle) = 0;
+	protected:
+		Scope<AssetStreamer> m_AssetStreamer;
+		std::atomic<uint32_t> m_LoadedAssetsVersion = 0;
 	};
 
 }
@@ -0,0 +1,132 @@
+#include "Precompiled.h"
+#include "AssetStreamer.h"
+
+#include "X2/Core/Debug/Profiler.h"
+
+namespace X2 {
+
+	AssetStreamer::AssetStreamer(const LoadFn& loadFn)
+		: m_LoadFn(loadFn)
+	{
+	}
+
+	AssetStreamer::~AssetStreamer()
+	{
+		Stop();
+	}
+
+	void AssetStreamer::Request(AssetHandle handle, float priority)
+	{
+		{
+			std::scoped_lock<std::mutex> lock(m_Mutex);
+			if (!m_Running || m_Loading.find(handle) != m_Loading.end() || m_Failed.find(handle) != m_Failed.end())
+				return;
+
+			auto it = m_Queued.find(handle);
+			if (it != m_Queued.end())
+			{
+				if (priority <= it->second)
+					return;
+
+				it->second = priority;
+			}
+			else
+			{
+				m_Queued[handle] = priority;
+			}
+
+			m_Queue.push({ priority, handle });
+		}
+
+		// One job per entry, the job loads whatever has the highest priority once it runs
+		JobSystem::RunBackground([this]() { LoadQueued(); }, &m_Jobs);
+	}
+
+	bool AssetStreamer::Claim(AssetHandle handle)
+	{
+		const std::thread::id threadID = std::this_thread::get_id();
+
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_Queued.erase(handle);
+
+		auto it = m_Loading.find(handle);
+		if (it != m_Loading.end() && it->second == threadID)
+			return false;
+
+		m_LoadedCondition.wait(lock, [this, handle]() { return m_Loading.find(handle) == m_Loading.end(); });
+		m_Loading[handle] = threadID;
+		return true;
+	}
+
+	void AssetStreamer::Release(AssetHandle handle, bool loaded)
+	{
+		{
+			std::scoped_lock<std::mutex> lock(m_Mutex);
+			m_Loading.erase(handle);
+			if (loaded)
+				m_Failed.erase(handle);
+			else
+				m_Failed.insert(handle);
+		}
+		m_LoadedCondition.notify_all();
+	}
+
+	bool AssetStreamer::HasFailed(AssetHandle handle)
+	{
+		std::scoped_lock<std::mutex> lock(m_Mutex);
+		return m_Failed.find(handle) != m_Failed.end();
+	}
+
+	void AssetStreamer::ClearFailed(AssetHandle handle)
+	{
+		std::scoped_lock<std::mutex> lock(m_Mutex);
+		m_Failed.erase(handle);
+	}
+
+	void AssetStreamer::Stop()
+	{
+		{
+			std::scoped_lock<std::mutex> lock(m_Mutex);
+			m_Running = false;
+			m_Queue = {};
+			m_Queued.clear();
+		}
+
+		// Jobs that are still queued find the queue empty and return right away
+		JobSystem::Wait(m_Jobs);
+	}
+
+	void AssetStreamer::LoadQueued()
+	{
+		AssetHandle handle;
+		{
+			std::scoped_lock<std::mutex> lock(m_Mutex);
+			while (true)
+			{
+				if (!m_Running || m_Queue.empty())
+					return;
+
+				QueueEntry entry = m_Queue.top();
+				m_Queue.pop();
+
+				auto it = m_Queued.find(entry.Handle);
+				if (it == m_Queued.end() || it->second != entry.Priority)
+					continue;
+
+				handle = entry.Handle;
+				m_Queued.erase(it);
+				m_Loading[handle] = std::this_thread::get_id();
+				break;
+			}
+		}
+
+		Ref<Asset> asset;
+		{
+			X2_PROFILE_FUNC("AssetStreamer::Load");
+			asset = m_LoadFn(handle);
+		}
+
+		Release(handle, asset != nullptr);
+	}
+
+}
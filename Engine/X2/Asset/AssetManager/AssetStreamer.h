@@ -0,0 +1,73 @@
+#pragma once
+
+#include "X2/Asset/Asset.h"
+#include "X2/Core/JobSystem.h"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace X2 {
+
+	//////////////////////////////////////////////////////////////////
+	// AssetStreamer /////////////////////////////////////////////////
+	//////////////////////////////////////////////////////////////////
+	// Backs AssetManager::GetAssetAsync. Every request queues a    //
+	// JobSystem background job that loads the highest priority    //
+	// request, the load function publishes the result to the asset //
+	// manager itself                                               //
+	//////////////////////////////////////////////////////////////////
+	class AssetStreamer
+	{
+	public:
+		using LoadFn = std::function<Ref<Asset>(AssetHandle)>;
+	public:
+		AssetStreamer(const LoadFn& loadFn);
+		~AssetStreamer();
+
+		// Queues a load, or raises the priority of one that is still queued
+		void Request(AssetHandle handle, float priority);
+		// For synchronous loads: drops a queued request, waits for a load that is already in flight and marks
+		// the asset as loading so no worker starts it. Returns false when the calling thread is already
+		// loading the asset further up its stack, in that case there is nothing to release.
+		bool Claim(AssetHandle handle);
+		// Ends a synchronous load started with Claim
+		void Release(AssetHandle handle, bool loaded);
+		// Loads that failed are not retried, otherwise every frame would queue them again
+		bool HasFailed(AssetHandle handle);
+		// Lets a failed asset be requested again, for when its file or registry entry changed
+		void ClearFailed(AssetHandle handle);
+
+		// Drops queued requests and waits for in-flight loads to finish
+		void Stop();
+	private:
+		void LoadQueued();
+	private:
+		struct QueueEntry
+		{
+			float Priority;
+			AssetHandle Handle;
+
+			bool operator<(const QueueEntry& other) const { return Priority < other.Priority; }
+		};
+
+		LoadFn m_LoadFn;
+		JobCounter m_Jobs;
+
+		std::mutex m_Mutex;
+		std::condition_variable m_LoadedCondition;
+
+		// Raising a priority pushes a new entry, stale entries are skipped when they reach the top
+		std::priority_queue<QueueEntry> m_Queue;
+		std::unordered_map<AssetHandle, float> m_Queued;
+		// Assets being loaded and the thread loading them
+		std::unordered_map<AssetHandle, std::thread::id> m_Loading;
+		std::unordered_set<AssetHandle> m_Failed;
+		bool m_Running = true;
+	};
+
+}
@@ -27,17 +27,21 @@ namespace X2 {
 
 	EditorAssetManager::~EditorAssetManager()
 	{
+		StopStreaming();
 		FileSystem::ClearFileSystemChangedCallbacks();
 		WriteRegistryToFile();
 	}
 
 	AssetType EditorAssetManager::GetAssetType(AssetHandle assetHandle)
 	{
-		if (!IsAssetHandleValid(assetHandle))
-			return AssetType::None;
-
-		const auto& metadata = GetMetadata(assetHandle);
-		return metadata.Type;
+		// Memory assets are registered too, with IsMemoryAsset set
+		AssetType type = AssetType::None;
+		m_AssetRegistry.Read(assetHandle, [&type](const AssetMetadata& metadata)
+			{
+				if (metadata.IsValid() || metadata.IsMemoryAsset)
+					type = metadata.Type;
+			});
+		return type;
 	}
 
 	Ref<Asset> EditorAssetManager::GetAsset(AssetHandle assetHandle)
@@ -45,27 +49,49 @@ namespace X2 {
 		X2_PROFILE_FUNC();
 		X2_SCOPE_PERF("AssetManager::GetAsset");
 
-		if (IsMemoryAsset(assetHandle))
-			return m_MemoryAssets[assetHandle];
-
-		auto& metadata = GetMetadataInternal(assetHandle);
-		if (!metadata.IsValid())
-			return nullptr;
-
-		Ref<Asset> asset = nullptr;
-		if (!metadata.IsDataLoaded)
 		{
-			metadata.IsDataLoaded = AssetImporter::TryLoadData(metadata, asset);
-			if (!metadata.IsDataLoaded)
-				return nullptr;
+			std::scoped_lock<std::mutex> lock(m_AssetMutex);
+			if (auto it = m_MemoryAssets.find(assetHandle); it != m_MemoryAssets.end())
+				return it->second;
 
-			m_LoadedAssets[assetHandle] = asset;
+			if (auto it = m_LoadedAssets.find(assetHandle); it != m_LoadedAssets.end())
+				return it->second;
 		}
-		else
+
+		// Keeps the streaming workers and other threads from loading the same asset at the same time,
+		// whoever waited in Claim finds the asset in m_LoadedAssets
+		const bool claimed = m_AssetStreamer && m_AssetStreamer->Claim(assetHandle);
+		Ref<Asset> asset = LoadAsset(assetHandle);
+		if (claimed)
+			m_AssetStreamer->Release(assetHandle, asset != nullptr);
+
+		return asset;
+	}
+
+	Ref<Asset> EditorAssetManager::LoadAsset(AssetHandle assetHandle)
+	{
+		X2_PROFILE_FUNC();
+
 		{
-			asset = m_LoadedAssets[assetHandle];
+			std::scoped_lock<std::mutex> lock(m_AssetMutex);
+			if (auto it = m_LoadedAssets.find(assetHandle); it != m_LoadedAssets.end())
+				return it->second;
 		}
 
+		AssetMetadata metadata;
+		if (!m_AssetRegistry.TryGet(assetHandle, metadata) || !metadata.IsValid())
+			return nullptr;
+
+		// Imports run unlocked, they resolve their dependencies through AssetManager
+		Ref<Asset> asset = nullptr;
+		if (!AssetImporter::TryLoadData(metadata, asset))
+			return nullptr;
+
+		m_AssetRegistry.SetDataLoaded(assetHandle, true);
+
+		std::scoped_lock<std::mutex> lock(m_AssetMutex);
+		m_LoadedAssets[assetHandle] = asset;
+		m_LoadedAssetsVersion++;
 		return asset;
 	}
 
@@ -76,41 +102,38 @@ namespace X2 {
 		metadata.IsDataLoaded = true;
 		metadata.Type = asset->GetAssetType();
 		metadata.IsMemoryAsset = true;
-		m_AssetRegistry[metadata.Handle] = metadata;
+		m_AssetRegistry.Set(metadata);
 
+		std::scoped_lock<std::mutex> lock(m_AssetMutex);
 		m_MemoryAssets[asset->Handle] = asset;
 	}
 
 	std::unordered_set<AssetHandle> EditorAssetManager::GetAllAssetsWithType(AssetType type)
 	{
 		std::unordered_set<AssetHandle> result;
-		for (const auto& [handle, metadata] : m_AssetRegistry)
-		{
-			if (metadata.Type == type)
-				result.insert(handle);
-		}
+		m_AssetRegistry.ForEach([&](const AssetMetadata& metadata)
+			{
+				if (metadata.Type == type)
+					result.insert(metadata.Handle);
+			});
 		return result;
 	}
 
 	const AssetMetadata& EditorAssetManager::GetMetadata(AssetHandle handle)
 	{
-		if (m_AssetRegistry.Contains(handle))
-			return m_AssetRegistry[handle];
+		if (const AssetMetadata* metadata = m_AssetRegistry.Find(handle))
+			return *metadata;
 
 		return s_NullMetadata;
 	}
 
 	const AssetMetadata& EditorAssetManager::GetMetadata(const std::filesystem::path& filepath)
 	{
-		const auto relativePath = GetRelativePath(filepath);
+		AssetHandle handle = m_AssetRegistry.FindHandle(GetRelativePath(filepath));
+		if (handle == 0)
+			return s_NullMetadata;
 
-		for (auto& [handle, metadata] : m_AssetRegistry)
-		{
-			if (metadata.FilePath == relativePath)
-				return metadata;
-		}
-
-		return s_NullMetadata;
+		return GetMetadata(handle);
 	}
 
 	const AssetMetadata& EditorAssetManager::GetMetadata(const Ref<Asset>& asset)
@@ -118,14 +141,6 @@ namespace X2 {
 		return GetMetadata(asset->Handle);
 	}
 
-	AssetMetadata& EditorAssetManager::GetMutableMetadata(AssetHandle handle)
-	{
-		if (m_AssetRegistry.Contains(handle))
-			return m_AssetRegistry[handle];
-
-		return s_NullMetadata;
-	}
-
 	AssetHandle EditorAssetManager::GetAssetHandleFromFilePath(const std::filesystem::path& filepath)
 	{
 		return GetMetadata(filepath).Handle;
@@ -182,45 +197,91 @@ namespace X2 {
 
 	bool EditorAssetManager::ReloadData(AssetHandle assetHandle)
 	{
-		auto& metadata = GetMetadataInternal(assetHandle);
-		if (!metadata.IsValid())
+		AssetMetadata metadata;
+		if (!m_AssetRegistry.TryGet(assetHandle, metadata) || !metadata.IsValid())
 		{
 			X2_CORE_ERROR("Trying to reload invalid asset");
 			return false;
 		}
 
+		const bool claimed = m_AssetStreamer && m_AssetStreamer->Claim(assetHandle);
+
 		Ref<Asset> asset;
-		metadata.IsDataLoaded = AssetImporter::TryLoadData(metadata, asset);
-		if (metadata.IsDataLoaded)
+		bool loaded = AssetImporter::TryLoadData(metadata, asset);
+		m_AssetRegistry.SetDataLoaded(assetHandle, loaded);
+
+		if (loaded)
 		{
+			std::scoped_lock<std::mutex> lock(m_AssetMutex);
 			m_LoadedAssets[assetHandle] = asset;
+			m_LoadedAssetsVersion++;
 		}
-		return metadata.IsDataLoaded;
+
+		// A reload also decides whether a previously failed asset can be streamed again
+		if (claimed)
+			m_AssetStreamer->Release(assetHandle, loaded);
+		return loaded;
+	}
+
+	bool EditorAssetManager::IsAssetHandleValid(AssetHandle assetHandle)
+	{
+		if (IsMemoryAsset(assetHandle))
+			return true;
+
+		bool isValid = false;
+		m_AssetRegistry.Read(assetHandle, [&isValid](const AssetMetadata& metadata) { isValid = metadata.IsValid(); });
+		return isValid;
+	}
+
+	std::unordered_map<AssetHandle, Ref<Asset>> EditorAssetManager::GetLoadedAssets()
+	{
+		std::scoped_lock<std::mutex> lock(m_AssetMutex);
+		return m_LoadedAssets;
+	}
+
+	std::unordered_map<AssetHandle, Ref<Asset>> EditorAssetManager::GetMemoryOnlyAssets()
+	{
+		std::scoped_lock<std::mutex> lock(m_AssetMutex);
+		return m_MemoryAssets;
+	}
+
+	bool EditorAssetManager::IsMemoryAsset(AssetHandle handle)
+	{
+		std::scoped_lock<std::mutex> lock(m_AssetMutex);
+		return m_MemoryAssets.find(handle) != m_MemoryAssets.end();
 	}
 
 	bool EditorAssetManager::IsAssetLoaded(AssetHandle handle)
 	{
+		std::scoped_lock<std::mutex> lock(m_AssetMutex);
 		return m_LoadedAssets.find(handle) != m_LoadedAssets.end();
 	}
 
 	void EditorAssetManager::RemoveAsset(AssetHandle handle)
 	{
-		if (m_LoadedAssets.find(handle) != m_LoadedAssets.end())
-			m_LoadedAssets.erase(handle);
+		{
+			std::scoped_lock<std::mutex> lock(m_AssetMutex);
+			if (m_LoadedAssets.find(handle) != m_LoadedAssets.end())
+			{
+				m_LoadedAssets.erase(handle);
+				m_LoadedAssetsVersion++;
+			}
 
-		if (m_MemoryAssets.find(handle) != m_MemoryAssets.end())
-			m_MemoryAssets.erase(handle);
+			if (m_MemoryAssets.find(handle) != m_MemoryAssets.end())
+				m_MemoryAssets.erase(handle);
+		}
 
-		if (m_AssetRegistry.Contains(handle))
-			m_AssetRegistry.Remove(handle);
+		m_AssetRegistry.Remove(handle);
+		if (m_AssetStreamer)
+			m_AssetStreamer->ClearFailed(handle);
 	}
 
 	AssetHandle EditorAssetManager::ImportAsset(const std::filesystem::path& filepath)
 	{
 		std::filesystem::path path = GetRelativePath(filepath);
 
-		if (auto& metadata = GetMetadata(path); metadata.IsValid())
-			return metadata.Handle;
+		if (AssetHandle handle = m_AssetRegistry.FindHandle(path); handle != 0)
+			return handle;
 
 		AssetType type = GetAssetTypeFromPath(path);
 		if (type == AssetType::None)
@@ -230,7 +291,7 @@ namespace X2 {
 		metadata.Handle = AssetHandle();
 		metadata.FilePath = path;
 		metadata.Type = type;
-		m_AssetRegistry[metadata.Handle] = metadata;
+		m_AssetRegistry.Set(metadata);
 
 		return metadata.Handle;
 	}
@@ -333,7 +394,7 @@ namespace X2 {
 				continue;
 			}
 
-			m_AssetRegistry[metadata.Handle] = metadata;
+			m_AssetRegistry.Set(metadata);
 		}
 
 		X2_CORE_INFO("[AssetManager] Loaded {0} asset entries", m_AssetRegistry.Count());
@@ -365,18 +426,24 @@ namespace X2 {
 			AssetType Type;
 		};
 		std::map<UUID, AssetRegistryEntry> sortedMap;
-		for (auto& [filepath, metadata] : m_AssetRegistry)
-		{
-			if (!FileSystem::Exists(GetFileSystemPath(metadata)))
-				continue;
+		m_AssetRegistry.ForEach([&](const AssetMetadata& metadata)
+			{
+				if (metadata.IsMemoryAsset)
+					return;
 
-			if (metadata.IsMemoryAsset)
-				continue;
+				std::string pathToSerialize = metadata.FilePath.string();
+				// NOTE(Yan): if Windows
+				std::replace(pathToSerialize.begin(), pathToSerialize.end(), '\\', '/');
+				sortedMap[metadata.Handle] = { pathToSerialize, metadata.Type };
+			});
 
-			std::string pathToSerialize = metadata.FilePath.string();
-			// NOTE(Yan): if Windows
-			std::replace(pathToSerialize.begin(), pathToSerialize.end(), '\\', '/');
-			sortedMap[metadata.Handle] = { pathToSerialize, metadata.Type };
+		// Checked outside of the registry locks, this touches the disk for every entry
+		for (auto it = sortedMap.begin(); it != sortedMap.end();)
+		{
+			if (!FileSystem::Exists(Project::GetAssetDirectory() / it->second.FilePath))
+				it = sortedMap.erase(it);
+			else
+				it++;
 		}
 
 		X2_CORE_INFO("[AssetManager] serializing asset registry with {0} entries", sortedMap.size());
@@ -403,14 +470,6 @@ namespace X2 {
 		fout << out.c_str();
 	}
 
-	AssetMetadata& EditorAssetManager::GetMetadataInternal(AssetHandle handle)
-	{
-		if (m_AssetRegistry.Contains(handle))
-			return m_AssetRegistry[handle];
-
-		return s_NullMetadata; // make sure to check return value before you go changing it!
-	}
-
 	void EditorAssetManager::OnFileSystemChanged(const std::vector<FileSystemChangedEvent>& events)
 	{
 		// Process all events before the refreshing the Content Browser
@@ -462,12 +521,15 @@ namespace X2 {
 
 	void EditorAssetManager::OnAssetRenamed(AssetHandle assetHandle, const std::filesystem::path& newFilePath)
 	{
-		AssetMetadata& metadata = m_AssetRegistry[assetHandle];
-		if (!metadata.IsValid())
+		if (!GetMetadata(assetHandle).IsValid())
 			return;
 
-		metadata.FilePath = GetRelativePath(newFilePath);
+		m_AssetRegistry.SetFilePath(assetHandle, GetRelativePath(newFilePath));
 		WriteRegistryToFile();
+
+		// The asset may load from its new path
+		if (m_AssetStreamer)
+			m_AssetStreamer->ClearFailed(assetHandle);
 	}
 
 	void EditorAssetManager::OnAssetDeleted(AssetHandle assetHandle)
@@ -477,7 +539,11 @@ namespace X2 {
 			return;
 
 		m_AssetRegistry.Remove(assetHandle);
-		m_LoadedAssets.erase(assetHandle);
+		{
+			std::scoped_lock<std::mutex> lock(m_AssetMutex);
+			m_LoadedAssets.erase(assetHandle);
+			m_LoadedAssetsVersion++;
+		}
 		WriteRegistryToFile();
 	}
 
@@ -22,12 +22,11 @@ namespace X2 {
 		virtual void AddMemoryOnlyAsset(Ref<Asset> asset) override;
 
 		virtual std::unordered_set<AssetHandle> GetAllAssetsWithType(AssetType type) override;
-		virtual const std::unordered_map<AssetHandle, Ref<Asset>>& GetLoadedAssets() override { return m_LoadedAssets; }
-		virtual const std::unordered_map<AssetHandle, Ref<Asset>>& GetMemoryOnlyAssets() override { return m_MemoryAssets; }
+		virtual std::unordered_map<AssetHandle, Ref<Asset>> GetLoadedAssets() override;
+		virtual std::unordered_map<AssetHandle, Ref<Asset>> GetMemoryOnlyAssets() override;
 
 		// Editor-only
 		const AssetMetadata& GetMetadata(AssetHandle handle);
-		AssetMetadata& GetMutableMetadata(AssetHandle handle);
 		const AssetMetadata& GetMetadata(const std::filesystem::path& filepath);
 		const AssetMetadata& GetMetadata(const Ref<Asset>& asset);
 
@@ -48,8 +47,8 @@ namespace X2 {
 		bool FileExists(AssetMetadata& metadata) const;
 
 		virtual bool ReloadData(AssetHandle assetHandle) override;
-		virtual bool IsAssetHandleValid(AssetHandle assetHandle) override { return IsMemoryAsset(assetHandle) || GetMetadata(assetHandle).IsValid(); }
-		virtual bool IsMemoryAsset(AssetHandle handle) override { return m_MemoryAssets.find(handle) != m_MemoryAssets.end(); }
+		virtual bool IsAssetHandleValid(AssetHandle assetHandle) override;
+		virtual bool IsMemoryAsset(AssetHandle handle) override;
 		virtual bool IsAssetLoaded(AssetHandle handle) override;
 		void RemoveAsset(AssetHandle handle);
 
@@ -95,13 +94,16 @@ namespace X2 {
 				}
 			}*/
 
-			m_AssetRegistry[metadata.Handle] = metadata;
+			m_AssetRegistry.Set(metadata);
 
 			WriteRegistryToFile();
 
 			Ref<T> asset = CreateRef<T>(std::forward<Args>(args)...);
 			asset->Handle = metadata.Handle;
-			m_LoadedAssets[asset->Handle] = asset;
+			{
+				std::scoped_lock<std::mutex> lock(m_AssetMutex);
+				m_LoadedAssets[asset->Handle] = asset;
+			}
 			AssetImporter::Serialize(metadata, asset.get());
 
 			return asset;
@@ -122,8 +124,9 @@ namespace X2 {
 			metadata.Type = TAsset::GetStaticType();
 			metadata.IsMemoryAsset = true;
 
-			m_AssetRegistry[metadata.Handle] = metadata;
+			m_AssetRegistry.Set(metadata);
 
+			std::scoped_lock<std::mutex> lock(m_AssetMutex);
 			m_MemoryAssets[asset->Handle] = asset;
 			return asset->Handle;
 		}
@@ -134,21 +137,24 @@ namespace X2 {
 			Ref<Asset> asset = GetAsset(GetAssetHandleFromFilePath(filepath));
 			return asset.As<T>();
 		}
+	protected:
+		virtual Ref<Asset> LoadAsset(AssetHandle assetHandle) override;
 	private:
 		void LoadAssetRegistry();
 		void ProcessDirectory(const std::filesystem::path& directoryPath);
 		void ReloadAssets();
 		void WriteRegistryToFile();
 
-		AssetMetadata& GetMetadataInternal(AssetHandle handle);
-
 		void OnFileSystemChanged(const std::vector<FileSystemChangedEvent>& events);
 		void OnAssetRenamed(AssetHandle assetHandle, const std::filesystem::path& newFilePath);
 		void OnAssetDeleted(AssetHandle assetHandle);
 	private:
 		std::unordered_map<AssetHandle, Ref<Asset>> m_LoadedAssets;
 		std::unordered_map<AssetHandle, Ref<Asset>> m_MemoryAssets;
+		// Guards the maps above, streaming workers load into them concurrently
+		std::mutex m_AssetMutex;
 		AssetsChangeEventFn m_AssetsChangeCallback;
+		// Does its own locking
 		AssetRegistry m_AssetRegistry;
 
 		friend class ContentBrowserPanel;
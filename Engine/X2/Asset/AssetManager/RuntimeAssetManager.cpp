@@ -16,15 +16,18 @@ namespace X2 {
 
 	RuntimeAssetManager::~RuntimeAssetManager()
 	{
+		StopStreaming();
 	}
 
 	AssetType RuntimeAssetManager::GetAssetType(AssetHandle assetHandle)
 	{
-		Ref<Asset> asset = GetAsset(assetHandle);
-		if (!asset)
-			return AssetType::None;
+		{
+			std::scoped_lock<std::mutex> lock(m_AssetMutex);
+			if (auto it = m_MemoryAssets.find(assetHandle); it != m_MemoryAssets.end())
+				return it->second->GetAssetType();
+		}
 
-		return asset->GetAssetType();
+		return m_AssetPack ? m_AssetPack->GetAssetType(assetHandle) : AssetType::None;
 	}
 
 	Ref<Asset> RuntimeAssetManager::GetAsset(AssetHandle assetHandle)
@@ -32,38 +35,66 @@ namespace X2 {
 		X2_PROFILE_FUNC();
 		X2_SCOPE_PERF("AssetManager::GetAsset");
 
-		if (IsMemoryAsset(assetHandle))
-			return m_MemoryAssets[assetHandle];
-
-		Ref<Asset> asset = nullptr;
-		bool isLoaded = IsAssetLoaded(assetHandle);
-		if (isLoaded)
 		{
-			asset = m_LoadedAssets[assetHandle];
+			std::scoped_lock<std::mutex> lock(m_AssetMutex);
+			if (auto it = m_MemoryAssets.find(assetHandle); it != m_MemoryAssets.end())
+				return it->second;
+
+			if (auto it = m_LoadedAssets.find(assetHandle); it != m_LoadedAssets.end())
+				return it->second;
 		}
-		else
-		{
-			// Needs load
-			asset = m_AssetPack->LoadAsset(m_ActiveScene, assetHandle);
-			if (!asset)
-				return nullptr;
 
-			m_LoadedAssets[assetHandle] = asset;
+		// Keeps the streaming workers and other threads from loading the same asset at the same time,
+		// whoever waited in Claim finds the asset in m_LoadedAssets
+		const bool claimed = m_AssetStreamer && m_AssetStreamer->Claim(assetHandle);
+		Ref<Asset> asset = LoadAsset(assetHandle);
+		if (claimed)
+			m_AssetStreamer->Release(assetHandle, asset != nullptr);
+
+		return asset;
+	}
+
+	Ref<Asset> RuntimeAssetManager::LoadAsset(AssetHandle assetHandle)
+	{
+		X2_PROFILE_FUNC();
+
+		{
+			std::scoped_lock<std::mutex> lock(m_AssetMutex);
+			if (auto it = m_LoadedAssets.find(assetHandle); it != m_LoadedAssets.end())
+				return it->second;
 		}
+
+		// Needs load
+		Ref<Asset> asset = m_AssetPack->LoadAsset(m_ActiveScene, assetHandle);
+		if (!asset)
+			return nullptr;
+
+		std::scoped_lock<std::mutex> lock(m_AssetMutex);
+		m_LoadedAssets[assetHandle] = asset;
+		m_LoadedAssetsVersion++;
 		return asset;
 	}
 
 	void RuntimeAssetManager::AddMemoryOnlyAsset(Ref<Asset> asset)
 	{
+		std::scoped_lock<std::mutex> lock(m_AssetMutex);
 		m_MemoryAssets[asset->Handle] = asset;
 	}
 
 	bool RuntimeAssetManager::ReloadData(AssetHandle assetHandle)
 	{
+		const bool claimed = m_AssetStreamer && m_AssetStreamer->Claim(assetHandle);
+
 		Ref<Asset> asset = m_AssetPack->LoadAsset(m_ActiveScene, assetHandle);
 		if (asset)
+		{
+			std::scoped_lock<std::mutex> lock(m_AssetMutex);
 			m_LoadedAssets[assetHandle] = asset;
+			m_LoadedAssetsVersion++;
+		}
 
+		if (claimed)
+			m_AssetStreamer->Release(assetHandle, asset != nullptr);
 		return asset.get();
 	}
 
@@ -75,13 +106,27 @@ namespace X2 {
 		return IsMemoryAsset(assetHandle) || (m_AssetPack && m_AssetPack->IsAssetHandleValid(assetHandle));
 	}
 
+	std::unordered_map<AssetHandle, Ref<Asset>> RuntimeAssetManager::GetLoadedAssets()
+	{
+		std::scoped_lock<std::mutex> lock(m_AssetMutex);
+		return m_LoadedAssets;
+	}
+
+	std::unordered_map<AssetHandle, Ref<Asset>> RuntimeAssetManager::GetMemoryOnlyAssets()
+	{
+		std::scoped_lock<std::mutex> lock(m_AssetMutex);
+		return m_MemoryAssets;
+	}
+
 	bool RuntimeAssetManager::IsMemoryAsset(AssetHandle handle)
 	{
+		std::scoped_lock<std::mutex> lock(m_AssetMutex);
 		return m_MemoryAssets.find(handle) != m_MemoryAssets.end();
 	}
 
 	bool RuntimeAssetManager::IsAssetLoaded(AssetHandle handle)
 	{
+		std::scoped_lock<std::mutex> lock(m_AssetMutex);
 		return m_LoadedAssets.find(handle) != m_LoadedAssets.end();
 	}
 
@@ -94,6 +139,25 @@ namespace X2 {
 
 	Ref<Scene> RuntimeAssetManager::LoadScene(AssetHandle handle)
 	{
+		X2_PROFILE_FUNC();
+
+		// Decode what can be decoded in parallel up front, the scene then finds it in m_LoadedAssets
+		std::unordered_set<AssetHandle> loaded;
+		{
+			std::scoped_lock<std::mutex> lock(m_AssetMutex);
+			for (const auto& [assetHandle, asset] : m_LoadedAssets)
+				loaded.insert(assetHandle);
+		}
+
+		std::unordered_map<AssetHandle, Ref<Asset>> sceneAssets = m_AssetPack->LoadSceneAssetsParallel(handle, loaded);
+
+		{
+			std::scoped_lock<std::mutex> lock(m_AssetMutex);
+			for (auto& [assetHandle, asset] : sceneAssets)
+				m_LoadedAssets.emplace(assetHandle, asset);
+			m_LoadedAssetsVersion++;
+		}
+
 		Ref<Scene> scene = m_AssetPack->LoadScene(handle);
 		if (scene)
 			m_ActiveScene = handle;
@@ -22,16 +22,20 @@ namespace X2 {
 		virtual bool IsAssetLoaded(AssetHandle handle) override;
 
 		virtual std::unordered_set<AssetHandle> GetAllAssetsWithType(AssetType type) override;
-		virtual const std::unordered_map<AssetHandle, Ref<Asset>>& GetLoadedAssets() override { return m_LoadedAssets; }
-		virtual const std::unordered_map<AssetHandle, Ref<Asset>>& GetMemoryOnlyAssets() override { return m_MemoryAssets; }
+		virtual std::unordered_map<AssetHandle, Ref<Asset>> GetLoadedAssets() override;
+		virtual std::unordered_map<AssetHandle, Ref<Asset>> GetMemoryOnlyAssets() override;
 
 		// Loads Scene and makes active
 		Ref<Scene> LoadScene(AssetHandle handle);
 
 		void SetAssetPack(Ref<AssetPack> assetPack) { m_AssetPack = assetPack; }
+	protected:
+		virtual Ref<Asset> LoadAsset(AssetHandle assetHandle) override;
 	private:
 		std::unordered_map<AssetHandle, Ref<Asset>> m_LoadedAssets;
 		std::unordered_map<AssetHandle, Ref<Asset>> m_MemoryAssets;
+		// Guards the maps above, streaming workers load into them concurrently
+		std::mutex m_AssetMutex;
 
 		// TODO(Yan): support multiple asset packs maybe? Or at least multiple volumes
 		Ref<AssetPack> m_AssetPack;
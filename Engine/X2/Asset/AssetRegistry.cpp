@@ -6,59 +6,169 @@ namespace X2 {
 #define X2_ASSETREGISTRY_LOG 0
 #if X2_ASSETREGISTRY_LOG
 #define ASSET_LOG(...) X2_CORE_TRACE_TAG("ASSET", __VA_ARGS__)
-#else 
+#else
 #define ASSET_LOG(...)
 #endif
 
-	static std::mutex s_AssetRegistryMutex;
+	namespace Utils {
 
-	AssetMetadata& AssetRegistry::operator[](const AssetHandle handle)
+		// Same separators on every platform, so "Meshes\\Cube.xmesh" and "Meshes/Cube.xmesh" share an entry
+		static std::string GetAssetPathKey(const std::filesystem::path& filepath)
+		{
+			return filepath.lexically_normal().generic_string();
+		}
+
+		static bool IsPathIndexed(const AssetMetadata& metadata)
+		{
+			return !metadata.IsMemoryAsset && !metadata.FilePath.empty();
+		}
+
+	}
+
+	void AssetRegistry::Set(const AssetMetadata& metadata)
 	{
-		std::scoped_lock<std::mutex> lock(s_AssetRegistryMutex);
+		Shard& shard = GetShard(metadata.Handle);
+		std::unique_lock<std::shared_mutex> lock(shard.Mutex);
+
+		ASSET_LOG("Setting handle {}", metadata.Handle);
+		auto [it, inserted] = shard.Entries.try_emplace(metadata.Handle, metadata);
+		if (!inserted)
+		{
+			RemovePath(it->second);
+			it->second = metadata;
+		}
+		AddPath(metadata);
+	}
 
-		ASSET_LOG("Retrieving handle {}", handle);
-		return m_AssetRegistry[handle];
+	bool AssetRegistry::SetFilePath(const AssetHandle handle, const std::filesystem::path& filepath)
+	{
+		Shard& shard = GetShard(handle);
+		std::unique_lock<std::shared_mutex> lock(shard.Mutex);
+
+		auto it = shard.Entries.find(handle);
+		if (it == shard.Entries.end())
+			return false;
+
+		ASSET_LOG("Moving handle {} to {}", handle, filepath);
+		RemovePath(it->second);
+		it->second.FilePath = filepath;
+		AddPath(it->second);
+		return true;
 	}
 
-	const AssetMetadata& AssetRegistry::Get(const AssetHandle handle) const
+	bool AssetRegistry::SetDataLoaded(const AssetHandle handle, bool isDataLoaded)
 	{
-		std::scoped_lock<std::mutex> lock(s_AssetRegistryMutex);
+		Shard& shard = GetShard(handle);
+		std::unique_lock<std::shared_mutex> lock(shard.Mutex);
+
+		auto it = shard.Entries.find(handle);
+		if (it == shard.Entries.end())
+			return false;
 
-		X2_CORE_ASSERT(m_AssetRegistry.find(handle) != m_AssetRegistry.end());
-		ASSET_LOG("Retrieving const handle {}", handle);
-		return m_AssetRegistry.at(handle);
+		it->second.IsDataLoaded = isDataLoaded;
+		return true;
 	}
 
-	AssetMetadata& AssetRegistry::Get(const AssetHandle handle)
+	const AssetMetadata* AssetRegistry::Find(const AssetHandle handle) const
 	{
-		std::scoped_lock<std::mutex> lock(s_AssetRegistryMutex);
+		const Shard& shard = GetShard(handle);
+		std::shared_lock<std::shared_mutex> lock(shard.Mutex);
 
 		ASSET_LOG("Retrieving handle {}", handle);
-		return m_AssetRegistry[handle];
+		auto it = shard.Entries.find(handle);
+		return it != shard.Entries.end() ? &it->second : nullptr;
+	}
+
+	bool AssetRegistry::TryGet(const AssetHandle handle, AssetMetadata& outMetadata) const
+	{
+		return Read(handle, [&outMetadata](const AssetMetadata& metadata) { outMetadata = metadata; });
+	}
+
+	AssetHandle AssetRegistry::FindHandle(const std::filesystem::path& filepath) const
+	{
+		const std::string key = Utils::GetAssetPathKey(filepath);
+		const PathShard& pathShard = GetPathShard(key);
+		std::shared_lock<std::shared_mutex> lock(pathShard.Mutex);
+
+		auto it = pathShard.Handles.find(key);
+		return it != pathShard.Handles.end() ? it->second : AssetHandle(0);
+	}
+
+	size_t AssetRegistry::Count() const
+	{
+		size_t count = 0;
+		for (const Shard& shard : m_Shards)
+		{
+			std::shared_lock<std::shared_mutex> lock(shard.Mutex);
+			count += shard.Entries.size();
+		}
+		return count;
 	}
 
 	bool AssetRegistry::Contains(const AssetHandle handle) const
 	{
-		std::scoped_lock<std::mutex> lock(s_AssetRegistryMutex);
+		const Shard& shard = GetShard(handle);
+		std::shared_lock<std::shared_mutex> lock(shard.Mutex);
 
 		ASSET_LOG("Contains handle {}", handle);
-		return m_AssetRegistry.find(handle) != m_AssetRegistry.end();
+		return shard.Entries.find(handle) != shard.Entries.end();
 	}
 
 	size_t AssetRegistry::Remove(const AssetHandle handle)
 	{
-		std::scoped_lock<std::mutex> lock(s_AssetRegistryMutex);
+		Shard& shard = GetShard(handle);
+		std::unique_lock<std::shared_mutex> lock(shard.Mutex);
 
 		ASSET_LOG("Removing handle", handle);
-		return m_AssetRegistry.erase(handle);
+		auto it = shard.Entries.find(handle);
+		if (it == shard.Entries.end())
+			return 0;
+
+		RemovePath(it->second);
+		shard.Entries.erase(it);
+		return 1;
 	}
 
 	void AssetRegistry::Clear()
 	{
-		std::scoped_lock<std::mutex> lock(s_AssetRegistryMutex);
-
 		ASSET_LOG("Clearing registry");
-		m_AssetRegistry.clear();
+		for (Shard& shard : m_Shards)
+		{
+			std::unique_lock<std::shared_mutex> lock(shard.Mutex);
+			shard.Entries.clear();
+		}
+
+		for (PathShard& pathShard : m_PathShards)
+		{
+			std::unique_lock<std::shared_mutex> lock(pathShard.Mutex);
+			pathShard.Handles.clear();
+		}
+	}
+
+	void AssetRegistry::AddPath(const AssetMetadata& metadata)
+	{
+		if (!Utils::IsPathIndexed(metadata))
+			return;
+
+		const std::string key = Utils::GetAssetPathKey(metadata.FilePath);
+		PathShard& pathShard = GetPathShard(key);
+		std::unique_lock<std::shared_mutex> lock(pathShard.Mutex);
+		pathShard.Handles[key] = metadata.Handle;
+	}
+
+	void AssetRegistry::RemovePath(const AssetMetadata& metadata)
+	{
+		if (!Utils::IsPathIndexed(metadata))
+			return;
+
+		const std::string key = Utils::GetAssetPathKey(metadata.FilePath);
+		PathShard& pathShard = GetPathShard(key);
+		std::unique_lock<std::shared_mutex> lock(pathShard.Mutex);
+
+		// Another asset may have been registered under the same path since
+		auto it = pathShard.Handles.find(key);
+		if (it != pathShard.Handles.end() && it->second == metadata.Handle)
+			pathShard.Handles.erase(it);
 	}
 
 }
@@ -2,28 +2,87 @@
 
 #include "AssetMetadata.h"
 
+#include <array>
+#include <shared_mutex>
 #include <unordered_map>
 
 namespace X2 {
 
+	// Thread-safe registry of asset metadata. Entries are spread over shards that each have their own
+	// reader/writer lock, so lookups from streaming workers only wait on writes to the same shard.
+	// File paths are indexed as well, path lookups do not scan the registry
 	class AssetRegistry
 	{
 	public:
-		AssetMetadata& operator[](const AssetHandle handle);
-		AssetMetadata& Get(const AssetHandle handle);
-		const AssetMetadata& Get(const AssetHandle handle) const;
+		// Adds the entry for metadata.Handle, or replaces it
+		void Set(const AssetMetadata& metadata);
+		bool SetFilePath(const AssetHandle handle, const std::filesystem::path& filepath);
+		bool SetDataLoaded(const AssetHandle handle, bool isDataLoaded);
 
-		size_t Count() const { return m_AssetRegistry.size(); }
+		// The entry stays at this address until it is removed, but Set*() may change it from other threads.
+		// Code that can run off the main thread should use TryGet() or Read() instead
+		const AssetMetadata* Find(const AssetHandle handle) const;
+		bool TryGet(const AssetHandle handle, AssetMetadata& outMetadata) const;
+		// Returns 0 if no asset has this (asset directory relative) path, memory assets are not indexed
+		AssetHandle FindHandle(const std::filesystem::path& filepath) const;
+
+		// Runs fn under the entry's read lock, returns false if the handle is not registered
+		template<typename Fn>
+		bool Read(const AssetHandle handle, Fn&& fn) const
+		{
+			const Shard& shard = GetShard(handle);
+			std::shared_lock<std::shared_mutex> lock(shard.Mutex);
+
+			auto it = shard.Entries.find(handle);
+			if (it == shard.Entries.end())
+				return false;
+
+			fn(it->second);
+			return true;
+		}
+
+		// fn runs under each shard's read lock in turn, it must not call back into the registry
+		template<typename Fn>
+		void ForEach(Fn&& fn) const
+		{
+			for (const Shard& shard : m_Shards)
+			{
+				std::shared_lock<std::shared_mutex> lock(shard.Mutex);
+				for (const auto& [handle, metadata] : shard.Entries)
+					fn(metadata);
+			}
+		}
+
+		size_t Count() const;
 		bool Contains(const AssetHandle handle) const;
 		size_t Remove(const AssetHandle handle);
 		void Clear();
+	private:
+		struct Shard
+		{
+			mutable std::shared_mutex Mutex;
+			std::unordered_map<AssetHandle, AssetMetadata> Entries;
+		};
+
+		struct PathShard
+		{
+			mutable std::shared_mutex Mutex;
+			std::unordered_map<std::string, AssetHandle> Handles;
+		};
+
+		static constexpr uint32_t ShardCount = 16;
+
+		Shard& GetShard(const AssetHandle handle) { return m_Shards[std::hash<AssetHandle>()(handle) % ShardCount]; }
+		const Shard& GetShard(const AssetHandle handle) const { return m_Shards[std::hash<AssetHandle>()(handle) % ShardCount]; }
+		PathShard& GetPathShard(const std::string& key) { return m_PathShards[std::hash<std::string>()(key) % ShardCount]; }
+		const PathShard& GetPathShard(const std::string& key) const { return m_PathShards[std::hash<std::string>()(key) % ShardCount]; }
 
-		auto begin() { return m_AssetRegistry.begin(); }
-		auto end() { return m_AssetRegistry.end(); }
-		auto begin() const { return m_AssetRegistry.cbegin(); }
-		auto end() const { return m_AssetRegistry.cend(); }
+		// Called with the entry's shard locked, the entry lock is always taken before a path lock
+		void AddPath(const AssetMetadata& metadata);
+		void RemovePath(const AssetMetadata& metadata);
 	private:
-		std::unordered_map<AssetHandle, AssetMetadata> m_AssetRegistry;
+		std::array<Shard, ShardCount> m_Shards;
+		std::array<PathShard, ShardCount> m_PathShards;
 	};
 
 }
@@ -46,6 +46,15 @@ namespace X2 {
 		outInfo.Offset = stream.GetStreamPosition();
 
 		auto& metadata = Project::GetEditorAssetManager()->GetMetadata(handle);
+
+		// Textures with a source file are mipped and block compressed from it, the rest are read back from the GPU
+		std::filesystem::path filepath = Project::GetEditorAssetManager()->GetFileSystemPath(metadata);
+		if (FileSystem::Exists(filepath))
+		{
+			outInfo.Size = TextureRuntimeSerializer::SerializeTexture2DToFile(filepath, stream);
+			return true;
+		}
+
 		Ref<VulkanTexture2D> texture = AssetManager::GetAsset<VulkanTexture2D>(handle);
 		outInfo.Size = TextureRuntimeSerializer::SerializeTexture2DToFile(texture.get(), stream);
 		return true;
@@ -272,6 +272,8 @@ namespace X2 {
 			}
 		}
 
+		// Copied rather than viewed: the mesh source keeps its vertices and indices on the CPU for
+		// BVHs, picking and submesh triangle views
 		stream.SetStreamPosition(metadata.VertexBufferOffset + streamOffset);
 		stream.ReadArray(meshSource->m_Vertices);
 
@@ -0,0 +1,646 @@
+#include "Precompiled.h"
+#include "TextureCompressor.h"
+
+#include "X2/Core/Debug/Profiler.h"
+
+#include <array>
+#include <climits>
+#include <cmath>
+
+#include <glm/glm.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define X2_TEXTURE_SSE 1
+	#include <immintrin.h>
+#endif
+
+namespace X2 {
+
+	namespace Utils {
+
+		// One RGBA pixel during mip generation, filtered as a single SSE register
+		struct alignas(16) Texel
+		{
+			float Value[4];
+		};
+
+		using Block = uint8_t[16][4];
+
+		static float SRGBToLinear(float value)
+		{
+			return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+		}
+
+		static float LinearToSRGB(float value)
+		{
+			return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+		}
+
+		static const std::array<float, 256>& GetSRGBToLinearTable()
+		{
+			static const std::array<float, 256> table = []()
+			{
+				std::array<float, 256> result;
+				for (uint32_t i = 0; i < 256; i++)
+					result[i] = SRGBToLinear(i / 255.0f);
+				return result;
+			}();
+			return table;
+		}
+
+		static uint8_t ToUNorm8(float value)
+		{
+			return (uint8_t)(glm::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+		}
+
+		//////////////////////////////////////////////////////////////////////////////////
+		// Mip generation
+		//////////////////////////////////////////////////////////////////////////////////
+
+		static std::vector<float> GetFilterWeights(MipFilter filter)
+		{
+			if (filter == MipFilter::Box)
+				return { 0.5f, 0.5f };
+
+			// Kaiser windowed sinc over 8 taps, cut off at the destination's Nyquist frequency.
+			// Tap k sits k - 3.5 source texels away from the destination texel center.
+			constexpr int radius = 4;
+			constexpr float alpha = 4.0f;
+			constexpr float pi = 3.14159265358979f;
+
+			auto besselI0 = [](float x)
+			{
+				float sum = 1.0f, term = 1.0f;
+				for (int i = 1; i < 16; i++)
+				{
+					const float factor = x * 0.5f / i;
+					term *= factor * factor;
+					sum += term;
+				}
+				return sum;
+			};
+
+			std::vector<float> weights(radius * 2);
+			float total = 0.0f;
+			for (int k = 0; k < radius * 2; k++)
+			{
+				const float distance = k - radius + 0.5f;
+				const float t = distance / radius;
+				const float x = pi * distance * 0.5f;
+				const float sinc = x == 0.0f ? 1.0f : std::sin(x) / x;
+				const float window = besselI0(alpha * std::sqrt(std::max(1.0f - t * t, 0.0f))) / besselI0(alpha);
+
+				weights[k] = sinc * window;
+				total += weights[k];
+			}
+
+			for (float& weight : weights)
+				weight /= total;
+			return weights;
+		}
+
+		// Halves the image along one axis, the edges are clamped
+		static void DownsampleAxis(const std::vector<Texel>& source, std::vector<Texel>& destination, uint32_t width, uint32_t height, bool horizontal, const std::vector<float>& weights)
+		{
+			const uint32_t sourceLength = horizontal ? width : height;
+			const uint32_t destinationLength = std::max(sourceLength / 2, 1u);
+			const uint32_t lineCount = horizontal ? height : width;
+			destination.resize((size_t)destinationLength * lineCount);
+
+			auto sourceIndex = [&](uint32_t line, uint32_t i) { return horizontal ? (size_t)line * width + i : (size_t)i * width + line; };
+			auto destinationIndex = [&](uint32_t line, uint32_t i) { return horizontal ? (size_t)line * destinationLength + i : (size_t)i * width + line; };
+
+			const int radius = (int)weights.size() / 2;
+			for (uint32_t line = 0; line < lineCount; line++)
+			{
+				for (uint32_t i = 0; i < destinationLength; i++)
+				{
+					if (sourceLength == 1)
+					{
+						destination[destinationIndex(line, i)] = source[sourceIndex(line, 0)];
+						continue;
+					}
+
+					const int firstTap = (int)i * 2 - radius + 1;
+					Texel& result = destination[destinationIndex(line, i)];
+
+#ifdef X2_TEXTURE_SSE
+					__m128 sum = _mm_setzero_ps();
+					for (int k = 0; k < (int)weights.size(); k++)
+					{
+						const uint32_t tap = (uint32_t)glm::clamp(firstTap + k, 0, (int)sourceLength - 1);
+						sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_load_ps(source[sourceIndex(line, tap)].Value)));
+					}
+					_mm_store_ps(result.Value, sum);
+#else
+					result = {};
+					for (int k = 0; k < (int)weights.size(); k++)
+					{
+						const uint32_t tap = (uint32_t)glm::clamp(firstTap + k, 0, (int)sourceLength - 1);
+						const Texel& texel = source[sourceIndex(line, tap)];
+						for (uint32_t c = 0; c < 4; c++)
+							result.Value[c] += weights[k] * texel.Value[c];
+					}
+#endif
+				}
+			}
+		}
+
+		static std::vector<Texel> DecodeTexels(Buffer imageData, ImageFormat format, size_t texelCount, TextureRole role)
+		{
+			std::vector<Texel> texels(texelCount);
+			if (format == ImageFormat::RGBA32F)
+			{
+				memcpy(texels.data(), imageData.Data, texelCount * sizeof(Texel));
+				return texels;
+			}
+
+			const auto& srgbTable = GetSRGBToLinearTable();
+			const uint8_t* pixels = (const uint8_t*)imageData.Data;
+			for (size_t i = 0; i < texelCount; i++)
+			{
+				for (uint32_t c = 0; c < 4; c++)
+				{
+					const uint8_t value = pixels[i * 4 + c];
+					texels[i].Value[c] = role == TextureRole::Color && c < 3 ? srgbTable[value] : value / 255.0f;
+				}
+			}
+			return texels;
+		}
+
+		// Removes the overshoot of the filter and keeps normals unit length
+		static void FinishMip(std::vector<Texel>& texels, TextureRole role)
+		{
+			for (Texel& texel : texels)
+			{
+				if (role == TextureRole::HDR)
+				{
+					for (float& value : texel.Value)
+						value = std::max(value, 0.0f);
+					continue;
+				}
+
+				for (float& value : texel.Value)
+					value = glm::clamp(value, 0.0f, 1.0f);
+
+				if (role == TextureRole::Normal)
+				{
+					glm::vec3 normal = glm::vec3(texel.Value[0], texel.Value[1], texel.Value[2]) * 2.0f - 1.0f;
+					const float length = glm::length(normal);
+					normal = length > 0.0f ? normal / length : glm::vec3(0.0f, 0.0f, 1.0f);
+					texel.Value[0] = normal.x * 0.5f + 0.5f;
+					texel.Value[1] = normal.y * 0.5f + 0.5f;
+					texel.Value[2] = normal.z * 0.5f + 0.5f;
+				}
+			}
+		}
+
+		static void EncodeTexels(const std::vector<Texel>& texels, TextureRole role, std::vector<uint8_t>& outPixels)
+		{
+			outPixels.resize(texels.size() * 4);
+			for (size_t i = 0; i < texels.size(); i++)
+			{
+				for (uint32_t c = 0; c < 4; c++)
+				{
+					const float value = texels[i].Value[c];
+					outPixels[i * 4 + c] = ToUNorm8(role == TextureRole::Color && c < 3 ? LinearToSRGB(value) : value);
+				}
+			}
+		}
+
+		//////////////////////////////////////////////////////////////////////////////////
+		// Block encoders
+		//////////////////////////////////////////////////////////////////////////////////
+
+		static void GetBlock(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY, Block& block)
+		{
+			// Blocks past the edge of small mips repeat the last row/column
+			for (uint32_t y = 0; y < 4; y++)
+			{
+				const uint32_t pixelY = std::min(blockY * 4 + y, height - 1);
+				for (uint32_t x = 0; x < 4; x++)
+				{
+					const uint32_t pixelX = std::min(blockX * 4 + x, width - 1);
+					memcpy(block[y * 4 + x], pixels + ((size_t)pixelY * width + pixelX) * 4, 4);
+				}
+			}
+		}
+
+		// Fits a line through the block colors (first channelCount channels) and returns its end points,
+		// pulled in slightly since the extremes rarely land on an interpolated value
+		static void FitEndpoints(const Block& block, uint32_t channelCount, float (&outEndpoints)[2][4])
+		{
+			float mean[4] = {};
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				for (uint32_t c = 0; c < channelCount; c++)
+					mean[c] += block[i][c] / 16.0f;
+			}
+
+			float covariance[4][4] = {};
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				for (uint32_t a = 0; a < channelCount; a++)
+				{
+					for (uint32_t b = 0; b < channelCount; b++)
+						covariance[a][b] += (block[i][a] - mean[a]) * (block[i][b] - mean[b]);
+				}
+			}
+
+			// Principal axis by power iteration, starting from the channel with the largest variance
+			uint32_t largest = 0;
+			for (uint32_t c = 1; c < channelCount; c++)
+			{
+				if (covariance[c][c] > covariance[largest][largest])
+					largest = c;
+			}
+
+			float axis[4] = {};
+			for (uint32_t c = 0; c < channelCount; c++)
+				axis[c] = covariance[largest][c];
+
+			for (uint32_t iteration = 0; iteration < 8; iteration++)
+			{
+				float next[4] = {};
+				float length = 0.0f;
+				for (uint32_t a = 0; a < channelCount; a++)
+				{
+					for (uint32_t b = 0; b < channelCount; b++)
+						next[a] += covariance[a][b] * axis[b];
+					length += next[a] * next[a];
+				}
+
+				if (length <= 0.0f)
+					break;
+
+				length = std::sqrt(length);
+				for (uint32_t c = 0; c < channelCount; c++)
+					axis[c] = next[c] / length;
+			}
+
+			float minT = 0.0f, maxT = 0.0f;
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				float t = 0.0f;
+				for (uint32_t c = 0; c < channelCount; c++)
+					t += (block[i][c] - mean[c]) * axis[c];
+				minT = std::min(minT, t);
+				maxT = std::max(maxT, t);
+			}
+
+			const float inset = (maxT - minT) / 32.0f;
+			minT += inset;
+			maxT -= inset;
+
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				outEndpoints[0][c] = c < channelCount ? glm::clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f) : 255.0f;
+				outEndpoints[1][c] = c < channelCount ? glm::clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f) : 255.0f;
+			}
+		}
+
+		template<uint32_t ChannelCount, uint32_t PaletteSize>
+		static uint32_t FindClosest(const uint8_t* color, const int (&palette)[PaletteSize][4])
+		{
+			uint32_t best = 0;
+			int bestError = INT_MAX;
+			for (uint32_t i = 0; i < PaletteSize; i++)
+			{
+				int error = 0;
+				for (uint32_t c = 0; c < ChannelCount; c++)
+				{
+					const int difference = (int)color[c] - palette[i][c];
+					error += difference * difference;
+				}
+
+				if (error < bestError)
+				{
+					best = i;
+					bestError = error;
+				}
+			}
+			return best;
+		}
+
+		static uint16_t PackRGB565(const float (&color)[4])
+		{
+			const uint32_t r = (uint32_t)(color[0] * 31.0f / 255.0f + 0.5f);
+			const uint32_t g = (uint32_t)(color[1] * 63.0f / 255.0f + 0.5f);
+			const uint32_t b = (uint32_t)(color[2] * 31.0f / 255.0f + 0.5f);
+			return (uint16_t)((r << 11) | (g << 5) | b);
+		}
+
+		static void UnpackRGB565(uint16_t packed, int (&outColor)[4])
+		{
+			const int r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+			outColor[0] = (r << 3) | (r >> 2);
+			outColor[1] = (g << 2) | (g >> 4);
+			outColor[2] = (b << 3) | (b >> 2);
+			outColor[3] = 255;
+		}
+
+		// BC1 color block, always in 4 color mode so it is valid inside BC3 as well
+		static void EncodeColorBlock(const Block& block, uint8_t* out)
+		{
+			float endpoints[2][4];
+			FitEndpoints(block, 3, endpoints);
+
+			uint16_t color0 = PackRGB565(endpoints[0]);
+			uint16_t color1 = PackRGB565(endpoints[1]);
+			if (color0 < color1)
+				std::swap(color0, color1);
+
+			uint32_t indices = 0;
+			if (color0 != color1)
+			{
+				int palette[4][4];
+				UnpackRGB565(color0, palette[0]);
+				UnpackRGB565(color1, palette[1]);
+				for (uint32_t c = 0; c < 3; c++)
+				{
+					palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+					palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+				}
+
+				for (uint32_t i = 0; i < 16; i++)
+					indices |= FindClosest<3, 4>(block[i], palette) << (i * 2);
+			}
+
+			memcpy(out, &color0, 2);
+			memcpy(out + 2, &color1, 2);
+			memcpy(out + 4, &indices, 4);
+		}
+
+		// BC4 block of one channel, in 8 value mode
+		static void EncodeChannelBlock(const Block& block, uint32_t channel, uint8_t* out)
+		{
+			int minValue = 255, maxValue = 0;
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				minValue = std::min(minValue, (int)block[i][channel]);
+				maxValue = std::max(maxValue, (int)block[i][channel]);
+			}
+
+			out[0] = (uint8_t)maxValue;
+			out[1] = (uint8_t)minValue;
+
+			uint64_t indices = 0;
+			if (maxValue > minValue)
+			{
+				int palette[8][4] = {};
+				palette[0][0] = maxValue;
+				palette[1][0] = minValue;
+				for (int i = 2; i < 8; i++)
+					palette[i][0] = ((8 - i) * maxValue + (i - 1) * minValue + 3) / 7;
+
+				for (uint32_t i = 0; i < 16; i++)
+				{
+					const uint8_t value = block[i][channel];
+					indices |= (uint64_t)FindClosest<1, 8>(&value, palette) << (i * 3);
+				}
+			}
+
+			for (uint32_t i = 0; i < 6; i++)
+				out[2 + i] = (uint8_t)(indices >> (i * 8));
+		}
+
+		// BC7 mode 6: a single RGBA line with 7 bit end points, a p-bit each and 4 bit indices
+		static void EncodeBC7Block(const Block& block, uint8_t* out)
+		{
+			static constexpr int s_Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+			float endpoints[2][4];
+			FitEndpoints(block, 4, endpoints);
+
+			int quantized[2][4];
+			int pBits[2];
+			int palette[16][4];
+			for (uint32_t e = 0; e < 2; e++)
+			{
+				float bestError = FLT_MAX;
+				for (int p = 0; p < 2; p++)
+				{
+					int candidate[4];
+					float error = 0.0f;
+					for (uint32_t c = 0; c < 4; c++)
+					{
+						candidate[c] = glm::clamp((int)std::lround((endpoints[e][c] - p) / 2.0f), 0, 127);
+						const float difference = (float)((candidate[c] << 1) | p) - endpoints[e][c];
+						error += difference * difference;
+					}
+
+					if (error < bestError)
+					{
+						bestError = error;
+						pBits[e] = p;
+						memcpy(quantized[e], candidate, sizeof(candidate));
+					}
+				}
+			}
+
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				for (uint32_t c = 0; c < 4; c++)
+				{
+					const int endpoint0 = (quantized[0][c] << 1) | pBits[0];
+					const int endpoint1 = (quantized[1][c] << 1) | pBits[1];
+					palette[i][c] = ((64 - s_Weights[i]) * endpoint0 + s_Weights[i] * endpoint1 + 32) >> 6;
+				}
+			}
+
+			uint32_t indices[16];
+			for (uint32_t i = 0; i < 16; i++)
+				indices[i] = FindClosest<4, 16>(block[i], palette);
+
+			// The first index is stored without its top bit, swap the end points if it is set
+			if (indices[0] & 8)
+			{
+				std::swap(quantized[0], quantized[1]);
+				std::swap(pBits[0], pBits[1]);
+				for (uint32_t& index : indices)
+					index = 15 - index;
+			}
+
+			uint8_t bits[16] = {};
+			uint32_t position = 0;
+			auto write = [&](uint32_t value, uint32_t count)
+			{
+				for (uint32_t i = 0; i < count; i++, position++)
+				{
+					if (value & (1u << i))
+						bits[position >> 3] |= (uint8_t)(1u << (position & 7));
+				}
+			};
+
+			write(1u << 6, 7); // Mode 6
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				write(quantized[0][c], 7);
+				write(quantized[1][c], 7);
+			}
+			write(pBits[0], 1);
+			write(pBits[1], 1);
+			write(indices[0], 3);
+			for (uint32_t i = 1; i < 16; i++)
+				write(indices[i], 4);
+
+			memcpy(out, bits, 16);
+		}
+
+		static void CompressLevel(const uint8_t* pixels, uint32_t width, uint32_t height, ImageFormat format, uint8_t* out)
+		{
+			const uint32_t blockSize = (format == ImageFormat::BC1 || format == ImageFormat::BC4) ? 8 : 16;
+			const uint32_t blocksX = (width + 3) / 4;
+			const uint32_t blocksY = (height + 3) / 4;
+
+			Block block;
+			for (uint32_t blockY = 0; blockY < blocksY; blockY++)
+			{
+				for (uint32_t blockX = 0; blockX < blocksX; blockX++)
+				{
+					GetBlock(pixels, width, height, blockX, blockY, block);
+
+					uint8_t* blockOut = out + ((size_t)blockY * blocksX + blockX) * blockSize;
+					switch (format)
+					{
+					case ImageFormat::BC1: EncodeColorBlock(block, blockOut); break;
+					case ImageFormat::BC3: EncodeChannelBlock(block, 3, blockOut); EncodeColorBlock(block, blockOut + 8); break;
+					case ImageFormat::BC4: EncodeChannelBlock(block, 0, blockOut); break;
+					case ImageFormat::BC5: EncodeChannelBlock(block, 0, blockOut); EncodeChannelBlock(block, 1, blockOut + 8); break;
+					case ImageFormat::BC7: EncodeBC7Block(block, blockOut); break;
+					default: X2_CORE_ASSERT(false, "Not a block compressed format");
+					}
+				}
+			}
+		}
+
+		static ImageFormat GetBlockFormat(TextureRole role, bool hasAlpha, const TextureCompressionSettings& settings)
+		{
+			switch (role)
+			{
+			case TextureRole::Color:  return settings.HighQuality ? ImageFormat::BC7 : (hasAlpha ? ImageFormat::BC3 : ImageFormat::BC1);
+			case TextureRole::Normal: return ImageFormat::BC5;
+			case TextureRole::Mask:   return ImageFormat::BC4;
+			case TextureRole::HDR:    return ImageFormat::RGBA32F;
+			}
+			X2_CORE_ASSERT(false, "Unknown texture role");
+			return ImageFormat::None;
+		}
+
+	}
+
+	TextureRole TextureCompressor::DetectRole(const std::filesystem::path& filepath, Buffer imageData, ImageFormat format, uint32_t width, uint32_t height)
+	{
+		if (format == ImageFormat::RGBA32F)
+			return TextureRole::HDR;
+
+		if (format != ImageFormat::RGBA || !imageData)
+			return TextureRole::None;
+
+		std::string name = filepath.stem().string();
+		std::transform(name.begin(), name.end(), name.begin(), [](char c) { return (char)std::tolower(c); });
+
+		auto endsWith = [&name](std::string_view suffix) { return name.size() >= suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0; };
+		if (name.find("normal") != std::string::npos || endsWith("_n") || endsWith("_nrm") || endsWith("_nor") || endsWith("_norm"))
+			return TextureRole::Normal;
+
+		const size_t pixelCount = (size_t)width * height;
+		const uint8_t* pixels = (const uint8_t*)imageData.Data;
+
+		bool grayscale = true;
+		size_t unitLengthCount = 0;
+		float zSum = 0.0f;
+		for (size_t i = 0; i < pixelCount; i++)
+		{
+			const uint8_t* pixel = pixels + i * 4;
+			if (std::abs(pixel[0] - pixel[1]) > 2 || std::abs(pixel[1] - pixel[2]) > 2 || pixel[3] != 255)
+				grayscale = false;
+
+			const glm::vec3 normal = glm::vec3(pixel[0], pixel[1], pixel[2]) / 127.5f - 1.0f;
+			const float length = glm::length(normal);
+			if (length > 0.85f && length < 1.15f && normal.z >= 0.0f)
+				unitLengthCount++;
+			zSum += normal.z;
+		}
+
+		if (grayscale)
+			return TextureRole::Mask;
+
+		// Mostly unit length vectors pointing out of the surface
+		if (unitLengthCount >= pixelCount * 95 / 100 && zSum / pixelCount > 0.6f)
+			return TextureRole::Normal;
+
+		return TextureRole::Color;
+	}
+
+	CompressedTexture TextureCompressor::Compress(Buffer imageData, ImageFormat format, uint32_t width, uint32_t height, TextureRole role, const TextureCompressionSettings& settings)
+	{
+		X2_PROFILE_FUNC();
+
+		X2_CORE_ASSERT(format == ImageFormat::RGBA || format == ImageFormat::RGBA32F);
+		X2_CORE_ASSERT((role == TextureRole::HDR) == (format == ImageFormat::RGBA32F), "HDR textures must be RGBA32F");
+
+		bool hasAlpha = false;
+		if (format == ImageFormat::RGBA)
+		{
+			const uint8_t* pixels = (const uint8_t*)imageData.Data;
+			for (size_t i = 0; i < (size_t)width * height && !hasAlpha; i++)
+				hasAlpha = pixels[i * 4 + 3] != 255;
+		}
+
+		CompressedTexture result;
+		result.Format = Utils::GetBlockFormat(role, hasAlpha, settings);
+		result.Width = width;
+		result.Height = height;
+		result.Mips = Utils::CalculateMipCount(width, height);
+
+		uint64_t size = 0;
+		for (uint32_t mip = 0; mip < result.Mips; mip++)
+			size += Utils::GetImageMemorySize(result.Format, std::max(width >> mip, 1u), std::max(height >> mip, 1u));
+		result.Data.Allocate(size);
+
+		const std::vector<float> weights = Utils::GetFilterWeights(settings.Filter);
+
+		// Every mip is filtered from the unquantized previous one
+		std::vector<Utils::Texel> texels = Utils::DecodeTexels(imageData, format, (size_t)width * height, role);
+		std::vector<Utils::Texel> halved;
+		std::vector<uint8_t> pixels;
+
+		uint8_t* out = (uint8_t*)result.Data.Data;
+		uint32_t mipWidth = width, mipHeight = height;
+		for (uint32_t mip = 0; mip < result.Mips; mip++)
+		{
+			if (mip > 0)
+			{
+				Utils::DownsampleAxis(texels, halved, mipWidth, mipHeight, true, weights);
+				mipWidth = std::max(mipWidth / 2, 1u);
+				Utils::DownsampleAxis(halved, texels, mipWidth, mipHeight, false, weights);
+				mipHeight = std::max(mipHeight / 2, 1u);
+				Utils::FinishMip(texels, role);
+			}
+
+			if (role == TextureRole::HDR)
+			{
+				memcpy(out, texels.data(), texels.size() * sizeof(Utils::Texel));
+			}
+			else
+			{
+				// The top level is compressed straight from the source pixels
+				const uint8_t* levelPixels = (const uint8_t*)imageData.Data;
+				if (mip > 0)
+				{
+					Utils::EncodeTexels(texels, role, pixels);
+					levelPixels = pixels.data();
+				}
+
+				Utils::CompressLevel(levelPixels, mipWidth, mipHeight, result.Format, out);
+			}
+
+			out += Utils::GetImageMemorySize(result.Format, mipWidth, mipHeight);
+		}
+
+		X2_CORE_ASSERT(out == (uint8_t*)result.Data.Data + size);
+		return result;
+	}
+
+}
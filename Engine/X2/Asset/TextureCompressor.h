@@ -0,0 +1,55 @@
+#pragma once
+
+#include "X2/Core/Buffer.h"
+#include "X2/Vulkan/VulkanImage.h"
+
+#include <filesystem>
+
+namespace X2 {
+
+	// What a texture is sampled as, decides how its mips are filtered and which block format it gets
+	enum class TextureRole
+	{
+		None = 0,
+		Color,  // sRGB encoded color, filtered in linear space. BC7, or BC1/BC3 in fast mode
+		Normal, // Tangent space normal map, renormalized per mip. BC5, z is reconstructed in the shader
+		Mask,   // Single channel data (roughness, metalness, AO, grayscale). BC4, sampled as grayscale
+		HDR     // Float data, mips are generated but the texture stays RGBA32F
+	};
+
+	enum class MipFilter
+	{
+		Box = 0,
+		Kaiser
+	};
+
+	struct TextureCompressionSettings
+	{
+		MipFilter Filter = MipFilter::Kaiser;
+		// BC7 for color textures, otherwise BC1 (opaque) or BC3 (alpha) which encode much faster
+		bool HighQuality = true;
+	};
+
+	struct CompressedTexture
+	{
+		Buffer Data; // All mips, largest first
+		ImageFormat Format = ImageFormat::None;
+		uint32_t Width = 0, Height = 0;
+		uint32_t Mips = 0;
+	};
+
+	//
+	// Offline texture processing for asset packs: builds the full mip chain on the CPU and
+	// block compresses every level, so nothing is left for the GPU to generate at load time.
+	//
+	class TextureCompressor
+	{
+	public:
+		// Guesses the role from the file name and the image content. imageData is RGBA or RGBA32F.
+		static TextureRole DetectRole(const std::filesystem::path& filepath, Buffer imageData, ImageFormat format, uint32_t width, uint32_t height);
+
+		// The returned data is owned by the caller
+		static CompressedTexture Compress(Buffer imageData, ImageFormat format, uint32_t width, uint32_t height, TextureRole role, const TextureCompressionSettings& settings = {});
+	};
+
+}
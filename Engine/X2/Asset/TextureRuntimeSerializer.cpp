@@ -1,6 +1,7 @@
 #include "Precompiled.h"
 #include "TextureRuntimeSerializer.h"
 
+#include "X2/Asset/TextureCompressor.h"
 #include "X2/Asset/TextureImporter.h"
 
 namespace X2 {
@@ -58,8 +59,8 @@ namespace X2 {
 		TextureCubeMetadata metadata;
 		stream.ReadRaw<TextureCubeMetadata>(metadata);
 
-		Buffer buffer;
-		stream.ReadBuffer(buffer);
+		// Points into the pack mapping, CopyFromBuffer uploads straight from it
+		Buffer buffer = stream.ReadBufferView();
 
 		TextureSpecification spec;
 		spec.Width = metadata.Width;
@@ -73,13 +74,33 @@ namespace X2 {
 
 	uint64_t TextureRuntimeSerializer::SerializeTexture2DToFile(const std::filesystem::path& filepath, FileStreamWriter& stream)
 	{
-		// NOTE(Yan): serializing/deserializing mips is not support atm
+		ImageFormat format;
+		uint32_t width, height;
+		Buffer imageBuffer = TextureImporter::ToBufferFromFile(filepath, format, width, height);
+
 		Texture2DMetadata metadata;
+		metadata.Width = width;
+		metadata.Height = height;
+		metadata.Format = (uint16_t)format;
 		metadata.Mips = 1;
-		Buffer imageBuffer = TextureImporter::ToBufferFromFile(filepath, (ImageFormat&)metadata.Format, metadata.Width, metadata.Height);
 
-		uint64_t writtenSize = SerializeTexture2DToFile(imageBuffer, metadata, stream);
+		const TextureRole role = TextureCompressor::DetectRole(filepath, imageBuffer, format, width, height);
+		if (role == TextureRole::None)
+		{
+			uint64_t writtenSize = SerializeTexture2DToFile(imageBuffer, metadata, stream);
+			imageBuffer.Release();
+			return writtenSize;
+		}
+
+		// Full mip chain, block compressed unless it is HDR
+		CompressedTexture compressed = TextureCompressor::Compress(imageBuffer, format, width, height, role);
 		imageBuffer.Release();
+
+		metadata.Format = (uint16_t)compressed.Format;
+		metadata.Mips = (uint8_t)compressed.Mips;
+
+		uint64_t writtenSize = SerializeTexture2DToFile(compressed.Data, metadata, stream);
+		compressed.Data.Release();
 		return writtenSize;
 	}
 
@@ -115,18 +136,19 @@ namespace X2 {
 		Texture2DMetadata metadata;
 		stream.ReadRaw<Texture2DMetadata>(metadata);
 
-		Buffer buffer;
-		stream.ReadBuffer(buffer);
+		// Points into the pack mapping, or into the decompressed data for compressed assets
+		Buffer buffer = stream.ReadBufferView();
 
 		TextureSpecification spec;
 		spec.Width = metadata.Width;
 		spec.Height = metadata.Height;
 		spec.Format = (ImageFormat)metadata.Format;
 		spec.GenerateMips = true;
+		spec.StoredMips = metadata.Mips;
 
-		Ref<VulkanTexture2D> texture = CreateRef<VulkanTexture2D>(spec, buffer);
-		buffer.Release();
-		return texture;
+		// The pack mapping lives as long as the asset pack, so the upload can read it in place.
+		// Decompressed data is released once the asset is deserialized and has to be copied.
+		return CreateRef<VulkanTexture2D>(spec, buffer, !stream.HasPersistentViews());
 	}
 
 }
@@ -0,0 +1,174 @@
+#include "Precompiled.h"
+#include "Benchmark.h"
+
+#include "X2/Math/BVH.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+
+namespace X2::Benchmarks {
+
+	namespace Utils {
+
+		struct RayHit
+		{
+			bool Hit = false;
+			float Distance = 0.0f;
+		};
+
+		// Hit or miss has to agree, distances only up to rounding since the trees can reach the same
+		// distance through different triangles on shared edges
+		static uint32_t CountMismatches(const std::vector<RayHit>& reference, const std::vector<RayHit>& hits)
+		{
+			uint32_t mismatches = 0;
+			for (size_t i = 0; i < reference.size(); i++)
+			{
+				if (reference[i].Hit != hits[i].Hit)
+					mismatches++;
+				else if (reference[i].Hit && glm::abs(reference[i].Distance - hits[i].Distance) > 1e-4f * glm::max(reference[i].Distance, 1.0f))
+					mismatches++;
+			}
+			return mismatches;
+		}
+
+		static void CheckHits(const char* name, const std::vector<RayHit>& reference, const std::vector<RayHit>& hits)
+		{
+			const uint32_t mismatches = CountMismatches(reference, hits);
+			if (mismatches)
+				X2_CORE_ERROR_TAG("Benchmark", "{}: {} of {} rays differ from the binary BVH", name, mismatches, reference.size());
+		}
+
+	}
+
+	// Binary BVH traversal against the BVH4, one ray at a time and as 4, 8 and 16 ray packets.
+	// Primary rays of a camera looking over a displaced grid, so neighbouring rays are coherent.
+	void RunBVH()
+	{
+		constexpr uint32_t gridSize = 256;
+		constexpr uint32_t imageSize = 256;
+		constexpr uint32_t rayCount = imageSize * imageSize;
+		constexpr uint32_t iterations = 10;
+
+		std::vector<Volume::AABB> aabbs;
+		std::vector<Volume::BVHTriangle> data;
+		aabbs.reserve(gridSize * gridSize * 2);
+		data.reserve(gridSize * gridSize * 2);
+
+		std::mt19937 random(1234);
+		std::uniform_real_distribution<float> noise(-0.5f, 0.5f);
+		std::vector<glm::vec3> vertices((gridSize + 1) * (gridSize + 1));
+		for (uint32_t z = 0; z <= gridSize; z++)
+		{
+			for (uint32_t x = 0; x <= gridSize; x++)
+			{
+				const float height = 8.0f * glm::sin(x * 0.05f) * glm::cos(z * 0.07f) + noise(random);
+				vertices[z * (gridSize + 1) + x] = glm::vec3((float)x, height, (float)z);
+			}
+		}
+
+		auto addTriangle = [&](const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2)
+		{
+			Volume::BVHTriangle& triangle = data.emplace_back();
+			triangle.v0 = v0;
+			triangle.v1 = v1;
+			triangle.v2 = v2;
+			triangle.idx = (uint32_t)data.size() - 1;
+			aabbs.emplace_back(glm::min(v0, glm::min(v1, v2)), glm::max(v0, glm::max(v1, v2)));
+		};
+
+		for (uint32_t z = 0; z < gridSize; z++)
+		{
+			for (uint32_t x = 0; x < gridSize; x++)
+			{
+				const glm::vec3& v00 = vertices[z * (gridSize + 1) + x];
+				const glm::vec3& v10 = vertices[z * (gridSize + 1) + x + 1];
+				const glm::vec3& v01 = vertices[(z + 1) * (gridSize + 1) + x];
+				const glm::vec3& v11 = vertices[(z + 1) * (gridSize + 1) + x + 1];
+				addTriangle(v00, v10, v11);
+				addTriangle(v00, v11, v01);
+			}
+		}
+
+		const Volume::BVH bvh(aabbs, data);
+		const Volume::BVH4 bvh4(bvh);
+
+		// Rays are stored in 4x4 pixel tiles, in 2x2 quads within a tile, so every run of 4, 8 or 16
+		// rays covers a 2x2, 4x2 or 4x4 block of pixels
+		const glm::mat4 projection = glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 1000.0f);
+		const glm::mat4 view = glm::lookAt(glm::vec3(-20.0f, 40.0f, -20.0f), glm::vec3(128.0f, 0.0f, 128.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		const glm::mat4 inverseViewProjection = glm::inverse(projection * view);
+		const glm::vec3 cameraPosition(-20.0f, 40.0f, -20.0f);
+
+		std::vector<Volume::Ray> rays;
+		rays.reserve(rayCount);
+		for (uint32_t tileY = 0; tileY < imageSize; tileY += 4)
+		{
+			for (uint32_t tileX = 0; tileX < imageSize; tileX += 4)
+			{
+				for (uint32_t i = 0; i < 16; i++)
+				{
+					const uint32_t quad = i / 4, pixel = i % 4;
+					const uint32_t x = tileX + (quad % 2) * 2 + pixel % 2;
+					const uint32_t y = tileY + (quad / 2) * 2 + pixel / 2;
+
+					const glm::vec2 ndc = (glm::vec2((float)x, (float)y) + 0.5f) / (float)imageSize * 2.0f - 1.0f;
+					const glm::vec4 target = inverseViewProjection * glm::vec4(ndc, 1.0f, 1.0f);
+					rays.emplace_back(cameraPosition, glm::normalize(glm::vec3(target) / target.w - cameraPosition));
+				}
+			}
+		}
+
+		std::vector<Utils::RayHit> reference(rayCount), hits(rayCount);
+
+		std::vector<std::pair<int32_t, float>> stack(64);
+		Benchmark::Measure("BVH, binary, single rays", iterations, rayCount, [&]()
+		{
+			Volume::BVHTriangle triangle;
+			glm::vec3 intersection;
+			for (uint32_t r = 0; r < rayCount; r++)
+			{
+				reference[r].Hit = bvh.GetIntersection(stack, rays[r], triangle, intersection);
+				reference[r].Distance = intersection.x;
+			}
+		});
+
+		uint32_t hitCount = 0;
+		for (const Utils::RayHit& hit : reference)
+			hitCount += hit.Hit ? 1 : 0;
+		X2_CORE_INFO_TAG("Benchmark", "BVH: {} triangles, {} of {} rays hit", data.size(), hitCount, rayCount);
+
+		Benchmark::Measure("BVH, BVH4, single rays", iterations, rayCount, [&]()
+		{
+			Volume::BVHTriangle triangle;
+			glm::vec3 intersection;
+			for (uint32_t r = 0; r < rayCount; r++)
+			{
+				hits[r].Hit = bvh4.GetIntersection(stack, rays[r], triangle, intersection);
+				hits[r].Distance = intersection.x;
+			}
+		});
+		Utils::CheckHits("BVH, BVH4, single rays", reference, hits);
+
+		std::vector<Volume::BVH4::PacketStackEntry> packetStack(64);
+		for (uint32_t packetSize : { 4u, 8u, 16u })
+		{
+			const std::string name = fmt::format("BVH, BVH4, {} ray packets", packetSize);
+			Benchmark::Measure(name.c_str(), iterations, rayCount, [&]()
+			{
+				Volume::BVHTriangle triangles[Volume::BVH4::maxPacketSize];
+				glm::vec3 intersections[Volume::BVH4::maxPacketSize];
+				for (uint32_t first = 0; first < rayCount; first += packetSize)
+				{
+					const uint32_t hitMask = bvh4.GetIntersections(packetStack, rays.data() + first, packetSize, triangles, intersections);
+					for (uint32_t r = 0; r < packetSize; r++)
+					{
+						hits[first + r].Hit = hitMask & (1u << r);
+						hits[first + r].Distance = intersections[r].x;
+					}
+				}
+			});
+			Utils::CheckHits(name.c_str(), reference, hits);
+		}
+	}
+
+}
@@ -0,0 +1,43 @@
+#include "Precompiled.h"
+#include "Benchmark.h"
+
+namespace X2 {
+
+	double Benchmark::Measure(const char* name, uint32_t iterations, uint64_t itemCount, const std::function<void()>& func, const std::function<void()>& reset)
+	{
+		X2_CORE_ASSERT(iterations > 0);
+
+		func();
+		if (reset)
+			reset();
+
+		std::vector<double> times(iterations);
+		for (uint32_t i = 0; i < iterations; i++)
+		{
+			const auto start = std::chrono::high_resolution_clock::now();
+			func();
+			times[i] = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+			if (reset)
+				reset();
+		}
+
+		std::sort(times.begin(), times.end());
+		const double median = times[iterations / 2];
+		const double perItem = itemCount ? median * 1000000.0 / (double)itemCount : 0.0;
+		X2_CORE_INFO_TAG("Benchmark", "{}: {:.3f} ms median, {:.3f} ms best, {:.2f} ns per item", name, median, times[0], perItem);
+		return median;
+	}
+
+	void Benchmark::RunAll()
+	{
+		X2_CORE_INFO_TAG("Benchmark", "Running benchmarks...");
+
+		Benchmarks::RunFrustumCulling();
+		Benchmarks::RunRenderCommandQueue();
+		Benchmarks::RunBVH();
+
+		X2_CORE_INFO_TAG("Benchmark", "Done");
+	}
+
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+namespace X2 {
+
+	//
+	// Micro benchmarks of engine hot paths, run from the editor's Debug menu. They don't touch the
+	// scene or the renderer, and log their timings under the "Benchmark" tag. Each benchmark also
+	// checks that the paths it compares produce the same result.
+	//
+	class Benchmark
+	{
+	public:
+		// Calls func once to warm up, then iterations times. Logs the median and fastest run and the
+		// median time per item, itemCount being the number of items one call processes. reset runs
+		// untimed after every call. Returns the median in milliseconds.
+		static double Measure(const char* name, uint32_t iterations, uint64_t itemCount, const std::function<void()>& func, const std::function<void()>& reset = {});
+
+		static void RunAll();
+	};
+
+	namespace Benchmarks {
+
+		void RunFrustumCulling();
+		void RunRenderCommandQueue();
+		void RunBVH();
+
+	}
+
+}
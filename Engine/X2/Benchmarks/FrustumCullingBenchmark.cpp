@@ -0,0 +1,86 @@
+#include "Precompiled.h"
+#include "Benchmark.h"
+
+#include "X2/Math/Frustum.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+
+namespace X2::Benchmarks {
+
+	// Batched SoA culling against the per-box test, both writing a visibility mask and a compacted index list
+	void RunFrustumCulling()
+	{
+		constexpr uint32_t boxCount = 1000000;
+		constexpr uint32_t iterations = 20;
+
+		std::vector<float> minX(boxCount), minY(boxCount), minZ(boxCount);
+		std::vector<float> maxX(boxCount), maxY(boxCount), maxZ(boxCount);
+		std::vector<Volume::AABB> boxes(boxCount);
+
+		// Boxes spread around the camera, so a good part of them is visible
+		std::mt19937 random(1234);
+		std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+		std::uniform_real_distribution<float> extent(0.1f, 5.0f);
+		for (uint32_t i = 0; i < boxCount; i++)
+		{
+			const glm::vec3 center(position(random), position(random), position(random));
+			const glm::vec3 halfSize(extent(random), extent(random), extent(random));
+			minX[i] = center.x - halfSize.x; minY[i] = center.y - halfSize.y; minZ[i] = center.z - halfSize.z;
+			maxX[i] = center.x + halfSize.x; maxY[i] = center.y + halfSize.y; maxZ[i] = center.z + halfSize.z;
+			boxes[i] = Volume::AABB(center - halfSize, center + halfSize);
+		}
+
+		Volume::AABBArrays bounds;
+		bounds.MinX = minX.data(); bounds.MinY = minY.data(); bounds.MinZ = minZ.data();
+		bounds.MaxX = maxX.data(); bounds.MaxY = maxY.data(); bounds.MaxZ = maxZ.data();
+		bounds.Count = boxCount;
+
+		const glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+		const glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 20.0f, 0.0f), glm::vec3(100.0f, 0.0f, 100.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		Volume::Frustum frustum;
+		frustum.SetFromViewProjection(projection * view);
+
+		const uint32_t maskWords = (boxCount + 31) / 32;
+		std::vector<uint32_t> scalarMask(maskWords), batchMask(maskWords);
+		std::vector<uint32_t> scalarIndices(boxCount), batchIndices(boxCount);
+		uint32_t scalarVisible = 0, batchVisible = 0;
+
+		Benchmark::Measure("Frustum culling, scalar mask", iterations, boxCount, [&]()
+		{
+			std::fill(scalarMask.begin(), scalarMask.end(), 0u);
+			for (uint32_t i = 0; i < boxCount; i++)
+			{
+				if (frustum.Intersects(boxes[i]))
+					scalarMask[i / 32] |= 1u << (i % 32);
+			}
+		});
+
+		Benchmark::Measure("Frustum culling, batched mask", iterations, boxCount, [&]()
+		{
+			frustum.Intersects(bounds, batchMask.data());
+		});
+
+		Benchmark::Measure("Frustum culling, scalar indices", iterations, boxCount, [&]()
+		{
+			scalarVisible = 0;
+			for (uint32_t i = 0; i < boxCount; i++)
+			{
+				if (frustum.Intersects(boxes[i]))
+					scalarIndices[scalarVisible++] = i;
+			}
+		});
+
+		Benchmark::Measure("Frustum culling, batched indices", iterations, boxCount, [&]()
+		{
+			batchVisible = frustum.Cull(bounds, batchIndices.data());
+		});
+
+		X2_CORE_INFO_TAG("Benchmark", "Frustum culling: {} of {} boxes visible", scalarVisible, boxCount);
+		if (scalarMask != batchMask)
+			X2_CORE_ERROR_TAG("Benchmark", "Frustum culling: batched mask differs from the scalar test");
+		if (scalarVisible != batchVisible || !std::equal(scalarIndices.begin(), scalarIndices.begin() + scalarVisible, batchIndices.begin()))
+			X2_CORE_ERROR_TAG("Benchmark", "Frustum culling: batched indices differ from the scalar test");
+	}
+
+}
@@ -0,0 +1,241 @@
+#include "Precompiled.h"
+#include "Benchmark.h"
+
+#include "X2/Core/JobSystem.h"
+#include "X2/Renderer/RenderCommandQueue.h"
+
+#include <glm/glm.hpp>
+
+namespace X2::Benchmarks {
+
+	namespace Utils {
+
+		//
+		// The command queue the engine used before RenderCommandQueue was chunked: one fixed 10 MB
+		// buffer, unaligned commands and a single producer. Kept here as the baseline.
+		//
+		class LinearCommandQueue
+		{
+		public:
+			typedef void(*RenderCommandFn)(void*);
+
+			static constexpr size_t s_Capacity = 10 * 1024 * 1024;
+
+			LinearCommandQueue()
+			{
+				m_CommandBuffer = hnew uint8_t[s_Capacity];
+				m_CommandBufferPtr = m_CommandBuffer;
+				memset(m_CommandBuffer, 0, s_Capacity);
+			}
+
+			~LinearCommandQueue()
+			{
+				hdelete[] m_CommandBuffer;
+			}
+
+			void* Allocate(RenderCommandFn fn, uint32_t size)
+			{
+				X2_CORE_ASSERT(m_CommandBufferPtr + sizeof(RenderCommandFn) + sizeof(uint32_t) + size <= m_CommandBuffer + s_Capacity);
+
+				*(RenderCommandFn*)m_CommandBufferPtr = fn;
+				m_CommandBufferPtr += sizeof(RenderCommandFn);
+
+				*(uint32_t*)m_CommandBufferPtr = size;
+				m_CommandBufferPtr += sizeof(uint32_t);
+
+				void* memory = m_CommandBufferPtr;
+				m_CommandBufferPtr += size;
+
+				m_CommandCount++;
+				return memory;
+			}
+
+			template<typename FuncT>
+			void Submit(FuncT&& func)
+			{
+				auto renderCmd = [](void* ptr) {
+					auto pFunc = (FuncT*)ptr;
+					(*pFunc)();
+					pFunc->~FuncT();
+				};
+				auto storageBuffer = Allocate(renderCmd, sizeof(func));
+				new (storageBuffer) FuncT(std::forward<FuncT>(func));
+			}
+
+			void Execute()
+			{
+				uint8_t* buffer = m_CommandBuffer;
+				for (uint32_t i = 0; i < m_CommandCount; i++)
+				{
+					RenderCommandFn function = *(RenderCommandFn*)buffer;
+					buffer += sizeof(RenderCommandFn);
+
+					uint32_t size = *(uint32_t*)buffer;
+					buffer += sizeof(uint32_t);
+					function(buffer);
+					buffer += size;
+				}
+
+				m_CommandBufferPtr = m_CommandBuffer;
+				m_CommandCount = 0;
+			}
+		private:
+			uint8_t* m_CommandBuffer;
+			uint8_t* m_CommandBufferPtr;
+			uint32_t m_CommandCount = 0;
+		};
+
+		// Filled in by the commands when the queue executes
+		struct ExecutedCommands
+		{
+			uint32_t Count = 0;
+			uint32_t OutOfOrder = 0;
+			uint64_t Sum = 0;
+		};
+
+		// A command the size of a typical draw submission: a transform, an index and a pointer
+		template<typename QueueT>
+		static void SubmitCommand(QueueT& queue, uint32_t index, ExecutedCommands* executed)
+		{
+			glm::mat4 transform(1.0f);
+			queue.Submit([transform, index, executed]()
+			{
+				if (index != executed->Count)
+					executed->OutOfOrder++;
+
+				executed->Count++;
+				executed->Sum += index + (uint64_t)transform[3][3];
+			});
+		}
+
+		static void CheckExecuted(const char* name, ExecutedCommands& executed, uint32_t commandCount, bool checkOrder)
+		{
+			const uint64_t expectedSum = (uint64_t)commandCount * (commandCount - 1) / 2 + commandCount;
+			if (executed.Count != commandCount || executed.Sum != expectedSum)
+				X2_CORE_ERROR_TAG("Benchmark", "{}: executed {} of {} commands", name, executed.Count, commandCount);
+			else if (checkOrder && executed.OutOfOrder)
+				X2_CORE_ERROR_TAG("Benchmark", "{}: {} commands executed out of submission order", name, executed.OutOfOrder);
+
+			executed = {};
+		}
+
+	}
+
+	// Submission throughput of the old single buffer against RenderCommandQueue, on one thread and on
+	// all job system threads. The commands of one run span several chunks, the growth runs start every
+	// run from a new queue so the chunks are allocated while recording.
+	void RunRenderCommandQueue()
+	{
+		constexpr uint32_t commandCount = 65536;
+		constexpr uint32_t iterations = 20;
+		constexpr uint32_t grainSize = 1024;
+
+		Utils::ExecutedCommands executed;
+
+		{
+			const char* name = "Command queue, single buffer, 1 thread";
+			Utils::LinearCommandQueue queue;
+			Benchmark::Measure(name, iterations, commandCount, [&]()
+			{
+				for (uint32_t i = 0; i < commandCount; i++)
+					Utils::SubmitCommand(queue, i, &executed);
+			}, [&]()
+			{
+				queue.Execute();
+				Utils::CheckExecuted(name, executed, commandCount, true);
+			});
+		}
+
+		{
+			const char* name = "Command queue, chunked, 1 thread";
+			RenderCommandQueue queue;
+			Benchmark::Measure(name, iterations, commandCount, [&]()
+			{
+				for (uint32_t i = 0; i < commandCount; i++)
+					Utils::SubmitCommand(queue, i, &executed);
+				queue.Merge();
+			}, [&]()
+			{
+				queue.Execute();
+				Utils::CheckExecuted(name, executed, commandCount, true);
+			});
+		}
+
+		{
+			const char* name = "Command queue, chunked with growth, 1 thread";
+			Scope<RenderCommandQueue> queue = CreateScope<RenderCommandQueue>();
+			Benchmark::Measure(name, iterations, commandCount, [&]()
+			{
+				for (uint32_t i = 0; i < commandCount; i++)
+					Utils::SubmitCommand(*queue, i, &executed);
+				queue->Merge();
+			}, [&]()
+			{
+				queue->Execute();
+				Utils::CheckExecuted(name, executed, commandCount, true);
+				queue = CreateScope<RenderCommandQueue>();
+			});
+		}
+
+		X2_CORE_INFO_TAG("Benchmark", "Command queue: multi-threaded runs submit from {} threads", JobSystem::GetWorkerCount() + 1);
+
+		{
+			const char* name = "Command queue, single buffer behind a mutex, all threads";
+			Utils::LinearCommandQueue queue;
+			std::mutex mutex;
+			Benchmark::Measure(name, iterations, commandCount, [&]()
+			{
+				JobSystem::ParallelFor(commandCount, grainSize, [&](uint32_t begin, uint32_t end)
+				{
+					for (uint32_t i = begin; i < end; i++)
+					{
+						std::scoped_lock<std::mutex> lock(mutex);
+						Utils::SubmitCommand(queue, i, &executed);
+					}
+				});
+			}, [&]()
+			{
+				queue.Execute();
+				Utils::CheckExecuted(name, executed, commandCount, false);
+			});
+		}
+
+		{
+			const char* name = "Command queue, chunked, all threads";
+			RenderCommandQueue queue;
+			Benchmark::Measure(name, iterations, commandCount, [&]()
+			{
+				JobSystem::ParallelFor(commandCount, grainSize, [&](uint32_t begin, uint32_t end)
+				{
+					for (uint32_t i = begin; i < end; i++)
+						Utils::SubmitCommand(queue, i, &executed);
+				});
+				queue.Merge();
+			}, [&]()
+			{
+				queue.Execute();
+				Utils::CheckExecuted(name, executed, commandCount, false);
+			});
+		}
+
+		{
+			const char* name = "Command queue, chunked with growth, all threads";
+			Scope<RenderCommandQueue> queue = CreateScope<RenderCommandQueue>();
+			Benchmark::Measure(name, iterations, commandCount, [&]()
+			{
+				JobSystem::ParallelFor(commandCount, grainSize, [&](uint32_t begin, uint32_t end)
+				{
+					for (uint32_t i = begin; i < end; i++)
+						Utils::SubmitCommand(*queue, i, &executed);
+				});
+				queue->Merge();
+			}, [&]()
+			{
+				queue->Execute();
+				Utils::CheckExecuted(name, executed, commandCount, false);
+				queue = CreateScope<RenderCommandQueue>();
+			});
+		}
+	}
+
+}
@@ -154,26 +154,28 @@ namespace X2 {
 		{
 			X2_PROFILE_FRAME("MainThread");
 
-			// Wait for render thread to finish frame
+			static uint64_t frameCounter = 0;
+			//X2_CORE_INFO("-- BEGIN FRAME {0}", frameCounter);
+
+			{
+				// The window callbacks feed ImGui, which runs on the render thread
+				std::scoped_lock<std::mutex> lock(m_ImGuiMutex);
+				ProcessEvents();
+			}
+
+			m_Profiler->FlushPerFrameData(m_ProfilerPreviousFrameData);
+			m_JobSystemStats = JobSystem::FlushStats();
+
+			// Only waits for the render thread when it is FramesInFlight - 1 frames behind
 			{
 				X2_PROFILE_FUNC("Wait");
 				Timer timer;
 
-				m_RenderThread.BlockUntilRenderComplete();
+				m_RenderThread.NextFrame();
 
 				m_PerformanceTimers.MainThreadWaitTime = timer.ElapsedMillis();
 			}
 
-			static uint64_t frameCounter = 0;
-			//X2_CORE_INFO("-- BEGIN FRAME {0}", frameCounter);
-
-			ProcessEvents(); // Poll events when both threads are idle
-
-			m_ProfilerPreviousFrameData = m_Profiler->GetPerFrameData();
-			m_Profiler->Clear();
-
-			m_RenderThread.NextFrame();
-
 			// Start rendering previous frame
 			m_RenderThread.Kick();
 
@@ -198,8 +200,12 @@ namespace X2 {
 				Application* app = this;
 				if (m_Specification.EnableImGui)
 				{
-					Renderer::Submit([app]() { app->RenderImGui(); });
-					Renderer::Submit([=]() { m_ImGuiLayer->End(); });
+					Renderer::Submit([app]()
+						{
+							std::scoped_lock<std::mutex> lock(app->m_ImGuiMutex);
+							app->RenderImGui();
+							app->m_ImGuiLayer->End();
+						});
 				}
 				Renderer::EndFrame();
 
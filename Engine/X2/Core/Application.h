@@ -11,6 +11,7 @@
 
 #include "X2/Core/Event/ApplicationEvent.h"
 #include "X2/Core/RenderThread.h"
+#include "X2/Core/JobSystem.h"
 
 #include "X2/ImGui/ImGuiLayer.h"
 #include <queue>
@@ -114,6 +115,7 @@ namespace X2 {
 		uint32_t GetCurrentFrameIndex() const { return m_CurrentFrameIndex; }
 		PerformanceTimers GetPerformanceTimers() const { return m_PerformanceTimers; }
 		const std::unordered_map<const char*, float>& GetProfilerPreviousFrameData() const { return m_ProfilerPreviousFrameData; }
+		const JobSystemStats& GetJobSystemStats() const { return m_JobSystemStats; }
 
 		static bool IsRuntime() { return s_IsRuntime; }
 	private:
@@ -134,11 +136,14 @@ namespace X2 {
 		Timestep m_TimeStep;
 		PerformanceProfiler* m_Profiler = nullptr; // TODO: Should be null in Dist
 		std::unordered_map<const char*, float> m_ProfilerPreviousFrameData;
+		JobSystemStats m_JobSystemStats;
 		bool m_ShowStats = true;
 
 		RenderThread m_RenderThread;
 
 		std::mutex m_EventQueueMutex;
+		// Held while polling window events and while the render thread builds the ImGui frame
+		std::mutex m_ImGuiMutex;
 		std::queue<std::function<void()>> m_EventQueue;
 		std::vector<EventCallbackFn> m_EventCallbacks;
 
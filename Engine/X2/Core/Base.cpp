@@ -2,6 +2,7 @@
 #include "Base.h"
 
 #include "Log.h"
+#include "JobSystem.h"
 #include "Memory.h"
 
 #define X2_BUILD_ID "v0.1a"
@@ -15,12 +16,15 @@ namespace X2 {
 
 		X2_CORE_TRACE_TAG("Core", "X2 Engine {}", X2_BUILD_ID);
 		X2_CORE_TRACE_TAG("Core", "Initializing...");
+
+		JobSystem::Init();
 	}
 
 	void ShutdownCore()
 	{
 		X2_CORE_TRACE_TAG("Core", "Shutting down...");
 
+		JobSystem::Shutdown();
 		Log::Shutdown();
 	}
 
@@ -0,0 +1,206 @@
+#include "Precompiled.h"
+#include "Compression.h"
+
+namespace X2 {
+
+	namespace Utils {
+
+		static constexpr uint64_t LZ4MinMatch = 4;
+		static constexpr uint64_t LZ4LastLiterals = 5; // The format requires the block to end in literals
+		static constexpr uint64_t LZ4MatchFindLimit = 12; // No match may start this close to the end
+		static constexpr uint64_t LZ4MaxOffset = 65535;
+		static constexpr uint32_t LZ4HashLog = 16;
+
+		static uint32_t ReadU32(const uint8_t* data)
+		{
+			uint32_t value;
+			memcpy(&value, data, sizeof(uint32_t));
+			return value;
+		}
+
+		static uint32_t HashLZ4(uint32_t sequence)
+		{
+			return (sequence * 2654435761u) >> (32 - LZ4HashLog);
+		}
+
+		static uint8_t* WriteLZ4Length(uint8_t* output, uint64_t length)
+		{
+			while (length >= 255)
+			{
+				*output++ = 255;
+				length -= 255;
+			}
+			*output++ = (uint8_t)length;
+			return output;
+		}
+
+		static bool ReadLZ4Length(const uint8_t* source, uint64_t sourceSize, uint64_t& position, uint64_t& length)
+		{
+			uint8_t value;
+			do
+			{
+				if (position >= sourceSize)
+					return false;
+
+				value = source[position++];
+				length += value;
+			} while (value == 255);
+
+			return true;
+		}
+
+		static uint8_t* WriteLZ4Sequence(uint8_t* output, const uint8_t* literals, uint64_t literalLength, uint64_t offset, uint64_t matchLength)
+		{
+			uint8_t* token = output++;
+			*token = (uint8_t)(std::min<uint64_t>(literalLength, 15) << 4);
+			if (literalLength >= 15)
+				output = WriteLZ4Length(output, literalLength - 15);
+
+			if (literalLength)
+			{
+				memcpy(output, literals, literalLength);
+				output += literalLength;
+			}
+
+			// Last sequence carries literals only
+			if (matchLength == 0)
+				return output;
+
+			*output++ = (uint8_t)(offset & 0xff);
+			*output++ = (uint8_t)(offset >> 8);
+
+			matchLength -= LZ4MinMatch;
+			*token |= (uint8_t)std::min<uint64_t>(matchLength, 15);
+			if (matchLength >= 15)
+				output = WriteLZ4Length(output, matchLength - 15);
+
+			return output;
+		}
+
+	}
+
+	uint64_t Compression::GetLZ4Bound(uint64_t sourceSize)
+	{
+		return sourceSize + sourceSize / 255 + 16;
+	}
+
+	uint64_t Compression::GetLZ4MaxDecodedSize(uint64_t sourceSize)
+	{
+		// Every length byte adds at most 255 bytes of output, clamped so the product can't overflow
+		return std::min<uint64_t>(sourceSize, std::numeric_limits<uint64_t>::max() / 256) * 255 + 16;
+	}
+
+	uint64_t Compression::CompressLZ4(const uint8_t* source, uint64_t sourceSize, uint8_t* destination, uint64_t destinationCapacity)
+	{
+		if (destinationCapacity < GetLZ4Bound(sourceSize))
+			return 0;
+
+		uint8_t* output = destination;
+		uint64_t anchor = 0;
+
+		if (sourceSize > Utils::LZ4MatchFindLimit)
+		{
+			std::vector<uint32_t> table(1ull << Utils::LZ4HashLog, 0);
+
+			const uint64_t matchFindLimit = sourceSize - Utils::LZ4MatchFindLimit;
+			const uint64_t matchEndLimit = sourceSize - Utils::LZ4LastLiterals;
+
+			uint64_t position = 0;
+			while (position < matchFindLimit)
+			{
+				uint32_t sequence = Utils::ReadU32(source + position);
+				uint32_t& entry = table[Utils::HashLZ4(sequence)];
+				uint64_t candidate = entry;
+				entry = (uint32_t)position;
+
+				if (candidate >= position || position - candidate > Utils::LZ4MaxOffset || Utils::ReadU32(source + candidate) != sequence)
+				{
+					// Skip faster through data that does not compress
+					position += 1 + ((position - anchor) >> 6);
+					continue;
+				}
+
+				while (position > anchor && candidate > 0 && source[position - 1] == source[candidate - 1])
+				{
+					position--;
+					candidate--;
+				}
+
+				uint64_t matchLength = Utils::LZ4MinMatch;
+				while (position + matchLength < matchEndLimit && source[position + matchLength] == source[candidate + matchLength])
+					matchLength++;
+
+				output = Utils::WriteLZ4Sequence(output, source + anchor, position - anchor, position - candidate, matchLength);
+
+				position += matchLength;
+				anchor = position;
+
+				if (position < matchFindLimit)
+					table[Utils::HashLZ4(Utils::ReadU32(source + position - 2))] = (uint32_t)(position - 2);
+			}
+		}
+
+		output = Utils::WriteLZ4Sequence(output, source + anchor, sourceSize - anchor, 0, 0);
+		return output - destination;
+	}
+
+	bool Compression::DecompressLZ4(const uint8_t* source, uint64_t sourceSize, uint8_t* destination, uint64_t destinationSize)
+	{
+		uint64_t input = 0;
+		uint64_t output = 0;
+
+		while (true)
+		{
+			if (input >= sourceSize)
+				return false;
+
+			uint8_t token = source[input++];
+
+			uint64_t literalLength = token >> 4;
+			if (literalLength == 15 && !Utils::ReadLZ4Length(source, sourceSize, input, literalLength))
+				return false;
+
+			if (literalLength > sourceSize - input || literalLength > destinationSize - output)
+				return false;
+
+			memcpy(destination + output, source + input, literalLength);
+			input += literalLength;
+			output += literalLength;
+
+			if (input == sourceSize)
+				break;
+
+			if (sourceSize - input < 2)
+				return false;
+
+			uint64_t offset = source[input] | ((uint64_t)source[input + 1] << 8);
+			input += 2;
+			if (offset == 0 || offset > output)
+				return false;
+
+			uint64_t matchLength = token & 15;
+			if (matchLength == 15 && !Utils::ReadLZ4Length(source, sourceSize, input, matchLength))
+				return false;
+
+			matchLength += Utils::LZ4MinMatch;
+			if (matchLength > destinationSize - output)
+				return false;
+
+			uint8_t* match = destination + output - offset;
+			if (offset >= matchLength)
+			{
+				memcpy(destination + output, match, matchLength);
+			}
+			else
+			{
+				// Overlapping copy repeats the last offset bytes
+				for (uint64_t i = 0; i < matchLength; i++)
+					destination[output + i] = match[i];
+			}
+			output += matchLength;
+		}
+
+		return output == destinationSize;
+	}
+
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+namespace X2 {
+
+	// Block compression, the output is the LZ4 block format so packs stay readable by stock LZ4 tooling
+	class Compression
+	{
+	public:
+		// Worst case compressed size for sourceSize bytes
+		static uint64_t GetLZ4Bound(uint64_t sourceSize);
+		// Upper bound of what sourceSize bytes of compressed data can decode to
+		static uint64_t GetLZ4MaxDecodedSize(uint64_t sourceSize);
+
+		// Returns the compressed size, 0 if destinationCapacity is below GetLZ4Bound(sourceSize)
+		static uint64_t CompressLZ4(const uint8_t* source, uint64_t sourceSize, uint8_t* destination, uint64_t destinationCapacity);
+		// Fails on malformed input and when the decoded size is not exactly destinationSize
+		static bool DecompressLZ4(const uint8_t* source, uint64_t sourceSize, uint8_t* destination, uint64_t destinationSize);
+	};
+
+}
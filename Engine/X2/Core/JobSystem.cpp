@@ -0,0 +1,448 @@
+#include "Precompiled.h"
+#include "JobSystem.h"
+
+#include "X2/Core/Thread.h"
+#include "X2/Core/Timer.h"
+#include "X2/Core/Debug/Profiler.h"
+
+#include <deque>
+
+namespace X2 {
+
+	struct Job
+	{
+		JobSystem::JobFunction Function;
+		JobCounter* Counter = nullptr;
+	};
+
+	namespace Utils {
+
+		//
+		// Chase-Lev deque with a fixed capacity. Only the owning thread pushes and pops at the bottom,
+		// any thread steals from the top.
+		//
+		class alignas(64) WorkStealingQueue
+		{
+		public:
+			static constexpr int64_t Capacity = 4096;
+
+			bool Push(Job* job)
+			{
+				const int64_t bottom = m_Bottom.load(std::memory_order_relaxed);
+				const int64_t top = m_Top.load(std::memory_order_acquire);
+				if (bottom - top >= Capacity)
+					return false;
+
+				m_Jobs[bottom & (Capacity - 1)].store(job, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_release);
+				m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+				return true;
+			}
+
+			Job* Pop()
+			{
+				const int64_t bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+				m_Bottom.store(bottom, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				int64_t top = m_Top.load(std::memory_order_relaxed);
+
+				if (top > bottom)
+				{
+					m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+					return nullptr;
+				}
+
+				Job* job = m_Jobs[bottom & (Capacity - 1)].load(std::memory_order_relaxed);
+				if (top == bottom)
+				{
+					// Last job, race the thieves for it
+					if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+						job = nullptr;
+					m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+				}
+				return job;
+			}
+
+			Job* Steal()
+			{
+				int64_t top = m_Top.load(std::memory_order_acquire);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				const int64_t bottom = m_Bottom.load(std::memory_order_acquire);
+				if (top >= bottom)
+					return nullptr;
+
+				Job* job = m_Jobs[top & (Capacity - 1)].load(std::memory_order_relaxed);
+				if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+					return nullptr;
+				return job;
+			}
+		private:
+			std::atomic<int64_t> m_Top = 0;
+			std::atomic<int64_t> m_Bottom = 0;
+			std::atomic<Job*> m_Jobs[Capacity] = {};
+		};
+
+	}
+
+	struct JobSystemData
+	{
+		// Index 0 belongs to the thread that called Init, the workers follow
+		std::vector<std::unique_ptr<Utils::WorkStealingQueue>> Queues;
+		std::vector<Thread> Workers;
+
+		// Jobs queued by threads that don't own a deque
+		std::mutex SharedQueueMutex;
+		std::deque<Job*> SharedQueue;
+
+		std::mutex BackgroundQueueMutex;
+		std::deque<Job*> BackgroundQueue;
+		std::atomic<uint32_t> QueuedBackgroundJobs = 0;
+		std::atomic<uint32_t> ActiveBackgroundJobs = 0;
+		uint32_t MaxBackgroundJobs = 1;
+
+		std::atomic<bool> Running = true;
+		std::atomic<int32_t> QueuedJobs = 0;
+		std::atomic<uint32_t> SleepingWorkers = 0;
+		std::mutex SleepMutex;
+		std::condition_variable WakeCondition;
+
+		std::atomic<uint32_t> JobCount = 0;
+		// Nanoseconds
+		std::atomic<uint64_t> WorkerBusyTime = 0;
+		std::atomic<uint64_t> AssistTime = 0;
+		Timer StatsTimer;
+	};
+
+	static JobSystemData* s_Data = nullptr;
+
+	static thread_local uint32_t s_ThreadIndex = UINT32_MAX;
+	// Jobs that wait run other jobs, only the outermost one is timed
+	static thread_local uint32_t s_ExecuteDepth = 0;
+
+	JobCounter::~JobCounter()
+	{
+		X2_CORE_ASSERT(m_Value == 0 && m_Continuations.empty(), "Job counter destroyed while jobs still use it");
+	}
+
+	void JobSystem::Init(uint32_t workerCount)
+	{
+		X2_CORE_ASSERT(!s_Data);
+
+		if (workerCount == 0)
+			workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+		s_Data = hnew JobSystemData();
+		s_Data->MaxBackgroundJobs = std::max(workerCount / 2, 1u);
+		s_ThreadIndex = 0;
+
+		for (uint32_t i = 0; i <= workerCount; i++)
+			s_Data->Queues.push_back(std::make_unique<Utils::WorkStealingQueue>());
+
+		s_Data->Workers.reserve(workerCount);
+		for (uint32_t i = 1; i <= workerCount; i++)
+			s_Data->Workers.emplace_back(fmt::format("Job Worker {}", i)).Dispatch(WorkerThreadFunc, i);
+
+		X2_CORE_TRACE_TAG("Core", "Job system started with {} workers", workerCount);
+	}
+
+	void JobSystem::Shutdown()
+	{
+		if (!s_Data)
+			return;
+
+		X2_CORE_ASSERT(s_ThreadIndex == 0, "The job system has to be shut down by the thread that started it");
+
+		// Whatever is still queued finishes first, the workers take care of the background jobs
+		while (s_Data->QueuedJobs > 0 || s_Data->QueuedBackgroundJobs > 0 || s_Data->ActiveBackgroundJobs > 0)
+		{
+			if (Job* job = FindJob(s_ThreadIndex))
+				Execute(job);
+			else
+				std::this_thread::yield();
+		}
+
+		{
+			std::scoped_lock<std::mutex> lock(s_Data->SleepMutex);
+			s_Data->Running = false;
+		}
+		s_Data->WakeCondition.notify_all();
+
+		for (Thread& worker : s_Data->Workers)
+			worker.Join();
+
+		hdelete s_Data;
+		s_Data = nullptr;
+		s_ThreadIndex = UINT32_MAX;
+	}
+
+	void JobSystem::Run(JobFunction func, JobCounter* counter, JobCounter* dependency)
+	{
+		if (!s_Data)
+		{
+			func();
+			return;
+		}
+
+		if (counter)
+			counter->m_Value++;
+
+		Job* job = hnew Job{ std::move(func), counter };
+
+		if (dependency)
+		{
+			std::scoped_lock<std::mutex> lock(dependency->m_Mutex);
+			if (dependency->m_Value > 0)
+			{
+				dependency->m_Continuations.push_back(job);
+				return;
+			}
+		}
+
+		Submit(job);
+	}
+
+	void JobSystem::RunBackground(JobFunction func, JobCounter* counter)
+	{
+		if (!s_Data)
+		{
+			func();
+			return;
+		}
+
+		if (counter)
+			counter->m_Value++;
+
+		{
+			std::scoped_lock<std::mutex> lock(s_Data->BackgroundQueueMutex);
+			s_Data->BackgroundQueue.push_back(hnew Job{ std::move(func), counter });
+			s_Data->QueuedBackgroundJobs++;
+		}
+
+		std::scoped_lock<std::mutex> lock(s_Data->SleepMutex);
+		s_Data->WakeCondition.notify_one();
+	}
+
+	void JobSystem::Wait(JobCounter& counter)
+	{
+		while (!counter.IsDone())
+		{
+			if (!s_Data)
+				break;
+
+			if (Job* job = FindJob(s_ThreadIndex))
+				Execute(job);
+			else
+				std::this_thread::yield();
+		}
+
+		// The last job may still be inside Finish, it is done with the counter once it unlocked it
+		std::scoped_lock<std::mutex> lock(counter.m_Mutex);
+	}
+
+	void JobSystem::ParallelFor(uint32_t count, uint32_t grainSize, const RangeFunction& func)
+	{
+		X2_PROFILE_FUNC();
+
+		grainSize = std::max(grainSize, 1u);
+		const uint32_t rangeCount = (count + grainSize - 1) / grainSize;
+		if (rangeCount <= 1 || !s_Data)
+		{
+			if (count)
+				func(0, count);
+			return;
+		}
+
+		// The calling thread takes the first range itself
+		JobCounter counter;
+		for (uint32_t range = 1; range < rangeCount; range++)
+		{
+			const uint32_t begin = range * grainSize;
+			const uint32_t end = std::min(begin + grainSize, count);
+			Run([&func, begin, end]() { func(begin, end); }, &counter);
+		}
+
+		func(0, grainSize);
+		Wait(counter);
+	}
+
+	uint32_t JobSystem::GetWorkerCount()
+	{
+		return s_Data ? (uint32_t)s_Data->Workers.size() : 0;
+	}
+
+	JobSystemStats JobSystem::FlushStats()
+	{
+		JobSystemStats stats;
+		if (!s_Data)
+			return stats;
+
+		const float elapsed = s_Data->StatsTimer.ElapsedMillis();
+		s_Data->StatsTimer.Reset();
+
+		stats.WorkerCount = (uint32_t)s_Data->Workers.size();
+		stats.JobCount = s_Data->JobCount.exchange(0);
+		stats.AssistTime = s_Data->AssistTime.exchange(0) * 0.000001f;
+
+		const float busyTime = s_Data->WorkerBusyTime.exchange(0) * 0.000001f;
+		if (elapsed > 0.0f && stats.WorkerCount)
+			stats.Utilization = std::min(busyTime / (elapsed * stats.WorkerCount), 1.0f);
+
+		return stats;
+	}
+
+	void JobSystem::WorkerThreadFunc(uint32_t threadIndex)
+	{
+		X2_PROFILE_THREAD("Job Worker");
+
+		s_ThreadIndex = threadIndex;
+
+		while (s_Data->Running)
+		{
+			if (Job* job = FindJob(threadIndex))
+			{
+				Execute(job);
+				continue;
+			}
+
+			if (Job* job = FindBackgroundJob())
+			{
+				Execute(job);
+				s_Data->ActiveBackgroundJobs--;
+
+				// Another worker may have gone to sleep while every background slot was taken
+				if (s_Data->QueuedBackgroundJobs > 0 && s_Data->SleepingWorkers > 0)
+				{
+					std::scoped_lock<std::mutex> lock(s_Data->SleepMutex);
+					s_Data->WakeCondition.notify_one();
+				}
+				continue;
+			}
+
+			// Nothing to steal, sleep until a job is queued
+			std::unique_lock<std::mutex> lock(s_Data->SleepMutex);
+			s_Data->SleepingWorkers++;
+			s_Data->WakeCondition.wait(lock, []
+				{
+					const bool backgroundJobReady = s_Data->QueuedBackgroundJobs > 0 && s_Data->ActiveBackgroundJobs < s_Data->MaxBackgroundJobs;
+					return s_Data->QueuedJobs > 0 || backgroundJobReady || !s_Data->Running;
+				});
+			s_Data->SleepingWorkers--;
+		}
+	}
+
+	void JobSystem::Submit(Job* job)
+	{
+		if (s_ThreadIndex < s_Data->Queues.size())
+		{
+			// A full deque runs the job right away rather than growing
+			if (!s_Data->Queues[s_ThreadIndex]->Push(job))
+			{
+				Execute(job);
+				return;
+			}
+		}
+		else
+		{
+			std::scoped_lock<std::mutex> lock(s_Data->SharedQueueMutex);
+			s_Data->SharedQueue.push_back(job);
+		}
+
+		s_Data->QueuedJobs++;
+		if (s_Data->SleepingWorkers > 0)
+		{
+			std::scoped_lock<std::mutex> lock(s_Data->SleepMutex);
+			s_Data->WakeCondition.notify_one();
+		}
+	}
+
+	Job* JobSystem::FindJob(uint32_t threadIndex)
+	{
+		Job* job = nullptr;
+		const uint32_t queueCount = (uint32_t)s_Data->Queues.size();
+
+		if (threadIndex < queueCount)
+			job = s_Data->Queues[threadIndex]->Pop();
+
+		if (!job)
+		{
+			std::scoped_lock<std::mutex> lock(s_Data->SharedQueueMutex);
+			if (!s_Data->SharedQueue.empty())
+			{
+				job = s_Data->SharedQueue.front();
+				s_Data->SharedQueue.pop_front();
+			}
+		}
+
+		// Victims rotate so the thieves don't all pile onto the same deque
+		static thread_local uint32_t s_NextVictim = 0;
+		for (uint32_t i = 0; i < queueCount && !job; i++)
+		{
+			const uint32_t victim = (s_NextVictim++) % queueCount;
+			if (victim != threadIndex)
+				job = s_Data->Queues[victim]->Steal();
+		}
+
+		if (job)
+			s_Data->QueuedJobs--;
+		return job;
+	}
+
+	Job* JobSystem::FindBackgroundJob()
+	{
+		if (s_Data->QueuedBackgroundJobs == 0)
+			return nullptr;
+
+		// Takes a slot first so no more than MaxBackgroundJobs run at once
+		if (s_Data->ActiveBackgroundJobs.fetch_add(1) >= s_Data->MaxBackgroundJobs)
+		{
+			s_Data->ActiveBackgroundJobs--;
+			return nullptr;
+		}
+
+		std::scoped_lock<std::mutex> lock(s_Data->BackgroundQueueMutex);
+		if (s_Data->BackgroundQueue.empty())
+		{
+			s_Data->ActiveBackgroundJobs--;
+			return nullptr;
+		}
+
+		Job* job = s_Data->BackgroundQueue.front();
+		s_Data->BackgroundQueue.pop_front();
+		s_Data->QueuedBackgroundJobs--;
+		return job;
+	}
+
+	void JobSystem::Execute(Job* job)
+	{
+		const auto start = std::chrono::high_resolution_clock::now();
+		s_ExecuteDepth++;
+		job->Function();
+		s_ExecuteDepth--;
+
+		if (s_ExecuteDepth == 0)
+		{
+			const uint64_t time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start).count();
+			const bool worker = s_ThreadIndex != 0 && s_ThreadIndex < s_Data->Queues.size();
+			(worker ? s_Data->WorkerBusyTime : s_Data->AssistTime) += time;
+		}
+		s_Data->JobCount++;
+
+		if (job->Counter)
+			Finish(job->Counter);
+		hdelete job;
+	}
+
+	void JobSystem::Finish(JobCounter* counter)
+	{
+		std::vector<Job*> continuations;
+		{
+			std::scoped_lock<std::mutex> lock(counter->m_Mutex);
+			if (--counter->m_Value == 0)
+				continuations.swap(counter->m_Continuations);
+		}
+
+		for (Job* job : continuations)
+			Submit(job);
+	}
+
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace X2 {
+
+	struct Job;
+
+	//
+	// Counts the unfinished jobs it was passed to. Jobs can wait for a counter to reach zero before
+	// they start, and JobSystem::Wait runs other jobs until it does. A counter has to outlive its jobs.
+	//
+	class JobCounter
+	{
+	public:
+		JobCounter() = default;
+		~JobCounter();
+
+		JobCounter(const JobCounter&) = delete;
+		JobCounter& operator=(const JobCounter&) = delete;
+
+		bool IsDone() const { return m_Value.load() == 0; }
+	private:
+		std::atomic<uint32_t> m_Value = 0;
+		std::mutex m_Mutex;
+		// Jobs that depend on this counter, queued once it reaches zero
+		std::vector<Job*> m_Continuations;
+
+		friend class JobSystem;
+	};
+
+	struct JobSystemStats
+	{
+		uint32_t WorkerCount = 0;
+		uint32_t JobCount = 0;
+		// Busy time of the workers over their available time, 0..1
+		float Utilization = 0.0f;
+		// Time threads waiting on a counter spent running jobs
+		float AssistTime = 0.0f;
+	};
+
+	//
+	// Work stealing job system shared by the engine. Every worker owns a Chase-Lev deque: it pushes and
+	// pops jobs at the bottom while idle workers steal from the top. The thread that called Init owns a
+	// deque too, any other thread hands its jobs to a shared queue. Waiting on a counter runs jobs
+	// instead of blocking, so jobs can wait on the jobs they spawned. Work that blocks, like loading
+	// assets from disk, goes through RunBackground instead.
+	//
+	class JobSystem
+	{
+	public:
+		using JobFunction = std::function<void()>;
+		using RangeFunction = std::function<void(uint32_t begin, uint32_t end)>;
+
+		// workerCount 0 uses one worker per hardware thread besides the calling one
+		static void Init(uint32_t workerCount = 0);
+		static void Shutdown();
+
+		// Queues func. counter is incremented now and decremented once func returned, func only starts
+		// once dependency reached zero. Runs func right away if the job system isn't initialized.
+		static void Run(JobFunction func, JobCounter* counter = nullptr, JobCounter* dependency = nullptr);
+
+		// Queues func as a background job, for work that blocks on IO or locks. Background jobs run in
+		// order on idle workers, on at most half of them, and never on a thread waiting on a counter, so
+		// they can't stall the jobs further up that thread's stack.
+		static void RunBackground(JobFunction func, JobCounter* counter = nullptr);
+
+		// Runs queued jobs on the calling thread until counter reaches zero
+		static void Wait(JobCounter& counter);
+
+		// Calls func for [0, count) in ranges of grainSize, the calling thread takes part and returns once all ranges are done
+		static void ParallelFor(uint32_t count, uint32_t grainSize, const RangeFunction& func);
+
+		// Number of worker threads, not counting the threads that wait
+		static uint32_t GetWorkerCount();
+
+		// Returns the stats gathered since the last call, called once per frame
+		static JobSystemStats FlushStats();
+	private:
+		static void WorkerThreadFunc(uint32_t threadIndex);
+		static void Submit(Job* job);
+		static Job* FindJob(uint32_t threadIndex);
+		static Job* FindBackgroundJob();
+		static void Execute(Job* job);
+		static void Finish(JobCounter* counter);
+	};
+
+}
@@ -1,99 +1,79 @@
 #include "Precompiled.h"
 #include "RenderThread.h"
 
-#include <Windows.h>
-
 #include "X2/Renderer/Renderer.h"
 
+#include <condition_variable>
+#include <mutex>
 
 namespace X2 {
 
 	struct RenderThreadData
 	{
-		CRITICAL_SECTION m_CriticalSection;
-		CONDITION_VARIABLE m_ConditionVariable;
+		mutable std::mutex Mutex;
+		std::condition_variable FrameKicked;
+		std::condition_variable FrameRendered;
 
-		RenderThread::State m_State = RenderThread::State::Idle;
+		uint32_t RecordedFrames = 0; // Finished by NextFrame(), not kicked yet
+		uint32_t PendingFrames = 0;  // Kicked, not executed yet
 	};
 
 	RenderThread::RenderThread(ThreadingPolicy coreThreadingPolicy)
 		: m_RenderThread("Render Thread"), m_ThreadingPolicy(coreThreadingPolicy)
 	{
 		m_Data = new RenderThreadData();
-
-		if (m_ThreadingPolicy == ThreadingPolicy::MultiThreaded)
-		{
-			InitializeCriticalSection(&m_Data->m_CriticalSection);
-			InitializeConditionVariable(&m_Data->m_ConditionVariable);
-		}
 	}
 
 	RenderThread::~RenderThread()
 	{
-		if (m_ThreadingPolicy == ThreadingPolicy::MultiThreaded)
-			DeleteCriticalSection(&m_Data->m_CriticalSection);
+		delete m_Data;
 	}
 
 	void RenderThread::Run()
 	{
 		m_IsRunning = true;
 		if (m_ThreadingPolicy == ThreadingPolicy::MultiThreaded)
+		{
 			m_RenderThread.Dispatch(Renderer::RenderThreadFunc, this);
+			// The render thread keeps its core, the job workers are left to the scheduler
+			m_RenderThread.SetAffinityMask(8);
+		}
 	}
 
 	void RenderThread::Terminate()
 	{
-		m_IsRunning = false;
+		// Finish every frame recorded so far before letting the render thread go
 		Pump();
 
+		{
+			std::scoped_lock<std::mutex> lock(m_Data->Mutex);
+			m_IsRunning = false;
+		}
+		m_Data->FrameKicked.notify_all();
+
 		if (m_ThreadingPolicy == ThreadingPolicy::MultiThreaded)
 			m_RenderThread.Join();
 	}
 
-	void RenderThread::Wait(State waitForState)
+	void RenderThread::NextFrame()
 	{
-		if (m_ThreadingPolicy == ThreadingPolicy::SingleThreaded)
-			return;
+		m_AppThreadFrame++;
 
-		EnterCriticalSection(&m_Data->m_CriticalSection);
-		while (m_Data->m_State != waitForState)
+		if (m_ThreadingPolicy == ThreadingPolicy::MultiThreaded)
 		{
-			// This releases the CS so that another thread can wake it
-			SleepConditionVariableCS(&m_Data->m_ConditionVariable, &m_Data->m_CriticalSection, INFINITE);
+			// The next queue is in use until the render thread has executed the oldest pending frame
+			const uint32_t queueCount = Renderer::GetRenderCommandQueueCount();
+			std::unique_lock<std::mutex> lock(m_Data->Mutex);
+			m_Data->FrameRendered.wait(lock, [&] { return m_Data->PendingFrames + m_Data->RecordedFrames + 1 < queueCount; });
+			m_Data->RecordedFrames++;
 		}
-		LeaveCriticalSection(&m_Data->m_CriticalSection);
-	}
-
-	void RenderThread::WaitAndSet(State waitForState, State setToState)
-	{
-		if (m_ThreadingPolicy == ThreadingPolicy::SingleThreaded)
-			return;
-
-		EnterCriticalSection(&m_Data->m_CriticalSection);
-		while (m_Data->m_State != waitForState)
+		else
 		{
-			SleepConditionVariableCS(&m_Data->m_ConditionVariable, &m_Data->m_CriticalSection, INFINITE);
+			std::scoped_lock<std::mutex> lock(m_Data->Mutex);
+			m_Data->RecordedFrames++;
 		}
-		m_Data->m_State = setToState;
-		WakeAllConditionVariable(&m_Data->m_ConditionVariable);
-		LeaveCriticalSection(&m_Data->m_CriticalSection);
-	}
 
-	void RenderThread::Set(State setToState)
-	{
-		if (m_ThreadingPolicy == ThreadingPolicy::SingleThreaded)
-			return;
-
-		EnterCriticalSection(&m_Data->m_CriticalSection);
-		m_Data->m_State = setToState;
-		WakeAllConditionVariable(&m_Data->m_ConditionVariable);
-		LeaveCriticalSection(&m_Data->m_CriticalSection);
-	}
-
-	void RenderThread::NextFrame()
-	{
-		m_AppThreadFrame++;
-		Renderer::SwapQueues();
+		Renderer::NextSubmissionQueue();
 	}
 
 	void RenderThread::BlockUntilRenderComplete()
@@ -101,18 +81,26 @@ namespace X2 {
 		if (m_ThreadingPolicy == ThreadingPolicy::SingleThreaded)
 			return;
 
-		Wait(State::Idle);
+		std::unique_lock<std::mutex> lock(m_Data->Mutex);
+		m_Data->FrameRendered.wait(lock, [&] { return m_Data->PendingFrames == 0; });
 	}
 
 	void RenderThread::Kick()
 	{
+		{
+			std::scoped_lock<std::mutex> lock(m_Data->Mutex);
+			m_Data->PendingFrames += m_Data->RecordedFrames;
+			m_Data->RecordedFrames = 0;
+		}
+
 		if (m_ThreadingPolicy == ThreadingPolicy::MultiThreaded)
 		{
-			Set(State::Kick);
+			m_Data->FrameKicked.notify_all();
 		}
 		else
 		{
-			Renderer::WaitAndRender(this);
+			while (GetPendingFrameCount())
+				Renderer::WaitAndRender(this);
 		}
 	}
 
@@ -123,4 +111,27 @@ namespace X2 {
 		BlockUntilRenderComplete();
 	}
 
+	bool RenderThread::WaitForFrame()
+	{
+		std::unique_lock<std::mutex> lock(m_Data->Mutex);
+		m_Data->FrameKicked.wait(lock, [&] { return m_Data->PendingFrames > 0 || !m_IsRunning; });
+		return m_Data->PendingFrames > 0;
+	}
+
+	void RenderThread::FrameComplete()
+	{
+		{
+			std::scoped_lock<std::mutex> lock(m_Data->Mutex);
+			X2_CORE_ASSERT(m_Data->PendingFrames > 0);
+			m_Data->PendingFrames--;
+		}
+		m_Data->FrameRendered.notify_all();
+	}
+
+	uint32_t RenderThread::GetPendingFrameCount() const
+	{
+		std::scoped_lock<std::mutex> lock(m_Data->Mutex);
+		return m_Data->PendingFrames;
+	}
+
 }
@@ -14,15 +14,14 @@ namespace X2 {
 		None = 0, SingleThreaded, MultiThreaded
 	};
 
+	//
+	// Hands the frames recorded by the app thread over to the render thread. Every frame is recorded
+	// into its own render command queue (one per frame in flight, see Renderer::GetRenderCommandQueueCount),
+	// so the app thread keeps recording while the render thread works through the frames before it and
+	// only waits when every other queue is still pending.
+	//
 	class RenderThread
 	{
-	public:
-		enum class State
-		{
-			Idle = 0,
-			Busy,
-			Kick
-		};
 	public:
 		RenderThread(ThreadingPolicy coreThreadingPolicy);
 		~RenderThread();
@@ -31,22 +30,28 @@ namespace X2 {
 		bool IsRunning() const { return m_IsRunning; }
 		void Terminate();
 
-		void Wait(State waitForState);
-		void WaitAndSet(State waitForState, State setToState);
-		void Set(State setToState);
-
+		// App thread: finishes recording the current frame and moves on to the next queue once it is free
 		void NextFrame();
+		// Waits until the render thread has executed every kicked frame
 		void BlockUntilRenderComplete();
+		// Hands the frames finished by NextFrame() to the render thread, executes them right away when single threaded
 		void Kick();
 
 		void Pump();
+
+		// Render thread: waits for a kicked frame, returns false if the thread was terminated instead
+		bool WaitForFrame();
+		// Render thread: the oldest kicked frame has been executed
+		void FrameComplete();
+
+		uint32_t GetPendingFrameCount() const;
 	private:
 		RenderThreadData* m_Data;
 		ThreadingPolicy m_ThreadingPolicy;
 
 		Thread m_RenderThread;
 
-		bool m_IsRunning = false;
+		std::atomic<bool> m_IsRunning = false;
 
 		std::atomic<uint32_t> m_AppThreadFrame = 0;
 	};
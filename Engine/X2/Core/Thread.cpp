@@ -1,7 +1,12 @@
 #include "Precompiled.h"
 #include "Thread.h"
 
+// Checks the compiler's platform macro, X2_PLATFORM_WINDOWS is defined on every platform
+#ifdef _WIN32
 #include <Windows.h>
+#else
+#include <pthread.h>
+#endif
 
 namespace X2 {
 
@@ -12,22 +17,46 @@ namespace X2 {
 
 	void Thread::SetName(const std::string& name)
 	{
+#ifdef _WIN32
 		HANDLE threadHandle = m_Thread.native_handle();
 
 		std::wstring wName(name.begin(), name.end());
 		SetThreadDescription(threadHandle, wName.c_str());
-		SetThreadAffinityMask(threadHandle, 8);
+#else
+		// Linux limits thread names to 15 characters
+		pthread_setname_np(m_Thread.native_handle(), name.substr(0, 15).c_str());
+#endif
 	}
 
 	ThreadSignal::ThreadSignal(const std::string& name, bool manualReset)
+		: m_ManualReset(manualReset)
 	{
-		std::string str(name.begin(), name.end());
-		m_SignalHandle = CreateEvent(NULL, (BOOL)manualReset, FALSE, str.c_str());
 	}
 
 	void ThreadSignal::Wait()
 	{
-		WaitForSingleObject(m_SignalHandle, INFINITE);
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_ConditionVariable.wait(lock, [this] { return m_Signaled; });
+
+		// An auto reset signal releases one waiter
+		if (!m_ManualReset)
+			m_Signaled = false;
+	}
+
+	void Thread::SetAffinityMask(uint64_t mask)
+	{
+#ifdef _WIN32
+		SetThreadAffinityMask(m_Thread.native_handle(), (DWORD_PTR)mask);
+#else
+		cpu_set_t cpuSet;
+		CPU_ZERO(&cpuSet);
+		for (uint32_t cpu = 0; cpu < 64; cpu++)
+		{
+			if (mask & (1ull << cpu))
+				CPU_SET(cpu, &cpuSet);
+		}
+		pthread_setaffinity_np(m_Thread.native_handle(), sizeof(cpu_set_t), &cpuSet);
+#endif
 	}
 
 	void Thread::Join()
@@ -37,12 +66,21 @@ namespace X2 {
 
 	void ThreadSignal::Signal()
 	{
-		SetEvent(m_SignalHandle);
+		{
+			std::scoped_lock<std::mutex> lock(m_Mutex);
+			m_Signaled = true;
+		}
+
+		if (m_ManualReset)
+			m_ConditionVariable.notify_all();
+		else
+			m_ConditionVariable.notify_one();
 	}
 
 	void ThreadSignal::Reset()
 	{
-		ResetEvent(m_SignalHandle);
+		std::scoped_lock<std::mutex> lock(m_Mutex);
+		m_Signaled = false;
 	}
 
 }
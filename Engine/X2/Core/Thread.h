@@ -2,6 +2,8 @@
 
 #include <string>
 #include <thread>
+#include <mutex>
+#include <condition_variable>
 
 namespace X2 {
 
@@ -18,6 +20,8 @@ namespace X2 {
 		}
 
 		void SetName(const std::string& name);
+		// Bit i allows the thread to run on CPU i, threads run on any CPU by default
+		void SetAffinityMask(uint64_t mask);
 
 		void Join();
 	private:
@@ -34,7 +38,10 @@ namespace X2 {
 		void Signal();
 		void Reset();
 	private:
-		void* m_SignalHandle = nullptr;
+		std::mutex m_Mutex;
+		std::condition_variable m_ConditionVariable;
+		bool m_Signaled = false;
+		bool m_ManualReset = false;
 	};
 
 }
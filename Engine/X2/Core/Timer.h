@@ -53,6 +53,14 @@ namespace X2 {
 			m_PerFrameData.clear();
 		}
 
+		// Moves the timings gathered so far into outData, the render thread may add timings at any time
+		void FlushPerFrameData(std::unordered_map<const char*, float>& outData)
+		{
+			std::scoped_lock<std::mutex> lock(m_PerFrameDataMutex);
+			outData = m_PerFrameData;
+			m_PerFrameData.clear();
+		}
+
 		const std::unordered_map<const char*, float>& GetPerFrameData() const { return m_PerFrameData; }
 	private:
 		std::unordered_map<const char*, float> m_PerFrameData;
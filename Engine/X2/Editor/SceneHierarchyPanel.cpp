@@ -1675,6 +1675,7 @@ namespace X2 {
 							//}
 						}
 					}
+					m_Context->MarkMeshesChanged();
 				}
 					ImGui::PopItemFlag();
 					if (error == UI::PropertyAssetReferenceError::InvalidMetadata)
@@ -1694,6 +1695,7 @@ namespace X2 {
 								auto& mc = entity.GetComponent<MeshComponent>();
 								mc.SubmeshIndex = glm::clamp<uint32_t>(submeshIndex, 0, (uint32_t)mesh->GetMeshSource()->GetSubmeshes().size() - 1);
 							}
+							m_Context->MarkMeshesChanged();
 						}
 						ImGui::PopItemFlag();
 					}
@@ -1734,6 +1736,7 @@ namespace X2 {
 							CookingFactory::CookMesh(mcc.CollisionMesh);
 						}*/
 					}
+					m_Context->MarkMeshesChanged();
 				}
 
 					ImGui::PopItemFlag();
@@ -13,6 +13,7 @@
 
 #include "X2/Core/Event/EditorEvent.h"
 #include "X2/Core/Debug/Profiler.h"
+#include "X2/Benchmarks/Benchmark.h"
 
 #include "X2/Project/Project.h"
 #include "X2/Project/ProjectSerializer.h"
@@ -589,6 +590,9 @@ namespace X2 {
 
 					ImGui::PushStyleColor(ImGuiCol_HeaderHovered, colHovered);
 
+					if (ImGui::MenuItem("Run Benchmarks"))
+						Benchmark::RunAll();
+
 					/*if (PhysXDebugger::IsDebugging())
 					{
 						if (ImGui::MenuItem("Stop PhysX Debugging"))
@@ -1289,6 +1293,7 @@ namespace X2 {
 
 					checkbox("Show Grid", viewportRenderOptions.ShowGrid);
 					checkbox("Show Selected Wireframe", viewportRenderOptions.ShowSelectedInWireframe);
+					checkbox("Cross-Entity Instancing", viewportRenderOptions.CrossEntityInstancing);
 
 					static const char* physicsColliderViewOptions[] = { "Selected Entity", "All" };
 					checkbox("Show Physics Colliders", viewportRenderOptions.ShowPhysicsColliders);
@@ -2854,11 +2859,17 @@ namespace X2 {
 				if (ImGui::BeginTabItem("Performance"))
 				{
 					ImGui::Text("Frame Time: %.2fms\n", app.GetTimestep().GetMilliseconds());
-					const auto& perFrameData = app.GetPerformanceProfiler()->GetPerFrameData();
+					const auto& perFrameData = app.GetProfilerPreviousFrameData();
 					for (auto&& [name, time] : perFrameData)
 					{
 						ImGui::Text("%s: %.3fms\n", name, time);
 					}
+
+					const JobSystemStats& jobStats = app.GetJobSystemStats();
+					ImGui::Separator();
+					ImGui::Text("Job Workers: %u (%.0f%% busy)\n", jobStats.WorkerCount, jobStats.Utilization * 100.0f);
+					ImGui::Text("Jobs: %u\n", jobStats.JobCount);
+					ImGui::Text("Waiting Threads Assist: %.3fms\n", jobStats.AssistTime);
 					ImGui::EndTabItem();
 				}
 				if (ImGui::BeginTabItem("Memory"))
@@ -3362,77 +3373,44 @@ namespace X2 {
 		if (mouseX > -1.0f && mouseX < 1.0f && mouseY > -1.0f && mouseY < 1.0f)
 		{
 			const auto& camera = m_ViewportPanelMouseOver ? m_EditorCamera : m_SecondEditorCamera;
-			auto [origin, direction] = CastRay(camera, mouseX, mouseY);
-
-			auto meshEntities = m_CurrentScene->GetAllEntitiesWith<MeshComponent>();
-			for (auto e : meshEntities)
-			{
-				Entity entity = { e, m_CurrentScene.get() };
-				auto& mc = entity.GetComponent<MeshComponent>();
-				auto mesh = AssetManager::GetAsset<Mesh>(mc.Mesh);
-				if (!mesh || mesh->IsFlagSet(AssetFlag::Missing))
-					continue;
-
-				auto& submeshes = mesh->GetMeshSource()->GetSubmeshes();
-				float lastT = std::numeric_limits<float>::max();
-				auto& submesh = submeshes[mc.SubmeshIndex];
-				glm::mat4 transform = m_CurrentScene->GetWorldSpaceTransformMatrix(entity);
-				Volume::Ray ray = {
-					glm::inverse(transform) * glm::vec4(origin, 1.0f),
-					glm::inverse(glm::mat3(transform)) * direction
-				};
+			const auto& viewportBounds = m_ViewportPanelMouseOver ? m_ViewportBounds : m_SecondViewportBounds;
+			const glm::vec2 pixelSize = 2.0f / (viewportBounds[1] - viewportBounds[0]);
+
+			// One packet of rays around the cursor, so thin geometry doesn't need a pixel exact click:
+			// the cursor itself, then rings at 2 and 4 pixels
+			constexpr uint32_t ringCount = 3;
+			constexpr uint32_t ringSizes[ringCount] = { 1, 5, 10 };
+			constexpr float ringRadii[ringCount] = { 0.0f, 2.0f, 4.0f };
 
-				float t;
-				bool intersects = ray.Intersects(submesh.BoundingBox, 0.3 ,50.0 , t);
-				if (intersects)
+			Volume::Ray rays[Volume::BVH4::maxPacketSize];
+			uint32_t rayCount = 0;
+			for (uint32_t ring = 0; ring < ringCount; ring++)
+			{
+				for (uint32_t i = 0; i < ringSizes[ring]; i++)
 				{
-					const auto& triangleCache = mesh->GetMeshSource()->GetTriangleCache(mc.SubmeshIndex);
-					for (const auto& triangle : triangleCache)
-					{
-						if (ray.Intersects(triangle.V0.Position, triangle.V1.Position, triangle.V2.Position, t))
-						{
-							selectionData.push_back({ entity, &submesh, t });
-							break;
-						}
-					}
+					const float angle = glm::two_pi<float>() * (float)i / (float)ringSizes[ring];
+					const glm::vec2 offset = glm::vec2(glm::cos(angle), glm::sin(angle)) * ringRadii[ring] * pixelSize;
+					auto [origin, direction] = CastRay(camera, mouseX + offset.x, mouseY + offset.y);
+					rays[rayCount++] = Volume::Ray(origin, direction);
 				}
 			}
 
-			auto staticMeshEntities = m_CurrentScene->GetAllEntitiesWith<StaticMeshComponent>();
-			for (auto e : staticMeshEntities)
-			{
-				Entity entity = { e, m_CurrentScene.get() };
-				auto& smc = entity.GetComponent<StaticMeshComponent>();
-				auto staticMesh = AssetManager::GetAsset<StaticMesh>(smc.StaticMesh);
-				if (!staticMesh || staticMesh->IsFlagSet(AssetFlag::Missing))
-					continue;
+			// Closest hits over all mesh instances, through the scene's two level BVH
+			m_SceneRayQuery.Update(m_CurrentScene.get());
 
-				auto& submeshes = staticMesh->GetMeshSource()->GetSubmeshes();
-				float lastT = std::numeric_limits<float>::max();
-				for (uint32_t i = 0; i < submeshes.size(); i++)
-				{
-					auto& submesh = submeshes[i];
-					glm::mat4 transform = m_CurrentScene->GetWorldSpaceTransformMatrix(entity);
-					Volume::Ray ray = {
-						glm::inverse(transform * submesh.Transform) * glm::vec4(origin, 1.0f),
-						glm::inverse(glm::mat3(transform * submesh.Transform)) * direction
-					};
+			SceneRayQuery::Hit hits[Volume::BVH4::maxPacketSize];
+			const uint32_t hitMask = m_SceneRayQuery.CastRays(rays, rayCount, hits);
 
-					float t;
-					bool intersects = ray.Intersects(submesh.BoundingBox, 0.3, 50.0, t);
-					if (intersects)
-					{
-						const auto& triangleCache = staticMesh->GetMeshSource()->GetTriangleCache(i);
-						for (const auto& triangle : triangleCache)
-						{
-							if (ray.Intersects(triangle.V0.Position, triangle.V1.Position, triangle.V2.Position, t))
-							{
-								selectionData.push_back({ entity, &submesh, t });
-								break;
-							}
-						}
-					}
+			// Only the innermost ring that hit anything is considered
+			uint32_t firstRay = 0;
+			for (uint32_t ring = 0; ring < ringCount && selectionData.empty(); ring++)
+			{
+				for (uint32_t r = firstRay; r < firstRay + ringSizes[ring]; r++)
+				{
+					if (hitMask & (1u << r))
+						selectionData.push_back({ hits[r].Entity, &hits[r].MeshSource->GetSubmeshes()[hits[r].SubmeshIndex], hits[r].Distance });
 				}
+				firstRay += ringSizes[ring];
 			}
 
 			std::sort(selectionData.begin(), selectionData.end(), [](auto& a, auto& b) { return a.Distance < b.Distance; });
@@ -26,6 +26,8 @@
 
 #include "X2/Renderer/UI/Font.h"
 
+#include "X2/Scene/SceneRayQuery.h"
+
 #include <future>
 
 namespace X2 {
@@ -135,6 +137,7 @@ namespace X2 {
 		bool m_ShowStatisticsPanel = false;
 
 		Ref<Scene> m_RuntimeScene, m_EditorScene, m_SimulationScene, m_CurrentScene;
+		SceneRayQuery m_SceneRayQuery; // Mouse picking
 		Ref<SceneRenderer> m_ViewportRenderer;
 		Ref<SceneRenderer> m_SecondViewportRenderer;
 		Ref<SceneRenderer> m_FocusedRenderer;
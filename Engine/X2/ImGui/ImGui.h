@@ -1968,7 +1968,7 @@ namespace X2::UI {
 			preview = "Null";
 		}
 
-		auto& assets = AssetManager::GetLoadedAssets();
+		auto assets = AssetManager::GetLoadedAssets();
 		AssetHandle current = *selected;
 
 		ImGui::SetNextWindowSize(size);
@@ -81,18 +81,18 @@ namespace X2::UI
 						}
 					}
 
-					for (const auto& [path, metadata] : assetRegistry)
+					assetRegistry.ForEach([&](const AssetMetadata& metadata)
 					{
 						if (metadata.Type != assetType)
-							continue;
+							return;
 
 						if (metadata.IsMemoryAsset)
-							continue;
+							return;
 
 						const std::string assetName = metadata.FilePath.stem().string();
 
 						if (!searchString.empty() && !UI::IsMatchingSearch(assetName, searchString))
-							continue;
+							return;
 
 						bool is_selected = (current == metadata.Handle);
 						if (ImGui::Selectable(assetName.c_str(), is_selected))
@@ -110,7 +110,7 @@ namespace X2::UI
 						{
 							ImGui::SetItemDefaultFocus();
 						}
-					}
+					});
 
 					ImGui::EndListBox();
 				}
@@ -199,18 +199,18 @@ namespace X2::UI
 						}
 					}
 
-					for (const auto& [path, metadata] : assetRegistry)
+					assetRegistry.ForEach([&](const AssetMetadata& metadata)
 					{
 						if (allowMemoryOnlyAssets != metadata.IsMemoryAsset)
-							continue;
+							return;
 
 						if (metadata.Type != assetType)
-							continue;
+							return;
 
 						const std::string assetName = metadata.IsMemoryAsset ? metadata.FilePath.string() : metadata.FilePath.stem().string();
 
 						if (!searchString.empty() && !UI::IsMatchingSearch(assetName, searchString))
-							continue;
+							return;
 
 						bool is_selected = (current == metadata.Handle);
 						if (ImGui::Selectable(assetName.c_str(), is_selected))
@@ -228,7 +228,7 @@ namespace X2::UI
 						{
 							ImGui::SetItemDefaultFocus();
 						}
-					}
+					});
 
 					ImGui::EndListBox();
 				}
@@ -317,7 +317,7 @@ namespace X2::UI
 						}
 					}
 
-					for (const auto& [path, metadata] : assetRegistry)
+					assetRegistry.ForEach([&](const AssetMetadata& metadata)
 					{
 						bool isValidType = false;
 
@@ -331,12 +331,12 @@ namespace X2::UI
 						}
 
 						if (!isValidType)
-							continue;
+							return;
 
 						const std::string assetName = metadata.FilePath.stem().string();
 
 						if (!searchString.empty() && !UI::IsMatchingSearch(assetName, searchString))
-							continue;
+							return;
 
 						std::string label = fmt::format("{}##{}", assetName, metadata.FilePath.string());
 
@@ -368,7 +368,7 @@ namespace X2::UI
 						{
 							ImGui::SetItemDefaultFocus();
 						}
-					}
+					});
 
 					ImGui::EndListBox();
 				}
@@ -1,27 +1,27 @@
 // Based on: Spatial Splits in Bounding Volume Hierarchies, Stich et. al.
 // https://www.nvidia.in/docs/IO/77714/sbvh.pdf
 #include <numeric>
-#include <future>
 
 #include "BVH.h"
 #include "X2/Core/Log.h"
+#include "X2/Core/Assert.h"
+#include "X2/Core/Timer.h"
+#include "X2/Core/JobSystem.h"
+
+#include <cstring>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define X2_BVH_SSE 1
+    #include <emmintrin.h>
+#endif
 
 namespace X2 {
 
     namespace Volume {
 
-        uint32_t BVHBuilder::maxDepth = 0;
-        uint32_t BVHBuilder::maxTriangles = 0;
-        uint32_t BVHBuilder::minTriangles = 10000;
-        uint32_t BVHBuilder::spatialSplitCount = 0;
-        float BVHBuilder::totalSurfaceArea = 0.0f;
-
         BVH::BVH(std::vector<AABB>& aabbs, std::vector<BVHTriangle>& data) {
 
-            X2_CORE_INFO("Started BVH build");
-
-            //Tools::PerformanceCounter perfCounter;
-
             if (aabbs.size() != data.size())
                 return;
 
@@ -38,42 +38,29 @@ namespace X2 {
                 aabb.Grow(aabbs[ref.idx]);
 
             auto minOverlap = aabb.GetSurfaceArea() * 10e-6f;
-            auto builder = new BVHBuilder(aabb, 0, refs.size(), minOverlap, 256);
+            BVHBuilder builder(&data, minOverlap, 256);
 
-            builder->Build(refs, data);
-            refs.reserve(data.size());
+            std::vector<BVHBuilder::Ref> leafRefs;
+            stats = builder.Build(refs, aabb, nodes, leafRefs);
 
-            //X2_CORE_INFO("Build: " + std::to_string(perfCounter.StepStamp().delta));
+            this->aabbs.resize(leafRefs.size());
+            this->data.resize(leafRefs.size());
 
-            builder->Flatten(nodes, refs);
-
-            this->aabbs.resize(refs.size());
-            this->data.resize(refs.size());
-
-            for (size_t i = 0; i < refs.size(); i++) {
-                auto ref = refs[i];
+            for (size_t i = 0; i < leafRefs.size(); i++) {
+                auto ref = leafRefs[i];
                 this->aabbs[i] = aabbs[ref.idx];
                 this->data[i] = data[ref.idx];
                 this->data[i].endOfNode = ref.endOfNode;
             }
 
-            delete builder;
-
-            //X2_CORE_INFO("Flatten: " + std::to_string(perfCounter.StepStamp().delta));
-            X2_CORE_INFO("Triangle count: " + std::to_string(refs.size()));
-            X2_CORE_INFO("Node count: " + std::to_string(nodes.size()));
-            X2_CORE_INFO("Max depth: " + std::to_string(BVHBuilder::maxDepth));
-            X2_CORE_INFO("Min triangles: " + std::to_string(BVHBuilder::minTriangles));
-            X2_CORE_INFO("Max triangles: " + std::to_string(BVHBuilder::maxTriangles));
-            X2_CORE_INFO("Num spatial splits: " + std::to_string(BVHBuilder::spatialSplitCount));
-            X2_CORE_INFO("Surface area: " + std::to_string(BVHBuilder::totalSurfaceArea));
-            X2_CORE_INFO("Finished BVH build");
+            X2_CORE_INFO("BVH build: {} triangles, {} references, {} nodes, max depth {}, {} spatial splits, {:.2f}ms",
+                data.size(), stats.refCount, stats.nodeCount, stats.maxDepth, stats.spatialSplitCount, stats.buildTime);
 
         }
 
         BVH::BVH(std::vector<AABB>& aabbs) {
 
-            refs.resize(aabbs.size());
+            std::vector<BVHBuilder::Ref> refs(aabbs.size());
             for (size_t i = 0; i < refs.size(); i++) {
                 refs[i].idx = uint32_t(i);
                 refs[i].aabb = aabbs[i];
@@ -85,13 +72,7 @@ namespace X2 {
             for (auto& ref : refs)
                 aabb.Grow(aabbs[ref.idx]);
 
-            auto builder = new BVHBuilder(aabb, 0, refs.size(), 128);
-
-            builder->Build(refs);
-
-            refs.reserve(data.size());
-
-            if (!nodes.size() && aabbs.size() == 1) {
+            if (aabbs.size() == 1) {
                 BVHNode node;
                 node.leftPtr = ~0;
                 node.rightPtr = ~0;
@@ -101,20 +82,19 @@ namespace X2 {
                 nodes.push_back(node);
             }
 
-            builder->Flatten(nodes, refs);
+            BVHBuilder builder(nullptr, 0.0f, 128);
+            stats = builder.Build(refs, aabb, nodes, this->refs);
 
-            this->aabbs.resize(refs.size());
+            this->aabbs.resize(this->refs.size());
 
-            for (size_t i = 0; i < refs.size(); i++) {
-                auto ref = refs[i];
+            for (size_t i = 0; i < this->refs.size(); i++) {
+                auto ref = this->refs[i];
                 this->aabbs[i] = aabbs[ref.idx];
             }
 
-            delete builder;
-
         }
 
-        bool BVH::GetIntersection(std::vector<std::pair<int32_t, float>>& stack, Ray ray, BVHTriangle& closest, glm::vec3& intersection) {
+        bool BVH::GetIntersection(std::vector<std::pair<int32_t, float>>& stack, Ray ray, BVHTriangle& closest, glm::vec3& intersection) const {
 
             constexpr auto max = std::numeric_limits<float>::max();
 
@@ -122,13 +102,14 @@ namespace X2 {
 
         }
 
-        bool BVH::GetIntersection(std::vector<std::pair<int32_t, float>>& stack, Ray ray, BVHTriangle& closest, glm::vec3& intersection, float max) {
+        bool BVH::GetIntersection(std::vector<std::pair<int32_t, float>>& stack, Ray ray, BVHTriangle& closest, glm::vec3& intersection, float max) const {
 
             intersection.x = max;
 
-            if (nodes.size()) {
-                // Use a stack based iterative ray traversal
-                stack[0] = std::pair(0, 0.0f);
+            if (nodes.size() || data.size()) {
+                // Use a stack based iterative ray traversal. Trees with few enough triangles
+                // are a single leaf and have no nodes.
+                stack[0] = std::pair(nodes.size() ? 0 : ~0, 0.0f);
 
                 uint32_t stackPtr = 1u;
                 int32_t closestPtr = 0;
@@ -193,10 +174,10 @@ namespace X2 {
 
         }
 
-        bool BVH::GetIntersectionAny(std::vector<std::pair<int32_t, float>>& stack, Ray ray, float max) {
+        bool BVH::GetIntersectionAny(std::vector<std::pair<int32_t, float>>& stack, Ray ray, float max) const {
 
-            if (nodes.size()) {
-                stack[0] = std::pair(0, 0.0f);
+            if (nodes.size() || data.size()) {
+                stack[0] = std::pair(nodes.size() ? 0 : ~0, 0.0f);
 
                 uint32_t stackPtr = 1u;
 
@@ -242,309 +223,787 @@ namespace X2 {
 
         }
 
-        BVHBuilder::BVHBuilder(const AABB aabb, uint32_t depth, size_t refCount,
-            const float minOverlap, const uint32_t binCount) :
-            depth(depth), binCount(binCount), minOverlap(minOverlap), aabb(aabb) {
+        struct DecodedBVH4Node {
+            alignas(16) float min[3][4];
+            alignas(16) float max[3][4];
+            uint32_t childMask;
+        };
 
-            // Calculate cost for current node
-            nodeCost = float(refCount) * this->aabb.GetSurfaceArea();
+        struct BVH4Ray {
+            glm::vec3 origin;
+            glm::vec3 inverseDirection;
+        };
 
-            totalSurfaceArea += this->aabb.GetSurfaceArea();
+#ifdef X2_BVH_SSE
+        static inline __m128 LoadQuantized(const uint8_t* quantized) {
+
+            int32_t packed;
+            std::memcpy(&packed, quantized, sizeof(packed));
+
+            auto value = _mm_cvtsi32_si128(packed);
+            value = _mm_unpacklo_epi8(value, _mm_setzero_si128());
+            value = _mm_unpacklo_epi16(value, _mm_setzero_si128());
+            return _mm_cvtepi32_ps(value);
 
         }
+#endif
+
+        static void DecodeBVH4Node(const BVH4Node& node, DecodedBVH4Node& decoded) {
+
+            for (int32_t axis = 0; axis < 3; axis++) {
+#ifdef X2_BVH_SSE
+                auto origin = _mm_set1_ps(node.origin[axis]);
+                auto scale = _mm_set1_ps(node.scale[axis]);
+                _mm_store_ps(decoded.min[axis], _mm_add_ps(origin, _mm_mul_ps(LoadQuantized(node.min[axis]), scale)));
+                _mm_store_ps(decoded.max[axis], _mm_add_ps(origin, _mm_mul_ps(LoadQuantized(node.max[axis]), scale)));
+#else
+                for (int32_t i = 0; i < 4; i++) {
+                    decoded.min[axis][i] = node.origin[axis] + float(node.min[axis][i]) * node.scale[axis];
+                    decoded.max[axis][i] = node.origin[axis] + float(node.max[axis][i]) * node.scale[axis];
+                }
+#endif
+            }
 
-        BVHBuilder::BVHBuilder(const AABB aabb, uint32_t depth, size_t refCount, const uint32_t binCount) :
-            depth(depth), binCount(binCount), minOverlap(0.0f), aabb(aabb) {
+            decoded.childMask = 0;
+            for (int32_t i = 0; i < 4; i++)
+                if (node.children[i] != BVH4::emptyChild) decoded.childMask |= 1u << i;
 
-            // Calculate cost for current node
-            nodeCost = float(refCount) * this->aabb.GetSurfaceArea();
+        }
+
+        // Slab test against all four children, returns the mask of children that are hit in [0, tmax]
+        static uint32_t IntersectBVH4Children(const DecodedBVH4Node& node, const BVH4Ray& ray, float tmax, float* distances) {
+
+#ifdef X2_BVH_SSE
+            auto tnear = _mm_setzero_ps();
+            auto tfar = _mm_set1_ps(tmax);
+
+            for (int32_t axis = 0; axis < 3; axis++) {
+                auto origin = _mm_set1_ps(ray.origin[axis]);
+                auto inverseDirection = _mm_set1_ps(ray.inverseDirection[axis]);
 
-            totalSurfaceArea += this->aabb.GetSurfaceArea();
+                auto t0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.min[axis]), origin), inverseDirection);
+                auto t1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.max[axis]), origin), inverseDirection);
+
+                // Operand order drops the NaNs of rays parallel to a slab that starts on its plane
+                tnear = _mm_max_ps(_mm_min_ps(t0, t1), tnear);
+                tfar = _mm_min_ps(_mm_max_ps(t0, t1), tfar);
+            }
+
+            _mm_storeu_ps(distances, tnear);
+            return uint32_t(_mm_movemask_ps(_mm_cmple_ps(tnear, tfar))) & node.childMask;
+#else
+            uint32_t mask = 0;
+            for (int32_t i = 0; i < 4; i++) {
+                auto tnear = 0.0f, tfar = tmax;
+                for (int32_t axis = 0; axis < 3; axis++) {
+                    auto t0 = (node.min[axis][i] - ray.origin[axis]) * ray.inverseDirection[axis];
+                    auto t1 = (node.max[axis][i] - ray.origin[axis]) * ray.inverseDirection[axis];
+                    tnear = glm::max(tnear, glm::min(t0, t1));
+                    tfar = glm::min(tfar, glm::max(t0, t1));
+                }
+                distances[i] = tnear;
+                if (tnear <= tfar) mask |= 1u << i;
+            }
+            return mask & node.childMask;
+#endif
 
         }
 
-        BVHBuilder::~BVHBuilder() {
+        // Orders the hit children far to near, so the nearest one ends up on top of the stack
+        static uint32_t SortBVH4Children(uint32_t mask, const float* distances, uint32_t* order) {
+
+            uint32_t count = 0;
+            for (uint32_t i = 0; i < 4; i++) {
+                if (!(mask & (1u << i))) continue;
 
-            delete leftChild;
-            delete rightChild;
+                auto j = count++;
+                for (; j > 0 && distances[order[j - 1]] < distances[i]; j--)
+                    order[j] = order[j - 1];
+                order[j] = i;
+            }
+
+            return count;
 
         }
 
-        void BVHBuilder::Build(std::vector<Ref>& refs, const std::vector<BVHTriangle>& data) {
+        BVH4::BVH4(const BVH& bvh) {
 
-            const size_t refCount = 2;
-            // Create leaf node
-            if (refs.size() <= refCount || depth >= 32) {
-                CreateLeaf(refs);
-                return;
+            data = bvh.data;
+
+            if (bvh.nodes.size()) {
+                const auto& root = bvh.nodes[0];
+                Child children[2] = { { root.leftPtr, root.leftAABB }, { root.rightPtr, root.rightAABB } };
+                Collapse(bvh, children, 2);
             }
+            else if (data.size()) {
+                // Trees with few triangles are a single leaf without nodes
+                AABB aabb(glm::vec3(std::numeric_limits<float>::max()), glm::vec3(-std::numeric_limits<float>::max()));
+                for (auto& triangle : data) {
+                    aabb.Grow(triangle.v0);
+                    aabb.Grow(triangle.v1);
+                    aabb.Grow(triangle.v2);
+                }
 
-            Split objectSplit;
-            objectSplit = FindObjectSplit(refs);
+                Child child = { ~0, aabb };
+                Collapse(bvh, &child, 1);
+            }
 
-            Split spatialSplit;
-            if (depth <= 16) {
-                AABB overlap = objectSplit.leftAABB;
-                overlap.Intersect(objectSplit.rightAABB);
-                if (overlap.GetSurfaceArea() >= minOverlap) {
-                    spatialSplit = FindSpatialSplit(refs, data);
+        }
+
+        int32_t BVH4::Collapse(const BVH& bvh, const Child* binaryChildren, uint32_t binaryChildCount) {
+
+            Child children[4];
+            uint32_t childCount = binaryChildCount;
+            std::copy(binaryChildren, binaryChildren + binaryChildCount, children);
+
+            // Pull up the grandchildren of the largest inner children until the node is full
+            while (childCount < 4) {
+                int32_t largest = -1;
+                auto largestArea = -1.0f;
+                for (uint32_t i = 0; i < childCount; i++) {
+                    if (children[i].ptr < 0) continue;
+
+                    auto area = children[i].aabb.GetSurfaceArea();
+                    if (area > largestArea) {
+                        largest = int32_t(i);
+                        largestArea = area;
+                    }
                 }
+
+                if (largest < 0) break;
+
+                const auto& binaryNode = bvh.nodes[children[largest].ptr];
+                children[largest] = { binaryNode.leftPtr, binaryNode.leftAABB };
+                children[childCount++] = { binaryNode.rightPtr, binaryNode.rightAABB };
             }
 
-            std::vector<Ref> leftRefs;
-            std::vector<Ref> rightRefs;
+            AABB aabb = children[0].aabb;
+            for (uint32_t i = 1; i < childCount; i++)
+                aabb.Grow(children[i].aabb);
 
-            leftRefs.reserve(refs.size());
-            rightRefs.reserve(refs.size());
+            BVH4Node node;
+            node.origin = aabb.Min;
 
-            Split split;
-            // If we haven't found a cost improvement we create a leaf node
-            if ((objectSplit.axis < 0 || objectSplit.cost >= nodeCost) &&
-                (spatialSplit.axis < 0 || spatialSplit.cost >= nodeCost)) {
-                CreateLeaf(refs);
-                return;
+            auto extent = aabb.Max - aabb.Min;
+            for (int32_t axis = 0; axis < 3; axis++) {
+                auto scale = extent[axis] / 255.0f;
+                // The largest step has to reach the maximum despite rounding
+                while (node.origin[axis] + 255.0f * scale < aabb.Max[axis])
+                    scale = std::nextafter(scale, std::numeric_limits<float>::max());
+                node.scale[axis] = scale;
             }
-            else {
-                if (spatialSplit.cost < objectSplit.cost) {
-                    PerformSpatialSplit(refs, data, rightRefs, leftRefs, spatialSplit);
-                    split = spatialSplit;
+
+            for (uint32_t i = 0; i < 4; i++) {
+                node.children[i] = emptyChild;
+                if (i >= childCount) continue;
+
+                for (int32_t axis = 0; axis < 3; axis++) {
+                    auto origin = node.origin[axis];
+                    auto scale = node.scale[axis];
+                    if (scale == 0.0f) continue;
+
+                    // Round outwards, then fix up what float rounding still got wrong
+                    auto min = int32_t(glm::clamp(std::floor((children[i].aabb.Min[axis] - origin) / scale), 0.0f, 255.0f));
+                    auto max = int32_t(glm::clamp(std::ceil((children[i].aabb.Max[axis] - origin) / scale), 0.0f, 255.0f));
+                    while (min > 0 && origin + float(min) * scale > children[i].aabb.Min[axis]) min--;
+                    while (max < 255 && origin + float(max) * scale < children[i].aabb.Max[axis]) max++;
+
+                    node.min[axis][i] = uint8_t(min);
+                    node.max[axis][i] = uint8_t(max);
                 }
+            }
 
-                if (objectSplit.cost <= spatialSplit.cost) {
-                    leftRefs.clear();
-                    rightRefs.clear();
-                    PerformObjectSplit(refs, rightRefs, leftRefs, objectSplit);
-                    split = objectSplit;
+            auto nodeIdx = int32_t(nodes.size());
+            nodes.push_back(node);
+
+            // Children are collapsed after the parent is stored, nodes may reallocate
+            for (uint32_t i = 0; i < childCount; i++) {
+                if (children[i].ptr < 0) {
+                    nodes[nodeIdx].children[i] = children[i].ptr;
+                    continue;
                 }
-                else {
-                    spatialSplitCount++;
+
+                const auto& binaryNode = bvh.nodes[children[i].ptr];
+                Child grandChildren[2] = { { binaryNode.leftPtr, binaryNode.leftAABB }, { binaryNode.rightPtr, binaryNode.rightAABB } };
+                auto childIdx = Collapse(bvh, grandChildren, 2);
+                nodes[nodeIdx].children[i] = childIdx;
+            }
+
+            return nodeIdx;
+
+        }
+
+        bool BVH4::GetIntersection(std::vector<std::pair<int32_t, float>>& stack, Ray ray, BVHTriangle& closest, glm::vec3& intersection, float max) const {
+
+            intersection.x = max;
+
+            if (nodes.empty())
+                return false;
+
+            const BVH4Ray wideRay = { ray.origin, 1.0f / ray.direction };
+
+            if (stack.size() < 64)
+                stack.resize(64);
+
+            stack[0] = std::pair(0, 0.0f);
+
+            uint32_t stackPtr = 1u;
+            int32_t closestPtr = -1;
+
+            DecodedBVH4Node decoded;
+            float distances[4];
+            uint32_t order[4];
+
+            while (stackPtr != 0u) {
+                const auto [nodePtr, distance] = stack[--stackPtr];
+
+                if (distance > intersection.x) continue;
+
+                if (nodePtr < 0) {
+                    auto triPtr = ~nodePtr;
+                    auto endOfNode = false;
+                    while (!endOfNode) {
+                        auto ptr = triPtr++;
+                        auto& triangle = data[ptr];
+                        endOfNode = triangle.endOfNode;
+
+                        glm::vec3 intersect;
+                        bool hit = ray.Intersects(triangle.v0, triangle.v1, triangle.v2, intersect);
+
+                        if (hit && intersect.x < intersection.x) {
+                            closestPtr = ptr;
+                            intersection = intersect;
+                        }
+                    }
+                    continue;
                 }
+
+                const auto& node = nodes[nodePtr];
+                DecodeBVH4Node(node, decoded);
+
+                auto mask = IntersectBVH4Children(decoded, wideRay, intersection.x, distances);
+                auto count = SortBVH4Children(mask, distances, order);
+
+                if (stack.size() < stackPtr + count)
+                    stack.resize(stack.size() * 2);
+
+                for (uint32_t i = 0; i < count; i++)
+                    stack[stackPtr++] = std::pair(node.children[order[i]], distances[order[i]]);
             }
 
-            refs.clear();
-            refs.shrink_to_fit();
+            if (closestPtr >= 0)
+                closest = data[closestPtr];
+
+            return (intersection.x < max);
+
+        }
+
+        bool BVH4::GetIntersectionAny(std::vector<std::pair<int32_t, float>>& stack, Ray ray, float max) const {
 
-            if (depth <= 5) {
-                auto leftLambda = [&]() {
-                    if (!leftRefs.size()) return;
-                    leftChild = new BVHBuilder(split.leftAABB, depth + 1, leftRefs.size(), minOverlap, binCount);
-                    leftChild->Build(leftRefs, data);
-                };
+            if (nodes.empty())
+                return false;
 
-                auto rightLambda = [&]() {
-                    if (!rightRefs.size()) return;
-                    rightChild = new BVHBuilder(split.rightAABB, depth + 1, rightRefs.size(), minOverlap, binCount);
-                    rightChild->Build(rightRefs, data);
-                };
+            const BVH4Ray wideRay = { ray.origin, 1.0f / ray.direction };
 
-                auto leftBuilderFuture = std::async(leftLambda);
-                auto rightBuilderFuture = std::async(rightLambda);
+            if (stack.size() < 64)
+                stack.resize(64);
 
-                leftBuilderFuture.get();
-                rightBuilderFuture.get();
+            stack[0] = std::pair(0, 0.0f);
+
+            uint32_t stackPtr = 1u;
+
+            DecodedBVH4Node decoded;
+            float distances[4];
+
+            while (stackPtr != 0u) {
+                const auto [nodePtr, _] = stack[--stackPtr];
+
+                if (nodePtr < 0) {
+                    auto triPtr = ~nodePtr;
+                    auto endOfNode = false;
+                    while (!endOfNode) {
+                        auto& triangle = data[triPtr++];
+                        endOfNode = triangle.endOfNode;
+
+                        glm::vec3 intersect;
+                        bool hit = ray.Intersects(triangle.v0, triangle.v1, triangle.v2, intersect);
+
+                        if (hit && intersect.x < max) {
+                            return true;
+                        }
+                    }
+                    continue;
+                }
+
+                const auto& node = nodes[nodePtr];
+                DecodeBVH4Node(node, decoded);
+
+                auto mask = IntersectBVH4Children(decoded, wideRay, max, distances);
+
+                if (stack.size() < stackPtr + 4)
+                    stack.resize(stack.size() * 2);
+
+                for (uint32_t i = 0; i < 4; i++)
+                    if (mask & (1u << i)) stack[stackPtr++] = std::pair(node.children[i], 0.0f);
             }
-            else {
-                if (leftRefs.size()) {
-                    leftChild = new BVHBuilder(split.leftAABB, depth + 1, leftRefs.size(), minOverlap, binCount);
-                    leftChild->Build(leftRefs, data);
+
+            return false;
+
+        }
+
+        uint32_t BVH4::GetIntersections(std::vector<PacketStackEntry>& stack, const Ray* rays, uint32_t rayCount,
+            BVHTriangle* closest, glm::vec3* intersections, float max) const {
+
+            X2_CORE_ASSERT(rayCount <= maxPacketSize, "Packet is too large");
+
+            for (uint32_t r = 0; r < rayCount; r++)
+                intersections[r].x = max;
+
+            if (nodes.empty() || !rayCount)
+                return 0;
+
+            Ray packet[maxPacketSize];
+            BVH4Ray wideRays[maxPacketSize];
+            int32_t closestPtrs[maxPacketSize];
+            for (uint32_t r = 0; r < rayCount; r++) {
+                packet[r] = rays[r];
+                wideRays[r] = { rays[r].origin, 1.0f / rays[r].direction };
+                closestPtrs[r] = -1;
+            }
+
+            if (stack.size() < 64)
+                stack.resize(64);
+
+            // Each entry carries the rays that hit the node, the others skip it
+            stack[0] = { 0, (1u << rayCount) - 1u, 0.0f };
+
+            uint32_t stackPtr = 1u;
+
+            DecodedBVH4Node decoded;
+            float distances[4];
+            uint32_t order[4];
+
+            while (stackPtr != 0u) {
+                const auto [nodePtr, entryMask, distance] = stack[--stackPtr];
+
+                // Rays that found something closer since the node was pushed are done with it
+                uint32_t rayMask = 0;
+                for (uint32_t r = 0; r < rayCount; r++)
+                    if ((entryMask & (1u << r)) && distance <= intersections[r].x) rayMask |= 1u << r;
+
+                if (!rayMask) continue;
+
+                if (nodePtr < 0) {
+                    auto triPtr = ~nodePtr;
+                    auto endOfNode = false;
+                    while (!endOfNode) {
+                        auto ptr = triPtr++;
+                        auto& triangle = data[ptr];
+                        endOfNode = triangle.endOfNode;
+
+                        for (uint32_t r = 0; r < rayCount; r++) {
+                            if (!(rayMask & (1u << r))) continue;
+
+                            glm::vec3 intersect;
+                            bool hit = packet[r].Intersects(triangle.v0, triangle.v1, triangle.v2, intersect);
+
+                            if (hit && intersect.x < intersections[r].x) {
+                                closestPtrs[r] = ptr;
+                                intersections[r] = intersect;
+                            }
+                        }
+                    }
+                    continue;
                 }
 
-                if (rightRefs.size()) {
-                    rightChild = new BVHBuilder(split.rightAABB, depth + 1, rightRefs.size(), minOverlap, binCount);
-                    rightChild->Build(rightRefs, data);
+                // Decoded once for the whole packet
+                const auto& node = nodes[nodePtr];
+                DecodeBVH4Node(node, decoded);
+
+                uint32_t childRays[4] = { 0u, 0u, 0u, 0u };
+                float childDistances[4] = { max, max, max, max };
+                for (uint32_t r = 0; r < rayCount; r++) {
+                    if (!(rayMask & (1u << r))) continue;
+
+                    auto mask = IntersectBVH4Children(decoded, wideRays[r], intersections[r].x, distances);
+                    for (uint32_t i = 0; i < 4; i++) {
+                        if (!(mask & (1u << i))) continue;
+
+                        childRays[i] |= 1u << r;
+                        childDistances[i] = glm::min(childDistances[i], distances[i]);
+                    }
                 }
+
+                uint32_t mask = 0;
+                for (uint32_t i = 0; i < 4; i++)
+                    if (childRays[i]) mask |= 1u << i;
+
+                auto count = SortBVH4Children(mask, childDistances, order);
+
+                if (stack.size() < stackPtr + count)
+                    stack.resize(stack.size() * 2);
+
+                for (uint32_t i = 0; i < count; i++)
+                    stack[stackPtr++] = { node.children[order[i]], childRays[order[i]], childDistances[order[i]] };
             }
 
+            uint32_t hitMask = 0;
+            for (uint32_t r = 0; r < rayCount; r++) {
+                if (closestPtrs[r] < 0) continue;
+
+                closest[r] = data[closestPtrs[r]];
+                hitMask |= 1u << r;
+            }
+
+            return hitMask;
+
         }
 
-        void BVHBuilder::Build(std::vector<Ref>& refs) {
+        void BVH4::Clear() {
 
-            // Create leaf node
-            if (refs.size() == 1) {
-                CreateLeaf(refs);
-                return;
-            }
+            nodes.clear();
+            data.clear();
 
-            Split objectSplit;
-            objectSplit = FindObjectSplit(refs);
+        }
 
-            std::vector<Ref> leftRefs;
-            std::vector<Ref> rightRefs;
+        // Subtrees with fewer references are built by the task that reached them
+        static constexpr uint32_t s_TaskRefThreshold = 4096;
+        // Nodes with more references are binned in parallel over ranges of s_BinningGrainSize references
+        static constexpr uint32_t s_ParallelBinningRefThreshold = 65536;
+        static constexpr uint32_t s_BinningGrainSize = 16384;
+
+        void BVHBuildStats::Merge(const BVHBuildStats& stats) {
+
+            nodeCount += stats.nodeCount;
+            leafCount += stats.leafCount;
+            refCount += stats.refCount;
+            maxDepth = std::max(maxDepth, stats.maxDepth);
+            minTriangles = std::min(minTriangles, stats.minTriangles);
+            maxTriangles = std::max(maxTriangles, stats.maxTriangles);
+            spatialSplitCount += stats.spatialSplitCount;
+            totalSurfaceArea += stats.totalSurfaceArea;
+
+        }
+
+        BVHBuilder::BVHBuilder(const std::vector<BVHTriangle>* data, const float minOverlap, const uint32_t binCount) :
+            data(data), minOverlap(minOverlap), binCount(binCount) {
+
+        }
+
+        BVHBuildStats BVHBuilder::Build(std::vector<Ref>& refs, const AABB& aabb, std::vector<BVHNode>& nodes,
+            std::vector<Ref>& leafRefs) {
+
+            Timer timer;
+
+            Output output;
+            output.refs.reserve(refs.size());
+
+            if (refs.size())
+                BuildNode(output, refs.data(), uint32_t(refs.size()), aabb, 0);
+
+            nodes.insert(nodes.end(), output.nodes.begin(), output.nodes.end());
+            leafRefs.insert(leafRefs.end(), output.refs.begin(), output.refs.end());
+
+            output.stats.nodeCount = uint32_t(output.nodes.size());
+            output.stats.refCount = uint32_t(output.refs.size());
+            output.stats.buildTime = timer.ElapsedMillis();
+
+            return output.stats;
+
+        }
 
-            leftRefs.reserve(refs.size() / 2);
-            rightRefs.reserve(refs.size() / 2);
+        int32_t BVHBuilder::BuildNode(Output& output, Ref* refs, uint32_t refCount, const AABB& aabb, uint32_t depth) {
+
+            output.stats.totalSurfaceArea += aabb.GetSurfaceArea();
+            output.stats.maxDepth = std::max(depth, output.stats.maxDepth);
+
+            // Triangle trees stop at two references per leaf, AABB trees at one
+            const auto triangles = data != nullptr;
+            if (refCount <= (triangles ? 2u : 1u) || (triangles && depth >= 32))
+                return CreateLeaf(output, refs, refCount);
+
+            // Calculate cost for current node
+            const auto nodeCost = float(refCount) * aabb.GetSurfaceArea();
+
+            auto objectSplit = FindSplit(refs, refCount, aabb, depth, false);
+
+            Split spatialSplit;
+            if (triangles && depth <= 16) {
+                AABB overlap = objectSplit.leftAABB;
+                overlap.Intersect(objectSplit.rightAABB);
+                if (overlap.GetSurfaceArea() >= minOverlap) {
+                    spatialSplit = FindSplit(refs, refCount, aabb, depth, true);
+                }
+            }
+
+            // Object splits partition the references in place, spatial splits duplicate
+            // some of them and need new storage which lives until the subtree is built
+            std::vector<Ref> splitRefs;
+            Ref* leftRefs = refs;
+            uint32_t leftCount = 0;
+            uint32_t rightCount = 0;
 
             Split split;
-            // If we haven't found a cost improvement but need to continue since only one item per leaf is allowed
-            if (objectSplit.axis < 0 || objectSplit.cost >= nodeCost) {
-                split = PerformMedianSplit(refs, rightRefs, leftRefs);
+            // If we haven't found a cost improvement we create a leaf node. AABB trees
+            // have to continue since only one item per leaf is allowed.
+            if ((objectSplit.axis < 0 || objectSplit.cost >= nodeCost) &&
+                (spatialSplit.axis < 0 || spatialSplit.cost >= nodeCost)) {
+                if (triangles)
+                    return CreateLeaf(output, refs, refCount);
+
+                split = PerformMedianSplit(refs, refCount, aabb);
+                leftCount = refCount / 2;
+                rightCount = refCount - leftCount;
+            }
+            else if (spatialSplit.cost < objectSplit.cost) {
+                split = spatialSplit;
+                leftCount = PerformSpatialSplit(refs, refCount, aabb, depth, splitRefs, split);
+                rightCount = uint32_t(splitRefs.size()) - leftCount;
+                leftRefs = splitRefs.data();
+                output.stats.spatialSplitCount++;
             }
             else {
-                leftRefs.clear();
-                rightRefs.clear();
-                PerformObjectSplit(refs, rightRefs, leftRefs, objectSplit);
                 split = objectSplit;
+                leftCount = PerformObjectSplit(refs, refCount, aabb, depth, split);
+                rightCount = refCount - leftCount;
             }
 
-            refs.clear();
-            refs.shrink_to_fit();
+            if (!leftCount || !rightCount)
+                return CreateLeaf(output, refs, refCount);
+
+            auto rightRefs = leftRefs + leftCount;
 
-            if (depth <= 5) {
-                auto leftLambda = [&]() {
-                    if (!leftRefs.size()) return;
-                    leftChild = new BVHBuilder(split.leftAABB, depth + 1, leftRefs.size(), binCount);
-                    leftChild->Build(leftRefs);
-                };
+            const auto nodeIdx = output.nodes.size();
+            output.nodes.emplace_back();
+            output.nodes[nodeIdx].leftAABB = split.leftAABB;
+            output.nodes[nodeIdx].rightAABB = split.rightAABB;
 
-                auto rightLambda = [&]() {
-                    if (!rightRefs.size()) return;
-                    rightChild = new BVHBuilder(split.rightAABB, depth + 1, rightRefs.size(), binCount);
-                    rightChild->Build(rightRefs);
-                };
+            int32_t leftPtr, rightPtr;
 
-                auto leftBuilderFuture = std::async(leftLambda);
-                auto rightBuilderFuture = std::async(rightLambda);
+            // Hand the right subtree to the job system while this thread continues on the left,
+            // idle workers steal it and waiting for it runs other subtrees
+            if (rightCount >= s_TaskRefThreshold) {
+                Output rightOutput;
+                rightOutput.refs.reserve(rightCount);
 
-                leftBuilderFuture.get();
-                rightBuilderFuture.get();
+                JobCounter rightCounter;
+                int32_t rightSubtreePtr = 0;
+                JobSystem::Run([&]() {
+                    rightSubtreePtr = BuildNode(rightOutput, rightRefs, rightCount, split.rightAABB, depth + 1);
+                    }, &rightCounter);
 
+                leftPtr = BuildNode(output, leftRefs, leftCount, split.leftAABB, depth + 1);
+                JobSystem::Wait(rightCounter);
+                rightPtr = Append(output, rightOutput, rightSubtreePtr);
             }
             else {
-                if (leftRefs.size()) {
-                    leftChild = new BVHBuilder(split.leftAABB, depth + 1, leftRefs.size(), binCount);
-                    leftChild->Build(leftRefs);
-                }
-
-                if (rightRefs.size()) {
-                    rightChild = new BVHBuilder(split.rightAABB, depth + 1, rightRefs.size(), binCount);
-                    rightChild->Build(rightRefs);
-                }
+                leftPtr = BuildNode(output, leftRefs, leftCount, split.leftAABB, depth + 1);
+                rightPtr = BuildNode(output, rightRefs, rightCount, split.rightAABB, depth + 1);
             }
 
+            output.nodes[nodeIdx].leftPtr = leftPtr;
+            output.nodes[nodeIdx].rightPtr = rightPtr;
+
+            return int32_t(nodeIdx);
+
         }
 
-        void BVHBuilder::Flatten(std::vector<BVHNode>& nodes, std::vector<Ref>& refs) {
+        int32_t BVHBuilder::CreateLeaf(Output& output, const Ref* refs, uint32_t refCount) {
 
-            // Check for leaf
-            if (this->refs.size()) {
-                for (auto& ref : this->refs) {
-                    ref.nodeIdx = uint32_t(nodes.size() - 1);
-                }
-                refs.insert(refs.end(), this->refs.begin(), this->refs.end());
-                refs[refs.size() - 1].endOfNode = true;
+            const auto refIdx = int32_t(output.refs.size());
+
+            output.refs.insert(output.refs.end(), refs, refs + refCount);
+            output.refs.back().endOfNode = true;
+
+            output.stats.leafCount++;
+            output.stats.minTriangles = std::min(refCount, output.stats.minTriangles);
+            output.stats.maxTriangles = std::max(refCount, output.stats.maxTriangles);
+
+            return ~refIdx;
+
+        }
+
+        int32_t BVHBuilder::Append(Output& output, Output& subtree, int32_t subtreePtr) {
+
+            const auto nodeOffset = int32_t(output.nodes.size());
+            const auto refOffset = int32_t(output.refs.size());
+
+            auto relocate = [&](int32_t ptr) {
+                return ptr < 0 ? ~(~ptr + refOffset) : ptr + nodeOffset;
+            };
+
+            output.nodes.reserve(output.nodes.size() + subtree.nodes.size());
+            for (auto node : subtree.nodes) {
+                node.leftPtr = relocate(node.leftPtr);
+                node.rightPtr = relocate(node.rightPtr);
+                output.nodes.push_back(node);
+            }
+
+            output.refs.insert(output.refs.end(), subtree.refs.begin(), subtree.refs.end());
+            output.stats.Merge(subtree.stats);
+
+            return relocate(subtreePtr);
+
+        }
+
+        BVHBuilder::Split BVHBuilder::FindSplit(const Ref* refs, uint32_t refCount, const AABB& aabb, uint32_t depth, bool spatial) const {
+
+            const auto depthBinCount = GetBinCount(depth);
+
+            auto binRefs = [&](const Ref* rangeRefs, uint32_t rangeRefCount, int32_t axis, Bin* bins) {
+                if (spatial)
+                    BinSpatial(rangeRefs, rangeRefCount, aabb, depth, axis, bins);
+                else
+                    BinObjects(rangeRefs, rangeRefCount, aabb, depth, axis, bins);
+            };
+
+            auto sweepBins = [&](const Bin* bins, int32_t axis) {
+                return spatial ? SweepSpatialBins(bins, refCount, aabb, depth, axis) :
+                    SweepObjectBins(bins, refCount, aabb, depth, axis);
+            };
+
+            Split splits[3];
+
+            if (refCount >= s_ParallelBinningRefThreshold) {
+                // Every range fills its own bins for all three axes. Bins merge exactly, so the
+                // split is the same as a sequential pass would find.
+                const uint32_t rangeCount = (refCount + s_BinningGrainSize - 1) / s_BinningGrainSize;
+                std::vector<Bin> rangeBins(size_t(rangeCount) * 3 * depthBinCount);
+
+                JobSystem::ParallelFor(refCount, s_BinningGrainSize, [&](uint32_t begin, uint32_t end) {
+                    const uint32_t range = begin / s_BinningGrainSize;
+                    for (int32_t axis = 0; axis < 3; axis++)
+                        binRefs(refs + begin, end - begin, axis, &rangeBins[(size_t(range) * 3 + axis) * depthBinCount]);
+                    });
+
+                JobSystem::ParallelFor(3, 1, [&](uint32_t begin, uint32_t end) {
+                    for (uint32_t axis = begin; axis < end; axis++) {
+                        std::vector<Bin> bins(depthBinCount);
+                        for (uint32_t range = 0; range < rangeCount; range++) {
+                            const Bin* source = &rangeBins[(size_t(range) * 3 + axis) * depthBinCount];
+                            for (uint32_t j = 0; j < depthBinCount; j++) {
+                                bins[j].aabb.Grow(source[j].aabb);
+                                bins[j].primitiveCount += source[j].primitiveCount;
+                                bins[j].enter += source[j].enter;
+                                bins[j].exit += source[j].exit;
+                            }
+                        }
+                        splits[axis] = sweepBins(bins.data(), int32_t(axis));
+                    }
+                    });
             }
             else {
-                const auto nodeIdx = nodes.size();
-                nodes.push_back(BVHNode());
-
-                // Flatten recursively
-                if (leftChild) {
-                    auto leaf = leftChild->refs.size() > 0;
-                    nodes[nodeIdx].leftAABB = leftChild->aabb;
-                    nodes[nodeIdx].leftPtr = leaf ? ~int32_t(refs.size()) : uint32_t(nodes.size());
-                    leftChild->Flatten(nodes, refs);
-                }
-                if (rightChild) {
-                    auto leaf = rightChild->refs.size() > 0;
-                    nodes[nodeIdx].rightAABB = rightChild->aabb;
-                    nodes[nodeIdx].rightPtr = leaf ? ~int32_t(refs.size()) : uint32_t(nodes.size());
-                    rightChild->Flatten(nodes, refs);
+                std::vector<Bin> bins(depthBinCount);
+                for (int32_t axis = 0; axis < 3; axis++) {
+                    std::fill(bins.begin(), bins.end(), Bin());
+                    binRefs(refs, refCount, axis, bins.data());
+                    splits[axis] = sweepBins(bins.data(), axis);
                 }
             }
 
+            // Ties go to the lower axis, like a sequential sweep over the axes
+            auto split = splits[0];
+            for (int32_t i = 1; i < 3; i++)
+                if (splits[i].cost < split.cost) split = splits[i];
+
+            return split;
+
         }
 
+        uint32_t BVHBuilder::GetBinCount(uint32_t depth) const {
 
-        BVHBuilder::Split BVHBuilder::FindObjectSplit(std::vector<Ref>& refs) {
+            return std::max(binCount / (depth + 1), 16u);
 
-            Split split;
-            const auto depthBinCount = std::max(binCount / (depth + 1), 16u);
+        }
 
-            std::vector<Bin> bins(depthBinCount);
-            std::vector<AABB> rightAABBs(bins.size());
+        void BVHBuilder::BinObjects(const Ref* refs, uint32_t refCount, const AABB& aabb, uint32_t depth, int32_t axis, Bin* bins) const {
 
-            // Iterate over 3 axises
-            for (int32_t i = 0; i < 3; i++) {
+            const auto depthBinCount = GetBinCount(depth);
 
-                for (auto& bin : bins) {
-                    bin.aabb = InitialAABB();
-                    bin.primitiveCount = 0;
-                }
+            auto start = aabb.Min[axis];
+            auto stop = aabb.Max[axis];
 
-                for (auto& aabb : rightAABBs) {
-                    aabb = InitialAABB();
-                }
+            // If the dimension of this axis is to small continue
+            if (fabsf(stop - start) < 1e-3f)
+                return;
 
-                auto start = aabb.Min[i];
-                auto stop = aabb.Max[i];
+            auto binSize = (stop - start) / float(depthBinCount);
+            auto invBinSize = 1.0f / binSize;
 
-                // If the dimension of this axis is to small continue
-                if (fabsf(stop - start) < 1e-3f)
-                    continue;
+            for (uint32_t i = 0; i < refCount; i++) {
+                const auto& ref = refs[i];
+                const auto value = 0.5f * (ref.aabb.Min[axis] + ref.aabb.Max[axis]);
 
-                auto binSize = (stop - start) / float(depthBinCount);
-                auto invBinSize = 1.0f / binSize;
+                auto binIdx = uint32_t(glm::clamp((value - start) * invBinSize,
+                    0.0f, float(depthBinCount) - 1.0f));
 
-                for (const auto& ref : refs) {
-                    const auto value = 0.5f * (ref.aabb.Min[i] + ref.aabb.Max[i]);
+                bins[binIdx].primitiveCount++;
+                bins[binIdx].aabb.Grow(ref.aabb);
+            }
 
-                    auto binIdx = uint32_t(glm::clamp((value - start) * invBinSize,
-                        0.0f, float(depthBinCount) - 1.0f));
+        }
 
-                    bins[binIdx].primitiveCount++;
-                    bins[binIdx].aabb.Grow(ref.aabb);
-                }
+        BVHBuilder::Split BVHBuilder::SweepObjectBins(const Bin* bins, uint32_t refCount, const AABB& aabb, uint32_t depth, int32_t axis) const {
 
-                // Sweep from right to left
-                AABB rightAABB = InitialAABB();
-                for (size_t j = bins.size() - 1; j > 0; j--) {
-                    rightAABB.Grow(bins[j].aabb);
-                    rightAABBs[j - 1] = rightAABB;
-                }
+            Split split;
+            const auto depthBinCount = GetBinCount(depth);
 
-                AABB leftAABB = InitialAABB();
-                uint32_t primitivesLeft = 0;
+            auto start = aabb.Min[axis];
+            auto stop = aabb.Max[axis];
 
-                // Sweep from left to right and attempt to
-                // find cost improvement
-                for (size_t j = 1; j < bins.size(); j++) {
-                    leftAABB.Grow(bins[j - 1].aabb);
-                    primitivesLeft += bins[j - 1].primitiveCount;
+            if (fabsf(stop - start) < 1e-3f)
+                return split;
 
-                    const auto rightAABB = rightAABBs[j - 1];
-                    const auto primitivesRight = uint32_t(refs.size()) - primitivesLeft;
+            std::vector<AABB> rightAABBs(depthBinCount, InitialAABB());
+            auto binSize = (stop - start) / float(depthBinCount);
 
-                    if (!primitivesLeft || !primitivesRight) continue;
+            // Sweep from right to left
+            AABB rightAABB = InitialAABB();
+            for (size_t j = depthBinCount - 1; j > 0; j--) {
+                rightAABB.Grow(bins[j].aabb);
+                rightAABBs[j - 1] = rightAABB;
+            }
 
-                    const auto leftSurface = leftAABB.GetSurfaceArea();
-                    const auto rightSurface = rightAABB.GetSurfaceArea();
+            AABB leftAABB = InitialAABB();
+            uint32_t primitivesLeft = 0;
 
-                    // Calculate cost for current split
-                    const auto cost = leftSurface * float(primitivesLeft) +
-                        rightSurface * float(primitivesRight);
+            // Sweep from left to right and attempt to
+            // find cost improvement
+            for (size_t j = 1; j < depthBinCount; j++) {
+                leftAABB.Grow(bins[j - 1].aabb);
+                primitivesLeft += bins[j - 1].primitiveCount;
 
-                    // Check if cost has improved
-                    if (cost < split.cost) {
-                        split.cost = cost;
-                        split.axis = i;
-                        split.binIdx = uint32_t(j);
-                        split.pos = start + float(j) * binSize;
+                const auto rightAABB = rightAABBs[j - 1];
+                const auto primitivesRight = refCount - primitivesLeft;
 
-                        split.leftAABB = leftAABB;
-                        split.rightAABB = rightAABB;
-                    }
-                }
+                if (!primitivesLeft || !primitivesRight) continue;
+
+                const auto leftSurface = leftAABB.GetSurfaceArea();
+                const auto rightSurface = rightAABB.GetSurfaceArea();
+
+                // Calculate cost for current split
+                const auto cost = leftSurface * float(primitivesLeft) +
+                    rightSurface * float(primitivesRight);
 
+                // Check if cost has improved
+                if (cost < split.cost) {
+                    split.cost = cost;
+                    split.axis = axis;
+                    split.binIdx = uint32_t(j);
+                    split.pos = start + float(j) * binSize;
+
+                    split.leftAABB = leftAABB;
+                    split.rightAABB = rightAABB;
+                }
             }
 
             return split;
 
         }
 
-        void BVHBuilder::PerformObjectSplit(std::vector<Ref>& refs, std::vector<Ref>& rightRefs,
-            std::vector<Ref>& leftRefs, Split& split) {
+        uint32_t BVHBuilder::PerformObjectSplit(Ref* refs, uint32_t refCount, const AABB& aabb, uint32_t depth, const Split& split) const {
 
-            const auto depthBinCount = std::max(binCount / (depth + 1), 16u);
+            const auto depthBinCount = GetBinCount(depth);
 
             auto start = aabb.Min[split.axis];
             auto stop = aabb.Max[split.axis];
@@ -552,138 +1011,132 @@ namespace X2 {
             auto binSize = (stop - start) / float(depthBinCount);
             auto invBinSize = 1.0f / binSize;
 
-            for (const auto& ref : refs) {
+            auto middle = std::partition(refs, refs + refCount, [&](const Ref& ref) {
                 const auto value = 0.5f * (ref.aabb.Min[split.axis]
                     + ref.aabb.Max[split.axis]);
 
                 auto binIdx = uint32_t(glm::clamp((value - start) * invBinSize,
                     0.0f, float(depthBinCount) - 1.0f));
 
-                if (binIdx < split.binIdx) {
-                    leftRefs.push_back(ref);
-                }
-                else {
-                    rightRefs.push_back(ref);
-                }
-            }
+                return binIdx < split.binIdx;
+                });
+
+            return uint32_t(middle - refs);
 
         }
 
-        BVHBuilder::Split BVHBuilder::FindSpatialSplit(std::vector<Ref>& refs, const std::vector<BVHTriangle>& data) {
+        void BVHBuilder::BinSpatial(const Ref* refs, uint32_t refCount, const AABB& aabb, uint32_t depth, int32_t axis, Bin* bins) const {
 
-            Split split;
-            const auto depthBinCount = std::max(binCount / (depth + 1), 16u);
+            const auto depthBinCount = GetBinCount(depth);
 
-            std::vector<Bin> bins(depthBinCount);
-            std::vector<AABB> rightAABBs(bins.size());
+            auto start = aabb.Min[axis];
+            auto stop = aabb.Max[axis];
+
+            // If the dimension of this axis is to small continue
+            if (fabsf(stop - start) < 1e-3f)
+                return;
 
-            // Iterate over 3 axises
-            for (int32_t i = 0; i < 3; i++) {
+            auto binSize = (stop - start) / float(depthBinCount);
+            auto invBinSize = 1.0f / binSize;
+
+            for (uint32_t i = 0; i < refCount; i++) {
+                const auto& ref = refs[i];
+                const auto startBinIdx = uint32_t(glm::clamp((ref.aabb.Min[axis] - start) * invBinSize,
+                    0.0f, float(depthBinCount) - 1.0f));
+                const auto endBinIdx = uint32_t(glm::clamp((ref.aabb.Max[axis] - start) * invBinSize,
+                    0.0f, float(depthBinCount) - 1.0f));
 
-                for (auto& bin : bins) {
-                    bin.aabb = InitialAABB();
-                    bin.enter = 0;
-                    bin.exit = 0;
+                // If the reference only is in a single bin
+                if (startBinIdx == endBinIdx) {
+                    bins[startBinIdx].enter++;
+                    bins[startBinIdx].exit++;
+                    bins[startBinIdx].aabb.Grow(ref.aabb);
+                    continue;
                 }
 
-                for (auto& aabb : rightAABBs) {
-                    aabb = InitialAABB();
+                Ref currentRef = ref;
+                // Split the reference across multiple bins
+                for (uint32_t j = startBinIdx; j < endBinIdx; j++) {
+                    Ref leftRef, rightRef;
+                    const auto planePos = start + float(j + 1) * binSize;
+                    SplitReference((*data)[ref.idx], currentRef,
+                        leftRef, rightRef, planePos, axis);
+                    bins[j].aabb.Grow(leftRef.aabb);
+                    currentRef = rightRef;
                 }
 
-                auto start = aabb.Min[i];
-                auto stop = aabb.Max[i];
+                // Grow last right bin which isn't covered by the loop
+                bins[endBinIdx].aabb.Grow(currentRef.aabb);
+                bins[startBinIdx].enter++;
+                bins[endBinIdx].exit++;
+            }
 
-                // If the dimension of this axis is to small continue
-                if (fabsf(stop - start) < 1e-3f)
-                    continue;
+        }
 
-                auto binSize = (stop - start) / float(depthBinCount);
-                auto invBinSize = 1.0f / binSize;
-
-                for (const auto& ref : refs) {
-                    const auto startBinIdx = uint32_t(glm::clamp((ref.aabb.Min[i] - start) * invBinSize,
-                        0.0f, float(depthBinCount) - 1.0f));
-                    const auto endBinIdx = uint32_t(glm::clamp((ref.aabb.Max[i] - start) * invBinSize,
-                        0.0f, float(depthBinCount) - 1.0f));
-
-                    // If the reference only is in a single bin
-                    if (startBinIdx == endBinIdx) {
-                        bins[startBinIdx].enter++;
-                        bins[startBinIdx].exit++;
-                        bins[startBinIdx].aabb.Grow(ref.aabb);
-                        continue;
-                    }
+        BVHBuilder::Split BVHBuilder::SweepSpatialBins(const Bin* bins, uint32_t refCount, const AABB& aabb, uint32_t depth, int32_t axis) const {
 
-                    Ref currentRef = ref;
-                    // Split the reference across multiple bins
-                    for (uint32_t j = startBinIdx; j < endBinIdx; j++) {
-                        Ref leftRef, rightRef;
-                        const auto planePos = start + float(j + 1) * binSize;
-                        const auto triangle = data[ref.idx];
-                        SplitReference(triangle, currentRef,
-                            leftRef, rightRef, planePos, i);
-                        bins[j].aabb.Grow(leftRef.aabb);
-                        currentRef = rightRef;
-                    }
+            Split split;
+            const auto depthBinCount = GetBinCount(depth);
 
-                    // Grow last right bin which isn't covered by the loop
-                    bins[endBinIdx].aabb.Grow(currentRef.aabb);
-                    bins[startBinIdx].enter++;
-                    bins[endBinIdx].exit++;
-                }
+            auto start = aabb.Min[axis];
+            auto stop = aabb.Max[axis];
 
-                // Sweep from right to left
-                AABB rightAABB = InitialAABB();
-                for (size_t j = bins.size() - 1; j > 0; j--) {
-                    rightAABB.Grow(bins[j].aabb);
-                    rightAABBs[j - 1] = rightAABB;
-                }
+            if (fabsf(stop - start) < 1e-3f)
+                return split;
 
-                AABB leftAABB = InitialAABB();
-                uint32_t primitivesRight = uint32_t(refs.size());
-                uint32_t primitivesLeft = 0;
+            std::vector<AABB> rightAABBs(depthBinCount, InitialAABB());
+            auto binSize = (stop - start) / float(depthBinCount);
 
-                // Sweep from left to right and attempt to
-                // find cost improvement
-                for (size_t j = 1; j < bins.size(); j++) {
-                    leftAABB.Grow(bins[j - 1].aabb);
+            // Sweep from right to left
+            AABB rightAABB = InitialAABB();
+            for (size_t j = depthBinCount - 1; j > 0; j--) {
+                rightAABB.Grow(bins[j].aabb);
+                rightAABBs[j - 1] = rightAABB;
+            }
 
-                    primitivesLeft += bins[j - 1].enter;
-                    primitivesRight -= bins[j - 1].exit;
+            AABB leftAABB = InitialAABB();
+            uint32_t primitivesRight = refCount;
+            uint32_t primitivesLeft = 0;
 
-                    const auto rightAABB = rightAABBs[j - 1];
+            // Sweep from left to right and attempt to
+            // find cost improvement
+            for (size_t j = 1; j < depthBinCount; j++) {
+                leftAABB.Grow(bins[j - 1].aabb);
 
-                    if (!primitivesLeft || !primitivesRight) continue;
+                primitivesLeft += bins[j - 1].enter;
+                primitivesRight -= bins[j - 1].exit;
 
-                    const auto leftSurface = leftAABB.GetSurfaceArea();
-                    const auto rightSurface = rightAABB.GetSurfaceArea();
+                const auto rightAABB = rightAABBs[j - 1];
 
-                    // Calculate cost for current split
-                    const auto cost = leftSurface * float(primitivesLeft) +
-                        rightSurface * float(primitivesRight);
+                if (!primitivesLeft || !primitivesRight) continue;
 
-                    // Check if cost has improved
-                    if (cost < split.cost) {
-                        split.cost = cost;
-                        split.axis = i;
-                        split.binIdx = uint32_t(j);
-                        split.pos = start + float(j) * binSize;
+                const auto leftSurface = leftAABB.GetSurfaceArea();
+                const auto rightSurface = rightAABB.GetSurfaceArea();
 
-                        split.leftAABB = leftAABB;
-                        split.rightAABB = rightAABB;
-                    }
-                }
+                // Calculate cost for current split
+                const auto cost = leftSurface * float(primitivesLeft) +
+                    rightSurface * float(primitivesRight);
 
+                // Check if cost has improved
+                if (cost < split.cost) {
+                    split.cost = cost;
+                    split.axis = axis;
+                    split.binIdx = uint32_t(j);
+                    split.pos = start + float(j) * binSize;
+
+                    split.leftAABB = leftAABB;
+                    split.rightAABB = rightAABB;
+                }
             }
 
             return split;
 
         }
 
-        void BVHBuilder::PerformSpatialSplit(std::vector<Ref>& refs, const std::vector<BVHTriangle>& data,
-            std::vector<Ref>& rightRefs, std::vector<Ref>& leftRefs, Split& split) {
+        uint32_t BVHBuilder::PerformSpatialSplit(const Ref* refs, uint32_t refCount, const AABB& aabb, uint32_t depth,
+            std::vector<Ref>& splitRefs, Split& split) const {
 
-            const auto depthBinCount = std::max(binCount / (depth + 1), 16u);
+            const auto depthBinCount = GetBinCount(depth);
 
             auto start = aabb.Min[split.axis];
             auto stop = aabb.Max[split.axis];
@@ -691,17 +1144,25 @@ namespace X2 {
             auto binSize = (stop - start) / float(depthBinCount);
             auto invBinSize = 1.0f / binSize;
 
-            for (const auto& ref : refs) {
+            // Left references go to the front of splitRefs, right ones are appended at the end
+            std::vector<Ref> rightRefs;
+            splitRefs.reserve(refCount + refCount / 4);
+            rightRefs.reserve(refCount / 2);
+
+            auto getBins = [&](const Ref& ref) {
                 const auto min = ref.aabb.Min[split.axis];
                 const auto max = ref.aabb.Max[split.axis];
 
-                const auto startBinIdx = uint32_t(glm::clamp((min - start) * invBinSize,
-                    0.0f, float(depthBinCount) - 1.0f));
-                const auto endBinIdx = uint32_t(glm::clamp((max - start) * invBinSize,
-                    0.0f, float(depthBinCount) - 1.0f));
+                return std::pair(uint32_t(glm::clamp((min - start) * invBinSize, 0.0f, float(depthBinCount) - 1.0f)),
+                    uint32_t(glm::clamp((max - start) * invBinSize, 0.0f, float(depthBinCount) - 1.0f)));
+            };
+
+            for (uint32_t i = 0; i < refCount; i++) {
+                const auto& ref = refs[i];
+                const auto [startBinIdx, endBinIdx] = getBins(ref);
 
                 if (endBinIdx < split.binIdx) {
-                    leftRefs.push_back(ref);
+                    splitRefs.push_back(ref);
                     split.leftAABB.Grow(ref.aabb);
                 }
                 else if (startBinIdx >= split.binIdx) {
@@ -710,18 +1171,13 @@ namespace X2 {
                 }
             }
 
-            for (const auto& ref : refs) {
-                const auto min = ref.aabb.Min[split.axis];
-                const auto max = ref.aabb.Max[split.axis];
-
-                const auto startBinIdx = uint32_t(glm::clamp((min - start) * invBinSize,
-                    0.0f, float(depthBinCount) - 1.0f));
-                const auto endBinIdx = uint32_t(glm::clamp((max - start) * invBinSize,
-                    0.0f, float(depthBinCount) - 1.0f));
+            for (uint32_t i = 0; i < refCount; i++) {
+                const auto& ref = refs[i];
+                const auto [startBinIdx, endBinIdx] = getBins(ref);
 
                 if (endBinIdx >= split.binIdx && startBinIdx < split.binIdx) {
                     Ref leftRef, rightRef;
-                    SplitReference(data[ref.idx], ref, leftRef,
+                    SplitReference((*data)[ref.idx], ref, leftRef,
                         rightRef, split.pos, split.axis);
 
                     auto unsplitLeft = split.leftAABB;
@@ -735,10 +1191,10 @@ namespace X2 {
                     duplicateRight.Grow(rightRef.aabb);
 
                     // Original triangle cost
-                    auto leftRefCost = float(leftRefs.size());
+                    auto leftRefCost = float(splitRefs.size());
                     auto rightRefCost = float(rightRefs.size());
                     // Triangle cost with added reference to either right or left side
-                    auto leftModRefCost = float(leftRefs.size() + 1);
+                    auto leftModRefCost = float(splitRefs.size() + 1);
                     auto rightModRefCost = float(rightRefs.size() + 1);
 
                     auto unsplitLeftSAH = unsplitLeft.GetSurfaceArea() * leftModRefCost +
@@ -752,7 +1208,7 @@ namespace X2 {
 
                     if (minSAH == unsplitLeftSAH) {
                         split.leftAABB = unsplitLeft;
-                        leftRefs.push_back(ref);
+                        splitRefs.push_back(ref);
                     }
                     else if (minSAH == unsplitRightSAH) {
                         split.rightAABB = unsplitRight;
@@ -763,12 +1219,17 @@ namespace X2 {
                         rightRef.idx = ref.idx;
                         split.leftAABB = duplicateLeft;
                         split.rightAABB = duplicateRight;
-                        leftRefs.push_back(leftRef);
+                        splitRefs.push_back(leftRef);
                         rightRefs.push_back(rightRef);
                     }
                 }
             }
 
+            const auto leftCount = uint32_t(splitRefs.size());
+            splitRefs.insert(splitRefs.end(), rightRefs.begin(), rightRefs.end());
+
+            return leftCount;
+
         }
 
         void BVHBuilder::SplitReference(const BVHTriangle triangle, Ref currentRef,
@@ -811,48 +1272,31 @@ namespace X2 {
 
         }
 
-        BVHBuilder::Split BVHBuilder::PerformMedianSplit(std::vector<Ref>& refs,
-            std::vector<Ref>& rightRefs, std::vector<Ref>& leftRefs) {
+        BVHBuilder::Split BVHBuilder::PerformMedianSplit(Ref* refs, uint32_t refCount, const AABB& aabb) const {
 
             Split split;
 
             auto dimensions = aabb.Max - aabb.Min;
             auto axis = dimensions.x > dimensions.y ? dimensions.x > dimensions.z ? 0 : 2 :
                 dimensions.y > dimensions.z ? 1 : 2;
-            std::sort(refs.begin(), refs.end(), [&](const Ref& ref0, const Ref& ref1) {
-                auto center0 = ref0.aabb.Max[axis] - ref0.aabb.Min[axis];
-                auto center1 = ref1.aabb.Max[axis] - ref1.aabb.Min[axis];
+
+            auto splitIdx = refCount / 2;
+            std::nth_element(refs, refs + splitIdx, refs + refCount, [&](const Ref& ref0, const Ref& ref1) {
+                auto center0 = ref0.aabb.Max[axis] + ref0.aabb.Min[axis];
+                auto center1 = ref1.aabb.Max[axis] + ref1.aabb.Min[axis];
                 return center0 < center1;
                 });
 
-            auto splitIdx = uint32_t(refs.size() / 2);
-
-            for (uint32_t i = 0; i < splitIdx; i++) {
-                const auto& ref = refs[i];
-                split.leftAABB.Grow(ref.aabb);
-                leftRefs.push_back(ref);
-            }
+            for (uint32_t i = 0; i < splitIdx; i++)
+                split.leftAABB.Grow(refs[i].aabb);
 
-            for (uint32_t i = splitIdx; i < uint32_t(refs.size()); i++) {
-                const auto& ref = refs[i];
-                split.rightAABB.Grow(ref.aabb);
-                rightRefs.push_back(ref);
-            }
+            for (uint32_t i = splitIdx; i < refCount; i++)
+                split.rightAABB.Grow(refs[i].aabb);
 
             return split;
 
         }
 
-        void BVHBuilder::CreateLeaf(std::vector<Ref>& refs) {
-
-            this->refs = refs;
-
-            maxDepth = std::max(depth, maxDepth);
-            minTriangles = std::min(uint32_t(refs.size()), minTriangles);
-            maxTriangles = std::max(uint32_t(refs.size()), maxTriangles);
-
-        }
-
         AABB BVHBuilder::InitialAABB() {
 
             const auto min = glm::vec3(std::numeric_limits<float>::max());
@@ -863,4 +1307,4 @@ namespace X2 {
 
     }
 
-}
\ No newline at end of file
+}
@@ -6,6 +6,7 @@
 
 #include <vector>
 #include <algorithm>
+#include <limits>
 
 namespace X2 {
 
@@ -32,46 +33,55 @@ namespace X2 {
             bool endOfNode = false;
         };
 
+        /**
+         * Statistics of a single BVH build.
+         */
+        struct BVHBuildStats {
+
+            uint32_t nodeCount = 0;
+            uint32_t leafCount = 0;
+            uint32_t refCount = 0; // Spatial splits reference triangles more than once
+            uint32_t maxDepth = 0;
+            uint32_t minTriangles = std::numeric_limits<uint32_t>::max(); // Per leaf
+            uint32_t maxTriangles = 0;
+            uint32_t spatialSplitCount = 0;
+            float totalSurfaceArea = 0.0f;
+            float buildTime = 0.0f; // In milliseconds
+
+            void Merge(const BVHBuildStats& stats);
+
+        };
+
+        /**
+         * Binned SAH builder with spatial splits. References are partitioned in place, only spatial
+         * splits need new storage. Large subtrees are built as parallel tasks, each writes its own
+         * flat nodes and references which are appended to the parent's once the task is done.
+         */
         class BVHBuilder {
 
         public:
             struct Ref {
                 uint32_t idx = 0;
-                uint32_t nodeIdx = 0;
                 bool endOfNode = false;
                 AABB aabb = InitialAABB();
             };
 
-            BVHBuilder(const AABB aabb, uint32_t depth, size_t refCount,
-                const float minOverlap, const uint32_t binCount);
-
-            BVHBuilder(const AABB aabb, uint32_t depth, size_t refCount, const uint32_t binCount);
-
-            ~BVHBuilder();
-
-            void Build(std::vector<Ref>& refs, const std::vector<BVHTriangle>& data);
-
-            void Build(std::vector<Ref>& refs);
-
-            void Flatten(std::vector<BVHNode>& nodes, std::vector<Ref>& refs);
-
-            BVHBuilder* leftChild = nullptr;
-            BVHBuilder* rightChild = nullptr;
-
-            uint32_t depth;
-            uint32_t binCount;
-
-            float minOverlap;
-            float nodeCost;
-
-            AABB aabb;
-            std::vector<Ref> refs;
-
-            static uint32_t maxDepth;
-            static uint32_t minTriangles;
-            static uint32_t maxTriangles;
-            static uint32_t spatialSplitCount;
-            static float totalSurfaceArea;
+            /**
+             * Constructs a BVHBuilder object.
+             * @param data The triangles, enables spatial splits. Without them the builder only works on AABBs
+             * and subdivides until every leaf holds a single reference.
+             * @param minOverlap Child overlap from which spatial splits are considered.
+             * @param binCount Bins used at the root, deeper nodes use fewer.
+             */
+            BVHBuilder(const std::vector<BVHTriangle>* data, const float minOverlap, const uint32_t binCount);
+
+            /**
+             * Builds the tree over refs, which is reordered in the process.
+             * @param nodes Receives the flattened nodes, empty if the root is a leaf.
+             * @param leafRefs Receives the references in leaf order, the last one of each leaf is marked with endOfNode.
+             */
+            BVHBuildStats Build(std::vector<Ref>& refs, const AABB& aabb, std::vector<BVHNode>& nodes,
+                std::vector<Ref>& leafRefs);
 
         private:
             struct Bin {
@@ -93,25 +103,48 @@ namespace X2 {
                 AABB rightAABB = InitialAABB();
             };
 
-            Split FindObjectSplit(std::vector<Ref>& refs);
+            // Flat subtree, pointers are relative to its own nodes and refs
+            struct Output {
+                std::vector<BVHNode> nodes;
+                std::vector<Ref> refs;
+                BVHBuildStats stats;
+            };
+
+            int32_t BuildNode(Output& output, Ref* refs, uint32_t refCount, const AABB& aabb, uint32_t depth);
+
+            int32_t CreateLeaf(Output& output, const Ref* refs, uint32_t refCount);
+
+            int32_t Append(Output& output, Output& subtree, int32_t subtreePtr);
+
+            Split FindSplit(const Ref* refs, uint32_t refCount, const AABB& aabb, uint32_t depth, bool spatial) const;
+
+            void BinObjects(const Ref* refs, uint32_t refCount, const AABB& aabb, uint32_t depth, int32_t axis, Bin* bins) const;
 
-            void PerformObjectSplit(std::vector<Ref>& refs, std::vector<Ref>& rightRefs,
-                std::vector<Ref>& leftRefs, Split& split);
+            Split SweepObjectBins(const Bin* bins, uint32_t refCount, const AABB& aabb, uint32_t depth, int32_t axis) const;
 
-            Split FindSpatialSplit(std::vector<Ref>& refs, const std::vector<BVHTriangle>& data);
+            uint32_t PerformObjectSplit(Ref* refs, uint32_t refCount, const AABB& aabb, uint32_t depth, const Split& split) const;
 
-            void PerformSpatialSplit(std::vector<Ref>& refs, const std::vector<BVHTriangle>& data,
-                std::vector<Ref>& rightRefs, std::vector<Ref>& leftRefs, Split& split);
+            void BinSpatial(const Ref* refs, uint32_t refCount, const AABB& aabb, uint32_t depth, int32_t axis, Bin* bins) const;
 
-            void SplitReference(const BVHTriangle triangle, Ref currentRef,
+            Split SweepSpatialBins(const Bin* bins, uint32_t refCount, const AABB& aabb, uint32_t depth, int32_t axis) const;
+
+            uint32_t PerformSpatialSplit(const Ref* refs, uint32_t refCount, const AABB& aabb, uint32_t depth,
+                std::vector<Ref>& splitRefs, Split& split) const;
+
+            static void SplitReference(const BVHTriangle triangle, Ref currentRef,
                 Ref& leftRef, Ref& rightRef, const float planePos, const int32_t axis);
 
-            Split PerformMedianSplit(std::vector<Ref>& refs, std::vector<Ref>& rightRefs, std::vector<Ref>& leftRefs);
+            Split PerformMedianSplit(Ref* refs, uint32_t refCount, const AABB& aabb) const;
 
-            void CreateLeaf(std::vector<Ref>& refs);
+            uint32_t GetBinCount(uint32_t depth) const;
 
             static AABB InitialAABB();
 
+            const std::vector<BVHTriangle>* data;
+
+            float minOverlap;
+            uint32_t binCount;
+
         };
 
 
@@ -125,12 +158,12 @@ namespace X2 {
             BVH(std::vector<AABB>& aabbs);
 
             bool GetIntersection(std::vector<std::pair<int32_t, float>>& stack, Ray ray, BVHTriangle& closest,
-                glm::vec3& intersection);
+                glm::vec3& intersection) const;
 
             bool GetIntersection(std::vector<std::pair<int32_t, float>>& stack, Ray ray, BVHTriangle& closest,
-                glm::vec3& intersection, float max);
+                glm::vec3& intersection, float max) const;
 
-            bool GetIntersectionAny(std::vector<std::pair<int32_t, float>>& stack, Ray ray, float max);
+            bool GetIntersectionAny(std::vector<std::pair<int32_t, float>>& stack, Ray ray, float max) const;
 
             std::vector<BVHNode>& GetTree();
 
@@ -142,6 +175,81 @@ namespace X2 {
 
             std::vector<BVHNode> nodes;
 
+            BVHBuildStats stats;
+
+        };
+
+        /**
+         * Node of a BVH4. The bounds of the four children are stored per axis and quantized
+         * to 8 bits relative to the node, so a ray is tested against all of them at once.
+         */
+        struct alignas(16) BVH4Node {
+
+            glm::vec3 origin = glm::vec3(0.0f); // Minimum of the node bounds
+            glm::vec3 scale = glm::vec3(0.0f); // Size of one quantization step
+
+            uint8_t min[3][4] = {}; // Child bounds per axis, rounded outwards
+            uint8_t max[3][4] = {};
+
+            // Inner node if >= 0, ~first triangle of a leaf if < 0, unused slots are emptyChild.
+            // Used slots always come first.
+            int32_t children[4];
+
+        };
+
+        static_assert(sizeof(BVH4Node) == 64, "BVH4Node should fill one cache line");
+
+        /**
+         * 4-wide BVH collapsed from a binary BVH. Traversal decodes a node once and slab tests
+         * its children with SSE, and coherent rays can be traced as a packet sharing one traversal.
+         * Triangles keep the order and leaf layout of the binary BVH.
+         */
+        class BVH4 {
+
+        public:
+            static constexpr int32_t emptyChild = std::numeric_limits<int32_t>::min();
+            static constexpr uint32_t maxPacketSize = 16;
+
+            struct PacketStackEntry {
+                int32_t ptr;
+                uint32_t rayMask; // Rays that hit the node
+                float distance; // Nearest entry distance of these rays
+            };
+
+            BVH4() = default;
+
+            /**
+             * Collapses a binary BVH that was built with triangle data.
+             */
+            explicit BVH4(const BVH& bvh);
+
+            bool GetIntersection(std::vector<std::pair<int32_t, float>>& stack, Ray ray, BVHTriangle& closest,
+                glm::vec3& intersection, float max = std::numeric_limits<float>::max()) const;
+
+            bool GetIntersectionAny(std::vector<std::pair<int32_t, float>>& stack, Ray ray, float max) const;
+
+            /**
+             * Traces up to maxPacketSize rays together. Works best for rays with a similar origin and direction.
+             * @return A mask of the rays that hit, closest and intersections are only written for those.
+             */
+            uint32_t GetIntersections(std::vector<PacketStackEntry>& stack, const Ray* rays, uint32_t rayCount,
+                BVHTriangle* closest, glm::vec3* intersections, float max = std::numeric_limits<float>::max()) const;
+
+            bool IsEmpty() const { return nodes.empty(); }
+
+            void Clear();
+
+            std::vector<BVH4Node> nodes;
+            std::vector<BVHTriangle> data;
+
+        private:
+            struct Child {
+                int32_t ptr;
+                AABB aabb;
+            };
+
+            int32_t Collapse(const BVH& bvh, const Child* children, uint32_t childCount);
+
         };
 
     }
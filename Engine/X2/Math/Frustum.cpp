@@ -1,7 +1,101 @@
 #include "Frustum.h"
 
+#include <cstring>
+
+#if defined(__AVX__)
+    #define X2_FRUSTUM_AVX 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define X2_FRUSTUM_SSE 1
+#endif
+#if defined(X2_FRUSTUM_AVX) || defined(X2_FRUSTUM_SSE)
+    #include <immintrin.h>
+#endif
+
 namespace X2 {
     namespace Volume {
+
+        namespace {
+
+            /**
+             * Tests the boxes against the planes and hands the visibility of every run of
+             * boxes to emit(firstIndex, mask, count), with bit i of mask set if box firstIndex + i
+             * is visible. Runs are 8 (AVX), 4 (SSE) or 1 box wide and never straddle a 32 bit word.
+             */
+            template<typename Fn>
+            void TestBounds(const glm::vec4 (&planes)[6], const AABBArrays& bounds, Fn&& emit) {
+
+                // Per plane, only the box corner furthest along the normal needs testing,
+                // so select its arrays once instead of per box
+                const float* px[6];
+                const float* py[6];
+                const float* pz[6];
+                for (uint8_t p = 0; p < 6; p++) {
+                    px[p] = planes[p].x >= 0.0f ? bounds.MaxX : bounds.MinX;
+                    py[p] = planes[p].y >= 0.0f ? bounds.MaxY : bounds.MinY;
+                    pz[p] = planes[p].z >= 0.0f ? bounds.MaxZ : bounds.MinZ;
+                }
+
+                size_t i = 0;
+
+#ifdef X2_FRUSTUM_AVX
+                {
+                    __m256 nx[6], ny[6], nz[6], d[6];
+                    for (uint8_t p = 0; p < 6; p++) {
+                        nx[p] = _mm256_set1_ps(planes[p].x);
+                        ny[p] = _mm256_set1_ps(planes[p].y);
+                        nz[p] = _mm256_set1_ps(planes[p].z);
+                        d[p] = _mm256_set1_ps(planes[p].w);
+                    }
+
+                    const __m256 zero = _mm256_setzero_ps();
+                    for (; i + 8 <= bounds.Count; i += 8) {
+                        __m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+                        for (uint8_t p = 0; p < 6; p++) {
+                            __m256 distance = _mm256_add_ps(d[p], _mm256_mul_ps(nx[p], _mm256_loadu_ps(px[p] + i)));
+                            distance = _mm256_add_ps(distance, _mm256_mul_ps(ny[p], _mm256_loadu_ps(py[p] + i)));
+                            distance = _mm256_add_ps(distance, _mm256_mul_ps(nz[p], _mm256_loadu_ps(pz[p] + i)));
+                            visible = _mm256_and_ps(visible, _mm256_cmp_ps(distance, zero, _CMP_GE_OQ));
+                        }
+                        emit(i, (uint32_t)_mm256_movemask_ps(visible), 8u);
+                    }
+                }
+#endif
+
+#ifdef X2_FRUSTUM_SSE
+                {
+                    __m128 nx[6], ny[6], nz[6], d[6];
+                    for (uint8_t p = 0; p < 6; p++) {
+                        nx[p] = _mm_set1_ps(planes[p].x);
+                        ny[p] = _mm_set1_ps(planes[p].y);
+                        nz[p] = _mm_set1_ps(planes[p].z);
+                        d[p] = _mm_set1_ps(planes[p].w);
+                    }
+
+                    const __m128 zero = _mm_setzero_ps();
+                    for (; i + 4 <= bounds.Count; i += 4) {
+                        __m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+                        for (uint8_t p = 0; p < 6; p++) {
+                            __m128 distance = _mm_add_ps(d[p], _mm_mul_ps(nx[p], _mm_loadu_ps(px[p] + i)));
+                            distance = _mm_add_ps(distance, _mm_mul_ps(ny[p], _mm_loadu_ps(py[p] + i)));
+                            distance = _mm_add_ps(distance, _mm_mul_ps(nz[p], _mm_loadu_ps(pz[p] + i)));
+                            visible = _mm_and_ps(visible, _mm_cmpge_ps(distance, zero));
+                        }
+                        emit(i, (uint32_t)_mm_movemask_ps(visible), 4u);
+                    }
+                }
+#endif
+
+                for (; i < bounds.Count; i++) {
+                    bool visible = true;
+                    for (uint8_t p = 0; p < 6 && visible; p++)
+                        visible = planes[p].w + planes[p].x * px[p][i] + planes[p].y * py[p][i] + planes[p].z * pz[p][i] >= 0.0f;
+                    emit(i, visible ? 1u : 0u, 1u);
+                }
+
+            }
+
+        }
         Frustum::Frustum(const std::vector<glm::vec3>& corners) {
 
             Resize(corners);
@@ -33,7 +127,36 @@ namespace X2 {
 
         }
 
-        bool Frustum::Intersects(AABB aabb) {
+        void Frustum::SetFromViewProjection(const glm::mat4& matrix, bool extrudeNear) {
+
+            // Gribb-Hartmann, a point is inside when -w <= x, y, z <= w
+            const glm::vec4 rowX = glm::vec4(matrix[0][0], matrix[1][0], matrix[2][0], matrix[3][0]);
+            const glm::vec4 rowY = glm::vec4(matrix[0][1], matrix[1][1], matrix[2][1], matrix[3][1]);
+            const glm::vec4 rowZ = glm::vec4(matrix[0][2], matrix[1][2], matrix[2][2], matrix[3][2]);
+            const glm::vec4 rowW = glm::vec4(matrix[0][3], matrix[1][3], matrix[2][3], matrix[3][3]);
+
+            const glm::vec4 equations[6] = {
+                rowW + rowZ, rowW - rowZ, rowW - rowY,
+                rowW + rowY, rowW + rowX, rowW - rowX
+            };
+
+            for (uint8_t i = 0; i < 6; i++) {
+                const float length = glm::length(glm::vec3(equations[i]));
+                planes[i].normal = glm::vec3(equations[i]) / length;
+                planes[i].distance = equations[i].w / length;
+            }
+
+            if (extrudeNear) {
+                // Degenerate plane every point passes
+                planes[NEAR_PLANE].normal = glm::vec3(0.0f);
+                planes[NEAR_PLANE].distance = 1.0f;
+            }
+
+            corners.clear();
+
+        }
+
+        bool Frustum::Intersects(const AABB& aabb) const {
 
             for (uint8_t i = 0; i < 6; i++) {
 
@@ -54,7 +177,7 @@ namespace X2 {
 
         }
 
-        bool Frustum::IsInside(AABB aabb) {
+        bool Frustum::IsInside(const AABB& aabb) const {
 
             for (uint8_t i = 0; i < 6; i++) {
 
@@ -75,6 +198,39 @@ namespace X2 {
 
         }
 
+        void Frustum::Intersects(const AABBArrays& bounds, uint32_t* visibilityMask) const {
+
+            glm::vec4 packedPlanes[6];
+            for (uint8_t i = 0; i < 6; i++)
+                packedPlanes[i] = glm::vec4(planes[i].normal, planes[i].distance);
+
+            std::memset(visibilityMask, 0, ((bounds.Count + 31) / 32) * sizeof(uint32_t));
+
+            TestBounds(packedPlanes, bounds, [visibilityMask](size_t first, uint32_t mask, uint32_t count) {
+                visibilityMask[first >> 5] |= mask << (first & 31);
+            });
+
+        }
+
+        uint32_t Frustum::Cull(const AABBArrays& bounds, uint32_t* visibleIndices) const {
+
+            glm::vec4 packedPlanes[6];
+            for (uint8_t i = 0; i < 6; i++)
+                packedPlanes[i] = glm::vec4(planes[i].normal, planes[i].distance);
+
+            uint32_t visibleCount = 0;
+            TestBounds(packedPlanes, bounds, [visibleIndices, &visibleCount](size_t first, uint32_t mask, uint32_t count) {
+                // Branchless compaction, always store and only advance on visible boxes
+                for (uint32_t lane = 0; lane < count; lane++) {
+                    visibleIndices[visibleCount] = (uint32_t)first + lane;
+                    visibleCount += (mask >> lane) & 1u;
+                }
+            });
+
+            return visibleCount;
+
+        }
+
         std::vector<glm::vec4> Frustum::GetPlanes() {
 
             std::vector<glm::vec4> planes;
@@ -8,6 +8,21 @@
 
 namespace X2 {
     namespace Volume {
+
+        /**
+         * Structure of arrays view over a batch of AABBs for batched culling.
+         * Every array holds Count floats, the arrays are not owned.
+         */
+        struct AABBArrays {
+            const float* MinX = nullptr;
+            const float* MinY = nullptr;
+            const float* MinZ = nullptr;
+            const float* MaxX = nullptr;
+            const float* MaxY = nullptr;
+            const float* MaxZ = nullptr;
+            size_t Count = 0;
+        };
+
         class Frustum {
 
         public:
@@ -48,19 +63,45 @@ namespace X2 {
              */
             void Resize(glm::mat4 matrix);
 
+            /**
+             * Extracts the planes directly from a view projection matrix.
+             * @param matrix The (non-reversed) view projection matrix of the frustum.
+             * @param extrudeNear Pushes the near plane to infinity, so objects between the
+             * frustum and the light (shadow casters) are kept.
+             * @note The near plane is conservative for [0, 1] depth ranges and
+             * the corners are not calculated.
+             */
+            void SetFromViewProjection(const glm::mat4& matrix, bool extrudeNear = false);
+
             /**
              * Checks if the AABB intersects the frustum
              * @param aabb An AABB to test against the frustum
              * @return True if visible, false otherwise.
              */
-            bool Intersects(AABB aabb);
+            bool Intersects(const AABB& aabb) const;
+
+            /**
+             * Checks a batch of AABBs against the frustum, using SSE/AVX when available
+             * @param bounds The AABBs to test against the frustum
+             * @param visibilityMask One bit per AABB, set if visible. Must hold (bounds.Count + 31) / 32 words.
+             */
+            void Intersects(const AABBArrays& bounds, uint32_t* visibilityMask) const;
+
+            /**
+             * Checks a batch of AABBs against the frustum and compacts the visible ones
+             * @param bounds The AABBs to test against the frustum
+             * @param visibleIndices Receives the indices of the visible AABBs in ascending order.
+             * Must hold bounds.Count entries.
+             * @return The number of visible AABBs
+             */
+            uint32_t Cull(const AABBArrays& bounds, uint32_t* visibleIndices) const;
 
             /**
              * Checks if the AABB is inside the frustum
              * @param aabb An AABB to test against the frustum
              * @return True if visible, false otherwise.
              */
-            bool IsInside(AABB aabb);
+            bool IsInside(const AABB& aabb) const;
 
             /**
              * Returns the planes of the frustum as 4-component vectors
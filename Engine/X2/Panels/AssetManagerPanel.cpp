@@ -44,7 +44,7 @@ namespace X2 {
 					}
 
 					int id = 0;
-					for (const auto& [h, metadata] : assetRegistry)
+					assetRegistry.ForEach([&](const AssetMetadata& metadata)
 					{
 						ImGui::PushID(id++);
 
@@ -80,7 +80,7 @@ namespace X2 {
 						}
 
 						ImGui::PopID();
-					}
+					});
 					UI::EndPropertyGrid();
 				}
 				ImGui::EndChild();
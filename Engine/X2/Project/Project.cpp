@@ -22,6 +22,8 @@ namespace X2 {
 	{
 		if (s_ActiveProject)
 		{
+			// Streaming workers resolve dependencies through Project::GetAssetManager, stop them while it is still set
+			s_AssetManager->StopStreaming();
 			s_AssetManager = nullptr;
 			//PhysicsSystem::Shutdown();
 			//AudioCommandRegistry::Shutdown();
@@ -47,6 +49,8 @@ namespace X2 {
 	{
 		if (s_ActiveProject)
 		{
+			// Streaming workers resolve dependencies through Project::GetAssetManager, stop them while it is still set
+			s_AssetManager->StopStreaming();
 			s_AssetManager = nullptr;
 			//PhysicsSystem::Shutdown();
 			//AudioCommandRegistry::Shutdown();
@@ -0,0 +1,385 @@
+#include "Precompiled.h"
+#include "DrawPacketList.h"
+
+#include "X2/Core/Debug/Profiler.h"
+
+namespace X2 {
+
+	namespace Utils {
+
+		static uint64_t HashCombine(uint64_t seed, uint64_t value)
+		{
+			// splitmix64 finalizer, good enough to spread asset handles over the key bits
+			uint64_t x = seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+			x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+			x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+			return x ^ (x >> 31);
+		}
+
+		static uint64_t HashCaster(uint64_t seed, const DrawSource& source)
+		{
+			uint64_t hash = HashCombine(seed, source.MeshHandle);
+			hash = HashCombine(hash, source.SubmeshIndex);
+
+			uint32_t bits[sizeof(TransformVertexData) / sizeof(uint32_t)];
+			memcpy(bits, &source.Transform, sizeof(TransformVertexData));
+			for (uint32_t i = 0; i < sizeof(TransformVertexData) / sizeof(uint32_t); i += 2)
+				hash = HashCombine(hash, ((uint64_t)bits[i] << 32) | bits[i + 1]);
+			return hash;
+		}
+
+		static uint32_t PopCount(uint32_t value)
+		{
+			value = value - ((value >> 1) & 0x55555555u);
+			value = (value & 0x33333333u) + ((value >> 2) & 0x33333333u);
+			return (((value + (value >> 4)) & 0x0f0f0f0fu) * 0x01010101u) >> 24;
+		}
+
+		static bool IsBitSet(const std::vector<uint32_t>& bits, uint32_t index)
+		{
+			return (bits[index >> 5] >> (index & 31)) & 1u;
+		}
+
+	}
+
+	// Sort key layout (MSB -> LSB)
+	//   Opaque:      pass:4 | pipeline:2 | material:16 | mesh:20 | depth:16 | unused:6
+	//   Transparent: pass:4 | pipeline:2 | ~depth:16 | material:16 | mesh:20 | unused:6
+	static constexpr uint32_t s_GroupShift = 58;
+
+	static DrawPass GetPass(const DrawPacket& packet)
+	{
+		return (DrawPass)(packet.SortKey >> 60);
+	}
+
+	void DrawPacketList::Reset()
+	{
+		m_Sources.clear();
+		m_Packets.clear();
+		m_Batches.clear();
+
+		m_BoundsMinX.clear(); m_BoundsMinY.clear(); m_BoundsMinZ.clear();
+		m_BoundsMaxX.clear(); m_BoundsMaxY.clear(); m_BoundsMaxZ.clear();
+		m_BoundedSourceCount = 0;
+		m_CulledSourceCount = 0;
+		m_TransformCount = 0;
+		m_Culled = false;
+		m_ShadowViewCount = 0;
+
+		for (auto& passRanges : m_BatchRanges)
+			for (auto& range : passRanges)
+				range = {};
+	}
+
+	DrawSource& DrawPacketList::AddSource(uint32_t& outSourceIndex)
+	{
+		outSourceIndex = (uint32_t)m_Sources.size();
+
+		// Unbounded until SetBounds(), an infinite box passes every plane
+		m_BoundsMinX.push_back(-FLT_MAX); m_BoundsMinY.push_back(-FLT_MAX); m_BoundsMinZ.push_back(-FLT_MAX);
+		m_BoundsMaxX.push_back(FLT_MAX); m_BoundsMaxY.push_back(FLT_MAX); m_BoundsMaxZ.push_back(FLT_MAX);
+
+		return m_Sources.emplace_back();
+	}
+
+	void DrawPacketList::SetBounds(uint32_t sourceIndex, const Volume::AABB& bounds)
+	{
+		m_BoundsMinX[sourceIndex] = bounds.Min.x; m_BoundsMinY[sourceIndex] = bounds.Min.y; m_BoundsMinZ[sourceIndex] = bounds.Min.z;
+		m_BoundsMaxX[sourceIndex] = bounds.Max.x; m_BoundsMaxY[sourceIndex] = bounds.Max.y; m_BoundsMaxZ[sourceIndex] = bounds.Max.z;
+		m_BoundedSourceCount++;
+	}
+
+	Volume::AABBArrays DrawPacketList::GetBounds() const
+	{
+		Volume::AABBArrays bounds;
+		bounds.MinX = m_BoundsMinX.data(); bounds.MinY = m_BoundsMinY.data(); bounds.MinZ = m_BoundsMinZ.data();
+		bounds.MaxX = m_BoundsMaxX.data(); bounds.MaxY = m_BoundsMaxY.data(); bounds.MaxZ = m_BoundsMaxZ.data();
+		bounds.Count = m_Sources.size();
+		return bounds;
+	}
+
+	uint32_t DrawPacketList::AddShadowView(const Volume::Frustum& frustum)
+	{
+		if (m_ShadowViewCount == m_ShadowViews.size())
+			m_ShadowViews.emplace_back();
+
+		ShadowView& view = m_ShadowViews[m_ShadowViewCount];
+		view.Frustum = frustum;
+		for (auto& range : view.BatchRanges)
+			range = {};
+
+		return m_ShadowViewCount++;
+	}
+
+	void DrawPacketList::Cull(const Volume::Frustum& frustum)
+	{
+		X2_PROFILE_FUNC();
+
+		const Volume::AABBArrays bounds = GetBounds();
+		const size_t wordCount = (m_Sources.size() + 31) / 32;
+
+		m_SourceVisibility.resize(wordCount);
+		frustum.Intersects(bounds, m_SourceVisibility.data());
+
+		uint32_t visibleCount = 0;
+		for (uint32_t word : m_SourceVisibility)
+			visibleCount += Utils::PopCount(word);
+
+		m_CulledSourceCount = (uint32_t)m_Sources.size() - visibleCount;
+
+		for (uint32_t i = 0; i < m_ShadowViewCount; i++)
+		{
+			ShadowView& view = m_ShadowViews[i];
+			view.Visibility.resize(wordCount);
+			view.Frustum.Intersects(bounds, view.Visibility.data());
+		}
+
+		// Count the instances that survive culling so the transform buffer is sized exactly
+		uint32_t instanceCount = 0;
+		for (const DrawPacket& packet : m_Packets)
+		{
+			const DrawPass pass = GetPass(packet);
+			if (pass == DrawPass::Shadow)
+			{
+				for (uint32_t i = 0; i < m_ShadowViewCount; i++)
+					instanceCount += Utils::IsBitSet(m_ShadowViews[i].Visibility, packet.SourceIndex);
+			}
+			else if (pass == DrawPass::Collider || IsSourceVisible(packet.SourceIndex))
+			{
+				instanceCount++;
+			}
+		}
+
+		m_TransformCount = instanceCount * 2;
+		m_Culled = true;
+	}
+
+	void DrawPacketList::AddPacket(DrawPass pass, DrawPipeline pipeline, uint32_t sourceIndex)
+	{
+		m_Packets.push_back({ BuildSortKey(pass, pipeline, m_Sources[sourceIndex]), sourceIndex });
+	}
+
+	void DrawPacketList::Build(TransformVertexData* transformData)
+	{
+		X2_PROFILE_FUNC();
+		X2_CORE_ASSERT(m_Culled, "DrawPacketList::Cull must be called before Build");
+
+		RadixSort(m_Packets, m_SortScratch);
+
+		m_Batches.clear();
+		for (auto& passRanges : m_BatchRanges)
+			for (auto& range : passRanges)
+				range = {};
+
+		uint32_t transformIndex = 0;
+		uint64_t currentGroup = UINT64_MAX;
+		for (const DrawPacket& packet : m_Packets)
+		{
+			const DrawPass pass = GetPass(packet);
+
+			// Shadow casters are batched per shadow view below
+			if (pass == DrawPass::Shadow)
+				continue;
+
+			// Camera culling only applies to the passes drawn from the camera
+			if (pass != DrawPass::Collider && !IsSourceVisible(packet.SourceIndex))
+				continue;
+
+			const uint64_t group = packet.SortKey >> s_GroupShift;
+			AppendInstance(packet, m_BatchRanges[group >> 2][group & 0x3], group != currentGroup, transformData, transformIndex);
+			currentGroup = group;
+		}
+
+		// Shadow packets sort first, every view walks them and keeps its own casters
+		for (uint32_t viewIndex = 0; viewIndex < m_ShadowViewCount; viewIndex++)
+		{
+			ShadowView& view = m_ShadowViews[viewIndex];
+			for (auto& range : view.BatchRanges)
+				range = {};
+			view.StaticCasterHash = 0;
+
+			currentGroup = UINT64_MAX;
+			for (const DrawPacket& packet : m_Packets)
+			{
+				if (GetPass(packet) != DrawPass::Shadow)
+					break;
+
+				if (!Utils::IsBitSet(view.Visibility, packet.SourceIndex))
+					continue;
+
+				const uint64_t group = packet.SortKey >> s_GroupShift;
+				AppendInstance(packet, view.BatchRanges[group & 0x3], group != currentGroup, transformData, transformIndex);
+				currentGroup = group;
+
+				if ((group & 0x3) == (uint64_t)DrawPipeline::Static)
+					view.StaticCasterHash = Utils::HashCaster(view.StaticCasterHash, m_Sources[packet.SourceIndex]);
+			}
+		}
+
+		X2_CORE_ASSERT(transformIndex == m_TransformCount);
+
+		UpdateHistory();
+	}
+
+	void DrawPacketList::AppendInstance(const DrawPacket& packet, Range& range, bool newGroup, TransformVertexData* transformData, uint32_t& transformIndex)
+	{
+		const DrawSource& source = m_Sources[packet.SourceIndex];
+
+		if (newGroup)
+			range.Begin = (uint32_t)m_Batches.size();
+
+		if (newGroup || !CanBatch(m_Sources[m_Batches.back().SourceIndex], source))
+			m_Batches.push_back({ packet.SourceIndex, transformIndex * (uint32_t)sizeof(TransformVertexData), 0 });
+
+		m_Batches.back().InstanceCount++;
+		range.End = (uint32_t)m_Batches.size();
+
+		transformData[transformIndex++] = source.Transform;
+		transformData[transformIndex++] = GetPreviousTransform(source);
+	}
+
+	DrawPacketList::BatchRange DrawPacketList::GetBatches(DrawPass pass, DrawPipeline pipeline) const
+	{
+		const Range& range = m_BatchRanges[(size_t)pass][(size_t)pipeline];
+		return { m_Batches.data() + range.Begin, m_Batches.data() + range.End };
+	}
+
+	DrawPacketList::BatchRange DrawPacketList::GetShadowBatches(uint32_t viewIndex, DrawPipeline pipeline) const
+	{
+		X2_CORE_ASSERT(viewIndex < m_ShadowViewCount);
+		const Range& range = m_ShadowViews[viewIndex].BatchRanges[(size_t)pipeline];
+		return { m_Batches.data() + range.Begin, m_Batches.data() + range.End };
+	}
+
+	uint64_t DrawPacketList::GetShadowCasterHash(uint32_t viewIndex) const
+	{
+		X2_CORE_ASSERT(viewIndex < m_ShadowViewCount);
+		return m_ShadowViews[viewIndex].StaticCasterHash;
+	}
+
+	void DrawPacketList::RadixSort(std::vector<DrawPacket>& packets, std::vector<DrawPacket>& scratch)
+	{
+		const size_t count = packets.size();
+		if (count < 2)
+			return;
+
+		scratch.resize(count);
+
+		uint32_t histograms[8][256] = {};
+		for (const DrawPacket& packet : packets)
+		{
+			for (uint32_t digit = 0; digit < 8; digit++)
+				histograms[digit][(packet.SortKey >> (digit * 8)) & 0xff]++;
+		}
+
+		DrawPacket* src = packets.data();
+		DrawPacket* dst = scratch.data();
+		for (uint32_t digit = 0; digit < 8; digit++)
+		{
+			const uint32_t shift = digit * 8;
+			uint32_t* histogram = histograms[digit];
+
+			// Every key has the same value for this digit, the pass would only copy
+			if (histogram[(src[0].SortKey >> shift) & 0xff] == count)
+				continue;
+
+			uint32_t offset = 0;
+			for (uint32_t bucket = 0; bucket < 256; bucket++)
+			{
+				const uint32_t bucketCount = histogram[bucket];
+				histogram[bucket] = offset;
+				offset += bucketCount;
+			}
+
+			for (size_t i = 0; i < count; i++)
+				dst[histogram[(src[i].SortKey >> shift) & 0xff]++] = src[i];
+
+			std::swap(src, dst);
+		}
+
+		if (src != packets.data())
+			packets.swap(scratch);
+	}
+
+	uint64_t DrawPacketList::GetInstanceID(const DrawSource& source)
+	{
+		return Utils::HashCombine(Utils::HashCombine(source.EntityUUID, source.MeshHandle), source.SubmeshIndex);
+	}
+
+	bool DrawPacketList::CanBatch(const DrawSource& a, const DrawSource& b) const
+	{
+		// Rigged submeshes read per-entity bone transforms, they never merge across entities
+		if (a.EntityUUID != b.EntityUUID && (!m_CrossEntityInstancing || a.IsRigged || b.IsRigged))
+			return false;
+
+		// MaterialHandle is already resolved through the material table, so entities with
+		// different tables can share a batch as long as this submesh ends up on the same material
+		if (a.EntityUUID == b.EntityUUID && a.MaterialTable != b.MaterialTable)
+			return false;
+
+		return a.Mesh == b.Mesh
+			&& a.StaticMesh == b.StaticMesh
+			&& a.SubmeshIndex == b.SubmeshIndex
+			&& a.MaterialHandle == b.MaterialHandle
+			&& a.OverrideMaterial == b.OverrideMaterial
+			&& a.IsRigged == b.IsRigged;
+	}
+
+	uint64_t DrawPacketList::BuildSortKey(DrawPass pass, DrawPipeline pipeline, const DrawSource& source) const
+	{
+		const glm::vec3 position = { source.Transform.MRow[0].w, source.Transform.MRow[1].w, source.Transform.MRow[2].w };
+		const float distance = glm::length(position - m_ViewPosition);
+
+		// Non-negative floats order like their bit patterns, keep exponent + top 8 mantissa bits
+		uint32_t distanceBits;
+		memcpy(&distanceBits, &distance, sizeof(float));
+		const uint64_t depth = (distanceBits >> 15) & 0xffff;
+
+		const uint64_t material = Utils::HashCombine(source.MaterialHandle, (uint64_t)source.OverrideMaterial.get()) & 0xffff;
+		const uint64_t mesh = Utils::HashCombine(source.MeshHandle, source.SubmeshIndex) & 0xfffff;
+
+		uint64_t key = ((uint64_t)pass << 60) | ((uint64_t)pipeline << s_GroupShift);
+		if (pass == DrawPass::Transparent)
+			key |= ((~depth & 0xffff) << 42) | (material << 26) | (mesh << 6);
+		else
+			key |= (material << 42) | (mesh << 22) | (depth << 6);
+
+		return key;
+	}
+
+	const TransformVertexData& DrawPacketList::GetPreviousTransform(const DrawSource& source) const
+	{
+		const TransformHistory& history = m_History[m_HistoryIndex];
+		const uint64_t id = GetInstanceID(source);
+
+		auto it = std::lower_bound(history.IDs.begin(), history.IDs.end(), id);
+		if (it == history.IDs.end() || *it != id)
+			return source.Transform;
+
+		return history.Transforms[it - history.IDs.begin()];
+	}
+
+	void DrawPacketList::UpdateHistory()
+	{
+		m_HistoryOrder.clear();
+		for (uint32_t i = 0; i < (uint32_t)m_Sources.size(); i++)
+			m_HistoryOrder.push_back({ GetInstanceID(m_Sources[i]), i });
+
+		RadixSort(m_HistoryOrder, m_SortScratch);
+
+		m_HistoryIndex ^= 1;
+		TransformHistory& history = m_History[m_HistoryIndex];
+		history.IDs.clear();
+		history.Transforms.clear();
+		for (const DrawPacket& entry : m_HistoryOrder)
+		{
+			// The same submesh submitted twice in a frame shares an ID, keep the first one
+			if (!history.IDs.empty() && history.IDs.back() == entry.SortKey)
+				continue;
+
+			history.IDs.push_back(entry.SortKey);
+			history.Transforms.push_back(m_Sources[entry.SourceIndex].Transform);
+		}
+	}
+
+}
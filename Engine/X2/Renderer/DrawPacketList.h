@@ -0,0 +1,178 @@
+#pragma once
+
+#include "X2/Scene/Scene.h"
+
+#include "Mesh.h"
+
+#include "X2/Math/Frustum.h"
+
+namespace X2 {
+
+	// Passes a draw packet can be routed to. The pass occupies the top bits of the
+	// sort key, so once sorted every pass is a contiguous range of packets.
+	enum class DrawPass : uint8_t
+	{
+		Shadow = 0,
+		Geometry,
+		Transparent,
+		Selected,
+		Collider,
+		Count
+	};
+
+	// Vertex input family of a draw. Sorted right below the pass, static meshes first.
+	enum class DrawPipeline : uint8_t
+	{
+		Static = 0,
+		Dynamic,
+		Count
+	};
+
+	// One submitted submesh, shared by all the packets (passes) it is routed to
+	struct DrawSource
+	{
+		Ref<Mesh> Mesh;
+		Ref<StaticMesh> StaticMesh;
+		Ref<MaterialTable> MaterialTable;
+		Ref<VulkanMaterial> OverrideMaterial;
+		AssetHandle MeshHandle = 0;
+		AssetHandle MaterialHandle = 0;
+		uint64_t EntityUUID = 0;
+		uint32_t SubmeshIndex = 0;
+		bool IsRigged = false;
+
+		TransformVertexData Transform;
+	};
+
+	struct DrawPacket
+	{
+		uint64_t SortKey;
+		uint32_t SourceIndex;
+		uint32_t Padding = 0;
+	};
+
+	// A run of sorted packets sharing mesh, submesh and material, drawn with one instanced call.
+	// Each instance keeps its own previous-frame transform, looked up per entity in the history.
+	struct DrawBatch
+	{
+		uint32_t SourceIndex;     // First source of the run, holds the mesh and material refs
+		uint32_t TransformOffset; // Byte offset into the transform vertex buffer
+		uint32_t InstanceCount;
+	};
+
+	//
+	// Flat per-frame replacement for the std::map draw lists. Submissions append packets
+	// with a 64-bit sort key (pass | pipeline | material | mesh | depth), the packets are
+	// radix sorted once per frame and collapsed into instanced batches. All storage keeps
+	// its capacity between frames, so steady state submission does not allocate.
+	//
+	class DrawPacketList
+	{
+	public:
+		struct BatchRange
+		{
+			const DrawBatch* First = nullptr;
+			const DrawBatch* Last = nullptr;
+
+			const DrawBatch* begin() const { return First; }
+			const DrawBatch* end() const { return Last; }
+			uint32_t Size() const { return (uint32_t)(Last - First); }
+			bool Empty() const { return First == Last; }
+		};
+	public:
+		void Reset();
+		void SetViewPosition(const glm::vec3& position) { m_ViewPosition = position; }
+
+		// When enabled, submissions from different entities that resolve to the same mesh,
+		// submesh and material are merged into one instanced batch
+		void SetCrossEntityInstancing(bool enabled) { m_CrossEntityInstancing = enabled; }
+
+		DrawSource& AddSource(uint32_t& outSourceIndex);
+		void AddPacket(DrawPass pass, DrawPipeline pipeline, uint32_t sourceIndex);
+
+		// World space bounds of a source. Sources without bounds are never culled.
+		void SetBounds(uint32_t sourceIndex, const Volume::AABB& bounds);
+
+		// Adds a shadow map view. Shadow packets are only drawn through views, every view gets
+		// the casters inside its volume as its own batches. Views are cleared by Reset().
+		uint32_t AddShadowView(const Volume::Frustum& frustum);
+
+		// Tests every source's bounds against the camera frustum and each shadow view in one
+		// batch per view. Packets of camera-culled sources are dropped by Build(), except
+		// collider packets. Must be called before GetTransformCount() and Build().
+		void Cull(const Volume::Frustum& frustum);
+
+		// Sorts the packets and builds the batches. Every drawn instance takes two transform entries
+		// (current and previous frame), written in batch order to transformData.
+		void Build(TransformVertexData* transformData);
+
+		uint32_t GetTransformCount() const { return m_TransformCount; }
+		uint32_t GetPacketCount() const { return (uint32_t)m_Packets.size(); }
+		uint32_t GetSourceCount() const { return (uint32_t)m_Sources.size(); }
+		uint32_t GetBoundedSourceCount() const { return m_BoundedSourceCount; }
+		uint32_t GetCulledSourceCount() const { return m_CulledSourceCount; }
+		bool IsSourceVisible(uint32_t sourceIndex) const { return (m_SourceVisibility[sourceIndex >> 5] >> (sourceIndex & 31)) & 1u; }
+		Volume::AABBArrays GetBounds() const;
+
+		BatchRange GetBatches(DrawPass pass, DrawPipeline pipeline) const;
+		BatchRange GetShadowBatches(uint32_t viewIndex, DrawPipeline pipeline) const;
+		// Hash of the static casters of a view (mesh, submesh and transform), unchanged between
+		// frames when nothing the view sees has moved. Used to keep cached shadow maps.
+		uint64_t GetShadowCasterHash(uint32_t viewIndex) const;
+		const DrawSource& GetSource(uint32_t index) const { return m_Sources[index]; }
+		const DrawSource& GetSource(const DrawBatch& batch) const { return m_Sources[batch.SourceIndex]; }
+
+		static void RadixSort(std::vector<DrawPacket>& packets, std::vector<DrawPacket>& scratch);
+	private:
+		static uint64_t GetInstanceID(const DrawSource& source);
+		bool CanBatch(const DrawSource& a, const DrawSource& b) const;
+
+		struct Range { uint32_t Begin = 0, End = 0; };
+		void AppendInstance(const DrawPacket& packet, Range& range, bool newGroup, TransformVertexData* transformData, uint32_t& transformIndex);
+
+		uint64_t BuildSortKey(DrawPass pass, DrawPipeline pipeline, const DrawSource& source) const;
+		const TransformVertexData& GetPreviousTransform(const DrawSource& source) const;
+		void UpdateHistory();
+	private:
+		std::vector<DrawSource> m_Sources;
+		std::vector<DrawPacket> m_Packets;
+		std::vector<DrawPacket> m_SortScratch;
+		std::vector<DrawBatch> m_Batches;
+
+		// Source bounds as structure of arrays for the batched frustum test
+		std::vector<float> m_BoundsMinX, m_BoundsMinY, m_BoundsMinZ;
+		std::vector<float> m_BoundsMaxX, m_BoundsMaxY, m_BoundsMaxZ;
+		std::vector<uint32_t> m_SourceVisibility; // One bit per source
+		uint32_t m_BoundedSourceCount = 0;
+		uint32_t m_CulledSourceCount = 0;
+		uint32_t m_TransformCount = 0;
+		bool m_Culled = false;
+
+		Range m_BatchRanges[(size_t)DrawPass::Count][(size_t)DrawPipeline::Count];
+
+		struct ShadowView
+		{
+			Volume::Frustum Frustum;
+			std::vector<uint32_t> Visibility; // One bit per source
+			Range BatchRanges[(size_t)DrawPipeline::Count];
+			uint64_t StaticCasterHash = 0;
+		};
+		std::vector<ShadowView> m_ShadowViews; // Only grows, the first m_ShadowViewCount are in use
+		uint32_t m_ShadowViewCount = 0;
+
+		// Last frame's transforms sorted by instance ID (entity, mesh, submesh), used for TAA's
+		// previous model matrix. Keyed per entity so batching across entities keeps motion vectors.
+		struct TransformHistory
+		{
+			std::vector<uint64_t> IDs;
+			std::vector<TransformVertexData> Transforms;
+		};
+		TransformHistory m_History[2];
+		std::vector<DrawPacket> m_HistoryOrder;
+		uint32_t m_HistoryIndex = 0;
+
+		glm::vec3 m_ViewPosition{ 0.0f };
+		bool m_CrossEntityInstancing = true;
+	};
+
+}
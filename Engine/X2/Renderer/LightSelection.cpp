@@ -0,0 +1,117 @@
+#include "Precompiled.h"
+#include "LightSelection.h"
+
+#include "X2/Core/Debug/Profiler.h"
+
+#include <algorithm>
+
+namespace X2 {
+
+	namespace Utils {
+
+		struct RankedLight
+		{
+			uint32_t Index;
+			float Importance;
+			bool ShadowCaster = false;
+		};
+
+		static bool IsLightVisible(const glm::vec3& position, float range, const Volume::Frustum& frustum)
+		{
+			return frustum.Intersects(Volume::AABB(position - glm::vec3(range), position + glm::vec3(range)));
+		}
+
+		static float GetLightImportance(const glm::vec3& position, float range, float intensity, const glm::vec3& radiance, const LightSelectionView& view)
+		{
+			range = glm::max(range, 0.001f);
+			const float luminance = glm::dot(radiance, glm::vec3(0.2126f, 0.7152f, 0.0722f)) * intensity;
+			const float distance = glm::distance(position, view.Position);
+
+			const float screenRadius = LightSelection::GetScreenRadius(position, range, view);
+			// Coverage alone rates a dim light with a huge range over a bright one next to the camera
+			const float distanceFactor = 1.0f / (1.0f + (distance / range) * (distance / range));
+
+			return luminance * screenRadius * screenRadius * distanceFactor;
+		}
+
+		template<typename TLight>
+		static uint32_t WriteRankedLights(const std::vector<TLight>& lights, std::vector<RankedLight>& rankedLights, uint32_t maxShadowCasters, std::vector<TLight>& outLights)
+		{
+			// Ties are broken by index so the selection doesn't flicker between equally important lights
+			std::sort(rankedLights.begin(), rankedLights.end(), [](const RankedLight& a, const RankedLight& b)
+				{
+					return a.Importance != b.Importance ? a.Importance > b.Importance : a.Index < b.Index;
+				});
+
+			uint32_t shadowCasterCount = 0;
+			for (RankedLight& rankedLight : rankedLights)
+			{
+				if (shadowCasterCount == maxShadowCasters)
+					break;
+
+				if (lights[rankedLight.Index].CastsShadows)
+				{
+					rankedLight.ShadowCaster = true;
+					shadowCasterCount++;
+				}
+			}
+			std::stable_partition(rankedLights.begin(), rankedLights.end(), [](const RankedLight& rankedLight) { return rankedLight.ShadowCaster; });
+
+			outLights.clear();
+			outLights.reserve(rankedLights.size());
+			for (const RankedLight& rankedLight : rankedLights)
+			{
+				TLight& light = outLights.emplace_back(lights[rankedLight.Index]);
+				light.CastsShadows = rankedLight.ShadowCaster;
+			}
+
+			return shadowCasterCount;
+		}
+
+	}
+
+	float LightSelection::GetScreenRadius(const glm::vec3& position, float range, const LightSelectionView& view)
+	{
+		// A light around the camera covers the whole screen
+		const float distance = glm::distance(position, view.Position);
+		return distance > range ? glm::min(range * view.ProjectionScale / glm::sqrt(distance * distance - range * range), 1.0f) : 1.0f;
+	}
+
+	uint32_t LightSelection::SelectPointLights(const std::vector<PointLightInfo>& lights, const LightSelectionView& view, uint32_t maxShadowCasters, std::vector<PointLightInfo>& outLights)
+	{
+		X2_PROFILE_FUNC();
+
+		std::vector<Utils::RankedLight> rankedLights;
+		rankedLights.reserve(lights.size());
+		for (uint32_t i = 0; i < (uint32_t)lights.size(); i++)
+		{
+			const PointLightInfo& light = lights[i];
+			if (light.Intensity <= 0.0f || !Utils::IsLightVisible(light.Position, light.Radius, view.Frustum))
+				continue;
+
+			rankedLights.push_back({ i, Utils::GetLightImportance(light.Position, light.Radius, light.Intensity, light.Radiance, view) });
+		}
+
+		return Utils::WriteRankedLights(lights, rankedLights, maxShadowCasters, outLights);
+	}
+
+	uint32_t LightSelection::SelectSpotLights(const std::vector<SpotLightInfo>& lights, const LightSelectionView& view, uint32_t maxShadowCasters, std::vector<SpotLightInfo>& outLights)
+	{
+		X2_PROFILE_FUNC();
+
+		std::vector<Utils::RankedLight> rankedLights;
+		rankedLights.reserve(lights.size());
+		for (uint32_t i = 0; i < (uint32_t)lights.size(); i++)
+		{
+			// The cone fits in the sphere of its range around the light
+			const SpotLightInfo& light = lights[i];
+			if (light.Intensity <= 0.0f || !Utils::IsLightVisible(light.Position, light.Range, view.Frustum))
+				continue;
+
+			rankedLights.push_back({ i, Utils::GetLightImportance(light.Position, light.Range, light.Intensity, light.Radiance, view) });
+		}
+
+		return Utils::WriteRankedLights(lights, rankedLights, maxShadowCasters, outLights);
+	}
+
+}
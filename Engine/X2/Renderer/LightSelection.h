@@ -0,0 +1,34 @@
+#pragma once
+
+#include "X2/Scene/Scene.h"
+#include "X2/Math/Frustum.h"
+
+namespace X2 {
+
+	struct LightSelectionView
+	{
+		glm::vec3 Position;
+		Volume::Frustum Frustum;
+		// Projection[1][1], turns a view space size at unit distance into a size in NDC
+		float ProjectionScale = 1.0f;
+	};
+
+	//
+	// Picks the lights that are uploaded for a view. Lights whose range doesn't reach into the view
+	// frustum are dropped and the rest are ranked by importance: intensity, distance to the camera and
+	// how much of the screen they cover. The most important shadow casting lights, up to
+	// maxShadowCasters, come first in the output so a light's index is also its shadow map slot.
+	// Every other light has CastsShadows cleared.
+	//
+	class LightSelection
+	{
+	public:
+		// Returns the number of shadow casters at the front of outLights
+		static uint32_t SelectPointLights(const std::vector<PointLightInfo>& lights, const LightSelectionView& view, uint32_t maxShadowCasters, std::vector<PointLightInfo>& outLights);
+		static uint32_t SelectSpotLights(const std::vector<SpotLightInfo>& lights, const LightSelectionView& view, uint32_t maxShadowCasters, std::vector<SpotLightInfo>& outLights);
+
+		// Projected radius of a light's range in NDC, clamped to 1
+		static float GetScreenRadius(const glm::vec3& position, float range, const LightSelectionView& view);
+	};
+
+}
@@ -93,6 +93,56 @@ namespace X2
 		X2_MESH_LOG("------------------------------------------------------");
 	}
 
+	SubmeshTriangles MeshSource::GetSubmeshTriangles(uint32_t submeshIndex) const
+	{
+		// Runtime meshes may not keep their geometry on the CPU
+		if (m_Vertices.empty() || m_Indices.empty())
+			return {};
+
+		const Submesh& submesh = m_Submeshes[submeshIndex];
+		return SubmeshTriangles(m_Vertices.data() + submesh.BaseVertex, m_Indices.data() + submesh.BaseIndex / 3, submesh.IndexCount / 3);
+	}
+
+	const Volume::BVH4& MeshSource::GetSubmeshBVH(uint32_t submeshIndex)
+	{
+		if (m_SubmeshBVHs.size() != m_Submeshes.size())
+		{
+			m_SubmeshBVHs.clear();
+			m_SubmeshBVHs.resize(m_Submeshes.size());
+			m_SubmeshBVHBuilt.assign(m_Submeshes.size(), false);
+		}
+
+		if (m_SubmeshBVHBuilt[submeshIndex])
+			return m_SubmeshBVHs[submeshIndex];
+
+		X2_PROFILE_FUNC();
+
+		m_SubmeshBVHBuilt[submeshIndex] = true;
+
+		const SubmeshTriangles triangles = GetSubmeshTriangles(submeshIndex);
+		if (triangles.IsEmpty())
+			return m_SubmeshBVHs[submeshIndex];
+
+		const uint32_t triangleCount = triangles.GetTriangleCount();
+		std::vector<Volume::AABB> aabbs(triangleCount);
+		std::vector<Volume::BVHTriangle> data(triangleCount);
+		for (uint32_t t = 0; t < triangleCount; t++)
+		{
+			// idx is the triangle index within the submesh
+			Volume::BVHTriangle& triangle = data[t];
+			triangle.v0 = triangles.GetPosition(t, 0);
+			triangle.v1 = triangles.GetPosition(t, 1);
+			triangle.v2 = triangles.GetPosition(t, 2);
+			triangle.idx = t;
+
+			aabbs[t] = Volume::AABB(glm::min(triangle.v0, glm::min(triangle.v1, triangle.v2)), glm::max(triangle.v0, glm::max(triangle.v1, triangle.v2)));
+		}
+
+		// Only the collapsed tree is kept
+		m_SubmeshBVHs[submeshIndex] = Volume::BVH4(Volume::BVH(aabbs, data));
+		return m_SubmeshBVHs[submeshIndex];
+	}
+
 
 	Mesh::Mesh(Ref<MeshSource> meshSource)
 		: m_MeshSource(meshSource)
@@ -6,6 +6,7 @@
 #include "X2/Asset/Asset.h"
 
 #include "X2/Math/AABB.h"
+#include "X2/Math/BVH.h"
 
 #include "MaterialAsset.h"
 
@@ -123,12 +124,28 @@ namespace X2 {
 
 	static_assert(sizeof(Index) == 3 * sizeof(uint32_t));
 
-	struct Triangle
+	// Triangles of a submesh, read through the index buffer instead of being copied out of it.
+	// Only valid while the MeshSource it came from is alive and its geometry is unchanged.
+	class SubmeshTriangles
 	{
-		Vertex V0, V1, V2;
+	public:
+		SubmeshTriangles() = default;
+		SubmeshTriangles(const Vertex* vertices, const Index* indices, uint32_t triangleCount)
+			: m_Vertices(vertices), m_Indices(indices), m_TriangleCount(triangleCount) {}
+
+		uint32_t GetTriangleCount() const { return m_TriangleCount; }
+		bool IsEmpty() const { return m_TriangleCount == 0; }
 
-		Triangle(const Vertex& v0, const Vertex& v1, const Vertex& v2)
-			: V0(v0), V1(v1), V2(v2) {}
+		const Index& GetIndex(uint32_t triangle) const { return m_Indices[triangle]; }
+		const glm::vec3& GetPosition(uint32_t triangle, uint32_t corner) const
+		{
+			const Index& index = m_Indices[triangle];
+			return m_Vertices[corner == 0 ? index.V1 : (corner == 1 ? index.V2 : index.V3)].Position;
+		}
+	private:
+		const Vertex* m_Vertices = nullptr; // Offset by the submesh's BaseVertex
+		const Index* m_Indices = nullptr;
+		uint32_t m_TriangleCount = 0;
 	};
 
 	class Submesh
@@ -235,7 +252,12 @@ namespace X2 {
 		const std::vector<Ref<VulkanMaterial>>& GetMaterials() const { return m_Materials; }
 		const std::string& GetFilePath() const { return m_FilePath; }
 
-		const std::vector<Triangle> GetTriangleCache(uint32_t index) const { return m_TriangleCache.at(index); }
+		// Empty when the geometry isn't kept on the CPU (runtime meshes)
+		SubmeshTriangles GetSubmeshTriangles(uint32_t submeshIndex) const;
+
+		// Bottom level of SceneRayQuery, one BVH per submesh in submesh space.
+		// Built on first use, so submeshes that are never queried don't pay for one.
+		const Volume::BVH4& GetSubmeshBVH(uint32_t submeshIndex);
 
 		Ref<VulkanVertexBuffer> GetVertexBuffer() { return m_VertexBuffer; }
 		Ref<VulkanIndexBuffer> GetIndexBuffer() { return m_IndexBuffer; }
@@ -259,7 +281,8 @@ namespace X2 {
 
 		std::vector<Ref<VulkanMaterial>> m_Materials;
 
-		std::unordered_map<uint32_t, std::vector<Triangle>> m_TriangleCache;
+		std::vector<Volume::BVH4> m_SubmeshBVHs;
+		std::vector<bool> m_SubmeshBVHBuilt;
 
 		Volume::AABB m_BoundingBox;
 
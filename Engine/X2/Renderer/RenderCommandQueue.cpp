@@ -5,53 +5,270 @@
 
 namespace X2 {
 
+	namespace Utils {
+
+		static uint8_t* AlignPointer(uint8_t* pointer, size_t alignment)
+		{
+			return (uint8_t*)(((uintptr_t)pointer + (alignment - 1)) & ~(uintptr_t)(alignment - 1));
+		}
+
+	}
+
+	static std::atomic<uint32_t> s_NextQueueID = 0;
+
+	// Live queues by ID, so an exiting thread only hands sub-queues back to queues that still exist
+	static std::mutex s_QueuesMutex;
+	static std::unordered_map<uint32_t, RenderCommandQueue*> s_Queues;
+
+	// Sub-queue of the calling thread per queue ID. IDs are never reused, so entries of
+	// destroyed queues are simply never looked up again.
+	struct ThreadSubQueues
+	{
+		std::vector<RenderCommandQueue::SubQueue*> SubQueues;
+
+		~ThreadSubQueues()
+		{
+			std::scoped_lock<std::mutex> lock(s_QueuesMutex);
+			for (uint32_t id = 0; id < (uint32_t)SubQueues.size(); id++)
+			{
+				if (!SubQueues[id])
+					continue;
+
+				auto it = s_Queues.find(id);
+				if (it != s_Queues.end())
+					it->second->ReleaseSubQueue(SubQueues[id]);
+			}
+		}
+	};
+
+	static thread_local ThreadSubQueues t_ThreadSubQueues;
+
 	RenderCommandQueue::RenderCommandQueue()
+		: m_ID(s_NextQueueID++)
 	{
-		m_CommandBuffer = hnew uint8_t[10 * 1024 * 1024]; // 10mb buffer
-		m_CommandBufferPtr = m_CommandBuffer;
-		memset(m_CommandBuffer, 0, 10 * 1024 * 1024);
+		std::scoped_lock<std::mutex> lock(s_QueuesMutex);
+		s_Queues[m_ID] = this;
 	}
 
 	RenderCommandQueue::~RenderCommandQueue()
 	{
-		delete[] m_CommandBuffer;
+		{
+			std::scoped_lock<std::mutex> lock(s_QueuesMutex);
+			s_Queues.erase(m_ID);
+		}
+
+		for (SubQueue* subQueue : m_SubQueues)
+			DeleteSubQueue(subQueue);
+
+		for (SubQueue* subQueue : m_FreeSubQueues)
+			DeleteSubQueue(subQueue);
+	}
+
+	void RenderCommandQueue::DeleteSubQueue(SubQueue* subQueue)
+	{
+		for (Chunk& chunk : subQueue->Chunks)
+			hdelete[] chunk.Data;
+
+		hdelete subQueue;
+	}
+
+	RenderCommandQueue::SubQueue& RenderCommandQueue::GetThreadSubQueue()
+	{
+		std::vector<SubQueue*>& threadSubQueues = t_ThreadSubQueues.SubQueues;
+		if (m_ID < threadSubQueues.size() && threadSubQueues[m_ID])
+			return *threadSubQueues[m_ID];
+
+		SubQueue* subQueue = nullptr;
+		{
+			std::scoped_lock<std::mutex> lock(m_SubQueueMutex);
+			if (!m_FreeSubQueues.empty())
+			{
+				subQueue = m_FreeSubQueues.back();
+				m_FreeSubQueues.pop_back();
+			}
+			else
+			{
+				subQueue = hnew SubQueue();
+			}
+			m_SubQueues.push_back(subQueue);
+		}
+
+		if (m_ID >= threadSubQueues.size())
+			threadSubQueues.resize(m_ID + 1, nullptr);
+
+		threadSubQueues[m_ID] = subQueue;
+		return *subQueue;
+	}
+
+	void RenderCommandQueue::ReleaseSubQueue(SubQueue* subQueue)
+	{
+		// It may still hold commands of the current frame, Execute recycles it after running them
+		std::scoped_lock<std::mutex> lock(m_SubQueueMutex);
+		m_ReleasedSubQueues.push_back(subQueue);
+	}
+
+	uint8_t* RenderCommandQueue::AllocateInChunk(SubQueue& subQueue, size_t size, size_t alignment)
+	{
+		// Move on to the next chunk (kept from earlier frames, or new) when the current one is full
+		while (subQueue.CurrentChunk < subQueue.Chunks.size())
+		{
+			Chunk& chunk = subQueue.Chunks[subQueue.CurrentChunk];
+			uint8_t* header = Utils::AlignPointer(chunk.Data + chunk.Used, alignof(CommandHeader));
+			uint8_t* payload = Utils::AlignPointer(header + sizeof(CommandHeader), alignment);
+			if (payload + size <= chunk.Data + chunk.Capacity)
+			{
+				chunk.Used = (payload + size) - chunk.Data;
+				return header;
+			}
+
+			subQueue.CurrentChunk++;
+		}
+
+		// Oversized commands get a chunk of their own
+		Chunk chunk;
+		chunk.Capacity = std::max(s_ChunkSize, sizeof(CommandHeader) + alignment + size);
+		chunk.Data = hnew uint8_t[chunk.Capacity];
+
+		uint8_t* header = Utils::AlignPointer(chunk.Data, alignof(CommandHeader));
+		uint8_t* payload = Utils::AlignPointer(header + sizeof(CommandHeader), alignment);
+		chunk.Used = (payload + size) - chunk.Data;
+
+		subQueue.CurrentChunk = (uint32_t)subQueue.Chunks.size();
+		subQueue.Chunks.push_back(chunk);
+		return header;
 	}
 
-	void* RenderCommandQueue::Allocate(RenderCommandFn fn, uint32_t size)
+	void* RenderCommandQueue::Allocate(RenderCommandFn fn, uint32_t size, uint32_t alignment)
 	{
-		// TODO: alignment
-		*(RenderCommandFn*)m_CommandBufferPtr = fn;
-		m_CommandBufferPtr += sizeof(RenderCommandFn);
+		X2_CORE_ASSERT(alignment && (alignment & (alignment - 1)) == 0, "Alignment must be a power of two");
+		X2_CORE_ASSERT(!m_Merged, "Recording into a queue that was already merged");
 
-		*(uint32_t*)m_CommandBufferPtr = size;
-		m_CommandBufferPtr += sizeof(uint32_t);
+		uint8_t* memory = AllocateInChunk(GetThreadSubQueue(), size, alignment);
+		uint8_t* payload = Utils::AlignPointer(memory + sizeof(CommandHeader), alignment);
 
-		void* memory = m_CommandBufferPtr;
-		m_CommandBufferPtr += size;
+		CommandHeader* header = (CommandHeader*)memory;
+		header->Function = fn;
+		header->Sequence = m_NextSequence.fetch_add(1, std::memory_order_relaxed);
+		header->PayloadOffset = (uint32_t)(payload - memory);
+		header->Size = size;
 
-		m_CommandCount++;
-		return memory;
+		return payload;
+	}
+
+	RenderCommandQueue::CommandHeader* RenderCommandQueue::GetCommand(Cursor& cursor)
+	{
+		while (cursor.ChunkIndex < cursor.Queue->Chunks.size() && cursor.ChunkIndex <= cursor.Queue->CurrentChunk)
+		{
+			const Chunk& chunk = cursor.Queue->Chunks[cursor.ChunkIndex];
+			uint8_t* header = Utils::AlignPointer(cursor.Position, alignof(CommandHeader));
+			if (header < chunk.Data + chunk.Used)
+				return (CommandHeader*)header;
+
+			if (++cursor.ChunkIndex < cursor.Queue->Chunks.size())
+				cursor.Position = cursor.Queue->Chunks[cursor.ChunkIndex].Data;
+		}
+		return nullptr;
+	}
+
+	void RenderCommandQueue::Merge()
+	{
+		X2_PROFILE_FUNC();
+
+		m_ExecutionOrder.clear();
+		m_MergedSubQueue = nullptr;
+
+		std::vector<Cursor> cursors;
+		for (const SubQueue* subQueue : m_SubQueues)
+		{
+			if (subQueue->Chunks.empty())
+				continue;
+
+			Cursor cursor = { subQueue, 0, subQueue->Chunks[0].Data };
+			if (GetCommand(cursor))
+				cursors.push_back(cursor);
+		}
+
+		// Commands of a single recording thread need no interleaving, Execute walks them in place
+		if (cursors.size() <= 1)
+		{
+			if (!cursors.empty())
+				m_MergedSubQueue = cursors[0].Queue;
+			m_Merged = true;
+			return;
+		}
+
+		m_ExecutionOrder.reserve(GetCommandCount());
+
+		// Every sub-queue is already in sequence order, so a k-way merge restores the
+		// global submission order. k is the number of recording threads and stays small.
+		while (true)
+		{
+			Cursor* next = nullptr;
+			CommandHeader* nextHeader = nullptr;
+			for (Cursor& cursor : cursors)
+			{
+				CommandHeader* header = GetCommand(cursor);
+				if (header && (!nextHeader || header->Sequence < nextHeader->Sequence))
+				{
+					next = &cursor;
+					nextHeader = header;
+				}
+			}
+
+			if (!nextHeader)
+				break;
+
+			m_ExecutionOrder.push_back(nextHeader);
+			next->Position = (uint8_t*)nextHeader + nextHeader->PayloadOffset + nextHeader->Size;
+		}
+
+		X2_CORE_ASSERT(m_ExecutionOrder.size() == GetCommandCount());
+		m_Merged = true;
 	}
 
 	void RenderCommandQueue::Execute()
 	{
-		//X2_RENDER_TRACE("RenderCommandQueue::Execute -- {0} commands, {1} bytes", m_CommandCount, (m_CommandBufferPtr - m_CommandBuffer));
+		//X2_RENDER_TRACE("RenderCommandQueue::Execute -- {0} commands", GetCommandCount());
 
-		byte* buffer = m_CommandBuffer;
+		// Queues that are not swapped (resource free queues) are merged here
+		if (!m_Merged)
+			Merge();
 
-		for (uint32_t i = 0; i < m_CommandCount; i++)
+		if (m_MergedSubQueue)
 		{
-			RenderCommandFn function = *(RenderCommandFn*)buffer;
-			buffer += sizeof(RenderCommandFn);
+			Cursor cursor = { m_MergedSubQueue, 0, m_MergedSubQueue->Chunks[0].Data };
+			while (CommandHeader* header = GetCommand(cursor))
+			{
+				header->Function((uint8_t*)header + header->PayloadOffset);
+				cursor.Position = (uint8_t*)header + header->PayloadOffset + header->Size;
+			}
+		}
 
-			uint32_t size = *(uint32_t*)buffer;
-			buffer += sizeof(uint32_t);
-			function(buffer);
-			buffer += size;
+		for (CommandHeader* header : m_ExecutionOrder)
+			header->Function((uint8_t*)header + header->PayloadOffset);
+
+		for (SubQueue* subQueue : m_SubQueues)
+		{
+			for (Chunk& chunk : subQueue->Chunks)
+				chunk.Used = 0;
+
+			subQueue->CurrentChunk = 0;
+		}
+
+		{
+			std::scoped_lock<std::mutex> lock(m_SubQueueMutex);
+			for (SubQueue* subQueue : m_ReleasedSubQueues)
+			{
+				m_SubQueues.erase(std::find(m_SubQueues.begin(), m_SubQueues.end(), subQueue));
+				m_FreeSubQueues.push_back(subQueue);
+			}
+			m_ReleasedSubQueues.clear();
 		}
 
-		m_CommandBufferPtr = m_CommandBuffer;
-		m_CommandCount = 0;
+		m_ExecutionOrder.clear();
+		m_MergedSubQueue = nullptr;
+		m_NextSequence = 0;
+		m_Merged = false;
 	}
 
 }
@@ -1,9 +1,21 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
+#include <mutex>
+#include <new>
+#include <vector>
 
 namespace X2 {
 
+	//
+	// Command storage for the render thread. Commands are recorded into chunks that grow on
+	// demand and are kept between frames. Every recording thread gets its own sub-queue, so
+	// worker threads can submit without locking. Merge() interleaves the sub-queues back into
+	// submission order; all recording must be finished before it runs. The sub-queue of a thread
+	// that exits is reused by the next thread that records, once its commands were executed.
+	//
 	class RenderCommandQueue
 	{
 	public:
@@ -12,12 +24,88 @@ namespace X2 {
 		RenderCommandQueue();
 		~RenderCommandQueue();
 
-		void* Allocate(RenderCommandFn func, uint32_t size);
+		RenderCommandQueue(const RenderCommandQueue&) = delete;
+		RenderCommandQueue& operator=(const RenderCommandQueue&) = delete;
 
+		void* Allocate(RenderCommandFn func, uint32_t size, uint32_t alignment = alignof(std::max_align_t));
+
+		// Records func, it is called and destroyed when the queue executes
+		template<typename FuncT>
+		void Submit(FuncT&& func)
+		{
+			auto renderCmd = [](void* ptr) {
+				auto pFunc = (FuncT*)ptr;
+				(*pFunc)();
+
+				// NOTE: Instead of destroying we could try and enforce all items to be trivally destructible
+				// however some items like uniforms which contain std::strings still exist for now
+				// static_assert(std::is_trivially_destructible_v<FuncT>, "FuncT must be trivially destructible");
+				pFunc->~FuncT();
+			};
+			auto storageBuffer = Allocate(renderCmd, sizeof(func), alignof(FuncT));
+			new (storageBuffer) FuncT(std::forward<FuncT>(func));
+		}
+
+		// Orders the commands of all sub-queues for execution, called when the queue is swapped
+		void Merge();
 		void Execute();
+
+		uint32_t GetCommandCount() const { return (uint32_t)m_NextSequence.load(std::memory_order_relaxed); }
 	private:
-		uint8_t* m_CommandBuffer;
-		uint8_t* m_CommandBufferPtr;
-		uint32_t m_CommandCount = 0;
+		struct CommandHeader
+		{
+			RenderCommandFn Function;
+			uint64_t Sequence;
+			uint32_t PayloadOffset; // From the start of the header
+			uint32_t Size;
+		};
+
+		struct Chunk
+		{
+			uint8_t* Data = nullptr;
+			size_t Capacity = 0;
+			size_t Used = 0;
+		};
+
+		// Recording storage of one thread
+		struct SubQueue
+		{
+			std::vector<Chunk> Chunks;
+			uint32_t CurrentChunk = 0;
+		};
+
+		// Read position in a sub-queue
+		struct Cursor
+		{
+			const SubQueue* Queue;
+			uint32_t ChunkIndex;
+			uint8_t* Position;
+		};
+
+		SubQueue& GetThreadSubQueue();
+		// Called when the thread that recorded into subQueue exits
+		void ReleaseSubQueue(SubQueue* subQueue);
+		static uint8_t* AllocateInChunk(SubQueue& subQueue, size_t size, size_t alignment);
+		// Returns the command at the cursor, or null once the sub-queue is exhausted
+		static CommandHeader* GetCommand(Cursor& cursor);
+		static void DeleteSubQueue(SubQueue* subQueue);
+	private:
+		static constexpr size_t s_ChunkSize = 1024 * 1024;
+
+		uint32_t m_ID;
+		std::atomic<uint64_t> m_NextSequence = 0;
+
+		std::mutex m_SubQueueMutex;
+		std::vector<SubQueue*> m_SubQueues;
+		// Sub-queues of exited threads, moved to m_FreeSubQueues by Execute once their commands ran
+		std::vector<SubQueue*> m_ReleasedSubQueues;
+		std::vector<SubQueue*> m_FreeSubQueues;
+
+		std::vector<CommandHeader*> m_ExecutionOrder;
+		// Set instead of m_ExecutionOrder when a single sub-queue recorded, it already is in order
+		const SubQueue* m_MergedSubQueue = nullptr;
+		bool m_Merged = false;
+
+		friend struct ThreadSubQueues;
 	};
 }
@@ -4,6 +4,7 @@
 #include "X2/Vulkan/VulkanShader.h"
 
 #include <map>
+#include <mutex>
 
 #include "SceneRenderer.h"
 #include "SceneEnvironment.h"
@@ -45,6 +46,8 @@ namespace X2 {
 		std::vector<VulkanMaterial*> Materials;
 	};
 	static std::unordered_map<size_t, ShaderDependencies> s_ShaderDependencies;
+	// Materials also get created on asset streaming workers
+	static std::mutex s_ShaderDependenciesMutex;
 
 	struct GlobalShaderInfo
 	{
@@ -57,21 +60,25 @@ namespace X2 {
 
 	void Renderer::RegisterShaderDependency(VulkanShader* shader, VulkanComputePipeline* computePipeline)
 	{
+		std::scoped_lock<std::mutex> lock(s_ShaderDependenciesMutex);
 		s_ShaderDependencies[shader->GetHash()].ComputePipelines.push_back(computePipeline);
 	}
 
 	void Renderer::RegisterShaderDependency(VulkanShader* shader, VulkanPipeline* pipeline)
 	{
+		std::scoped_lock<std::mutex> lock(s_ShaderDependenciesMutex);
 		s_ShaderDependencies[shader->GetHash()].Pipelines.push_back(pipeline);
 	}
 
 	void Renderer::RegisterShaderDependency(VulkanShader* shader, VulkanMaterial* material)
 	{
+		std::scoped_lock<std::mutex> lock(s_ShaderDependenciesMutex);
 		s_ShaderDependencies[shader->GetHash()].Materials.push_back(material);
 	}
 
 	void Renderer::OnShaderReloaded(size_t hash)
 	{
+		std::scoped_lock<std::mutex> lock(s_ShaderDependenciesMutex);
 		if (s_ShaderDependencies.find(hash) != s_ShaderDependencies.end())
 		{
 			auto& dependencies = s_ShaderDependencies.at(hash);
@@ -106,9 +113,12 @@ namespace X2 {
 
 
 	static RendererConfig s_Config;
-	constexpr static uint32_t s_RenderCommandQueueCount = 2;
-	static RenderCommandQueue* s_CommandQueue[s_RenderCommandQueueCount];
+	// One command queue per frame in flight: the app thread records into one while the render thread executes the others
+	constexpr static uint32_t s_MaxRenderCommandQueueCount = 3;
+	static RenderCommandQueue* s_CommandQueue[s_MaxRenderCommandQueueCount];
+	static uint32_t s_RenderCommandQueueCount = 2;
 	static std::atomic<uint32_t> s_RenderCommandQueueSubmissionIndex = 0;
+	static std::atomic<uint32_t> s_RenderCommandQueueIndex = 0;
 	static RenderCommandQueue s_ResourceFreeQueue[3];
 
 	RendererData* Renderer::s_Data = nullptr;
@@ -117,12 +127,15 @@ namespace X2 {
 	void Renderer::Init()
 	{
 		s_Data = hnew RendererData();
-		s_CommandQueue[0] = hnew RenderCommandQueue();
-		s_CommandQueue[1] = hnew RenderCommandQueue();
 
 		// Make sure we don't have more frames in flight than swapchain images
 		s_Config.FramesInFlight = glm::min<uint32_t>(s_Config.FramesInFlight, Application::Get().GetWindow().GetSwapChain().GetImageCount());
 
+		// Two queues at least so recording and rendering still overlap with a single frame in flight
+		s_RenderCommandQueueCount = glm::clamp<uint32_t>(s_Config.FramesInFlight, 2, s_MaxRenderCommandQueueCount);
+		for (uint32_t i = 0; i < s_RenderCommandQueueCount; i++)
+			s_CommandQueue[i] = hnew RenderCommandQueue();
+
 		s_RendererAPI = hnew VulkanRenderer();
 
 		s_Data->m_ShaderLibrary = CreateRef<ShaderLibrary>();
@@ -130,90 +143,93 @@ namespace X2 {
 		if (!s_Config.ShaderPackPath.empty())
 			Renderer::GetShaderLibrary()->LoadShaderPack(s_Config.ShaderPackPath);
 
-		// NOTE: some shaders (compute) need to have optimization disabled because of a shaderc internal error
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/PBR_Static.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/PBR_Transparent.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/PBR_Anim.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/Grid.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/Wireframe.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/Wireframe_Anim.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/Skybox.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/DirShadowMap.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/DirShadowMap_Anim.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/SpotShadowMap.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/SpotShadowMap_Anim.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/PointShadowMap.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/HZB.glsl");
-
-		// HBAO
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/Deinterleaving.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/Reinterleaving.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/PostProcessing/HBAOBlur.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/PostProcessing/HBAO.glsl");
-
-		// GTAO
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/PostProcessing/GTAO.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/PostProcessing/GTAO-Denoise.glsl");
-
-		// AO
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/PostProcessing/AO-Composite.glsl");
-
-		//SSR
-		Renderer::GetShaderLibrary()->Load("Resources/shaders/Pre-Integration.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/PostProcessing/Pre-Convolution.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/PostProcessing/SSR.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/PostProcessing/SSR-Composite.glsl");
-
-		// Environment compute shaders
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/EnvironmentMipFilter.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/EquirectangularToCubeMap.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/EnvironmentIrradiance.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/PreethamSky.glsl");
-
-		// Post-processing
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/PostProcessing/Bloom.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/PostProcessing/DOF.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/PostProcessing/EdgeDetection.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/PostProcessing/SceneComposite.glsl");
-
-		// Light-culling
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/PreDepth.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/PreDepth_Anim.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/LightCulling.glsl");
-
-		// Renderer2D Shaders
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/Renderer2D.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/Renderer2D_Line.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/Renderer2D_Circle.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/Renderer2D_Text.glsl");
-
-		// Jump Flood Shaders
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/JumpFlood_Init.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/JumpFlood_Pass.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/JumpFlood_Composite.glsl");
-
-		// Misc
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/SelectedGeometry.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/SelectedGeometry_Anim.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/TexturePass.glsl");
-
-		//SMAA
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/PostProcessing/SMAAEdgeDetect.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/PostProcessing/SMAABlendWeight.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/PostProcessing/SMAANeighborBlend.glsl");
-
-		//TAA
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/TAA/TAA.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/TAA/PBR_Static_TAA.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/TAA/PreDepth_TAA.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/TAA/TAA_ToneMapping.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/TAA/TAA_ToneUnMapping.glsl");
-		//Renderer::GetShaderLibrary()->Load("Resources/Shaders/TAA/Skybox_TAA.glsl");
-
-		//Ray Marching
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/FroxelFog/FroxelFog_LightInjection.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/FroxelFog/FroxelFog_Scattering.glsl");
-		Renderer::GetShaderLibrary()->Load("Resources/Shaders/FroxelFog/FroxelFog_Compositing.glsl");
+		// Compiled in parallel, the shader registry is written once for the whole batch
+		Renderer::GetShaderLibrary()->LoadBatch({
+			// NOTE: some shaders (compute) need to have optimization disabled because of a shaderc internal error
+			"Resources/Shaders/PBR_Static.glsl",
+			"Resources/Shaders/PBR_Transparent.glsl",
+			"Resources/Shaders/PBR_Anim.glsl",
+			"Resources/Shaders/Grid.glsl",
+			"Resources/Shaders/Wireframe.glsl",
+			"Resources/Shaders/Wireframe_Anim.glsl",
+			"Resources/Shaders/Skybox.glsl",
+			"Resources/Shaders/DirShadowMap.glsl",
+			"Resources/Shaders/DirShadowMap_Anim.glsl",
+			"Resources/Shaders/SpotShadowMap.glsl",
+			"Resources/Shaders/SpotShadowMap_Anim.glsl",
+			"Resources/Shaders/PointShadowMap.glsl",
+			"Resources/Shaders/HZB.glsl",
+
+			// HBAO
+			"Resources/Shaders/Deinterleaving.glsl",
+			"Resources/Shaders/Reinterleaving.glsl",
+			"Resources/Shaders/PostProcessing/HBAOBlur.glsl",
+			"Resources/Shaders/PostProcessing/HBAO.glsl",
+
+			// GTAO
+			"Resources/Shaders/PostProcessing/GTAO.glsl",
+			"Resources/Shaders/PostProcessing/GTAO-Denoise.glsl",
+
+			// AO
+			"Resources/Shaders/PostProcessing/AO-Composite.glsl",
+
+			//SSR
+			"Resources/shaders/Pre-Integration.glsl",
+			"Resources/Shaders/PostProcessing/Pre-Convolution.glsl",
+			"Resources/Shaders/PostProcessing/SSR.glsl",
+			"Resources/Shaders/PostProcessing/SSR-Composite.glsl",
+
+			// Environment compute shaders
+			"Resources/Shaders/EnvironmentMipFilter.glsl",
+			"Resources/Shaders/EquirectangularToCubeMap.glsl",
+			"Resources/Shaders/EnvironmentIrradiance.glsl",
+			"Resources/Shaders/PreethamSky.glsl",
+
+			// Post-processing
+			"Resources/Shaders/PostProcessing/Bloom.glsl",
+			"Resources/Shaders/PostProcessing/DOF.glsl",
+			"Resources/Shaders/PostProcessing/EdgeDetection.glsl",
+			"Resources/Shaders/PostProcessing/SceneComposite.glsl",
+
+			// Light-culling
+			"Resources/Shaders/PreDepth.glsl",
+			"Resources/Shaders/PreDepth_Anim.glsl",
+			"Resources/Shaders/LightCulling.glsl",
+
+			// Renderer2D Shaders
+			"Resources/Shaders/Renderer2D.glsl",
+			"Resources/Shaders/Renderer2D_Line.glsl",
+			"Resources/Shaders/Renderer2D_Circle.glsl",
+			"Resources/Shaders/Renderer2D_Text.glsl",
+
+			// Jump Flood Shaders
+			"Resources/Shaders/JumpFlood_Init.glsl",
+			"Resources/Shaders/JumpFlood_Pass.glsl",
+			"Resources/Shaders/JumpFlood_Composite.glsl",
+
+			// Misc
+			"Resources/Shaders/SelectedGeometry.glsl",
+			"Resources/Shaders/SelectedGeometry_Anim.glsl",
+			"Resources/Shaders/TexturePass.glsl",
+
+			//SMAA
+			"Resources/Shaders/PostProcessing/SMAAEdgeDetect.glsl",
+			"Resources/Shaders/PostProcessing/SMAABlendWeight.glsl",
+			"Resources/Shaders/PostProcessing/SMAANeighborBlend.glsl",
+
+			//TAA
+			"Resources/Shaders/TAA/TAA.glsl",
+			"Resources/Shaders/TAA/PBR_Static_TAA.glsl",
+			"Resources/Shaders/TAA/PreDepth_TAA.glsl",
+			"Resources/Shaders/TAA/TAA_ToneMapping.glsl",
+			"Resources/Shaders/TAA/TAA_ToneUnMapping.glsl",
+			//"Resources/Shaders/TAA/Skybox_TAA.glsl",
+
+			//Ray Marching
+			"Resources/Shaders/FroxelFog/FroxelFog_LightInjection.glsl",
+			"Resources/Shaders/FroxelFog/FroxelFog_Scattering.glsl",
+			"Resources/Shaders/FroxelFog/FroxelFog_Compositing.glsl"
+		});
 
 
 
@@ -330,8 +346,8 @@ namespace X2 {
 			queue.Execute();
 		}
 
-		delete s_CommandQueue[0];
-		delete s_CommandQueue[1];
+		for (uint32_t i = 0; i < s_RenderCommandQueueCount; i++)
+			delete s_CommandQueue[i];
 	}
 
 	RendererCapabilities& Renderer::GetCapabilities()
@@ -359,32 +375,43 @@ namespace X2 {
 		X2_PROFILE_FUNC();
 		auto& performanceTimers = Application::Get().m_PerformanceTimers;
 
-		// Wait for kick, then set render thread to busy
+		// Wait for a kicked frame
 		{
 			X2_PROFILE_FUNC("Wait");
 			Timer waitTimer;
-			renderThread->WaitAndSet(RenderThread::State::Kick, RenderThread::State::Busy);
+			const bool hasFrame = renderThread->WaitForFrame();
 			performanceTimers.RenderThreadWaitTime = waitTimer.ElapsedMillis();
+
+			if (!hasFrame)
+				return;
 		}
 
 		Timer workTimer;
-		s_CommandQueue[GetRenderQueueIndex()]->Execute();
+		s_CommandQueue[s_RenderCommandQueueIndex]->Execute();
 		// ExecuteRenderCommandQueue();
 
-		// Rendering has completed, set state to idle
-		renderThread->Set(RenderThread::State::Idle);
+		// Frames are kicked in queue order, the next one is in the following queue
+		s_RenderCommandQueueIndex = (s_RenderCommandQueueIndex + 1) % s_RenderCommandQueueCount;
+		renderThread->FrameComplete();
 
 		performanceTimers.RenderThreadWorkTime = workTimer.ElapsedMillis();
 	}
 
-	void Renderer::SwapQueues()
+	void Renderer::NextSubmissionQueue()
 	{
+		// Recording for this frame is done, interleave the per-thread commands before the render thread picks them up
+		s_CommandQueue[s_RenderCommandQueueSubmissionIndex]->Merge();
 		s_RenderCommandQueueSubmissionIndex = (s_RenderCommandQueueSubmissionIndex + 1) % s_RenderCommandQueueCount;
 	}
 
+	uint32_t Renderer::GetRenderCommandQueueCount()
+	{
+		return s_RenderCommandQueueCount;
+	}
+
 	uint32_t Renderer::GetRenderQueueIndex()
 	{
-		return (s_RenderCommandQueueSubmissionIndex + 1) % s_RenderCommandQueueCount;
+		return s_RenderCommandQueueIndex;
 	}
 
 	uint32_t Renderer::GetRenderQueueSubmissionIndex()
@@ -404,6 +431,16 @@ namespace X2 {
 		s_RendererAPI->EndRenderPass(renderCommandBuffer);
 	}
 
+	void Renderer::SetRenderArea(Ref<VulkanRenderCommandBuffer> renderCommandBuffer, uint32_t x, uint32_t y, uint32_t width, uint32_t height)
+	{
+		s_RendererAPI->SetRenderArea(renderCommandBuffer, x, y, width, height);
+	}
+
+	void Renderer::ClearDepthArea(Ref<VulkanRenderCommandBuffer> renderCommandBuffer, uint32_t x, uint32_t y, uint32_t width, uint32_t height, float depth)
+	{
+		s_RendererAPI->ClearDepthArea(renderCommandBuffer, x, y, width, height, depth);
+	}
+
 	void Renderer::RT_InsertGPUPerfMarker(Ref<VulkanRenderCommandBuffer> renderCommandBuffer, const std::string& label, const glm::vec4& color)
 	{
 		s_RendererAPI->RT_InsertGPUPerfMarker(renderCommandBuffer, label, color);
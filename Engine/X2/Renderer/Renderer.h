@@ -68,17 +68,7 @@ namespace X2 {
 		template<typename FuncT>
 		static void Submit(FuncT&& func)
 		{
-			auto renderCmd = [](void* ptr) {
-				auto pFunc = (FuncT*)ptr;
-				(*pFunc)();
-
-				// NOTE: Instead of destroying we could try and enforce all items to be trivally destructible
-				// however some items like uniforms which contain std::strings still exist for now
-				// static_assert(std::is_trivially_destructible_v<FuncT>, "FuncT must be trivially destructible");
-				pFunc->~FuncT();
-			};
-			auto storageBuffer = GetRenderCommandQueue().Allocate(renderCmd, sizeof(func));
-			new (storageBuffer) FuncT(std::forward<FuncT>(func));
+			GetRenderCommandQueue().Submit(std::forward<FuncT>(func));
 		}
 
 		template<typename FuncT>
@@ -97,7 +87,7 @@ namespace X2 {
 			Submit([renderCmd, func]()
 				{
 					const uint32_t index = Renderer::RT_GetCurrentFrameIndex();
-					auto storageBuffer = GetRenderResourceReleaseQueue(index).Allocate(renderCmd, sizeof(func));
+					auto storageBuffer = GetRenderResourceReleaseQueue(index).Allocate(renderCmd, sizeof(func), alignof(FuncT));
 					new (storageBuffer) FuncT(std::forward<FuncT>((FuncT&&)func));
 				});
 		}
@@ -108,7 +98,9 @@ namespace X2 {
 		}*/
 
 		static void WaitAndRender(RenderThread* renderThread);
-		static void SwapQueues();
+		// Called by RenderThread::NextFrame() once the render thread is done with the next queue
+		static void NextSubmissionQueue();
+		static uint32_t GetRenderCommandQueueCount();
 
 		static void RenderThreadFunc(RenderThread* renderThread);
 		static uint32_t GetRenderQueueIndex();
@@ -117,6 +109,10 @@ namespace X2 {
 		// ~Actual~ Renderer here... TODO: remove confusion later
 		static void BeginRenderPass(Ref<VulkanRenderCommandBuffer> renderCommandBuffer, Ref<VulkanRenderPass> renderPass, bool explicitClear = false);
 		static void EndRenderPass(Ref<VulkanRenderCommandBuffer> renderCommandBuffer);
+		// Restricts the viewport and scissor of the current render pass to a region of its framebuffer
+		static void SetRenderArea(Ref<VulkanRenderCommandBuffer> renderCommandBuffer, uint32_t x, uint32_t y, uint32_t width, uint32_t height);
+		// Clears the depth attachment of the current render pass inside a region, the rest is left as is
+		static void ClearDepthArea(Ref<VulkanRenderCommandBuffer> renderCommandBuffer, uint32_t x, uint32_t y, uint32_t width, uint32_t height, float depth = 1.0f);
 
 		static void RT_BeginGPUPerfMarker(Ref<VulkanRenderCommandBuffer> renderCommandBuffer, const std::string& label, const glm::vec4& markerColor = {});
 		static void RT_InsertGPUPerfMarker(Ref<VulkanRenderCommandBuffer> renderCommandBuffer, const std::string& label, const glm::vec4& markerColor = {});
@@ -19,6 +19,7 @@
 
 #include "X2/ImGui/ImGui.h"
 #include "X2/Core/Debug/Profiler.h"
+#include "X2/Core/JobSystem.h"
 #include "X2/Math/Math.h"
 #include "X2/Math/Noise.h"
 
@@ -39,6 +40,9 @@ namespace X2 {
 		SceneData = 2,
 		RendererData = 3,
 		PointLightData = 4,
+		SpotLightData = 19,
+		PointLightShadowMatrices = 28,
+		SpotLightShadowMatrices = 29,
 
 		VisiblePointLightIndicesBuffer = 14,
 		VisibleSpotLightIndicesBuffer = 23,
@@ -51,7 +55,23 @@ namespace X2 {
 		FogVolumesData = 27
 	};
 
-	static std::vector<std::thread> s_ThreadPool;
+	static JobCounter s_FlushDrawListJobs;
+
+	namespace Utils {
+
+		// Light buffers grow in powers of two so adding a few lights doesn't recreate them every frame
+		static bool GrowLightBufferCapacity(uint32_t lightCount, uint32_t& capacity)
+		{
+			if (lightCount <= capacity)
+				return false;
+
+			capacity = glm::max(capacity, 16u);
+			while (capacity < lightCount)
+				capacity *= 2;
+			return true;
+		}
+
+	}
 
 	SceneRenderer::SceneRenderer(Ref<Scene> scene, SceneRendererSpecification specification)
 		: m_Scene(scene.get()), m_Specification(specification)
@@ -106,9 +126,7 @@ namespace X2 {
 		m_UniformBufferSet->Create(sizeof(UBShadow), 1);
 		m_UniformBufferSet->Create(sizeof(UBScene), 2);
 		m_UniformBufferSet->Create(sizeof(UBRendererData), 3);
-		m_UniformBufferSet->Create(sizeof(UBPointLights), 4);
 		m_UniformBufferSet->Create(sizeof(UBScreenData), 17);
-		m_UniformBufferSet->Create(sizeof(UBSpotLights), 19);
 		m_UniformBufferSet->Create(sizeof(UBHBAOData), 18);
 
 		m_UniformBufferSet->Create(sizeof(UBSMAAData), 24);
@@ -116,6 +134,8 @@ namespace X2 {
 		m_UniformBufferSet->Create(sizeof(UBFroxelFogData), 26);
 
 		m_UniformBufferSet->Create(sizeof(UBFroxelFogData), 27);
+		m_UniformBufferSet->Create(sizeof(PointLightShadowData), Binding::PointLightShadowMatrices);
+		m_UniformBufferSet->Create(sizeof(SpotLightShadowData), Binding::SpotLightShadowMatrices);
 
 
 
@@ -131,6 +151,10 @@ namespace X2 {
 			m_StorageBufferSet->Create(1, Binding::VisiblePointLightIndicesBuffer); //Can't allocate 0 bytes.. Resized later
 			m_StorageBufferSet->Create(1, Binding::VisibleSpotLightIndicesBuffer); //Can't allocate 0 bytes.. Resized later
 
+			// Just the light count, grown with the scene's lights
+			m_StorageBufferSet->Create(sizeof(SBLightsHeader), Binding::PointLightData);
+			m_StorageBufferSet->Create(sizeof(SBLightsHeader), Binding::SpotLightData);
+
 			m_LightCullingMaterial = CreateRef<VulkanMaterial>(Renderer::GetShaderLibrary()->Get("LightCulling"), "LightCulling");
 			Ref<VulkanShader> lightCullingShader = Renderer::GetShaderLibrary()->Get("LightCulling");
 			m_LightCullingPipeline = CreateRef<VulkanComputePipeline>(lightCullingShader);
@@ -233,9 +257,12 @@ namespace X2 {
 
 		m_directionalLightShadow = CreateRef<DirectionalLightShadow>(shadowMapResolution);
 
-		m_spotLightsShadow = CreateRef<SpotLightShadow>(shadowMapResolution * 0.25);
+		// Spot and point lights share one atlas, tiles shrink with the light's coverage of the screen
+		m_ShadowAtlas = CreateRef<ShadowAtlas>(4096, 64, 1024);
+
+		m_spotLightsShadow = CreateRef<SpotLightShadow>(m_ShadowAtlas, shadowMapResolution * 0.25);
 
-		m_pointLightShadow = CreateRef<PointLightShadow>( 512 );
+		m_pointLightShadow = CreateRef<PointLightShadow>(m_ShadowAtlas, 512);
 
 		//// Non-directional shadow mapping pass
 		//{
@@ -1343,13 +1370,14 @@ namespace X2 {
 
 		}
 
-		// TODO(Yan): resizeable/flushable
-		const size_t TransformBufferCount = 10 * 1024; // 10240 transforms
+		// Initial size, grown in PreRender when a frame needs more
+		const uint32_t TransformBufferCount = 10 * 1024; // 10240 transforms
 		m_SubmeshTransformBuffers.resize(framesInFlight);
 		for (uint32_t i = 0; i < framesInFlight; i++)
 		{
 			m_SubmeshTransformBuffers[i].Buffer = CreateRef<VulkanVertexBuffer>(sizeof(TransformVertexData) * TransformBufferCount);
 			m_SubmeshTransformBuffers[i].Data = hnew TransformVertexData[TransformBufferCount];
+			m_SubmeshTransformBuffers[i].Capacity = TransformBufferCount;
 		}
 
 		//const size_t BoneTransformBufferCount = 1 * 1024; // basically means limited to 1024 animated meshes   TODO(0x): resizeable/flushable
@@ -1387,13 +1415,13 @@ namespace X2 {
 				instance->m_FroxelFog_RayInjectionMaterial[0]->Set("o_VoxelGrid", instance->m_FroxelFog_lightInjectionImage[0]);
 				instance->m_FroxelFog_RayInjectionMaterial[0]->Set("u_History", instance->m_FroxelFog_lightInjectionImage[1]);
 				instance->m_FroxelFog_RayInjectionMaterial[0]->Set("u_ShadowMapTexture", instance->m_directionalLightShadow->GetPipeline(0)->GetSpecification().RenderPass->GetSpecification().TargetFramebuffer->GetDepthImage());
-				instance->m_FroxelFog_RayInjectionMaterial[0]->Set("u_SpotShadowMapTexture", instance->m_spotLightsShadow->GetPipeline(0)->GetSpecification().RenderPass->GetSpecification().TargetFramebuffer->GetDepthImage());
+				instance->m_FroxelFog_RayInjectionMaterial[0]->Set("u_SpotShadowMapTexture", instance->m_ShadowAtlas->GetImage());
 
 
 				instance->m_FroxelFog_RayInjectionMaterial[1]->Set("o_VoxelGrid", instance->m_FroxelFog_lightInjectionImage[1]);
 				instance->m_FroxelFog_RayInjectionMaterial[1]->Set("u_History", instance->m_FroxelFog_lightInjectionImage[0]);
 				instance->m_FroxelFog_RayInjectionMaterial[1]->Set("u_ShadowMapTexture", instance->m_directionalLightShadow->GetPipeline(0)->GetSpecification().RenderPass->GetSpecification().TargetFramebuffer->GetDepthImage());
-				instance->m_FroxelFog_RayInjectionMaterial[1]->Set("u_SpotShadowMapTexture", instance->m_spotLightsShadow->GetPipeline(0)->GetSpecification().RenderPass->GetSpecification().TargetFramebuffer->GetDepthImage());
+				instance->m_FroxelFog_RayInjectionMaterial[1]->Set("u_SpotShadowMapTexture", instance->m_ShadowAtlas->GetImage());
 
 
 				instance->m_FroxelFog_ScatteringMaterial[0]->Set("i_VoxelGrid", instance->m_FroxelFog_lightInjectionImage[0]);
@@ -1528,21 +1556,6 @@ namespace X2 {
 		m_GTAOFinalImage = m_Options.GTAODenoisePasses && m_Options.GTAODenoisePasses % 2 != 0 ? m_GTAODenoiseImage : m_GTAOOutputImage;
 
 
-		static bool isFlip = false;
-		if (!isFlip)
-		{
-			m_CurTransformMap = &m_MeshTransformMap[0];
-			m_PrevTransformMap = &m_MeshTransformMap[1];
-		}
-		else
-		{
-			m_CurTransformMap = &m_MeshTransformMap[1];
-			m_PrevTransformMap = &m_MeshTransformMap[0];
-		}
-		isFlip = !isFlip;
-		m_CurTransformMap->clear();
-
-		
 		m_HaltonJitterCounter++;
 		if (m_HaltonJitterCounter >= 8)
 			m_HaltonJitterCounter = 0;
@@ -1729,10 +1742,8 @@ namespace X2 {
 		UBScene& sceneData = SceneDataUB;
 		UBShadow& shadowData = ShadowData;
 		UBRendererData& rendererData = RendererDataUB;
-		UBPointLights& pointLightData = PointLightsUB;
 		UBHBAOData& hbaoData = HBAODataUB;
 		UBScreenData& screenData = ScreenDataUB;
-		UBSpotLights& spotLightData = SpotLightUB;
 		UBTAAData& taaData = TAADataUB;
 		UBFroxelFogData& froxelFogData = FroxelFogDataUB;
 		UBFogVolumesData& fogVolumesData = FogVolumes;
@@ -1750,6 +1761,8 @@ namespace X2 {
 		const glm::mat4 viewInverse = glm::inverse(sceneCamera.ViewMatrix);
 		const glm::mat4 projectionInverse = glm::inverse(sceneCamera.Camera.GetProjectionMatrix());
 		const glm::vec3 cameraPosition = viewInverse[3];
+		m_DrawPackets.SetViewPosition(cameraPosition);
+		m_CameraFrustum.SetFromViewProjection(sceneCamera.Camera.GetUnReversedProjectionMatrix() * sceneCamera.ViewMatrix);
 
 		cameraData.ViewProjection = viewProjection;
 		cameraData.Projection = sceneCamera.Camera.GetProjectionMatrix();
@@ -1789,35 +1802,68 @@ namespace X2 {
 			});
 
 
-		m_pointLightShadow->Update(m_SceneData.SceneLightEnvironment.PointLights);
-		glm::mat4* pointLightShadowData = m_pointLightShadow->getData().ViewProjection;
+		// Only lights reaching into the view are uploaded, the most important casters get the shadow maps
+		LightSelectionView lightSelectionView;
+		lightSelectionView.Position = cameraPosition;
+		lightSelectionView.Frustum = m_CameraFrustum;
+		lightSelectionView.ProjectionScale = sceneCamera.Camera.GetProjectionMatrix()[1][1];
+
+		m_ShadowAtlas->BeginFrame();
+
+		const uint32_t pointShadowCasterCount = LightSelection::SelectPointLights(m_SceneData.SceneLightEnvironment.PointLights, lightSelectionView, MAX_POINT_LIGHT_SHADOW_COUNT, m_SelectedPointLights);
+		m_pointLightShadow->Update(m_SelectedPointLights, pointShadowCasterCount, lightSelectionView);
+		const PointLightShadowData& pointLightShadowData = m_pointLightShadow->getData();
+		std::vector<glm::mat4> pointLightShadowMatrices(pointLightShadowData.ViewProjection, pointLightShadowData.ViewProjection + pointShadowCasterCount * 6);
+		std::vector<glm::vec4> pointLightShadowRects(pointLightShadowData.AtlasRects, pointLightShadowData.AtlasRects + pointShadowCasterCount * 6);
 
-		Renderer::Submit([instance, pointLightsVec = m_SceneData.SceneLightEnvironment.PointLights , pointLightShadowData]() mutable
+		if (Utils::GrowLightBufferCapacity((uint32_t)m_SelectedPointLights.size(), m_PointLightsCapacity))
+			m_StorageBufferSet->Resize(Binding::PointLightData, 0, (uint32_t)(sizeof(SBLightsHeader) + sizeof(PointLightInfo) * m_PointLightsCapacity));
+
+		Renderer::Submit([instance, pointLightsVec = m_SelectedPointLights, pointLightShadowMatrices, pointLightShadowRects]() mutable
 			{
-				int pointLightCount = pointLightsVec.size();
+				SBLightsHeader header;
+				header.Count = (uint32_t)pointLightsVec.size();
 
 				const uint32_t bufferIndex = Renderer::RT_GetCurrentFrameIndex();
-				Ref<VulkanUniformBuffer> bufferSet = instance->m_UniformBufferSet->Get(Binding::PointLightData, 0, bufferIndex);
-				bufferSet->RT_SetData_DeviceOffset(&pointLightCount, 16ull);
-				bufferSet->RT_SetData_DeviceOffset(pointLightsVec.data(), sizeof PointLightInfo* pointLightCount, 16ull);
-				bufferSet->RT_SetData_DeviceOffset(pointLightShadowData, sizeof glm::mat4* pointLightCount * 6, 16ull + sizeof PointLightInfo * MAX_POINT_LIGHT_SHADOW_COUNT);
+				Ref<VulkanStorageBuffer> lightBuffer = instance->m_StorageBufferSet->Get(Binding::PointLightData, 0, bufferIndex);
+				lightBuffer->RT_SetData(&header, sizeof(SBLightsHeader));
+				if (header.Count)
+					lightBuffer->RT_SetData(pointLightsVec.data(), (uint32_t)(sizeof(PointLightInfo) * header.Count), sizeof(SBLightsHeader));
+
+				if (!pointLightShadowMatrices.empty())
+				{
+					Ref<VulkanUniformBuffer> shadowBuffer = instance->m_UniformBufferSet->Get(Binding::PointLightShadowMatrices, 0, bufferIndex);
+					shadowBuffer->RT_SetData(pointLightShadowMatrices.data(), (uint32_t)(sizeof(glm::mat4) * pointLightShadowMatrices.size()));
+					shadowBuffer->RT_SetData(pointLightShadowRects.data(), (uint32_t)(sizeof(glm::vec4) * pointLightShadowRects.size()), offsetof(PointLightShadowData, AtlasRects));
+				}
 			});
 
-	
+		const uint32_t spotShadowCasterCount = LightSelection::SelectSpotLights(m_SceneData.SceneLightEnvironment.SpotLights, lightSelectionView, MAX_SPOT_LIGHT_SHADOW_COUNT, m_SelectedSpotLights);
+		m_spotLightsShadow->Update(m_SelectedSpotLights, spotShadowCasterCount, lightSelectionView);
+		const SpotLightShadowData& spotLightShadowData = m_spotLightsShadow->getData();
+		std::vector<glm::mat4> spotLightShadowMatrices(spotLightShadowData.ViewProjection, spotLightShadowData.ViewProjection + spotShadowCasterCount);
+		std::vector<glm::vec4> spotLightShadowRects(spotLightShadowData.AtlasRects, spotLightShadowData.AtlasRects + spotShadowCasterCount);
 
-		m_spotLightsShadow->Update(m_SceneData.SceneLightEnvironment.SpotLights);
-		glm::mat4* spotLightShadowData = m_spotLightsShadow->getData().ViewProjection;
+		if (Utils::GrowLightBufferCapacity((uint32_t)m_SelectedSpotLights.size(), m_SpotLightsCapacity))
+			m_StorageBufferSet->Resize(Binding::SpotLightData, 0, (uint32_t)(sizeof(SBLightsHeader) + sizeof(SpotLightInfo) * m_SpotLightsCapacity));
 
-		//std::memcpy(spotLightData.SpotLights, spotLightsVec.data(), lightEnvironment.GetSpotLightsSize()); //(Karim) Do we really have to copy that?
-		Renderer::Submit([instance, spotLightsVec = m_SceneData.SceneLightEnvironment.SpotLights, spotLightShadowData]() mutable
+		Renderer::Submit([instance, spotLightsVec = m_SelectedSpotLights, spotLightShadowMatrices, spotLightShadowRects]() mutable
 			{
-				int spotLightCount = spotLightsVec.size();
+				SBLightsHeader header;
+				header.Count = (uint32_t)spotLightsVec.size();
 
 				const uint32_t bufferIndex = Renderer::RT_GetCurrentFrameIndex();
-				Ref<VulkanUniformBuffer> bufferSet = instance->m_UniformBufferSet->Get(19, 0, bufferIndex);
-				bufferSet->RT_SetData_DeviceOffset(&spotLightCount, 16ull);
-				bufferSet->RT_SetData_DeviceOffset(spotLightsVec.data(), sizeof SpotLightInfo * spotLightCount, 16ull);
-				bufferSet->RT_SetData_DeviceOffset(spotLightShadowData, sizeof glm::mat4 * spotLightCount , 16ull + sizeof SpotLightInfo * MAX_SPOT_LIGHT_SHADOW_COUNT);
+				Ref<VulkanStorageBuffer> lightBuffer = instance->m_StorageBufferSet->Get(Binding::SpotLightData, 0, bufferIndex);
+				lightBuffer->RT_SetData(&header, sizeof(SBLightsHeader));
+				if (header.Count)
+					lightBuffer->RT_SetData(spotLightsVec.data(), (uint32_t)(sizeof(SpotLightInfo) * header.Count), sizeof(SBLightsHeader));
+
+				if (!spotLightShadowMatrices.empty())
+				{
+					Ref<VulkanUniformBuffer> shadowBuffer = instance->m_UniformBufferSet->Get(Binding::SpotLightShadowMatrices, 0, bufferIndex);
+					shadowBuffer->RT_SetData(spotLightShadowMatrices.data(), (uint32_t)(sizeof(glm::mat4) * spotLightShadowMatrices.size()));
+					shadowBuffer->RT_SetData(spotLightShadowRects.data(), (uint32_t)(sizeof(glm::vec4) * spotLightShadowRects.size()), offsetof(SpotLightShadowData, AtlasRects));
+				}
 			});
 
 
@@ -1886,8 +1932,8 @@ namespace X2 {
 
 		Renderer::SetSceneEnvironment(this, m_SceneData.SceneEnvironment,
 			m_directionalLightShadow->GetPipeline(0)->GetSpecification().RenderPass->GetSpecification().TargetFramebuffer->GetDepthImage(),
-			m_spotLightsShadow->GetPipeline(0)->GetSpecification().RenderPass->GetSpecification().TargetFramebuffer->GetDepthImage(),
-			m_pointLightShadow->GetShadowCubemapAtlas()
+			m_ShadowAtlas->GetImage(),
+			m_ShadowAtlas->GetImage()
 		);
 
 
@@ -1956,10 +2002,10 @@ namespace X2 {
 		X2_CORE_ASSERT(m_Active);
 #if MULTI_THREAD
 		Ref<SceneRenderer> instance = this;
-		s_ThreadPool.emplace_back(([instance]() mutable
+		JobSystem::Run([instance]() mutable
 			{
 				instance->FlushDrawList();
-			}));
+			}, &s_FlushDrawListJobs);
 #else 
 		FlushDrawList();
 #endif
@@ -1969,18 +2015,33 @@ namespace X2 {
 
 	void SceneRenderer::WaitForThreads()
 	{
-		for (uint32_t i = 0; i < s_ThreadPool.size(); i++)
-			s_ThreadPool[i].join();
+		JobSystem::Wait(s_FlushDrawListJobs);
+	}
 
-		s_ThreadPool.clear();
+	static void ToTransformVertexData(const glm::mat4& transform, TransformVertexData& outData)
+	{
+		outData.MRow[0] = { transform[0][0], transform[1][0], transform[2][0], transform[3][0] };
+		outData.MRow[1] = { transform[0][1], transform[1][1], transform[2][1], transform[3][1] };
+		outData.MRow[2] = { transform[0][2], transform[1][2], transform[2][2], transform[3][2] };
+	}
+
+	Volume::AABB SceneRenderer::GetWorldBounds(const Volume::AABB& localBounds, const glm::mat4& transform)
+	{
+		// Arvo's method, transforms the center and extents instead of all eight corners
+		const glm::vec3 center = (localBounds.Min + localBounds.Max) * 0.5f;
+		const glm::vec3 extents = (localBounds.Max - localBounds.Min) * 0.5f;
+
+		const glm::vec3 worldCenter = glm::vec3(transform * glm::vec4(center, 1.0f));
+		const glm::mat3 absRotationScale = glm::mat3(glm::vec3(glm::abs(transform[0])), glm::vec3(glm::abs(transform[1])), glm::vec3(glm::abs(transform[2])));
+		const glm::vec3 worldExtents = absRotationScale * extents;
+
+		return Volume::AABB(worldCenter - worldExtents, worldCenter + worldExtents);
 	}
 
 	void SceneRenderer::SubmitMesh(uint64_t entityUUID, Ref<Mesh> mesh, uint32_t submeshIndex, Ref<MaterialTable> materialTable, const glm::mat4& transform, const std::vector<glm::mat4>& boneTransforms, Ref<VulkanMaterial> overrideMaterial)
 	{
 		X2_PROFILE_FUNC();
 
-		// TODO: Culling, sorting, etc.
-
 		const auto meshSource = mesh->GetMeshSource();
 		const auto& submeshes = meshSource->GetSubmeshes();
 		const auto& submesh = submeshes[submeshIndex];
@@ -1990,49 +2051,25 @@ namespace X2 {
 		AssetHandle materialHandle = materialTable->HasMaterial(materialIndex) ? materialTable->GetMaterial(materialIndex) : mesh->GetMaterials()->GetMaterial(materialIndex);
 		Ref<MaterialAsset> material = AssetManager::GetAsset<MaterialAsset>(materialHandle);
 
-		MeshKey meshKey = { entityUUID, mesh->Handle, materialHandle, submeshIndex, false };
-		auto& transformStorage = (* m_CurTransformMap)[meshKey].Transforms.emplace_back();
-
+		uint32_t sourceIndex;
+		DrawSource& source = m_DrawPackets.AddSource(sourceIndex);
+		source.Mesh = mesh;
+		source.MeshHandle = mesh->Handle;
+		source.MaterialTable = materialTable;
+		source.OverrideMaterial = overrideMaterial;
+		source.MaterialHandle = materialHandle;
+		source.EntityUUID = entityUUID;
+		source.SubmeshIndex = submeshIndex;
+		source.IsRigged = isRigged; // TODO: would it be better to have separate pipeline for rigged meshes, or this flag is OK?
+		ToTransformVertexData(transform, source.Transform);
+		m_DrawPackets.SetBounds(sourceIndex, GetWorldBounds(submesh.BoundingBox, transform));
 
-		transformStorage.MRow[0] = { transform[0][0], transform[1][0], transform[2][0], transform[3][0] };
-		transformStorage.MRow[1] = { transform[0][1], transform[1][1], transform[2][1], transform[3][1] };
-		transformStorage.MRow[2] = { transform[0][2], transform[1][2], transform[2][2], transform[3][2] };
-
-
-		if ((*m_PrevTransformMap).find(meshKey) == (*m_PrevTransformMap).end())
-		{
-			(*m_PrevTransformMap)[meshKey] = (*m_CurTransformMap)[meshKey];
-		}
-	
-
-		/*if (isRigged)
-		{
-			CopyToBoneTransformStorage(meshKey, meshSource, boneTransforms);
-		}*/
 		// Main geo
-		{
-			bool isTransparent = material->IsTransparent();
-			auto& destDrawList = !isTransparent ? m_DrawList : m_TransparentDrawList;
-			auto& dc = destDrawList[meshKey];
-			dc.Mesh = mesh;
-			dc.SubmeshIndex = submeshIndex;
-			dc.MaterialTable = materialTable;
-			dc.OverrideMaterial = overrideMaterial;
-			dc.InstanceCount++;
-			dc.IsRigged = isRigged;  // TODO: would it be better to have separate draw list for rigged meshes, or this flag is OK?
-		}
+		m_DrawPackets.AddPacket(material->IsTransparent() ? DrawPass::Transparent : DrawPass::Geometry, DrawPipeline::Dynamic, sourceIndex);
 
 		// Shadow pass
 		if (material->IsShadowCasting())
-		{
-			auto& dc = m_ShadowPassDrawList[meshKey];
-			dc.Mesh = mesh;
-			dc.SubmeshIndex = submeshIndex;
-			dc.MaterialTable = materialTable;
-			dc.OverrideMaterial = overrideMaterial;
-			dc.InstanceCount++;
-			dc.IsRigged = isRigged;
-		}
+			m_DrawPackets.AddPacket(DrawPass::Shadow, DrawPipeline::Dynamic, sourceIndex);
 	}
 
 	void SceneRenderer::SubmitStaticMesh(uint64_t entityUUID, Ref<StaticMesh> staticMesh, Ref<MaterialTable> materialTable, const glm::mat4& transform, Ref<VulkanMaterial> overrideMaterial)
@@ -2045,58 +2082,37 @@ namespace X2 {
 		{
 			glm::mat4 submeshTransform = transform * submeshData[submeshIndex].Transform;
 
-			const auto& submeshes = staticMesh->GetMeshSource()->GetSubmeshes();
-			uint32_t materialIndex = submeshes[submeshIndex].MaterialIndex;
+			uint32_t materialIndex = submeshData[submeshIndex].MaterialIndex;
 
 			AssetHandle materialHandle = materialTable->HasMaterial(materialIndex) ? materialTable->GetMaterial(materialIndex) : staticMesh->GetMaterials()->GetMaterial(materialIndex);
 			X2_CORE_VERIFY(materialHandle);
 			Ref<MaterialAsset> material = AssetManager::GetAsset<MaterialAsset>(materialHandle);
 
-			MeshKey meshKey = { entityUUID, staticMesh->Handle, materialHandle, submeshIndex, false };
-			auto& transformStorage = (* m_CurTransformMap)[meshKey].Transforms.emplace_back();
-
-			transformStorage.MRow[0] = { submeshTransform[0][0], submeshTransform[1][0], submeshTransform[2][0], submeshTransform[3][0] };
-			transformStorage.MRow[1] = { submeshTransform[0][1], submeshTransform[1][1], submeshTransform[2][1], submeshTransform[3][1] };
-			transformStorage.MRow[2] = { submeshTransform[0][2], submeshTransform[1][2], submeshTransform[2][2], submeshTransform[3][2] };
-			
-
-			if ((*m_PrevTransformMap).find(meshKey) == (*m_PrevTransformMap).end())
-			{
-				(*m_PrevTransformMap)[meshKey] = (*m_CurTransformMap)[meshKey];
-			}
+			uint32_t sourceIndex;
+			DrawSource& source = m_DrawPackets.AddSource(sourceIndex);
+			source.StaticMesh = staticMesh;
+			source.MeshHandle = staticMesh->Handle;
+			source.MaterialTable = materialTable;
+			source.OverrideMaterial = overrideMaterial;
+			source.MaterialHandle = materialHandle;
+			source.EntityUUID = entityUUID;
+			source.SubmeshIndex = submeshIndex;
+			ToTransformVertexData(submeshTransform, source.Transform);
+			m_DrawPackets.SetBounds(sourceIndex, GetWorldBounds(submeshData[submeshIndex].BoundingBox, submeshTransform));
 
 			// Main geo
-			{
-				bool isTransparent = material->IsTransparent();
-				auto& destDrawList = !isTransparent ? m_StaticMeshDrawList : m_TransparentStaticMeshDrawList;
-				auto& dc = destDrawList[meshKey];
-				dc.StaticMesh = staticMesh;
-				dc.SubmeshIndex = submeshIndex;
-				dc.MaterialTable = materialTable;
-				dc.OverrideMaterial = overrideMaterial;
-				dc.InstanceCount++;
-			}
+			m_DrawPackets.AddPacket(material->IsTransparent() ? DrawPass::Transparent : DrawPass::Geometry, DrawPipeline::Static, sourceIndex);
 
 			// Shadow pass
 			if (material->IsShadowCasting())
-			{
-				auto& dc = m_StaticMeshShadowPassDrawList[meshKey];
-				dc.StaticMesh = staticMesh;
-				dc.SubmeshIndex = submeshIndex;
-				dc.MaterialTable = materialTable;
-				dc.OverrideMaterial = overrideMaterial;
-				dc.InstanceCount++;
-			}
+				m_DrawPackets.AddPacket(DrawPass::Shadow, DrawPipeline::Static, sourceIndex);
 		}
-
 	}
 
 	void SceneRenderer::SubmitSelectedMesh(uint64_t entityUUID, Ref<Mesh> mesh, uint32_t submeshIndex, Ref<MaterialTable> materialTable, const glm::mat4& transform, const std::vector<glm::mat4>& boneTransforms, Ref<VulkanMaterial> overrideMaterial)
 	{
 		X2_PROFILE_FUNC();
 
-		// TODO: Culling, sorting, etc.
-
 		const auto meshSource = mesh->GetMeshSource();
 		const auto& submeshes = meshSource->GetSubmeshes();
 		const auto& submesh = submeshes[submeshIndex];
@@ -2107,63 +2123,28 @@ namespace X2 {
 		X2_CORE_VERIFY(materialHandle);
 		Ref<MaterialAsset> material = AssetManager::GetAsset<MaterialAsset>(materialHandle);
 
-		MeshKey meshKey = { entityUUID, mesh->Handle, materialHandle, submeshIndex, true };
-		auto& transformStorage = (* m_CurTransformMap)[meshKey].Transforms.emplace_back();
-
-		transformStorage.MRow[0] = { transform[0][0], transform[1][0], transform[2][0], transform[3][0] };
-		transformStorage.MRow[1] = { transform[0][1], transform[1][1], transform[2][1], transform[3][1] };
-		transformStorage.MRow[2] = { transform[0][2], transform[1][2], transform[2][2], transform[3][2] };
-
-		if ((*m_PrevTransformMap).find(meshKey) == (*m_PrevTransformMap).end())
-		{
-			(*m_PrevTransformMap)[meshKey] = (*m_CurTransformMap)[meshKey];
-		}
-
-		/*if (isRigged)
-		{
-			CopyToBoneTransformStorage(meshKey, meshSource, boneTransforms);
-		}*/
-
-		uint32_t instanceIndex = 0;
+		uint32_t sourceIndex;
+		DrawSource& source = m_DrawPackets.AddSource(sourceIndex);
+		source.Mesh = mesh;
+		source.MeshHandle = mesh->Handle;
+		source.MaterialTable = materialTable;
+		source.OverrideMaterial = overrideMaterial;
+		source.MaterialHandle = materialHandle;
+		source.EntityUUID = entityUUID;
+		source.SubmeshIndex = submeshIndex;
+		source.IsRigged = isRigged;
+		ToTransformVertexData(transform, source.Transform);
+		m_DrawPackets.SetBounds(sourceIndex, GetWorldBounds(submesh.BoundingBox, transform));
 
 		// Main geo
-		{
-			bool isTransparent = material->IsTransparent();
-			auto& destDrawList = !isTransparent ? m_DrawList : m_TransparentDrawList;
-			auto& dc = destDrawList[meshKey];
-			dc.Mesh = mesh;
-			dc.SubmeshIndex = submeshIndex;
-			dc.MaterialTable = materialTable;
-			dc.OverrideMaterial = overrideMaterial;
-
-			instanceIndex = dc.InstanceCount;
-			dc.InstanceCount++;
-			dc.IsRigged = isRigged;
-		}
+		m_DrawPackets.AddPacket(material->IsTransparent() ? DrawPass::Transparent : DrawPass::Geometry, DrawPipeline::Dynamic, sourceIndex);
 
 		// Selected mesh list
-		{
-			auto& dc = m_SelectedMeshDrawList[meshKey];
-			dc.Mesh = mesh;
-			dc.SubmeshIndex = submeshIndex;
-			dc.MaterialTable = materialTable;
-			dc.OverrideMaterial = overrideMaterial;
-			dc.InstanceCount++;
-			dc.InstanceOffset = instanceIndex;
-			dc.IsRigged = isRigged;
-		}
+		m_DrawPackets.AddPacket(DrawPass::Selected, DrawPipeline::Dynamic, sourceIndex);
 
 		// Shadow pass
 		if (material->IsShadowCasting())
-		{
-			auto& dc = m_ShadowPassDrawList[meshKey];
-			dc.Mesh = mesh;
-			dc.SubmeshIndex = submeshIndex;
-			dc.MaterialTable = materialTable;
-			dc.OverrideMaterial = overrideMaterial;
-			dc.InstanceCount++;
-			dc.IsRigged = isRigged;
-		}
+			m_DrawPackets.AddPacket(DrawPass::Shadow, DrawPipeline::Dynamic, sourceIndex);
 	}
 
 	void SceneRenderer::SubmitSelectedStaticMesh(uint64_t entityUUID, Ref<StaticMesh> staticMesh, Ref<MaterialTable> materialTable, const glm::mat4& transform, Ref<VulkanMaterial> overrideMaterial)
@@ -2176,57 +2157,33 @@ namespace X2 {
 		{
 			glm::mat4 submeshTransform = transform * submeshData[submeshIndex].Transform;
 
-			const auto& submeshes = staticMesh->GetMeshSource()->GetSubmeshes();
-			uint32_t materialIndex = submeshes[submeshIndex].MaterialIndex;
+			uint32_t materialIndex = submeshData[submeshIndex].MaterialIndex;
 
 			AssetHandle materialHandle = materialTable->HasMaterial(materialIndex) ? materialTable->GetMaterial(materialIndex) : staticMesh->GetMaterials()->GetMaterial(materialIndex);
 			X2_CORE_VERIFY(materialHandle);
 			Ref<MaterialAsset> material = AssetManager::GetAsset<MaterialAsset>(materialHandle);
 
-			MeshKey meshKey = { entityUUID, staticMesh->Handle, materialHandle, submeshIndex, true };
-			auto& transformStorage = (* m_CurTransformMap)[meshKey].Transforms.emplace_back();
-
-			transformStorage.MRow[0] = { submeshTransform[0][0], submeshTransform[1][0], submeshTransform[2][0], submeshTransform[3][0] };
-			transformStorage.MRow[1] = { submeshTransform[0][1], submeshTransform[1][1], submeshTransform[2][1], submeshTransform[3][1] };
-			transformStorage.MRow[2] = { submeshTransform[0][2], submeshTransform[1][2], submeshTransform[2][2], submeshTransform[3][2] };
-
-			if ((*m_PrevTransformMap).find(meshKey) == (*m_PrevTransformMap).end())
-			{
-				(*m_PrevTransformMap)[meshKey] = (*m_CurTransformMap)[meshKey];
-			}
+			uint32_t sourceIndex;
+			DrawSource& source = m_DrawPackets.AddSource(sourceIndex);
+			source.StaticMesh = staticMesh;
+			source.MeshHandle = staticMesh->Handle;
+			source.MaterialTable = materialTable;
+			source.OverrideMaterial = overrideMaterial;
+			source.MaterialHandle = materialHandle;
+			source.EntityUUID = entityUUID;
+			source.SubmeshIndex = submeshIndex;
+			ToTransformVertexData(submeshTransform, source.Transform);
+			m_DrawPackets.SetBounds(sourceIndex, GetWorldBounds(submeshData[submeshIndex].BoundingBox, submeshTransform));
 
 			// Main geo
-			{
-				bool isTransparent = material->IsTransparent();
-				auto& destDrawList = !isTransparent ? m_StaticMeshDrawList : m_TransparentStaticMeshDrawList;
-				auto& dc = destDrawList[meshKey];
-				dc.StaticMesh = staticMesh;
-				dc.SubmeshIndex = submeshIndex;
-				dc.MaterialTable = materialTable;
-				dc.OverrideMaterial = overrideMaterial;
-				dc.InstanceCount++;
-			}
+			m_DrawPackets.AddPacket(material->IsTransparent() ? DrawPass::Transparent : DrawPass::Geometry, DrawPipeline::Static, sourceIndex);
 
 			// Selected mesh list
-			{
-				auto& dc = m_SelectedStaticMeshDrawList[meshKey];
-				dc.StaticMesh = staticMesh;
-				dc.SubmeshIndex = submeshIndex;
-				dc.MaterialTable = materialTable;
-				dc.OverrideMaterial = overrideMaterial;
-				dc.InstanceCount++;
-			}
+			m_DrawPackets.AddPacket(DrawPass::Selected, DrawPipeline::Static, sourceIndex);
 
 			// Shadow pass
 			if (material->IsShadowCasting())
-			{
-				auto& dc = m_StaticMeshShadowPassDrawList[meshKey];
-				dc.StaticMesh = staticMesh;
-				dc.SubmeshIndex = submeshIndex;
-				dc.MaterialTable = materialTable;
-				dc.OverrideMaterial = overrideMaterial;
-				dc.InstanceCount++;
-			}
+				m_DrawPackets.AddPacket(DrawPass::Shadow, DrawPipeline::Static, sourceIndex);
 		}
 	}
 
@@ -2234,29 +2191,15 @@ namespace X2 {
 	{
 		X2_CORE_VERIFY(mesh->Handle);
 
-		Ref<MeshSource> meshSource = mesh->GetMeshSource();
-		const auto& submeshData = meshSource->GetSubmeshes();
-		glm::mat4 submeshTransform = transform * submeshData[submeshIndex].Transform;
-
-		MeshKey meshKey = { entityUUID, mesh->Handle, 5, submeshIndex, false };
-		auto& transformStorage = (* m_CurTransformMap)[meshKey].Transforms.emplace_back();
+		uint32_t sourceIndex;
+		DrawSource& source = m_DrawPackets.AddSource(sourceIndex);
+		source.Mesh = mesh;
+		source.MeshHandle = mesh->Handle;
+		source.EntityUUID = entityUUID;
+		source.SubmeshIndex = submeshIndex;
+		ToTransformVertexData(transform, source.Transform);
 
-
-		transformStorage.MRow[0] = { transform[0][0], transform[1][0], transform[2][0], transform[3][0] };
-		transformStorage.MRow[1] = { transform[0][1], transform[1][1], transform[2][1], transform[3][1] };
-		transformStorage.MRow[2] = { transform[0][2], transform[1][2], transform[2][2], transform[3][2] };
-
-		if ((*m_PrevTransformMap).find(meshKey) == (*m_PrevTransformMap).end())
-		{
-			(*m_PrevTransformMap)[meshKey] = (*m_CurTransformMap)[meshKey];
-		}
-
-		{
-			auto& dc = m_ColliderDrawList[meshKey];
-			dc.Mesh = mesh;
-			dc.SubmeshIndex = submeshIndex;
-			dc.InstanceCount++;
-		}
+		m_DrawPackets.AddPacket(DrawPass::Collider, DrawPipeline::Dynamic, sourceIndex);
 	}
 
 	void SceneRenderer::SubmitPhysicsStaticDebugMesh(uint64_t entityUUID, Ref<StaticMesh> staticMesh, const glm::mat4& transform, const bool isPrimitiveCollider)
@@ -2268,26 +2211,16 @@ namespace X2 {
 		{
 			glm::mat4 submeshTransform = transform * submeshData[submeshIndex].Transform;
 
-			MeshKey meshKey = {entityUUID, staticMesh->Handle, 5, submeshIndex, false };
-			auto& transformStorage = (* m_CurTransformMap)[meshKey].Transforms.emplace_back();
-
-			transformStorage.MRow[0] = { submeshTransform[0][0], submeshTransform[1][0], submeshTransform[2][0], submeshTransform[3][0] };
-			transformStorage.MRow[1] = { submeshTransform[0][1], submeshTransform[1][1], submeshTransform[2][1], submeshTransform[3][1] };
-			transformStorage.MRow[2] = { submeshTransform[0][2], submeshTransform[1][2], submeshTransform[2][2], submeshTransform[3][2] };
-			
-			if ((*m_PrevTransformMap).find(meshKey) == (*m_PrevTransformMap).end())
-			{
-				(*m_PrevTransformMap)[meshKey] = (*m_CurTransformMap)[meshKey];
-			}
-
-			{
-				auto& dc = m_StaticColliderDrawList[meshKey];
-				dc.StaticMesh = staticMesh;
-				dc.SubmeshIndex = submeshIndex;
-				dc.OverrideMaterial = isPrimitiveCollider ? m_SimpleColliderMaterial : m_ComplexColliderMaterial;
-				dc.InstanceCount++;
-			}
+			uint32_t sourceIndex;
+			DrawSource& source = m_DrawPackets.AddSource(sourceIndex);
+			source.StaticMesh = staticMesh;
+			source.MeshHandle = staticMesh->Handle;
+			source.OverrideMaterial = isPrimitiveCollider ? m_SimpleColliderMaterial : m_ComplexColliderMaterial;
+			source.EntityUUID = entityUUID;
+			source.SubmeshIndex = submeshIndex;
+			ToTransformVertexData(submeshTransform, source.Transform);
 
+			m_DrawPackets.AddPacket(DrawPass::Collider, DrawPipeline::Static, sourceIndex);
 		}
 	}
 
@@ -2305,7 +2238,7 @@ namespace X2 {
 		uint32_t frameIndex = Renderer::GetCurrentFrameIndex();
 		m_GPUTimeQueries.DirShadowMapPassQuery = m_CommandBuffer->BeginTimestampQuery();
 
-		m_directionalLightShadow->RenderStaticShadow(m_CommandBuffer, m_UniformBufferSet, m_StaticMeshShadowPassDrawList, m_CurTransformMap, m_SubmeshTransformBuffers[frameIndex].Buffer);
+		m_directionalLightShadow->RenderStaticShadow(m_CommandBuffer, m_UniformBufferSet, m_DrawPackets, m_SubmeshTransformBuffers[frameIndex].Buffer);
 
 		m_CommandBuffer->EndTimestampQuery(m_GPUTimeQueries.DirShadowMapPassQuery);
 	}
@@ -2318,7 +2251,7 @@ namespace X2 {
 		m_GPUTimeQueries.SpotShadowMapPassQuery = m_CommandBuffer->BeginTimestampQuery();
 
 
-		m_spotLightsShadow->RenderStaticShadow(m_CommandBuffer, m_UniformBufferSet, m_StaticMeshShadowPassDrawList, m_CurTransformMap, m_SubmeshTransformBuffers[frameIndex].Buffer);
+		m_spotLightsShadow->RenderStaticShadow(m_CommandBuffer, m_UniformBufferSet, m_DrawPackets, m_SubmeshTransformBuffers[frameIndex].Buffer);
 
 		m_CommandBuffer->EndTimestampQuery(m_GPUTimeQueries.SpotShadowMapPassQuery);
 
@@ -2331,7 +2264,7 @@ namespace X2 {
 		uint32_t frameIndex = Renderer::GetCurrentFrameIndex();
 		m_GPUTimeQueries.PointShadowMapPassQuery = m_CommandBuffer->BeginTimestampQuery();
 
-		m_pointLightShadow->RenderStaticShadow(m_CommandBuffer, m_UniformBufferSet, m_StaticMeshShadowPassDrawList, m_CurTransformMap, m_SubmeshTransformBuffers[frameIndex].Buffer);
+		m_pointLightShadow->RenderStaticShadow(m_CommandBuffer, m_UniformBufferSet, m_DrawPackets, m_SubmeshTransformBuffers[frameIndex].Buffer);
 
 		m_CommandBuffer->EndTimestampQuery(m_GPUTimeQueries.PointShadowMapPassQuery);
 
@@ -2345,54 +2278,36 @@ namespace X2 {
 		uint32_t frameIndex = Renderer::GetCurrentFrameIndex();
 		m_GPUTimeQueries.DepthPrePassQuery = m_CommandBuffer->BeginTimestampQuery();
 		Renderer::BeginRenderPass(m_CommandBuffer, m_PreDepthPipeline->GetSpecification().RenderPass);
-		for (auto& [mk, dc] : m_StaticMeshDrawList)
+		for (const DrawBatch& batch : m_DrawPackets.GetBatches(DrawPass::Geometry, DrawPipeline::Static))
 		{
-			const auto& transformData = m_CurTransformMap->at(mk);
+			const DrawSource& source = m_DrawPackets.GetSource(batch);
 			if(!IsUsingTAA(m_Options.AAMethod) || !m_Options.EnableAA)
-				Renderer::RenderStaticMeshWithMaterial(m_CommandBuffer, m_PreDepthPipeline, m_UniformBufferSet, nullptr, dc.StaticMesh, dc.SubmeshIndex, m_SubmeshTransformBuffers[frameIndex].Buffer, transformData.TransformOffset, dc.InstanceCount, m_PreDepthMaterial);
+				Renderer::RenderStaticMeshWithMaterial(m_CommandBuffer, m_PreDepthPipeline, m_UniformBufferSet, nullptr, source.StaticMesh, source.SubmeshIndex, m_SubmeshTransformBuffers[frameIndex].Buffer, batch.TransformOffset, batch.InstanceCount, m_PreDepthMaterial);
 			else
-				Renderer::RenderStaticMeshWithMaterial(m_CommandBuffer, m_PreDepthTAAPipeline, m_UniformBufferSet, nullptr, dc.StaticMesh, dc.SubmeshIndex, m_SubmeshTransformBuffers[frameIndex].Buffer, transformData.TransformOffset, dc.InstanceCount, m_PreDepthTAAMaterial);
+				Renderer::RenderStaticMeshWithMaterial(m_CommandBuffer, m_PreDepthTAAPipeline, m_UniformBufferSet, nullptr, source.StaticMesh, source.SubmeshIndex, m_SubmeshTransformBuffers[frameIndex].Buffer, batch.TransformOffset, batch.InstanceCount, m_PreDepthTAAMaterial);
 		}
-		for (auto& [mk, dc] : m_DrawList)
+		for (const DrawBatch& batch : m_DrawPackets.GetBatches(DrawPass::Geometry, DrawPipeline::Dynamic))
 		{
-			const auto& transformData = m_CurTransformMap->at(mk);
-			/*if (dc.IsRigged)
-			{
-				const auto& boneTransformsData = m_MeshBoneTransformsMap.at(mk);
-				Renderer::RenderMeshWithMaterial(m_CommandBuffer, m_PreDepthPipelineAnim, m_UniformBufferSet, nullptr, dc.Mesh, dc.SubmeshIndex, m_SubmeshTransformBuffers[frameIndex].Buffer, transformData.TransformOffset, m_BoneTransformStorageBuffers, boneTransformsData.BoneTransformsBaseIndex, dc.InstanceCount, m_PreDepthMaterial);
-			}
-			else
-			{*/
+			const DrawSource& source = m_DrawPackets.GetSource(batch);
 			if (!IsUsingTAA(m_Options.AAMethod) || !m_Options.EnableAA)
-				Renderer::RenderMeshWithMaterial(m_CommandBuffer, m_PreDepthPipeline, m_UniformBufferSet, nullptr, dc.Mesh, dc.SubmeshIndex, m_SubmeshTransformBuffers[frameIndex].Buffer, transformData.TransformOffset, {}, 0, dc.InstanceCount, m_PreDepthMaterial);
+				Renderer::RenderMeshWithMaterial(m_CommandBuffer, m_PreDepthPipeline, m_UniformBufferSet, nullptr, source.Mesh, source.SubmeshIndex, m_SubmeshTransformBuffers[frameIndex].Buffer, batch.TransformOffset, {}, 0, batch.InstanceCount, m_PreDepthMaterial);
 			else
-				Renderer::RenderMeshWithMaterial(m_CommandBuffer, m_PreDepthTAAPipeline, m_UniformBufferSet, nullptr, dc.Mesh, dc.SubmeshIndex, m_SubmeshTransformBuffers[frameIndex].Buffer, transformData.TransformOffset, {}, 0, dc.InstanceCount, m_PreDepthTAAMaterial);
-			//}
+				Renderer::RenderMeshWithMaterial(m_CommandBuffer, m_PreDepthTAAPipeline, m_UniformBufferSet, nullptr, source.Mesh, source.SubmeshIndex, m_SubmeshTransformBuffers[frameIndex].Buffer, batch.TransformOffset, {}, 0, batch.InstanceCount, m_PreDepthTAAMaterial);
 		}
 
 		Renderer::EndRenderPass(m_CommandBuffer);
 
 		Renderer::BeginRenderPass(m_CommandBuffer, m_PreDepthTransparentPipeline->GetSpecification().RenderPass);
 #if 1
-		/*for (auto& [mk, dc] : m_TransparentStaticMeshDrawList)
+		/*for (const DrawBatch& batch : m_DrawPackets.GetBatches(DrawPass::Transparent, DrawPipeline::Static))
 		{
-			const auto& transformData = m_CurTransformMap->at(mk);
-			Renderer::RenderMeshWithMaterial(m_CommandBuffer, m_PreDepthTransparentPipeline, m_UniformBufferSet, nullptr, dc.StaticMesh, dc.SubmeshIndex, m_SubmeshTransformBuffers[frameIndex].Buffer, transformData.TransformOffset, {}, 0, dc.InstanceCount, m_PreDepthMaterial);
+			const DrawSource& source = m_DrawPackets.GetSource(batch);
+			Renderer::RenderMeshWithMaterial(m_CommandBuffer, m_PreDepthTransparentPipeline, m_UniformBufferSet, nullptr, source.StaticMesh, source.SubmeshIndex, m_SubmeshTransformBuffers[frameIndex].Buffer, batch.TransformOffset, {}, 0, batch.InstanceCount, m_PreDepthMaterial);
 		}*/
-		for (auto& [mk, dc] : m_TransparentDrawList)
+		for (const DrawBatch& batch : m_DrawPackets.GetBatches(DrawPass::Transparent, DrawPipeline::Dynamic))
 		{
-			const auto& transformData = m_CurTransformMap->at(mk);
-			//if (dc.IsRigged)
-			//{
-			//	const auto& boneTransformsData = m_MeshBoneTransformsMap.at(mk);
-
-			//	// TODO(0x): This needs to be pre-depth transparent-anim pipeline
-			//	Renderer::RenderMeshWithMaterial(m_CommandBuffer, m_PreDepthPipelineAnim, m_UniformBufferSet, nullptr, dc.Mesh, dc.SubmeshIndex, m_SubmeshTransformBuffers[frameIndex].Buffer, transformData.TransformOffset, m_BoneTransformStorageBuffers, boneTransformsData.BoneTransformsBaseIndex, dc.InstanceCount, m_PreDepthMaterial);
-			//}
-			//else
-			//{
-				Renderer::RenderMeshWithMaterial(m_CommandBuffer, m_PreDepthTransparentPipeline, m_UniformBufferSet, nullptr, dc.Mesh, dc.SubmeshIndex, m_SubmeshTransformBuffers[frameIndex].Buffer, transformData.TransformOffset, {}, 0, dc.InstanceCount, m_PreDepthMaterial);
-			//}
+			const DrawSource& source = m_DrawPackets.GetSource(batch);
+			Renderer::RenderMeshWithMaterial(m_CommandBuffer, m_PreDepthTransparentPipeline, m_UniformBufferSet, nullptr, source.Mesh, source.SubmeshIndex, m_SubmeshTransformBuffers[frameIndex].Buffer, batch.TransformOffset, {}, 0, batch.InstanceCount, m_PreDepthMaterial);
 		}
 #endif
 
@@ -2738,33 +2653,26 @@ namespace X2 {
 		auto instance = this;
 		Renderer::Submit([instance]() mutable
 			{
-				auto inputImage = instance->m_spotLightsShadow->GetPipeline(0)->GetSpecification().RenderPass->GetSpecification().TargetFramebuffer->GetDepthImage();
+				// The atlas keeps cached tiles between frames, so its contents must survive the barrier
+				auto inputImage = instance->m_ShadowAtlas->GetImage();
 
 				Utils::InsertImageMemoryBarrier(instance->m_CommandBuffer->GetActiveCommandBuffer(), inputImage->GetImageInfo().Image,
-					VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT,
-					VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
-					VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
+					VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+					VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+					VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
 					{ VK_IMAGE_ASPECT_DEPTH_BIT, 0, inputImage->GetSpecification().Mips, 0, inputImage->GetSpecification().Layers});
 			});
 
 		Renderer::BeginRenderPass(m_CommandBuffer, m_SelectedGeometryPipeline->GetSpecification().RenderPass);
-		for (auto& [mk, dc] : m_SelectedStaticMeshDrawList)
+		for (const DrawBatch& batch : m_DrawPackets.GetBatches(DrawPass::Selected, DrawPipeline::Static))
 		{
-			const auto& transformData = m_CurTransformMap->at(mk);
-			Renderer::RenderStaticMeshWithMaterial(m_CommandBuffer, m_SelectedGeometryPipeline, m_UniformBufferSet, nullptr, dc.StaticMesh, dc.SubmeshIndex, m_SubmeshTransformBuffers[frameIndex].Buffer, transformData.TransformOffset + dc.InstanceOffset * sizeof(TransformVertexData), dc.InstanceCount, m_SelectedGeometryMaterial);
+			const DrawSource& source = m_DrawPackets.GetSource(batch);
+			Renderer::RenderStaticMeshWithMaterial(m_CommandBuffer, m_SelectedGeometryPipeline, m_UniformBufferSet, nullptr, source.StaticMesh, source.SubmeshIndex, m_SubmeshTransformBuffers[frameIndex].Buffer, batch.TransformOffset, batch.InstanceCount, m_SelectedGeometryMaterial);
 		}
-		for (auto& [mk, dc] : m_SelectedMeshDrawList)
+		for (const DrawBatch& batch : m_DrawPackets.GetBatches(DrawPass::Selected, DrawPipeline::Dynamic))
 		{
-			const auto& transformData = m_CurTransformMap->at(mk);
-			/*if (dc.IsRigged)
-			{
-				const auto& boneTransformsData = m_MeshBoneTransformsMap.at(mk);
-				Renderer::RenderMeshWithMaterial(m_CommandBuffer, m_SelectedGeometryPipelineAnim, m_UniformBufferSet, nullptr, dc.Mesh, dc.SubmeshIndex, m_SubmeshTransformBuffers[frameIndex].Buffer, transformData.TransformOffset + dc.InstanceOffset * sizeof(TransformVertexData), m_BoneTransformStorageBuffers, boneTransformsData.BoneTransformsBaseIndex + dc.InstanceOffset, dc.InstanceCount, m_SelectedGeometryMaterial);
-			}
-			else
-			{*/
-				Renderer::RenderMeshWithMaterial(m_CommandBuffer, m_SelectedGeometryPipeline, m_UniformBufferSet, nullptr, dc.Mesh, dc.SubmeshIndex, m_SubmeshTransformBuffers[frameIndex].Buffer, transformData.TransformOffset + dc.InstanceOffset * sizeof(TransformVertexData), {}, 0, dc.InstanceCount, m_SelectedGeometryMaterial);
-			//}
+			const DrawSource& source = m_DrawPackets.GetSource(batch);
+			Renderer::RenderMeshWithMaterial(m_CommandBuffer, m_SelectedGeometryPipeline, m_UniformBufferSet, nullptr, source.Mesh, source.SubmeshIndex, m_SubmeshTransformBuffers[frameIndex].Buffer, batch.TransformOffset, {}, 0, batch.InstanceCount, m_SelectedGeometryMaterial);
 		}
 		Renderer::EndRenderPass(m_CommandBuffer);
 
@@ -2782,53 +2690,45 @@ namespace X2 {
 
 		// Render static meshes
 		SceneRenderer::BeginGPUPerfMarker(m_CommandBuffer, "Static Meshes");
-		for (auto& [mk, dc] : m_StaticMeshDrawList)
+		for (const DrawBatch& batch : m_DrawPackets.GetBatches(DrawPass::Geometry, DrawPipeline::Static))
 		{
-			const auto& transformData = m_CurTransformMap->at(mk);
+			const DrawSource& source = m_DrawPackets.GetSource(batch);
 
 			if (!IsUsingTAA(m_Options.AAMethod) || !m_Options.EnableAA)
-				Renderer::RenderStaticMesh(m_CommandBuffer, m_GeometryPipeline, m_UniformBufferSet, m_StorageBufferSet, dc.StaticMesh, dc.SubmeshIndex, dc.MaterialTable ? dc.MaterialTable : dc.StaticMesh->GetMaterials(), m_SubmeshTransformBuffers[frameIndex].Buffer, transformData.TransformOffset, dc.InstanceCount);
+				Renderer::RenderStaticMesh(m_CommandBuffer, m_GeometryPipeline, m_UniformBufferSet, m_StorageBufferSet, source.StaticMesh, source.SubmeshIndex, source.MaterialTable ? source.MaterialTable : source.StaticMesh->GetMaterials(), m_SubmeshTransformBuffers[frameIndex].Buffer, batch.TransformOffset, batch.InstanceCount);
 			else
-				Renderer::RenderStaticMesh(m_CommandBuffer, m_GeometryTAAPipeline, m_UniformBufferSet, m_StorageBufferSet, dc.StaticMesh, dc.SubmeshIndex, dc.MaterialTable ? dc.MaterialTable : dc.StaticMesh->GetMaterials(), m_SubmeshTransformBuffers[frameIndex].Buffer, transformData.TransformOffset, dc.InstanceCount);
+				Renderer::RenderStaticMesh(m_CommandBuffer, m_GeometryTAAPipeline, m_UniformBufferSet, m_StorageBufferSet, source.StaticMesh, source.SubmeshIndex, source.MaterialTable ? source.MaterialTable : source.StaticMesh->GetMaterials(), m_SubmeshTransformBuffers[frameIndex].Buffer, batch.TransformOffset, batch.InstanceCount);
 
 		}
 		SceneRenderer::EndGPUPerfMarker(m_CommandBuffer);
 
 		// Render dynamic meshes
 		SceneRenderer::BeginGPUPerfMarker(m_CommandBuffer, "Dynamic Meshes");
-		for (auto& [mk, dc] : m_DrawList)
+		for (const DrawBatch& batch : m_DrawPackets.GetBatches(DrawPass::Geometry, DrawPipeline::Dynamic))
 		{
-			const auto& transformData = m_CurTransformMap->at(mk);
-			/*if (dc.IsRigged)
-			{
-				const auto& boneTransformsData = m_MeshBoneTransformsMap.at(mk);
-				Renderer::RenderSubmeshInstanced(m_CommandBuffer, m_GeometryPipelineAnim, m_UniformBufferSet, m_StorageBufferSet, dc.Mesh, dc.SubmeshIndex, dc.MaterialTable ? dc.MaterialTable : dc.Mesh->GetMaterials(), m_SubmeshTransformBuffers[frameIndex].Buffer, transformData.TransformOffset, m_BoneTransformStorageBuffers, boneTransformsData.BoneTransformsBaseIndex, dc.InstanceCount);
-			}
-			else
-			{*/
-				Renderer::RenderSubmeshInstanced(m_CommandBuffer, m_GeometryPipeline, m_UniformBufferSet, m_StorageBufferSet, dc.Mesh, dc.SubmeshIndex, dc.MaterialTable ? dc.MaterialTable : dc.Mesh->GetMaterials(), m_SubmeshTransformBuffers[frameIndex].Buffer, transformData.TransformOffset, {}, 0, dc.InstanceCount);
-			//}
+			const DrawSource& source = m_DrawPackets.GetSource(batch);
+			Renderer::RenderSubmeshInstanced(m_CommandBuffer, m_GeometryPipeline, m_UniformBufferSet, m_StorageBufferSet, source.Mesh, source.SubmeshIndex, source.MaterialTable ? source.MaterialTable : source.Mesh->GetMaterials(), m_SubmeshTransformBuffers[frameIndex].Buffer, batch.TransformOffset, {}, 0, batch.InstanceCount);
 		}
 		SceneRenderer::EndGPUPerfMarker(m_CommandBuffer);
 
 		{
 			// Render static meshes
 			SceneRenderer::BeginGPUPerfMarker(m_CommandBuffer, "Static Transparent Meshes");
-			for (auto& [mk, dc] : m_TransparentStaticMeshDrawList)
+			for (const DrawBatch& batch : m_DrawPackets.GetBatches(DrawPass::Transparent, DrawPipeline::Static))
 			{
-				const auto& transformData = m_CurTransformMap->at(mk);
-				Renderer::RenderStaticMesh(m_CommandBuffer, m_TransparentGeometryPipeline, m_UniformBufferSet, m_StorageBufferSet, dc.StaticMesh, dc.SubmeshIndex, dc.MaterialTable ? dc.MaterialTable : dc.StaticMesh->GetMaterials(), m_SubmeshTransformBuffers[frameIndex].Buffer, transformData.TransformOffset, dc.InstanceCount);
+				const DrawSource& source = m_DrawPackets.GetSource(batch);
+				Renderer::RenderStaticMesh(m_CommandBuffer, m_TransparentGeometryPipeline, m_UniformBufferSet, m_StorageBufferSet, source.StaticMesh, source.SubmeshIndex, source.MaterialTable ? source.MaterialTable : source.StaticMesh->GetMaterials(), m_SubmeshTransformBuffers[frameIndex].Buffer, batch.TransformOffset, batch.InstanceCount);
 
 			}
 			SceneRenderer::EndGPUPerfMarker(m_CommandBuffer);
 
 			// Render dynamic meshes
 			SceneRenderer::BeginGPUPerfMarker(m_CommandBuffer, "Dynamic Transparent Meshes");
-			for (auto& [mk, dc] : m_TransparentDrawList)
+			for (const DrawBatch& batch : m_DrawPackets.GetBatches(DrawPass::Transparent, DrawPipeline::Dynamic))
 			{
-				const auto& transformData = m_CurTransformMap->at(mk);
-				//Renderer::RenderSubmesh(m_CommandBuffer, m_GeometryPipeline, m_UniformBufferSet, m_StorageBufferSet, dc.Mesh, dc.SubmeshIndex, dc.MaterialTable ? dc.MaterialTable : dc.Mesh->GetMaterials(), dc.Transform);
-				Renderer::RenderSubmeshInstanced(m_CommandBuffer, m_TransparentGeometryPipeline, m_UniformBufferSet, m_StorageBufferSet, dc.Mesh, dc.SubmeshIndex, dc.MaterialTable ? dc.MaterialTable : dc.Mesh->GetMaterials(), m_SubmeshTransformBuffers[frameIndex].Buffer, transformData.TransformOffset, {}, 0, dc.InstanceCount);
+				const DrawSource& source = m_DrawPackets.GetSource(batch);
+				//Renderer::RenderSubmesh(m_CommandBuffer, m_GeometryPipeline, m_UniformBufferSet, m_StorageBufferSet, source.Mesh, source.SubmeshIndex, source.MaterialTable ? source.MaterialTable : source.Mesh->GetMaterials(), source.Transform);
+				Renderer::RenderSubmeshInstanced(m_CommandBuffer, m_TransparentGeometryPipeline, m_UniformBufferSet, m_StorageBufferSet, source.Mesh, source.SubmeshIndex, source.MaterialTable ? source.MaterialTable : source.Mesh->GetMaterials(), m_SubmeshTransformBuffers[frameIndex].Buffer, batch.TransformOffset, {}, 0, batch.InstanceCount);
 			}
 			SceneRenderer::EndGPUPerfMarker(m_CommandBuffer);
 		}
@@ -3581,26 +3481,18 @@ namespace X2 {
 			Renderer::BeginRenderPass(m_CommandBuffer, m_ExternalCompositeRenderPass);
 
 			SceneRenderer::BeginGPUPerfMarker(m_CommandBuffer, "Static Meshes Wireframe");
-			for (auto& [mk, dc] : m_SelectedStaticMeshDrawList)
+			for (const DrawBatch& batch : m_DrawPackets.GetBatches(DrawPass::Selected, DrawPipeline::Static))
 			{
-				const auto& transformData = m_CurTransformMap->at(mk);
-				Renderer::RenderStaticMeshWithMaterial(m_CommandBuffer, m_GeometryWireframePipeline, m_UniformBufferSet, nullptr, dc.StaticMesh, dc.SubmeshIndex, m_SubmeshTransformBuffers[frameIndex].Buffer, transformData.TransformOffset + dc.InstanceOffset * sizeof(TransformVertexData), dc.InstanceCount, m_WireframeMaterial);
+				const DrawSource& source = m_DrawPackets.GetSource(batch);
+				Renderer::RenderStaticMeshWithMaterial(m_CommandBuffer, m_GeometryWireframePipeline, m_UniformBufferSet, nullptr, source.StaticMesh, source.SubmeshIndex, m_SubmeshTransformBuffers[frameIndex].Buffer, batch.TransformOffset, batch.InstanceCount, m_WireframeMaterial);
 			}
 			SceneRenderer::EndGPUPerfMarker(m_CommandBuffer);
 
 			SceneRenderer::BeginGPUPerfMarker(m_CommandBuffer, "Dynamic Meshes Wireframe");
-			for (auto& [mk, dc] : m_SelectedMeshDrawList)
+			for (const DrawBatch& batch : m_DrawPackets.GetBatches(DrawPass::Selected, DrawPipeline::Dynamic))
 			{
-				const auto& transformData = m_CurTransformMap->at(mk);
-				/*if (dc.IsRigged)
-				{
-					const auto& boneTransformsData = m_MeshBoneTransformsMap.at(mk);
-					Renderer::RenderMeshWithMaterial(m_CommandBuffer, m_GeometryWireframePipelineAnim, m_UniformBufferSet, nullptr, dc.Mesh, dc.SubmeshIndex, m_SubmeshTransformBuffers[frameIndex].Buffer, transformData.TransformOffset + dc.InstanceOffset * sizeof(TransformVertexData), m_BoneTransformStorageBuffers, boneTransformsData.BoneTransformsBaseIndex + dc.InstanceOffset, dc.InstanceCount, m_WireframeMaterial);
-				}
-				else
-				{*/
-					Renderer::RenderMeshWithMaterial(m_CommandBuffer, m_GeometryWireframePipeline, m_UniformBufferSet, nullptr, dc.Mesh, dc.SubmeshIndex, m_SubmeshTransformBuffers[frameIndex].Buffer, transformData.TransformOffset + dc.InstanceOffset * sizeof(TransformVertexData), {}, 0, dc.InstanceCount, m_WireframeMaterial);
-				//}
+				const DrawSource& source = m_DrawPackets.GetSource(batch);
+				Renderer::RenderMeshWithMaterial(m_CommandBuffer, m_GeometryWireframePipeline, m_UniformBufferSet, nullptr, source.Mesh, source.SubmeshIndex, m_SubmeshTransformBuffers[frameIndex].Buffer, batch.TransformOffset, {}, 0, batch.InstanceCount, m_WireframeMaterial);
 			}
 			SceneRenderer::EndGPUPerfMarker(m_CommandBuffer);
 
@@ -3611,32 +3503,21 @@ namespace X2 {
 		{
 			Renderer::BeginRenderPass(m_CommandBuffer, m_ExternalCompositeRenderPass);
 			auto pipeline = m_Options.ShowPhysicsCollidersOnTop ? m_GeometryWireframeOnTopPipeline : m_GeometryWireframePipeline;
-			auto pipelineAnim = m_Options.ShowPhysicsCollidersOnTop ? m_GeometryWireframeOnTopPipelineAnim : m_GeometryWireframePipelineAnim;
 
 			SceneRenderer::BeginGPUPerfMarker(m_CommandBuffer, "Static Meshes Collider");
-			for (auto& [mk, dc] : m_StaticColliderDrawList)
+			for (const DrawBatch& batch : m_DrawPackets.GetBatches(DrawPass::Collider, DrawPipeline::Static))
 			{
-				X2_CORE_VERIFY(m_CurTransformMap->find(mk) != m_CurTransformMap->end());
-				const auto& transformData = m_CurTransformMap->at(mk);
-				Renderer::RenderStaticMeshWithMaterial(m_CommandBuffer, pipeline, m_UniformBufferSet, nullptr, dc.StaticMesh, dc.SubmeshIndex, m_SubmeshTransformBuffers[frameIndex].Buffer, transformData.TransformOffset, dc.InstanceCount, dc.OverrideMaterial);
+				const DrawSource& source = m_DrawPackets.GetSource(batch);
+				Renderer::RenderStaticMeshWithMaterial(m_CommandBuffer, pipeline, m_UniformBufferSet, nullptr, source.StaticMesh, source.SubmeshIndex, m_SubmeshTransformBuffers[frameIndex].Buffer, batch.TransformOffset, batch.InstanceCount, source.OverrideMaterial);
 			}
 			SceneRenderer::EndGPUPerfMarker(m_CommandBuffer);
 
 
 			SceneRenderer::BeginGPUPerfMarker(m_CommandBuffer, "Dynamic Meshes Collider");
-			for (auto& [mk, dc] : m_ColliderDrawList)
+			for (const DrawBatch& batch : m_DrawPackets.GetBatches(DrawPass::Collider, DrawPipeline::Dynamic))
 			{
-				X2_CORE_VERIFY(m_CurTransformMap->find(mk) != m_CurTransformMap->end());
-				const auto& transformData = m_CurTransformMap->at(mk);
-				/*if (dc.IsRigged)
-				{
-					const auto& boneTransformsData = m_MeshBoneTransformsMap.at(mk);
-					Renderer::RenderMeshWithMaterial(m_CommandBuffer, pipelineAnim, m_UniformBufferSet, nullptr, dc.Mesh, dc.SubmeshIndex, m_SubmeshTransformBuffers[frameIndex].Buffer, transformData.TransformOffset, m_BoneTransformStorageBuffers, boneTransformsData.BoneTransformsBaseIndex, dc.InstanceCount, m_SimpleColliderMaterial);
-				}
-				else
-				{*/
-					Renderer::RenderMeshWithMaterial(m_CommandBuffer, pipeline, m_UniformBufferSet, nullptr, dc.Mesh, dc.SubmeshIndex, m_SubmeshTransformBuffers[frameIndex].Buffer, transformData.TransformOffset, {}, 0, dc.InstanceCount, m_SimpleColliderMaterial);
-				//}
+				const DrawSource& source = m_DrawPackets.GetSource(batch);
+				Renderer::RenderMeshWithMaterial(m_CommandBuffer, pipeline, m_UniformBufferSet, nullptr, source.Mesh, source.SubmeshIndex, m_SubmeshTransformBuffers[frameIndex].Buffer, batch.TransformOffset, {}, 0, batch.InstanceCount, m_SimpleColliderMaterial);
 			}
 			SceneRenderer::EndGPUPerfMarker(m_CommandBuffer);
 
@@ -3865,22 +3746,9 @@ namespace X2 {
 
 		UpdateStatistics();
 
-		m_DrawList.clear();
-		m_TransparentDrawList.clear();
-		m_SelectedMeshDrawList.clear();
-		m_ShadowPassDrawList.clear();
-
-		m_StaticMeshDrawList.clear();
-		m_TransparentStaticMeshDrawList.clear();
-		m_SelectedStaticMeshDrawList.clear();
-		m_StaticMeshShadowPassDrawList.clear();
-
-		m_ColliderDrawList.clear();
-		m_StaticColliderDrawList.clear();
+		m_DrawPackets.Reset();
 		m_SceneData = {};
 
-		
-		//m_CurTransformMap->clear();
 		//m_MeshBoneTransformsMap.clear();
 	}
 
@@ -3890,28 +3758,29 @@ namespace X2 {
 
 		uint32_t frameIndex = Renderer::GetCurrentFrameIndex();
 
-		uint32_t offset = 0;
-		for (auto& [key, transformData] : *m_CurTransformMap)
-		{
-			
-			transformData.TransformOffset = offset * sizeof(TransformVertexData);
-
-			auto& prevTransformData = (*m_PrevTransformMap)[key];
-
-			uint32_t transformIndex = 0;
-			for (const auto& transform : transformData.Transforms)
-			{
-				m_SubmeshTransformBuffers[frameIndex].Data[offset] = transform;
-				offset++;
-
-				//Prev Frame Model Matrix; Used in Taa
-				m_SubmeshTransformBuffers[frameIndex].Data[offset] = prevTransformData.Transforms[transformIndex];
-				offset++;
-			}
+		// Every shadow map view culls its own casters, so the transform count is only known after culling
+		m_directionalLightShadow->AddShadowViews(m_DrawPackets);
+		m_spotLightsShadow->AddShadowViews(m_DrawPackets);
+		m_pointLightShadow->AddShadowViews(m_DrawPackets);
+		m_DrawPackets.Cull(m_CameraFrustum);
 
+		TransformBuffer& transformBuffer = m_SubmeshTransformBuffers[frameIndex];
+		const uint32_t transformCount = m_DrawPackets.GetTransformCount();
+		if (transformCount > transformBuffer.Capacity)
+		{
+			// Grow geometrically, the old buffer is released once the frames using it retire
+			uint32_t capacity = std::max(transformBuffer.Capacity * 2, transformCount);
+			hdelete[] transformBuffer.Data;
+			transformBuffer.Data = hnew TransformVertexData[capacity];
+			transformBuffer.Buffer = CreateRef<VulkanVertexBuffer>(sizeof(TransformVertexData) * capacity);
+			transformBuffer.Capacity = capacity;
 		}
 
-		m_SubmeshTransformBuffers[frameIndex].Buffer->SetData(m_SubmeshTransformBuffers[frameIndex].Data, offset * sizeof(TransformVertexData));
+		m_DrawPackets.SetCrossEntityInstancing(m_Options.CrossEntityInstancing);
+		m_DrawPackets.Build(transformBuffer.Data);
+
+		if (transformCount > 0)
+			transformBuffer.Buffer->SetData(transformBuffer.Data, transformCount * sizeof(TransformVertexData));
 
 
 		/*uint32_t index = 0;
@@ -4224,35 +4093,22 @@ namespace X2 {
 		m_Statistics.Instances = 0;
 		m_Statistics.Meshes = 0;
 
-		for (auto& [mk, dc] : m_SelectedStaticMeshDrawList)
+		for (DrawPass pass : { DrawPass::Selected, DrawPass::Geometry })
 		{
-			m_Statistics.Instances += dc.InstanceCount;
-			m_Statistics.DrawCalls++;
-			m_Statistics.Meshes++;
-		}
-
-		for (auto& [mk, dc] : m_StaticMeshDrawList)
-		{
-			m_Statistics.Instances += dc.InstanceCount;
-			m_Statistics.DrawCalls++;
-			m_Statistics.Meshes++;
-		}
-
-		for (auto& [mk, dc] : m_SelectedMeshDrawList)
-		{
-			m_Statistics.Instances += dc.InstanceCount;
-			m_Statistics.DrawCalls++;
-			m_Statistics.Meshes++;
-		}
-
-		for (auto& [mk, dc] : m_DrawList)
-		{
-			m_Statistics.Instances += dc.InstanceCount;
-			m_Statistics.DrawCalls++;
-			m_Statistics.Meshes++;
+			for (DrawPipeline pipeline : { DrawPipeline::Static, DrawPipeline::Dynamic })
+			{
+				for (const DrawBatch& batch : m_DrawPackets.GetBatches(pass, pipeline))
+				{
+					m_Statistics.Instances += batch.InstanceCount;
+					m_Statistics.DrawCalls++;
+					m_Statistics.Meshes++;
+				}
+			}
 		}
 
 		m_Statistics.SavedDraws = m_Statistics.Instances - m_Statistics.DrawCalls;
+		m_Statistics.CulledSubmeshes = m_DrawPackets.GetCulledSourceCount();
+		m_Statistics.VisibleSubmeshes = m_DrawPackets.GetBoundedSourceCount() - m_Statistics.CulledSubmeshes;
 
 		uint32_t frameIndex = Renderer::GetCurrentFrameIndex();
 		m_Statistics.TotalGPUTime = m_CommandBuffer->GetExecutionGPUTime(frameIndex);
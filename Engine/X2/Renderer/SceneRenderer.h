@@ -6,6 +6,10 @@
 
 #include "Mesh.h"
 #include "ShaderDefs.h"
+#include "DrawPacketList.h"
+#include "LightSelection.h"
+
+#include "X2/Math/Frustum.h"
 
 #include "X2/Vulkan/VulkanRenderPass.h"
 #include "X2/Vulkan/VulkanMaterial.h"
@@ -32,6 +36,9 @@ namespace X2
 		bool ShowGrid = true;
 		bool ShowSelectedInWireframe = false;
 
+		// Merge identical mesh/submesh/material submissions from different entities into one instanced draw
+		bool CrossEntityInstancing = true;
+
 		enum class PhysicsColliderView
 		{
 			SelectedEntity = 0, All = 1
@@ -155,6 +162,8 @@ namespace X2
 			uint32_t Meshes = 0;
 			uint32_t Instances = 0;
 			uint32_t SavedDraws = 0;
+			uint32_t VisibleSubmeshes = 0;
+			uint32_t CulledSubmeshes = 0;
 
 			float TotalGPUTime = 0.0f;
 		};
@@ -288,6 +297,8 @@ namespace X2
 		void CalculateCascadesManualSplit(CascadeData* cascades, const SceneRendererCamera& sceneCamera, const glm::vec3& lightDirection) const;
 
 		void UpdateStatistics();
+
+		static Volume::AABB GetWorldBounds(const Volume::AABB& localBounds, const glm::mat4& transform);
 	private:
 		Scene* m_Scene;
 		SceneRendererSpecification m_Specification;
@@ -386,22 +397,12 @@ namespace X2
 			float Intensity;
 		};
 
-		struct UBPointLights
+		// Header of the point and spot light storage buffers, the light array follows it
+		struct SBLightsHeader
 		{
 			uint32_t Count{ 0 };
 			glm::vec3 Padding{};
-			PointLightInfo PointLights[MAX_POINT_LIGHT_SHADOW_COUNT]{};
-			glm::mat4 ShadowMatrices[MAX_SPOT_LIGHT_SHADOW_COUNT * 6]{};
-
-		} PointLightsUB;
-
-		struct UBSpotLights
-		{
-			uint32_t Count{ 0 };
-			glm::vec3 Padding{};
-			SpotLightInfo SpotLights[MAX_SPOT_LIGHT_SHADOW_COUNT]{};
-			glm::mat4 ShadowMatrices[MAX_SPOT_LIGHT_SHADOW_COUNT]{};
-		} SpotLightUB;
+		};
 
 		//struct UBSpotShadowData
 		//{
@@ -639,9 +640,16 @@ namespace X2
 		Ref<VulkanPipeline> m_ShadowPassPipelinesAnim[4];*/
 
 		Ref<DirectionalLightShadow> m_directionalLightShadow;
+		Ref<ShadowAtlas> m_ShadowAtlas;
 		Ref<SpotLightShadow> m_spotLightsShadow;
 		Ref<PointLightShadow> m_pointLightShadow;
 
+		// Lights selected for this frame, shadow casters first
+		std::vector<PointLightInfo> m_SelectedPointLights;
+		std::vector<SpotLightInfo> m_SelectedSpotLights;
+		uint32_t m_PointLightsCapacity = 0;
+		uint32_t m_SpotLightsCapacity = 0;
+
 
 
 		Ref<VulkanPipeline> m_EdgeDetectionPipeline;
@@ -691,27 +699,12 @@ namespace X2
 		//	uint32_t BoneTransformsBaseIndex = 0;
 		//};
 
-		std::map<MeshKey, TransformMapData> m_MeshTransformMap[2];
-		std::map<MeshKey, TransformMapData> * m_CurTransformMap;
-		std::map<MeshKey, TransformMapData> * m_PrevTransformMap;
-
-
 		//std::map<MeshKey, BoneTransformsMapData> m_MeshBoneTransformsMap;
 
-		//std::vector<DrawCommand> m_DrawList;
-		std::map<MeshKey, DrawCommand> m_DrawList;
-		std::map<MeshKey, DrawCommand> m_TransparentDrawList;
-		std::map<MeshKey, DrawCommand> m_SelectedMeshDrawList;
-		std::map<MeshKey, DrawCommand> m_ShadowPassDrawList;
-
-		std::map<MeshKey, StaticDrawCommand> m_StaticMeshDrawList;
-		std::map<MeshKey, StaticDrawCommand> m_TransparentStaticMeshDrawList;
-		std::map<MeshKey, StaticDrawCommand> m_SelectedStaticMeshDrawList;
-		std::map<MeshKey, StaticDrawCommand> m_StaticMeshShadowPassDrawList;
+		DrawPacketList m_DrawPackets;
 
-		// Debug
-		std::map<MeshKey, StaticDrawCommand> m_StaticColliderDrawList;
-		std::map<MeshKey, DrawCommand> m_ColliderDrawList;
+		// Camera frustum the draw packets are culled against
+		Volume::Frustum m_CameraFrustum;
 
 		// Grid
 		Ref<VulkanPipeline> m_GridPipeline;
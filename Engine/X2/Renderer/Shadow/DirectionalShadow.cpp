@@ -208,7 +208,21 @@ namespace X2
 
 
 
-	void DirectionalLightShadow::RenderStaticShadow(Ref<VulkanRenderCommandBuffer> cb, Ref<VulkanUniformBufferSet> uniformBufferSet, std::map<MeshKey, StaticDrawCommand>& staticDrawList, std::map<MeshKey, TransformMapData>* curTransformMap, Ref<VulkanVertexBuffer> buffer)
+	void DirectionalLightShadow::AddShadowViews(DrawPacketList& drawList)
+	{
+		// Casters behind the cascade's near plane still throw shadows into it
+		for (int i = 0; i < CASCADED_COUNT; i++)
+		{
+			Volume::Frustum frustum;
+			frustum.SetFromViewProjection(m_data.ViewProjection[i], true);
+
+			const uint32_t viewIndex = drawList.AddShadowView(frustum);
+			if (i == 0)
+				m_FirstShadowView = viewIndex;
+		}
+	}
+
+	void DirectionalLightShadow::RenderStaticShadow(Ref<VulkanRenderCommandBuffer> cb, Ref<VulkanUniformBufferSet> uniformBufferSet, const DrawPacketList& drawList, Ref<VulkanVertexBuffer> buffer)
 	{
 		for (int i = 0; i < CASCADED_COUNT; i++)
 		{
@@ -218,11 +232,10 @@ namespace X2
 
 			// Render entities
 			const Buffer cascade(&i, sizeof(uint32_t));
-			for (auto& [mk, dc] : staticDrawList)
+			for (const DrawBatch& batch : drawList.GetShadowBatches(m_FirstShadowView + i, DrawPipeline::Static))
 			{
-				X2_CORE_VERIFY(curTransformMap->find(mk) != curTransformMap->end());
-				const auto& transformData = curTransformMap->at(mk);
-				Renderer::RenderStaticMeshWithMaterial(cb, m_ShadowPassPipelines[i], uniformBufferSet, nullptr, dc.StaticMesh, dc.SubmeshIndex, buffer, transformData.TransformOffset, dc.InstanceCount, m_ShadowPassMaterial, cascade);
+				const DrawSource& source = drawList.GetSource(batch);
+				Renderer::RenderStaticMeshWithMaterial(cb, m_ShadowPassPipelines[i], uniformBufferSet, nullptr, source.StaticMesh, source.SubmeshIndex, buffer, batch.TransformOffset, batch.InstanceCount, m_ShadowPassMaterial, cascade);
 			}
 
 			Renderer::EndRenderPass(cb);
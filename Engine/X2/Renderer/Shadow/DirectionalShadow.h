@@ -2,6 +2,7 @@
 #define X2_DIRECTIONALSHADOW
 
 #include "X2/Renderer/Renderer.h"
+#include "X2/Renderer/DrawPacketList.h"
 #include "X2/Vulkan/VulkanPipeline.h"
 #include "X2/Vulkan/VulkanRenderpass.h"
 #include "X2/Vulkan/VulkanTexture.h"
@@ -25,7 +26,10 @@ namespace X2
 
 		void Update( const glm::vec3 lightDirection, const SceneRendererCamera& camera, float splitLambda, float nearOffset, float farOffset);
 
-		void RenderStaticShadow(Ref<VulkanRenderCommandBuffer> cb, Ref<VulkanUniformBufferSet> uniformBufferSet, std::map<MeshKey, StaticDrawCommand>& staticDrawList, std::map<MeshKey, TransformMapData>* curTransformMap, Ref<VulkanVertexBuffer> buffer);
+		// Registers one caster culling view per cascade, extruded toward the light
+		void AddShadowViews(DrawPacketList& drawList);
+
+		void RenderStaticShadow(Ref<VulkanRenderCommandBuffer> cb, Ref<VulkanUniformBufferSet> uniformBufferSet, const DrawPacketList& drawList, Ref<VulkanVertexBuffer> buffer);
 
 		Ref<VulkanPipeline> GetPipeline(uint32_t index) { return m_ShadowPassPipelines[index]; }
 
@@ -36,6 +40,7 @@ namespace X2
 		DirectionalLightData m_data;
 
 		uint32_t m_resolution;
+		uint32_t m_FirstShadowView = 0;
 		Ref<VulkanPipeline> m_ShadowPassPipelines[4];
 		Ref<VulkanMaterial> m_ShadowPassMaterial;
 
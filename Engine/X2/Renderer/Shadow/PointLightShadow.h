@@ -2,6 +2,9 @@
 #define X2_POINTLIGHTSHADOW
 
 #include "X2/Renderer/Renderer.h"
+#include "X2/Renderer/DrawPacketList.h"
+#include "X2/Renderer/LightSelection.h"
+#include "X2/Renderer/Shadow/ShadowAtlas.h"
 #include "X2/Vulkan/VulkanPipeline.h"
 #include "X2/Vulkan/VulkanRenderpass.h"
 #include "X2/Vulkan/VulkanTexture.h"
@@ -13,23 +16,28 @@ namespace X2
 {
 	struct PointLightShadowData {
 		glm::mat4 ViewProjection[MAX_POINT_LIGHT_SHADOW_COUNT * 6];
+		// Atlas tile of each cube face, uv offset (xy) and scale (zw)
+		glm::vec4 AtlasRects[MAX_POINT_LIGHT_SHADOW_COUNT * 6];
 	};
 
 	class PointLightShadow
 	{
 	public:
-		PointLightShadow(uint32_t resolution);
+		// maxResolution is the face tile size of a light covering the whole screen
+		PointLightShadow(Ref<ShadowAtlas> atlas, uint32_t maxResolution);
 		~PointLightShadow() {}
 
-		void Update(const std::vector<PointLightInfo>& pointLightInfos);
+		// The first shadowCasterCount lights get shadow maps, see LightSelection. Each cube face gets an
+		// atlas tile sized by the light's coverage of the view.
+		void Update(const std::vector<PointLightInfo>& pointLightInfos, uint32_t shadowCasterCount, const LightSelectionView& view);
 
-		void RenderStaticShadow(Ref<VulkanRenderCommandBuffer> cb, Ref<VulkanUniformBufferSet> uniformBufferSet, std::map<MeshKey, StaticDrawCommand>& staticDrawList, std::map<MeshKey, TransformMapData>* curTransformMap, Ref<VulkanVertexBuffer> buffer);
+		// Registers one caster culling view per cube face of every active light
+		void AddShadowViews(DrawPacketList& drawList);
 
-		void FillTexturesToAtlas(Ref<VulkanRenderCommandBuffer> cb);
+		// Renders the face tiles whose light or casters changed since they were last rendered
+		void RenderStaticShadow(Ref<VulkanRenderCommandBuffer> cb, Ref<VulkanUniformBufferSet> uniformBufferSet, const DrawPacketList& drawList, Ref<VulkanVertexBuffer> buffer);
 
-		Ref<VulkanPipeline> GetPipeline(uint32_t index) { return m_ShadowPassPipelines[index]; }
-
-		Ref<VulkanImage2D> GetShadowCubemapAtlas() { return m_ShadowCubemapAtlas; }
+		Ref<VulkanPipeline> GetPipeline() { return m_ShadowPassPipeline; }
 
 		uint32_t GetResolution() { return m_resolution; }
 		PointLightShadowData& getData() { return m_data; }
@@ -38,13 +46,14 @@ namespace X2
 	private:
 		PointLightShadowData m_data;
 
+		Ref<ShadowAtlas> m_Atlas;
+		uint32_t m_TileHandles[MAX_POINT_LIGHT_SHADOW_COUNT * 6];
+
 		uint32_t m_resolution;
 		uint32_t m_activePointLightCount = 0;
-		
-		Ref<VulkanImage2D> m_ShadowCubemapAtlas;
-		Ref<VulkanImage2D> m_ShaodwArrays[MAX_POINT_LIGHT_SHADOW_COUNT];
-		Ref<VulkanPipeline> m_ShadowPassPipelines[MAX_POINT_LIGHT_SHADOW_COUNT * 6];
+		uint32_t m_FirstShadowView = 0;
 
+		Ref<VulkanPipeline> m_ShadowPassPipeline;
 		Ref<VulkanMaterial> m_ShadowPassMaterial;
 
 
@@ -0,0 +1,242 @@
+#include "ShadowAtlas.h"
+#include "X2/Vulkan/VulkanFramebuffer.h"
+
+#include <algorithm>
+
+namespace X2
+{
+
+	ShadowAtlas::ShadowAtlas(uint32_t size, uint32_t minTileSize, uint32_t maxTileSize)
+		:m_Size(size), m_MinTileSize(minTileSize), m_MaxTileSize(maxTileSize)
+	{
+		X2_CORE_ASSERT(minTileSize <= maxTileSize && maxTileSize <= size);
+		X2_CORE_ASSERT((size & (size - 1)) == 0 && (minTileSize & (minTileSize - 1)) == 0 && (maxTileSize & (maxTileSize - 1)) == 0, "Shadow atlas sizes must be powers of two");
+
+		m_FreeNodes.resize(GetLevel(minTileSize) + 1);
+		m_FreeNodes[0].push_back({ 0, 0 });
+
+		ImageSpecification spec;
+		spec.Format = ImageFormat::DEPTH32F;
+		spec.Usage = ImageUsage::Texture;
+		spec.Width = size;
+		spec.Height = size;
+		spec.DebugName = "Shadow Atlas";
+		m_Image = CreateRef<VulkanImage2D>(spec);
+		m_Image->Invalidate();
+
+		// Loads instead of clearing, only the tiles that are rendered in a frame are cleared
+		FramebufferSpecification framebufferSpec;
+		framebufferSpec.DebugName = "Shadow Atlas";
+		framebufferSpec.Width = size;
+		framebufferSpec.Height = size;
+		framebufferSpec.Attachments = { ImageFormat::DEPTH32F };
+		framebufferSpec.DepthClearValue = 1.0f;
+		framebufferSpec.ClearDepthOnLoad = false;
+		framebufferSpec.NoResize = true;
+		framebufferSpec.ExistingImages[0] = m_Image;
+
+		RenderPassSpecification renderPassSpec;
+		renderPassSpec.DebugName = framebufferSpec.DebugName;
+		renderPassSpec.TargetFramebuffer = CreateRef<VulkanFramebuffer>(framebufferSpec);
+		m_RenderPass = CreateRef<VulkanRenderPass>(renderPassSpec);
+	}
+
+	void ShadowAtlas::BeginFrame()
+	{
+		// Lights that got no tile have nothing cached, forget them once they are no longer requested
+		std::vector<uint32_t> emptyEntries;
+		for (const auto& [key, handle] : m_EntryByKey)
+		{
+			if (m_Entries[handle].Tile.Size == 0 && m_Entries[handle].LastUsedFrame < m_Frame)
+				emptyEntries.push_back(handle);
+		}
+		for (uint32_t handle : emptyEntries)
+			Release(handle);
+
+		m_Frame++;
+	}
+
+	uint32_t ShadowAtlas::RequestTile(uint32_t key, uint32_t size)
+	{
+		X2_CORE_ASSERT(size >= m_MinTileSize && size <= m_MaxTileSize && (size & (size - 1)) == 0);
+
+		auto it = m_EntryByKey.find(key);
+		if (it != m_EntryByKey.end())
+		{
+			const uint32_t handle = it->second;
+			Entry& entry = m_Entries[handle];
+
+			// Shrinking by one step keeps the cached tile, so a light on a size boundary doesn't re-render every frame
+			if (entry.RequestedSize == size || entry.RequestedSize == size * 2)
+			{
+				entry.LastUsedFrame = m_Frame;
+				if (entry.Tile.Size == 0)
+					Allocate(entry, entry.RequestedSize);
+				return handle;
+			}
+
+			Release(handle);
+		}
+
+		uint32_t handle;
+		if (!m_FreeEntries.empty())
+		{
+			handle = m_FreeEntries.back();
+			m_FreeEntries.pop_back();
+		}
+		else
+		{
+			handle = (uint32_t)m_Entries.size();
+			m_Entries.emplace_back();
+		}
+
+		Entry& entry = m_Entries[handle];
+		entry.Key = key;
+		entry.RequestedSize = size;
+		entry.LastUsedFrame = m_Frame;
+		m_EntryByKey[key] = handle;
+
+		Allocate(entry, size);
+		return handle;
+	}
+
+	bool ShadowAtlas::NeedsRender(uint32_t handle, uint64_t casterHash)
+	{
+		Entry& entry = m_Entries[handle];
+		if (entry.Tile.Size == 0 || (entry.Rendered && entry.CasterHash == casterHash))
+			return false;
+
+		entry.Rendered = true;
+		entry.CasterHash = casterHash;
+		return true;
+	}
+
+	glm::vec4 ShadowAtlas::GetTileRect(uint32_t handle) const
+	{
+		const ShadowAtlasTile& tile = m_Entries[handle].Tile;
+		return glm::vec4(tile.X, tile.Y, tile.Size, tile.Size) / (float)m_Size;
+	}
+
+	uint32_t ShadowAtlas::GetTileSize(float screenRadius, uint32_t maxTileSize) const
+	{
+		maxTileSize = glm::min(maxTileSize, m_MaxTileSize);
+		const float texels = glm::clamp(screenRadius, 0.0f, 1.0f) * maxTileSize;
+
+		uint32_t size = m_MinTileSize;
+		while (size < texels && size < maxTileSize)
+			size *= 2;
+		return size;
+	}
+
+	uint32_t ShadowAtlas::GetLevel(uint32_t size) const
+	{
+		uint32_t level = 0;
+		while ((m_Size >> level) > size)
+			level++;
+		return level;
+	}
+
+	bool ShadowAtlas::AllocateNode(uint32_t level, Node& outNode)
+	{
+		std::vector<Node>& freeNodes = m_FreeNodes[level];
+		if (!freeNodes.empty())
+		{
+			outNode = freeNodes.back();
+			freeNodes.pop_back();
+			return true;
+		}
+
+		if (level == 0)
+			return false;
+
+		// Split a node of the level above, the first quadrant is used and the other three become free
+		Node parent;
+		if (!AllocateNode(level - 1, parent))
+			return false;
+
+		const uint32_t childSize = m_Size >> level;
+		freeNodes.push_back({ parent.X + childSize, parent.Y + childSize });
+		freeNodes.push_back({ parent.X, parent.Y + childSize });
+		freeNodes.push_back({ parent.X + childSize, parent.Y });
+		outNode = parent;
+		return true;
+	}
+
+	void ShadowAtlas::FreeNode(uint32_t level, Node node)
+	{
+		std::vector<Node>& freeNodes = m_FreeNodes[level];
+		if (level > 0)
+		{
+			// Merge back into the parent once all four quadrants are free
+			const uint32_t parentMask = ~((m_Size >> (level - 1)) - 1);
+			const Node parent = { node.X & parentMask, node.Y & parentMask };
+			const auto isSibling = [&](const Node& other) { return (other.X & parentMask) == parent.X && (other.Y & parentMask) == parent.Y; };
+
+			if (std::count_if(freeNodes.begin(), freeNodes.end(), isSibling) == 3)
+			{
+				freeNodes.erase(std::remove_if(freeNodes.begin(), freeNodes.end(), isSibling), freeNodes.end());
+				FreeNode(level - 1, parent);
+				return;
+			}
+		}
+
+		freeNodes.push_back(node);
+	}
+
+	bool ShadowAtlas::Allocate(Entry& entry, uint32_t size)
+	{
+		entry.Tile = {};
+		entry.Rendered = false;
+
+		// Cached tiles of lights that are no longer requested go first, then the tile gets smaller
+		for (uint32_t tileSize = size; tileSize >= m_MinTileSize; tileSize /= 2)
+		{
+			const uint32_t level = GetLevel(tileSize);
+			do
+			{
+				Node node;
+				if (AllocateNode(level, node))
+				{
+					entry.Tile = { node.X, node.Y, tileSize };
+					return true;
+				}
+			} while (EvictUnused());
+		}
+
+		X2_CORE_TRACE_TAG("Renderer", "Shadow atlas is full, a light is rendered without shadows");
+		return false;
+	}
+
+	void ShadowAtlas::Release(uint32_t handle)
+	{
+		Entry& entry = m_Entries[handle];
+		if (entry.Tile.Size)
+			FreeNode(GetLevel(entry.Tile.Size), { entry.Tile.X, entry.Tile.Y });
+
+		m_EntryByKey.erase(entry.Key);
+		entry = {};
+		m_FreeEntries.push_back(handle);
+	}
+
+	bool ShadowAtlas::EvictUnused()
+	{
+		uint32_t evictHandle = UINT32_MAX;
+		uint64_t oldestFrame = m_Frame;
+		for (const auto& [key, handle] : m_EntryByKey)
+		{
+			const Entry& entry = m_Entries[handle];
+			if (entry.Tile.Size && entry.LastUsedFrame < oldestFrame)
+			{
+				oldestFrame = entry.LastUsedFrame;
+				evictHandle = handle;
+			}
+		}
+
+		if (evictHandle == UINT32_MAX)
+			return false;
+
+		Release(evictHandle);
+		return true;
+	}
+
+}
@@ -0,0 +1,106 @@
+#ifndef X2_SHADOWATLAS
+#define X2_SHADOWATLAS
+
+#include "X2/Core/Hash.h"
+#include "X2/Vulkan/VulkanImage.h"
+#include "X2/Vulkan/VulkanRenderpass.h"
+
+#include <unordered_map>
+
+
+namespace X2
+{
+	struct ShadowAtlasTile
+	{
+		// Texels in the atlas, Size is 0 when the atlas had no room left
+		uint32_t X = 0;
+		uint32_t Y = 0;
+		uint32_t Size = 0;
+	};
+
+	//
+	// One depth texture shared by the spot and point light shadow maps. Every shadow map is a square,
+	// power of two tile handed out by a quadtree allocator, sized by how much of the screen its light
+	// covers. Tiles are keyed by the light parameters that shape the shadow map (position, direction,
+	// range, ...) and survive between frames, so a light that didn't change keeps its tile and, as long
+	// as its casters didn't change either, its rendered depth. Tiles that are not requested in a frame
+	// stay cached until their space is needed by another light.
+	//
+	class ShadowAtlas
+	{
+	public:
+		ShadowAtlas(uint32_t size, uint32_t minTileSize, uint32_t maxTileSize);
+		~ShadowAtlas() {}
+
+		// Starts a frame, tiles requested in the previous frame become evictable
+		void BeginFrame();
+
+		// Returns the handle of the tile for key, reusing its cached tile when possible. If the atlas is full
+		// the tile gets smaller, down to the minimum tile size, after which the handle gets an empty tile.
+		uint32_t RequestTile(uint32_t key, uint32_t size);
+
+		// Records the caster hash the tile is rendered with, returns false if its depth is already up to date
+		bool NeedsRender(uint32_t handle, uint64_t casterHash);
+
+		const ShadowAtlasTile& GetTile(uint32_t handle) const { return m_Entries[handle].Tile; }
+		// UV offset (xy) and scale (zw) of a tile, zero for an empty tile
+		glm::vec4 GetTileRect(uint32_t handle) const;
+
+		// Maps the screen radius of a light (0..1, see LightSelection) to a tile size
+		uint32_t GetTileSize(float screenRadius, uint32_t maxTileSize) const;
+
+		uint32_t GetSize() const { return m_Size; }
+		uint32_t GetMaxTileSize() const { return m_MaxTileSize; }
+		Ref<VulkanImage2D> GetImage() { return m_Image; }
+		Ref<VulkanRenderPass> GetRenderPass() { return m_RenderPass; }
+
+		template<typename T>
+		static uint32_t GetTileKey(const T& lightParameters)
+		{
+			return Hash::GenerateFNVHash(std::string_view((const char*)&lightParameters, sizeof(T)));
+		}
+
+	private:
+		struct Node
+		{
+			uint32_t X, Y;
+		};
+
+		struct Entry
+		{
+			uint32_t Key = 0;
+			uint32_t RequestedSize = 0;
+			ShadowAtlasTile Tile;
+			uint64_t CasterHash = 0;
+			uint64_t LastUsedFrame = 0;
+			bool Rendered = false;
+		};
+
+		uint32_t GetLevel(uint32_t size) const;
+		bool AllocateNode(uint32_t level, Node& outNode);
+		void FreeNode(uint32_t level, Node node);
+		bool Allocate(Entry& entry, uint32_t size);
+		void Release(uint32_t handle);
+		bool EvictUnused();
+
+	private:
+		uint32_t m_Size;
+		uint32_t m_MinTileSize;
+		uint32_t m_MaxTileSize;
+		uint64_t m_Frame = 1;
+
+		// Free nodes per quadtree level, level 0 is the whole atlas
+		std::vector<std::vector<Node>> m_FreeNodes;
+
+		std::vector<Entry> m_Entries;
+		std::vector<uint32_t> m_FreeEntries;
+		std::unordered_map<uint32_t, uint32_t> m_EntryByKey;
+
+		Ref<VulkanImage2D> m_Image;
+		Ref<VulkanRenderPass> m_RenderPass;
+	};
+
+}
+
+
+#endif
@@ -5,8 +5,21 @@
 namespace X2
 {
 
-	SpotLightShadow::SpotLightShadow(uint32_t resolution)
-		:m_resolution(resolution)
+	namespace Utils {
+
+		// Everything that shapes a spot light's shadow map, lights with the same parameters share a tile
+		struct SpotShadowTileKey
+		{
+			glm::vec3 Position;
+			glm::vec3 Direction;
+			float Range;
+			float Angle;
+		};
+
+	}
+
+	SpotLightShadow::SpotLightShadow(Ref<ShadowAtlas> atlas, uint32_t maxResolution)
+		:m_Atlas(atlas), m_resolution(maxResolution)
 	{
 		VertexBufferLayout vertexLayout = {
 			{ ShaderDataType::Float3, "a_Position" },
@@ -26,98 +39,87 @@ namespace X2
 			{ ShaderDataType::Float4, "a_MRowPrev2" },
 		};
 
-
-		ImageSpecification spec;
-		spec.Format = ImageFormat::DEPTH32F;
-		spec.Type = ImageType::Image2DArray;
-		spec.Usage = ImageUsage::Attachment;
-		spec.Width = resolution;
-		spec.Height = resolution;
-		spec.Layers = MAX_SPOT_LIGHT_SHADOW_COUNT;
-		spec.DebugName = "Spot Shadows";
-		Ref<VulkanImage2D> cascadedDepthImage = CreateRef<VulkanImage2D>(spec);
-		cascadedDepthImage->Invalidate();
-		cascadedDepthImage->CreatePerLayerImageViews();
-
-
-		FramebufferSpecification shadowMapFramebufferSpec;
-		shadowMapFramebufferSpec.DebugName = "Spot Shadow Map";
-		shadowMapFramebufferSpec.Width = resolution;
-		shadowMapFramebufferSpec.Height = resolution;
-		shadowMapFramebufferSpec.Attachments = { ImageFormat::DEPTH32F };
-		shadowMapFramebufferSpec.ClearColor = { 0.0f, 0.0f, 0.0f, 0.0f };
-		shadowMapFramebufferSpec.DepthClearValue = 1.0f;
-		shadowMapFramebufferSpec.NoResize = true;
-		shadowMapFramebufferSpec.ExistingImage = cascadedDepthImage;
-
 		auto shadowPassShader = Renderer::GetShaderLibrary()->Get("SpotShadowMap");
 		auto shadowPassShaderAnim = Renderer::GetShaderLibrary()->Get("SpotShadowMap_Anim");
 
 
+		// Every light renders into its own tile of the atlas, the tile is picked with the viewport
 		PipelineSpecification pipelineSpec;
 		pipelineSpec.DebugName = "SpotShadowPass";
 		pipelineSpec.Shader = shadowPassShader;
 		pipelineSpec.DepthOperator = DepthCompareOperator::LessOrEqual;
 		pipelineSpec.Layout = vertexLayout;
 		pipelineSpec.InstanceLayout = instanceLayout;
+		pipelineSpec.RenderPass = m_Atlas->GetRenderPass();
+		m_ShadowPassPipeline = CreateRef<VulkanPipeline>(pipelineSpec);
 
-
-		// 15 shadows
-		for (int i = 0; i < MAX_SPOT_LIGHT_SHADOW_COUNT; i++)
-		{
-			shadowMapFramebufferSpec.ExistingImageLayers.clear();
-			shadowMapFramebufferSpec.ExistingImageLayers.emplace_back(i);
-
-			RenderPassSpecification shadowMapRenderPassSpec;
-			shadowMapRenderPassSpec.DebugName = shadowMapFramebufferSpec.DebugName;
-			shadowMapRenderPassSpec.TargetFramebuffer = CreateRef<VulkanFramebuffer>(shadowMapFramebufferSpec);
-			auto renderpass = CreateRef<VulkanRenderPass>(shadowMapRenderPassSpec);
-
-			pipelineSpec.RenderPass = renderpass;
-			m_ShadowPassPipelines[i] = CreateRef<VulkanPipeline>(pipelineSpec);
-		}
 		m_ShadowPassMaterial = CreateRef<VulkanMaterial>(shadowPassShader, "SpotShadowPass");
 	}
 
 
-	void SpotLightShadow::Update(const std::vector<SpotLightInfo>& spotLightInfos)
+	void SpotLightShadow::Update(const std::vector<SpotLightInfo>& spotLightInfos, uint32_t shadowCasterCount, const LightSelectionView& view)
 	{
-		X2_ASSERT(spotLightInfos.size() <= MAX_SPOT_LIGHT_SHADOW_COUNT, "Now Only Supports max 15 spotLight Shadow");
-		m_activeSpotLightCount = spotLightInfos.size();
-		for (size_t i = 0; i < spotLightInfos.size(); ++i)
+		X2_CORE_ASSERT(shadowCasterCount <= MAX_SPOT_LIGHT_SHADOW_COUNT && shadowCasterCount <= spotLightInfos.size());
+		m_activeSpotLightCount = shadowCasterCount;
+		for (size_t i = 0; i < shadowCasterCount; ++i)
 		{
 			auto& light = spotLightInfos[i];
-			if (!light.CastsShadows)
-				continue;
 
 			glm::mat4 projection = glm::perspective(glm::radians(light.Angle), 1.f, 0.1f, light.Range);
 
 			m_data.ViewProjection[i] = projection * glm::lookAt(light.Position, light.Position - light.Direction, glm::vec3(0.0f, 1.0f, 0.0f));
+
+			const uint32_t tileSize = m_Atlas->GetTileSize(LightSelection::GetScreenRadius(light.Position, light.Range, view), m_resolution);
+			m_TileHandles[i] = m_Atlas->RequestTile(ShadowAtlas::GetTileKey(Utils::SpotShadowTileKey{ light.Position, light.Direction, light.Range, light.Angle }), tileSize);
+			m_data.AtlasRects[i] = m_Atlas->GetTileRect(m_TileHandles[i]);
 		}
 	}
 
 
 
-	void SpotLightShadow::RenderStaticShadow(Ref<VulkanRenderCommandBuffer> cb, Ref<VulkanUniformBufferSet> uniformBufferSet, std::map<MeshKey, StaticDrawCommand>& staticDrawList, std::map<MeshKey, TransformMapData>* curTransformMap, Ref<VulkanVertexBuffer> buffer)
+	void SpotLightShadow::AddShadowViews(DrawPacketList& drawList)
 	{
+		for (uint32_t i = 0; i < m_activeSpotLightCount; i++)
+		{
+			Volume::Frustum frustum;
+			frustum.SetFromViewProjection(m_data.ViewProjection[i]);
 
-		for (int i = 0; i < m_activeSpotLightCount; i++)
+			const uint32_t viewIndex = drawList.AddShadowView(frustum);
+			if (i == 0)
+				m_FirstShadowView = viewIndex;
+		}
+	}
+
+	void SpotLightShadow::RenderStaticShadow(Ref<VulkanRenderCommandBuffer> cb, Ref<VulkanUniformBufferSet> uniformBufferSet, const DrawPacketList& drawList, Ref<VulkanVertexBuffer> buffer)
+	{
+		bool renderPassStarted = false;
+		for (uint32_t i = 0; i < m_activeSpotLightCount; i++)
 		{
-			Renderer::BeginRenderPass(cb, m_ShadowPassPipelines[i]->GetSpecification().RenderPass);
+			const uint32_t viewIndex = m_FirstShadowView + i;
+			if (!m_Atlas->NeedsRender(m_TileHandles[i], drawList.GetShadowCasterHash(viewIndex)))
+				continue;
+
+			if (!renderPassStarted)
+			{
+				Renderer::BeginRenderPass(cb, m_Atlas->GetRenderPass());
+				renderPassStarted = true;
+			}
 
-			// static glm::mat4 scaleBiasMatrix = glm::scale(glm::mat4(1.0f), { 0.5f, 0.5f, 0.5f }) * glm::translate(glm::mat4(1.0f), { 1, 1, 1 });
+			const ShadowAtlasTile& tile = m_Atlas->GetTile(m_TileHandles[i]);
+			Renderer::SetRenderArea(cb, tile.X, tile.Y, tile.Size, tile.Size);
+			Renderer::ClearDepthArea(cb, tile.X, tile.Y, tile.Size, tile.Size);
 
 			// Render entities
 			const Buffer lightIndex(&i, sizeof(uint32_t));
-			for (auto& [mk, dc] : staticDrawList)
+			for (const DrawBatch& batch : drawList.GetShadowBatches(viewIndex, DrawPipeline::Static))
 			{
-				X2_CORE_VERIFY(curTransformMap->find(mk) != curTransformMap->end());
-				const auto& transformData = curTransformMap->at(mk);
-				Renderer::RenderStaticMeshWithMaterial(cb, m_ShadowPassPipelines[i], uniformBufferSet, nullptr, dc.StaticMesh, dc.SubmeshIndex, buffer, transformData.TransformOffset, dc.InstanceCount, m_ShadowPassMaterial, lightIndex);
+				const DrawSource& source = drawList.GetSource(batch);
+				Renderer::RenderStaticMeshWithMaterial(cb, m_ShadowPassPipeline, uniformBufferSet, nullptr, source.StaticMesh, source.SubmeshIndex, buffer, batch.TransformOffset, batch.InstanceCount, m_ShadowPassMaterial, lightIndex);
 			}
+		}
 
+		if (renderPassStarted)
 			Renderer::EndRenderPass(cb);
-		}
 	}
 
 
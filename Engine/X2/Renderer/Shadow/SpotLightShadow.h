@@ -2,6 +2,9 @@
 #define X2_SPOTLIGHTSHADOW
 
 #include "X2/Renderer/Renderer.h"
+#include "X2/Renderer/DrawPacketList.h"
+#include "X2/Renderer/LightSelection.h"
+#include "X2/Renderer/Shadow/ShadowAtlas.h"
 #include "X2/Vulkan/VulkanPipeline.h"
 #include "X2/Vulkan/VulkanRenderpass.h"
 #include "X2/Vulkan/VulkanTexture.h"
@@ -14,20 +17,29 @@ namespace X2
 {
 	struct SpotLightShadowData {
 		glm::mat4 ViewProjection[MAX_SPOT_LIGHT_SHADOW_COUNT];
+		// Atlas tile of each light, uv offset (xy) and scale (zw)
+		glm::vec4 AtlasRects[MAX_SPOT_LIGHT_SHADOW_COUNT];
 	};
 
 
 	class SpotLightShadow
 	{
 	public:
-		SpotLightShadow(uint32_t resolution);
+		// maxResolution is the tile size of a light covering the whole screen
+		SpotLightShadow(Ref<ShadowAtlas> atlas, uint32_t maxResolution);
 		~SpotLightShadow() {}
 
-		void Update(const std::vector<SpotLightInfo>& spotLightInfos);
+		// The first shadowCasterCount lights get shadow maps, see LightSelection. Each one gets an atlas tile
+		// sized by its coverage of the view.
+		void Update(const std::vector<SpotLightInfo>& spotLightInfos, uint32_t shadowCasterCount, const LightSelectionView& view);
 
-		void RenderStaticShadow(Ref<VulkanRenderCommandBuffer> cb, Ref<VulkanUniformBufferSet> uniformBufferSet, std::map<MeshKey, StaticDrawCommand>& staticDrawList, std::map<MeshKey, TransformMapData>* curTransformMap, Ref<VulkanVertexBuffer> buffer);
+		// Registers one caster culling view per active light, its frustum bounds the cone
+		void AddShadowViews(DrawPacketList& drawList);
 
-		Ref<VulkanPipeline> GetPipeline(uint32_t index) { return m_ShadowPassPipelines[index]; }
+		// Renders the tiles whose light or casters changed since they were last rendered
+		void RenderStaticShadow(Ref<VulkanRenderCommandBuffer> cb, Ref<VulkanUniformBufferSet> uniformBufferSet, const DrawPacketList& drawList, Ref<VulkanVertexBuffer> buffer);
+
+		Ref<VulkanPipeline> GetPipeline() { return m_ShadowPassPipeline; }
 
 		uint32_t GetResolution() { return m_resolution; }
 		SpotLightShadowData& getData() { return m_data; }
@@ -35,9 +47,13 @@ namespace X2
 	private:
 		SpotLightShadowData m_data;
 
+		Ref<ShadowAtlas> m_Atlas;
+		uint32_t m_TileHandles[MAX_SPOT_LIGHT_SHADOW_COUNT];
+
 		uint32_t m_resolution;
 		uint32_t m_activeSpotLightCount = 0;
-		Ref<VulkanPipeline> m_ShadowPassPipelines[MAX_SPOT_LIGHT_SHADOW_COUNT];
+		uint32_t m_FirstShadowView = 0;
+		Ref<VulkanPipeline> m_ShadowPassPipeline;
 		Ref<VulkanMaterial> m_ShadowPassMaterial;
 
 	};
@@ -6,6 +6,7 @@
 #include "X2/Project/Project.h"
 #include "X2/Utilities/FileSystem.h"
 #include "X2/Asset/AssetManager.h"
+#include "X2/Core/JobSystem.h"
 
 namespace X2 {
 
@@ -37,7 +38,6 @@ namespace X2 {
 #define DEFAULT_MITER_LIMIT 1.0
 #define LCG_MULTIPLIER 6364136223846793005ull
 #define LCG_INCREMENT 1442695040888963407ull
-#define THREADS 8
 
 	namespace Utils {
 
@@ -100,7 +100,8 @@ namespace X2 {
 	{
 		msdf_atlas::ImmediateAtlasGenerator<S, N, GEN_FN, msdf_atlas::BitmapAtlasStorage<T, N>> generator(config.width, config.height);
 		generator.setAttributes(config.generatorAttributes);
-		generator.setThreadCount(THREADS);
+		// The generator runs its own threads, as many as the job system has workers plus this thread
+		generator.setThreadCount((int)JobSystem::GetWorkerCount() + 1);
 		generator.generate(glyphs.data(), (int)glyphs.size());
 
 		msdfgen::BitmapConstRef<T, N> bitmap = (msdfgen::BitmapConstRef<T, N>) generator.atlasStorage();
@@ -313,12 +314,14 @@ namespace X2 {
 		{
 			if (config.expensiveColoring)
 			{
-				msdf_atlas::Workload([&glyphs = m_MSDFData->Glyphs, &config](int i, int threadNo) -> bool
+				JobSystem::ParallelFor((uint32_t)m_MSDFData->Glyphs.size(), 16, [&glyphs = m_MSDFData->Glyphs, &config](uint32_t begin, uint32_t end)
 					{
-						unsigned long long glyphSeed = (LCG_MULTIPLIER * (config.coloringSeed ^ i) + LCG_INCREMENT) * !!config.coloringSeed;
-						glyphs[i].edgeColoring(config.edgeColoring, config.angleThreshold, glyphSeed);
-						return true;
-					}, (int)m_MSDFData->Glyphs.size()).finish(THREADS);
+						for (uint32_t i = begin; i < end; i++)
+						{
+							unsigned long long glyphSeed = (LCG_MULTIPLIER * (config.coloringSeed ^ i) + LCG_INCREMENT) * !!config.coloringSeed;
+							glyphs[i].edgeColoring(config.edgeColoring, config.angleThreshold, glyphSeed);
+						}
+					});
 			}
 			else
 			{
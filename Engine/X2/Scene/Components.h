@@ -146,6 +146,21 @@ namespace X2 {
 		friend class SceneSerializer;
 	};
 
+	// Runtime cache of an entity's world space transform, maintained by Scene::UpdateWorldTransforms().
+	// Not serialized or copied, the scene adds it to every entity when it rebuilds its transform hierarchy.
+	struct WorldTransformComponent
+	{
+		glm::mat4 Transform = glm::mat4(1.0f);
+
+		// Local TRS and parent the cached transform was built from, compared every frame to detect changes
+		glm::vec3 LocalTranslation = { 0.0f, 0.0f, 0.0f };
+		glm::quat LocalRotation = { 1.0f, 0.0f, 0.0f, 0.0f };
+		glm::vec3 LocalScale = { 1.0f, 1.0f, 1.0f };
+		UUID ParentHandle = 0;
+
+		bool Dirty = true;
+	};
+
 	struct MeshComponent
 	{
 		AssetHandle Mesh;
@@ -52,6 +52,21 @@ namespace X2 {
 
 	namespace Utils {
 		glm::mat4 Mat4FromAIMatrix4x4(const aiMatrix4x4& matrix);
+
+		// Meshes in front of the camera stream first, then the ones larger on screen.
+		// Bounds are unknown until the mesh is loaded, so the transform scale stands in for its size
+		static float GetStreamingPriority(const glm::mat4& viewProjection, const glm::vec3& cameraPosition, const glm::mat4& transform)
+		{
+			glm::vec3 position = transform[3];
+			float size = glm::max(glm::length(glm::vec3(transform[0])), glm::max(glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2]))));
+			float distance = glm::max(glm::distance(position, cameraPosition), 0.001f);
+			float screenSize = glm::min(size / distance, 0.99f);
+
+			glm::vec4 clip = viewProjection * glm::vec4(position, 1.0f);
+			float extent = clip.w + size;
+			bool visible = clip.w > -size && glm::abs(clip.x) <= extent && glm::abs(clip.y) <= extent;
+			return visible ? 1.0f + screenSize : screenSize;
+		}
 	}
 
 	/*struct PhysicsSceneComponent
@@ -78,6 +93,16 @@ namespace X2 {
 		m_Registry.emplace<SceneComponent>(m_SceneEntity, m_SceneID);
 		s_ActiveScenes[m_SceneID] = this;
 
+		m_Registry.on_construct<IDComponent>().connect<&Scene::OnEntityHierarchyChanged>(this);
+		m_Registry.on_destroy<IDComponent>().connect<&Scene::OnEntityHierarchyChanged>(this);
+
+		m_Registry.on_construct<MeshComponent>().connect<&Scene::OnMeshComponentChanged>(this);
+		m_Registry.on_update<MeshComponent>().connect<&Scene::OnMeshComponentChanged>(this);
+		m_Registry.on_destroy<MeshComponent>().connect<&Scene::OnMeshComponentChanged>(this);
+		m_Registry.on_construct<StaticMeshComponent>().connect<&Scene::OnMeshComponentChanged>(this);
+		m_Registry.on_update<StaticMeshComponent>().connect<&Scene::OnMeshComponentChanged>(this);
+		m_Registry.on_destroy<StaticMeshComponent>().connect<&Scene::OnMeshComponentChanged>(this);
+
 		if (!initalize)
 			return;
 
@@ -329,6 +354,8 @@ namespace X2 {
 	{
 		X2_PROFILE_FUNC();
 
+		UpdateWorldTransforms();
+
 		/////////////////////////////////////////////////////////////////////
 		// RENDER 3D SCENE
 		/////////////////////////////////////////////////////////////////////
@@ -336,7 +363,7 @@ namespace X2 {
 		if (!cameraEntity)
 			return;
 
-		glm::mat4 cameraViewMatrix = glm::inverse(GetWorldSpaceTransformMatrix(cameraEntity));
+		glm::mat4 cameraViewMatrix = glm::inverse(GetCachedWorldSpaceTransformMatrix(cameraEntity));
 		X2_CORE_ASSERT(cameraEntity, "Scene does not contain any cameras!");
 		SceneCamera& camera = cameraEntity.GetComponent<CameraComponent>();
 		camera.SetViewportSize(m_ViewportWidth, m_ViewportHeight);
@@ -371,9 +398,9 @@ namespace X2 {
 					{
 						Entity entity(e, this);
 						auto [transformComponent, lightComponent] = pointLights.get<TransformComponent, PointLightComponent>(e);
-						auto transform = GetWorldSpaceTransform(entity);
+						glm::mat4 transform = GetCachedWorldSpaceTransformMatrix(entity);
 						m_LightEnvironment.PointLights[pointLightIndex++] = {
-							transform.Translation,
+							glm::vec3(transform[3]),
 							lightComponent.Intensity,
 							lightComponent.Radiance,
 							lightComponent.MinRadius,
@@ -393,7 +420,7 @@ namespace X2 {
 					{
 						Entity entity(e, this);
 						auto [transformComponent, lightComponent] = spotLights.get<TransformComponent, SpotLightComponent>(e);
-						auto transform = GetWorldSpaceTransform(entity);
+						glm::mat4 transform = GetCachedWorldSpaceTransformMatrix(entity);
 						glm::vec3 direction = glm::normalize(lightComponent.Direction);
 
 						glm::mat4 projection = glm::perspective(glm::radians(lightComponent.Angle), 1.f, 0.1f, lightComponent.Range);
@@ -419,7 +446,7 @@ namespace X2 {
 						}
 
 						m_LightEnvironment.SpotLights[spotLightIndex++] = {
-							transform.Translation,
+							glm::vec3(transform[3]),
 							lightComponent.Intensity,
 							{
 							glm::vec4(corners[0].x, corners[0].y, corners[0].z, 1.0f),
@@ -476,6 +503,9 @@ namespace X2 {
 		renderer->SetScene(this);
 		renderer->BeginScene({ camera, cameraViewMatrix, camera.GetPerspectiveNearClip(), camera.GetPerspectiveFarClip(), camera.GetRadPerspectiveVerticalFOV() });
 
+		const glm::mat4 viewProjection = camera.GetProjectionMatrix() * cameraViewMatrix;
+		const glm::vec3 cameraPosition = glm::inverse(cameraViewMatrix)[3];
+
 		// Render Static Meshes
 		{
 			auto group = m_Registry.group<StaticMeshComponent>(entt::get<TransformComponent>);
@@ -488,12 +518,13 @@ namespace X2 {
 
 				if (AssetManager::IsAssetHandleValid(staticMeshComponent.StaticMesh))
 				{
-					Ref<StaticMesh> staticMesh = AssetManager::GetAsset<StaticMesh>(staticMeshComponent.StaticMesh);
+					Entity e = Entity(entity, this);
+					glm::mat4 transform = GetCachedWorldSpaceTransformMatrix(e);
+
+					// Streamed in the background, not drawn until it arrives
+					Ref<StaticMesh> staticMesh = AssetManager::GetAssetAsync<StaticMesh>(staticMeshComponent.StaticMesh, Utils::GetStreamingPriority(viewProjection, cameraPosition, transform));
 					if (staticMesh && !staticMesh->IsFlagSet(AssetFlag::Missing))
 					{
-						Entity e = Entity(entity, this);
-						glm::mat4 transform = GetWorldSpaceTransformMatrix(e);
-						
 						renderer->SubmitStaticMesh(e.GetUUID(),staticMesh, staticMeshComponent.MaterialTable, transform);
 					}
 				}
@@ -512,11 +543,12 @@ namespace X2 {
 
 				if (AssetManager::IsAssetHandleValid(meshComponent.Mesh))
 				{
-					Ref<Mesh> mesh = AssetManager::GetAsset<Mesh>(meshComponent.Mesh);
+					Entity e = Entity(entity, this);
+					glm::mat4 transform = GetCachedWorldSpaceTransformMatrix(e);
+
+					Ref<Mesh> mesh = AssetManager::GetAssetAsync<Mesh>(meshComponent.Mesh, Utils::GetStreamingPriority(viewProjection, cameraPosition, transform));
 					if (mesh && !mesh->IsFlagSet(AssetFlag::Missing))
 					{
-						Entity e = Entity(entity, this);
-						glm::mat4 transform = GetWorldSpaceTransformMatrix(e);
 						renderer->SubmitMesh(e.GetUUID(), mesh, meshComponent.SubmeshIndex, meshComponent.MaterialTable, transform);
 						//renderer->SubmitMesh(mesh, meshComponent.SubmeshIndex, meshComponent.MaterialTable, transform, GetModelSpaceBoneTransforms(meshComponent.BoneEntityIds, mesh));
 					}
@@ -546,13 +578,13 @@ namespace X2 {
 						if (AssetManager::IsAssetHandleValid(spriteRendererComponent.Texture))
 						{
 							Ref<VulkanTexture2D> texture = AssetManager::GetAsset<VulkanTexture2D>(spriteRendererComponent.Texture);
-							renderer2D->DrawQuad(GetWorldSpaceTransformMatrix(e), texture, spriteRendererComponent.TilingFactor,
+							renderer2D->DrawQuad(GetCachedWorldSpaceTransformMatrix(e), texture, spriteRendererComponent.TilingFactor,
 								spriteRendererComponent.Color, spriteRendererComponent.UVStart, spriteRendererComponent.UVEnd);
 						}
 					}
 					else
 					{
-						renderer2D->DrawQuad(GetWorldSpaceTransformMatrix(e), spriteRendererComponent.Color);
+						renderer2D->DrawQuad(GetCachedWorldSpaceTransformMatrix(e), spriteRendererComponent.Color);
 					}
 				}
 				auto group = m_Registry.group<TransformComponent>(entt::get<TextComponent>);
@@ -561,7 +593,7 @@ namespace X2 {
 					auto [transformComponent, textComponent] = group.get<TransformComponent, TextComponent>(entity);
 					Entity e = Entity(entity, this);
 					auto font = Font::GetFontAssetForTextComponent(textComponent);
-					renderer2D->DrawString(textComponent.TextString, font, GetWorldSpaceTransformMatrix(e), textComponent.MaxWidth, textComponent.Color, textComponent.LineSpacing, textComponent.Kerning);
+					renderer2D->DrawString(textComponent.TextString, font, GetCachedWorldSpaceTransformMatrix(e), textComponent.MaxWidth, textComponent.Color, textComponent.LineSpacing, textComponent.Kerning);
 				}
 			}
 
@@ -591,6 +623,8 @@ namespace X2 {
 	{
 		X2_PROFILE_FUNC();
 
+		UpdateWorldTransforms();
+
 		/////////////////////////////////////////////////////////////////////
 		// RENDER 3D SCENE
 		/////////////////////////////////////////////////////////////////////
@@ -627,9 +661,9 @@ namespace X2 {
 				for (auto entity : pointLights)
 				{
 					auto [transformComponent, lightComponent] = pointLights.get<TransformComponent, PointLightComponent>(entity);
-					auto transform = GetWorldSpaceTransform(Entity(entity, this));
+					glm::mat4 transform = GetCachedWorldSpaceTransformMatrix(Entity(entity, this));
 					m_LightEnvironment.PointLights[pointLightIndex++] = {
-						transform.Translation,
+						glm::vec3(transform[3]),
 						lightComponent.Intensity,
 						lightComponent.Radiance,
 						lightComponent.MinRadius,
@@ -650,11 +684,11 @@ namespace X2 {
 				for (auto entity : fogVolumes)
 				{
 					auto [transformComponent, fogVolumeComponent] = fogVolumes.get<TransformComponent, FogVolumeComponent>(entity);
-					auto transform = GetWorldSpaceTransform(Entity(entity, this));
+					glm::mat4 transform = GetCachedWorldSpaceTransformMatrix(Entity(entity, this));
 					m_FogVolumes[fogIndex++] = {
-						transform.Translation,
+						glm::vec3(transform[3]),
 						fogVolumeComponent.fogDensity,
-						glm::inverse(transform.GetTransform())
+						glm::inverse(transform)
 					};
 
 				}
@@ -669,7 +703,7 @@ namespace X2 {
 				{
 					Entity entity(e, this);
 					auto [transformComponent, lightComponent] = spotLights.get<TransformComponent, SpotLightComponent>(e);
-					auto transform = GetWorldSpaceTransform(entity);
+					glm::mat4 transform = GetCachedWorldSpaceTransformMatrix(entity);
 					glm::vec3 direction = glm::normalize(lightComponent.Direction);
 
 					glm::mat4 projection = glm::perspective(glm::radians(lightComponent.Angle), 1.f, 0.1f, lightComponent.Range);
@@ -694,7 +728,7 @@ namespace X2 {
 					}
 
 					m_LightEnvironment.SpotLights[spotLightIndex++] = {
-						transform.Translation,
+						glm::vec3(transform[3]),
 						lightComponent.Intensity,
 						{					
 							glm::vec4(corners[0].x, corners[0].y, corners[0].z, 1.0f),
@@ -749,6 +783,9 @@ namespace X2 {
 		renderer->SetScene(this);
 		renderer->BeginScene({ editorCamera, editorCamera.GetViewMatrix(), editorCamera.GetNearClip(), editorCamera.GetFarClip(), editorCamera.GetVerticalFOV() });
 
+		const glm::mat4 viewProjection = editorCamera.GetViewProjection();
+		const glm::vec3 cameraPosition = editorCamera.GetPosition();
+
 		// Render Static Meshes
 		{
 			auto group = m_Registry.group<StaticMeshComponent>(entt::get<TransformComponent>);
@@ -758,12 +795,13 @@ namespace X2 {
 				if (!staticMeshComponent.Visible)
 					continue;
 
-				auto staticMesh = AssetManager::GetAsset<StaticMesh>(staticMeshComponent.StaticMesh);
+				Entity e = Entity(entity, this);
+				glm::mat4 transform = GetCachedWorldSpaceTransformMatrix(e);
+
+				// Streamed in the background, not drawn until it arrives
+				Ref<StaticMesh> staticMesh = AssetManager::GetAssetAsync<StaticMesh>(staticMeshComponent.StaticMesh, Utils::GetStreamingPriority(viewProjection, cameraPosition, transform));
 				if (staticMesh && !staticMesh->IsFlagSet(AssetFlag::Missing))
 				{
-					Entity e = Entity(entity, this);
-					glm::mat4 transform = GetWorldSpaceTransformMatrix(e);
-
 					uint64_t entityUUID = e.GetUUID();
 					if (SelectionManager::IsEntityOrAncestorSelected(e))
 						renderer->SubmitSelectedStaticMesh(entityUUID, staticMesh, staticMeshComponent.MaterialTable, transform);
@@ -782,12 +820,12 @@ namespace X2 {
 				if (!meshComponent.Visible)
 					continue;
 
-				auto mesh = AssetManager::GetAsset<Mesh>(meshComponent.Mesh);
+				Entity e = Entity(entity, this);
+				glm::mat4 transform = GetCachedWorldSpaceTransformMatrix(e);
+
+				Ref<Mesh> mesh = AssetManager::GetAssetAsync<Mesh>(meshComponent.Mesh, Utils::GetStreamingPriority(viewProjection, cameraPosition, transform));
 				if (mesh && !mesh->IsFlagSet(AssetFlag::Missing))
 				{
-					Entity e = Entity(entity, this);
-					glm::mat4 transform = GetWorldSpaceTransformMatrix(e);
-
 					// TODO: Should we render (logically)
 					if (SelectionManager::IsEntityOrAncestorSelected(e))
 						renderer->SubmitSelectedMesh(e.GetUUID(), mesh, meshComponent.SubmeshIndex, meshComponent.MaterialTable, transform);
@@ -823,12 +861,12 @@ namespace X2 {
 						if (AssetManager::IsAssetHandleValid(spriteRendererComponent.Texture))
 						{
 							Ref<VulkanTexture2D> texture = AssetManager::GetAsset<VulkanTexture2D>(spriteRendererComponent.Texture);
-							renderer2D->DrawQuad(GetWorldSpaceTransformMatrix(e), texture, spriteRendererComponent.TilingFactor, spriteRendererComponent.Color, spriteRendererComponent.UVStart, spriteRendererComponent.UVEnd);
+							renderer2D->DrawQuad(GetCachedWorldSpaceTransformMatrix(e), texture, spriteRendererComponent.TilingFactor, spriteRendererComponent.Color, spriteRendererComponent.UVStart, spriteRendererComponent.UVEnd);
 						}
 					}
 					else
 					{
-						renderer2D->DrawQuad(GetWorldSpaceTransformMatrix(e), spriteRendererComponent.Color);
+						renderer2D->DrawQuad(GetCachedWorldSpaceTransformMatrix(e), spriteRendererComponent.Color);
 					}
 				}
 			}
@@ -839,7 +877,7 @@ namespace X2 {
 					auto [transformComponent, textComponent] = group.get<TransformComponent, TextComponent>(entity);
 					Entity e = Entity(entity, this);
 					auto font = Font::GetFontAssetForTextComponent(textComponent);
-					renderer2D->DrawString(textComponent.TextString, font, GetWorldSpaceTransformMatrix(e), textComponent.MaxWidth, textComponent.Color, textComponent.LineSpacing, textComponent.Kerning);
+					renderer2D->DrawString(textComponent.TextString, font, GetCachedWorldSpaceTransformMatrix(e), textComponent.MaxWidth, textComponent.Color, textComponent.LineSpacing, textComponent.Kerning);
 				}
 			}
 
@@ -2583,6 +2621,142 @@ namespace X2 {
 		return transformComponent;
 	}
 
+	glm::mat4 Scene::GetCachedWorldSpaceTransformMatrix(Entity entity)
+	{
+		if (const auto* worldTransform = m_Registry.try_get<WorldTransformComponent>(entity); worldTransform && !worldTransform->Dirty)
+			return worldTransform->Transform;
+
+		return GetWorldSpaceTransformMatrix(entity);
+	}
+
+	void Scene::OnEntityHierarchyChanged(entt::registry& registry, entt::entity entity)
+	{
+		m_TransformHierarchyDirty = true;
+	}
+
+	void Scene::OnMeshComponentChanged(entt::registry& registry, entt::entity entity)
+	{
+		m_MeshVersion++;
+	}
+
+	void Scene::RebuildTransformHierarchy()
+	{
+		X2_PROFILE_FUNC();
+
+		m_TransformHierarchy.clear();
+		m_TransformHierarchyDirty = false;
+
+		auto view = m_Registry.view<IDComponent, RelationshipComponent, TransformComponent>();
+
+		// Depth of every entity, parents are resolved through the UUID map only here
+		std::unordered_map<entt::entity, uint32_t> depths;
+		std::function<uint32_t(entt::entity)> getDepth = [&](entt::entity entity) -> uint32_t
+		{
+			if (auto it = depths.find(entity); it != depths.end())
+				return it->second;
+
+			uint32_t depth = 0;
+			Entity parent = TryGetEntityWithUUID(m_Registry.get<RelationshipComponent>(entity).ParentHandle);
+			if (parent)
+				depth = getDepth(parent) + 1;
+
+			depths[entity] = depth;
+			return depth;
+		};
+
+		uint32_t maxDepth = 0;
+		for (auto entity : view)
+			maxDepth = std::max(maxDepth, getDepth(entity));
+
+		// Counting sort by depth, parents always land before their children
+		std::vector<uint32_t> offsets(maxDepth + 2, 0);
+		for (auto& [entity, depth] : depths)
+			offsets[depth + 1]++;
+		for (uint32_t i = 1; i < offsets.size(); i++)
+			offsets[i] += offsets[i - 1];
+
+		m_TransformHierarchy.resize(depths.size());
+		std::unordered_map<entt::entity, uint32_t> indices;
+		indices.reserve(depths.size());
+		for (auto& [entity, depth] : depths)
+		{
+			const uint32_t index = offsets[depth]++;
+			m_TransformHierarchy[index].Entity = entity;
+			indices[entity] = index;
+		}
+
+		for (auto& node : m_TransformHierarchy)
+		{
+			const UUID parentHandle = m_Registry.get<RelationshipComponent>(node.Entity).ParentHandle;
+			Entity parent = TryGetEntityWithUUID(parentHandle);
+			node.ParentIndex = parent ? indices.at(parent) : UINT32_MAX;
+
+			auto& worldTransform = m_Registry.emplace_or_replace<WorldTransformComponent>(node.Entity);
+			worldTransform.ParentHandle = parentHandle;
+			worldTransform.Dirty = true;
+		}
+
+		m_TransformChanged.resize(m_TransformHierarchy.size());
+	}
+
+	void Scene::UpdateWorldTransforms()
+	{
+		X2_PROFILE_FUNC();
+
+		if (m_TransformHierarchyDirty)
+			RebuildTransformHierarchy();
+
+		// Reparenting is spread over several code paths, it is detected during the walk instead
+		if (!UpdateWorldTransformsInOrder())
+		{
+			RebuildTransformHierarchy();
+			UpdateWorldTransformsInOrder();
+		}
+	}
+
+	bool Scene::UpdateWorldTransformsInOrder()
+	{
+		for (size_t i = 0; i < m_TransformHierarchy.size(); i++)
+		{
+			const TransformHierarchyNode& node = m_TransformHierarchy[i];
+			const auto& relationship = m_Registry.get<RelationshipComponent>(node.Entity);
+			const auto& transform = m_Registry.get<TransformComponent>(node.Entity);
+			auto& worldTransform = m_Registry.get<WorldTransformComponent>(node.Entity);
+
+			if (relationship.ParentHandle != worldTransform.ParentHandle)
+				return false;
+
+			const bool parentChanged = node.ParentIndex != UINT32_MAX && m_TransformChanged[node.ParentIndex];
+			const bool changed = worldTransform.Dirty || parentChanged
+				|| transform.Translation != worldTransform.LocalTranslation
+				|| transform.Scale != worldTransform.LocalScale
+				|| transform.GetRotation() != worldTransform.LocalRotation;
+
+			m_TransformChanged[i] = changed;
+			if (!changed)
+				continue;
+
+			m_TransformVersion++;
+
+			worldTransform.LocalTranslation = transform.Translation;
+			worldTransform.LocalRotation = transform.GetRotation();
+			worldTransform.LocalScale = transform.Scale;
+			worldTransform.Dirty = false;
+
+			if (node.ParentIndex != UINT32_MAX)
+			{
+				const auto& parentTransform = m_Registry.get<WorldTransformComponent>(m_TransformHierarchy[node.ParentIndex].Entity);
+				worldTransform.Transform = parentTransform.Transform * transform.GetTransform();
+			}
+			else
+			{
+				worldTransform.Transform = transform.GetTransform();
+			}
+		}
+
+		return true;
+	}
+
 	void Scene::ParentEntity(Entity entity, Entity parent)
 	{
 		X2_PROFILE_FUNC();
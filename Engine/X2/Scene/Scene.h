@@ -86,73 +86,6 @@ namespace X2 {
 	};
 
 
-	struct DrawCommand
-	{
-		Ref<Mesh> Mesh;
-		uint32_t SubmeshIndex;
-		Ref<MaterialTable> MaterialTable;
-		Ref<VulkanMaterial> OverrideMaterial;
-
-		uint32_t InstanceCount = 0;
-		uint32_t InstanceOffset = 0;
-		bool IsRigged = false;
-	};
-
-	struct StaticDrawCommand
-	{
-		Ref<StaticMesh> StaticMesh;
-		uint32_t SubmeshIndex;
-		Ref<MaterialTable> MaterialTable;
-		Ref<VulkanMaterial> OverrideMaterial;
-
-		uint32_t InstanceCount = 0;
-		uint32_t InstanceOffset = 0;
-	};
-
-	struct MeshKey
-	{
-		uint64_t EntityUUID;
-		AssetHandle MeshHandle;
-		AssetHandle MaterialHandle;
-		uint32_t SubmeshIndex;
-		bool IsSelected;
-
-		MeshKey(uint64_t entityUUID, AssetHandle meshHandle, AssetHandle materialHandle, uint32_t submeshIndex, bool isSelected)
-			:EntityUUID(entityUUID), MeshHandle(meshHandle), MaterialHandle(materialHandle), SubmeshIndex(submeshIndex), IsSelected(isSelected)
-		{
-		}
-
-		bool operator<(const MeshKey& other) const
-		{
-			if (EntityUUID < other.EntityUUID)
-				return true;
-
-			if (EntityUUID > other.EntityUUID)
-				return false;
-
-			if (MeshHandle < other.MeshHandle)
-				return true;
-
-			if (MeshHandle > other.MeshHandle)
-				return false;
-
-			if (SubmeshIndex < other.SubmeshIndex)
-				return true;
-
-			if (SubmeshIndex > other.SubmeshIndex)
-				return false;
-
-			if (MaterialHandle < other.MaterialHandle)
-				return true;
-
-			if (MaterialHandle > other.MaterialHandle)
-				return false;
-
-			return IsSelected < other.IsSelected;
-
-		}
-	};
-
 	struct TransformVertexData
 	{
 		glm::vec4 MRow[3];
@@ -162,12 +95,7 @@ namespace X2 {
 	{
 		Ref<VulkanVertexBuffer> Buffer;
 		TransformVertexData* Data = nullptr;
-	};
-
-	struct TransformMapData
-	{
-		std::vector<TransformVertexData> Transforms;
-		uint32_t TransformOffset = 0;
+		uint32_t Capacity = 0;
 	};
 
 	struct SceneRendererCamera
@@ -276,6 +204,21 @@ namespace X2 {
 		glm::mat4 GetWorldSpaceTransformMatrix(Entity entity);
 		TransformComponent GetWorldSpaceTransform(Entity entity);
 
+		// Recomputes the cached world transforms of entities whose local transform or parent changed
+		void UpdateWorldTransforms();
+
+		// World transform cached by the last UpdateWorldTransforms(). Falls back to walking the
+		// parent chain for entities created since. Changes made after the update are not reflected.
+		glm::mat4 GetCachedWorldSpaceTransformMatrix(Entity entity);
+
+		// Change counters for caches built over the scene. The transform version moves whenever
+		// UpdateWorldTransforms() changes a cached world transform, the mesh version whenever a
+		// MeshComponent or StaticMeshComponent is added, removed or replaced.
+		uint64_t GetTransformVersion() const { return m_TransformVersion; }
+		uint64_t GetMeshVersion() const { return m_MeshVersion; }
+		// Call after pointing a mesh component at another mesh or submesh in place
+		void MarkMeshesChanged() { m_MeshVersion++; }
+
 		void ParentEntity(Entity entity, Entity parent);
 		void UnparentEntity(Entity entity, bool convertToWorldSpace = true);
 
@@ -348,6 +291,11 @@ namespace X2 {
 
 		void SortEntities();
 
+		void OnEntityHierarchyChanged(entt::registry& registry, entt::entity entity);
+		void OnMeshComponentChanged(entt::registry& registry, entt::entity entity);
+		void RebuildTransformHierarchy();
+		bool UpdateWorldTransformsInOrder();
+
 		template<typename Fn>
 		void SubmitPostUpdateFunc(Fn&& func)
 		{
@@ -371,6 +319,19 @@ namespace X2 {
 
 		EntityMap m_EntityIDMap;
 
+		// Entities in parent-before-child order, rebuilt when entities are created, destroyed or reparented
+		struct TransformHierarchyNode
+		{
+			entt::entity Entity;
+			uint32_t ParentIndex; // Index into m_TransformHierarchy, UINT32_MAX for roots
+		};
+		std::vector<TransformHierarchyNode> m_TransformHierarchy;
+		std::vector<uint8_t> m_TransformChanged;
+		bool m_TransformHierarchyDirty = true;
+
+		uint64_t m_TransformVersion = 0;
+		uint64_t m_MeshVersion = 0;
+
 		DirLight m_Light;
 		float m_LightMultiplier = 0.3f;
 
@@ -0,0 +1,643 @@
+#include "Precompiled.h"
+#include "SceneRayQuery.h"
+
+#include "X2/Asset/AssetManager.h"
+#include "X2/Core/Debug/Profiler.h"
+
+#include <numeric>
+
+namespace X2 {
+
+	static constexpr uint32_t s_MaxLeafSize = 4;
+	static constexpr uint32_t s_BinCount = 16;
+
+	// Bottom level trees stop splitting at depth 32 and every BVH4 level is at least one binary level deep.
+	// A level pops one node and pushes up to four children, so the stack holds at most 1 + 3 * 32 entries.
+	static constexpr uint32_t s_TriangleStackSize = 128;
+
+	namespace Utils {
+
+		static Volume::AABB GetEmptyBounds()
+		{
+			return Volume::AABB(glm::vec3(std::numeric_limits<float>::max()), glm::vec3(-std::numeric_limits<float>::max()));
+		}
+
+		static glm::vec3 GetCentroid(const Volume::AABB& bounds)
+		{
+			return (bounds.Min + bounds.Max) * 0.5f;
+		}
+
+	}
+
+	void SceneRayQuery::Update(Scene* scene)
+	{
+		X2_PROFILE_FUNC();
+
+		// Read before gathering, so assets loaded meanwhile are picked up by the next update
+		const uint32_t assetsVersion = AssetManager::GetLoadedAssetsVersion();
+		const bool sameScene = scene == m_Scene && scene->GetUUID() == m_SceneID;
+		if (sameScene && scene->GetMeshVersion() == m_MeshVersion && assetsVersion == m_AssetsVersion)
+		{
+			if (scene->GetTransformVersion() == m_TransformVersion)
+				return;
+
+			m_TransformVersion = scene->GetTransformVersion();
+			if (UpdateTransforms())
+				RefitOrRebuild();
+			return;
+		}
+
+		m_Scene = scene;
+		m_SceneID = scene->GetUUID();
+		m_TransformVersion = scene->GetTransformVersion();
+		m_MeshVersion = scene->GetMeshVersion();
+		m_AssetsVersion = assetsVersion;
+
+		Gather();
+	}
+
+	void SceneRayQuery::Gather()
+	{
+		X2_PROFILE_FUNC();
+
+		std::vector<Instance> instances;
+		instances.reserve(m_Instances.size());
+
+		auto addInstance = [&instances](entt::entity entity, const Ref<MeshSource>& meshSource, uint32_t submeshIndex, const glm::mat4& localTransform)
+		{
+			Instance& instance = instances.emplace_back();
+			instance.Entity = entity;
+			instance.MeshSource = meshSource;
+			instance.SubmeshIndex = submeshIndex;
+			instance.LocalTransform = localTransform;
+		};
+
+		auto meshEntities = m_Scene->GetAllEntitiesWith<MeshComponent>();
+		for (auto e : meshEntities)
+		{
+			Entity entity = { e, m_Scene };
+			auto& mc = entity.GetComponent<MeshComponent>();
+			auto mesh = AssetManager::GetAsset<Mesh>(mc.Mesh);
+			if (!mesh || mesh->IsFlagSet(AssetFlag::Missing))
+				continue;
+
+			Ref<MeshSource> meshSource = mesh->GetMeshSource();
+			if (!meshSource || mc.SubmeshIndex >= meshSource->GetSubmeshes().size())
+				continue;
+
+			addInstance(e, meshSource, mc.SubmeshIndex, glm::mat4(1.0f));
+		}
+
+		auto staticMeshEntities = m_Scene->GetAllEntitiesWith<StaticMeshComponent>();
+		for (auto e : staticMeshEntities)
+		{
+			Entity entity = { e, m_Scene };
+			auto& smc = entity.GetComponent<StaticMeshComponent>();
+			auto staticMesh = AssetManager::GetAsset<StaticMesh>(smc.StaticMesh);
+			if (!staticMesh || staticMesh->IsFlagSet(AssetFlag::Missing))
+				continue;
+
+			Ref<MeshSource> meshSource = staticMesh->GetMeshSource();
+			if (!meshSource)
+				continue;
+
+			const auto& submeshes = meshSource->GetSubmeshes();
+			for (uint32_t i = 0; i < (uint32_t)submeshes.size(); i++)
+				addInstance(e, meshSource, i, submeshes[i].Transform);
+		}
+
+		// Same instances in the same order, only transforms can have changed
+		bool sameInstances = instances.size() == m_Instances.size();
+		for (size_t i = 0; sameInstances && i < instances.size(); i++)
+		{
+			sameInstances = instances[i].Entity == m_Instances[i].Entity && instances[i].MeshSource == m_Instances[i].MeshSource
+				&& instances[i].SubmeshIndex == m_Instances[i].SubmeshIndex;
+		}
+
+		if (sameInstances)
+		{
+			if (UpdateTransforms())
+				RefitOrRebuild();
+			return;
+		}
+
+		m_Instances = std::move(instances);
+		for (Instance& instance : m_Instances)
+			SetTransform(instance, m_Scene->GetCachedWorldSpaceTransformMatrix({ instance.Entity, m_Scene }) * instance.LocalTransform);
+
+		Build();
+	}
+
+	bool SceneRayQuery::UpdateTransforms()
+	{
+		bool moved = false;
+		for (Instance& instance : m_Instances)
+		{
+			const glm::mat4 transform = m_Scene->GetCachedWorldSpaceTransformMatrix({ instance.Entity, m_Scene }) * instance.LocalTransform;
+			if (instance.Transform == transform)
+				continue;
+
+			SetTransform(instance, transform);
+			moved = true;
+		}
+		return moved;
+	}
+
+	void SceneRayQuery::SetTransform(Instance& instance, const glm::mat4& transform)
+	{
+		instance.Transform = transform;
+		instance.InverseValid = false;
+
+		Volume::AABB bounds = instance.MeshSource->GetSubmeshes()[instance.SubmeshIndex].BoundingBox;
+		instance.Bounds = bounds.Transform(transform);
+	}
+
+	void SceneRayQuery::Clear()
+	{
+		m_Scene = nullptr;
+		m_SceneID = 0;
+		m_TransformVersion = 0;
+		m_MeshVersion = 0;
+		m_AssetsVersion = 0;
+		m_Instances.clear();
+		m_InstanceOrder.clear();
+		m_Nodes.clear();
+		m_BuildCost = 0.0f;
+	}
+
+	void SceneRayQuery::Build()
+	{
+		X2_PROFILE_FUNC();
+
+		m_Nodes.clear();
+		m_InstanceOrder.resize(m_Instances.size());
+		std::iota(m_InstanceOrder.begin(), m_InstanceOrder.end(), 0);
+
+		if (m_Instances.empty())
+		{
+			m_BuildCost = 0.0f;
+			return;
+		}
+
+		// A binary tree over n instances has at most 2n - 1 nodes, so nodes are never reallocated while subdividing
+		m_Nodes.reserve(m_Instances.size() * 2);
+		m_Nodes.emplace_back();
+		Subdivide(0, 0, (uint32_t)m_Instances.size());
+
+		m_BuildCost = GetTreeCost();
+	}
+
+	void SceneRayQuery::Subdivide(uint32_t nodeIndex, uint32_t first, uint32_t count)
+	{
+		Node& node = m_Nodes[nodeIndex];
+		node.Bounds = Utils::GetEmptyBounds();
+
+		glm::vec3 centroidMin = glm::vec3(std::numeric_limits<float>::max());
+		glm::vec3 centroidMax = glm::vec3(-std::numeric_limits<float>::max());
+		for (uint32_t i = first; i < first + count; i++)
+		{
+			const Volume::AABB& bounds = m_Instances[m_InstanceOrder[i]].Bounds;
+			node.Bounds.Grow(bounds);
+
+			const glm::vec3 centroid = Utils::GetCentroid(bounds);
+			centroidMin = glm::min(centroidMin, centroid);
+			centroidMax = glm::max(centroidMax, centroid);
+		}
+
+		if (count <= s_MaxLeafSize)
+		{
+			node.First = first;
+			node.Count = count;
+			return;
+		}
+
+		const glm::vec3 extents = centroidMax - centroidMin;
+		const int axis = extents.x > extents.y ? (extents.x > extents.z ? 0 : 2) : (extents.y > extents.z ? 1 : 2);
+		const float extent = extents[axis];
+
+		auto getCentroid = [this, axis](uint32_t instanceIndex) { return Utils::GetCentroid(m_Instances[instanceIndex].Bounds)[axis]; };
+		auto getBin = [&](uint32_t instanceIndex)
+		{
+			return std::min((uint32_t)((getCentroid(instanceIndex) - centroidMin[axis]) / extent * s_BinCount), s_BinCount - 1);
+		};
+
+		auto begin = m_InstanceOrder.begin() + first;
+		auto end = begin + count;
+		uint32_t middle = first;
+		if (extent > 0.0f)
+		{
+			// Binned SAH
+			Volume::AABB binBounds[s_BinCount];
+			uint32_t binCounts[s_BinCount] = {};
+			for (auto& bounds : binBounds)
+				bounds = Utils::GetEmptyBounds();
+
+			for (auto it = begin; it != end; it++)
+			{
+				const uint32_t bin = getBin(*it);
+				binBounds[bin].Grow(m_Instances[*it].Bounds);
+				binCounts[bin]++;
+			}
+
+			float rightAreas[s_BinCount];
+			uint32_t rightCounts[s_BinCount];
+			Volume::AABB rightBounds = Utils::GetEmptyBounds();
+			uint32_t rightCount = 0;
+			for (int32_t bin = s_BinCount - 1; bin > 0; bin--)
+			{
+				if (binCounts[bin])
+					rightBounds.Grow(binBounds[bin]);
+				rightCount += binCounts[bin];
+				rightAreas[bin] = rightCount ? rightBounds.GetSurfaceArea() : 0.0f;
+				rightCounts[bin] = rightCount;
+			}
+
+			float bestCost = std::numeric_limits<float>::max();
+			uint32_t bestBin = 0;
+			Volume::AABB leftBounds = Utils::GetEmptyBounds();
+			uint32_t leftCount = 0;
+			for (uint32_t bin = 0; bin < s_BinCount - 1; bin++)
+			{
+				if (binCounts[bin])
+					leftBounds.Grow(binBounds[bin]);
+				leftCount += binCounts[bin];
+
+				if (!leftCount || !rightCounts[bin + 1])
+					continue;
+
+				const float cost = leftCount * leftBounds.GetSurfaceArea() + rightCounts[bin + 1] * rightAreas[bin + 1];
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestBin = bin;
+				}
+			}
+
+			middle = (uint32_t)(std::partition(begin, end, [&](uint32_t instanceIndex) { return getBin(instanceIndex) <= bestBin; }) - m_InstanceOrder.begin());
+		}
+
+		// All centroids in one bin, split at the median instead
+		if (middle == first || middle == first + count)
+		{
+			middle = first + count / 2;
+			std::nth_element(begin, m_InstanceOrder.begin() + middle, end, [&](uint32_t a, uint32_t b) { return getCentroid(a) < getCentroid(b); });
+		}
+
+		const uint32_t left = (uint32_t)m_Nodes.size();
+		m_Nodes.emplace_back();
+		m_Nodes.emplace_back();
+
+		m_Nodes[nodeIndex].First = left;
+		m_Nodes[nodeIndex].Count = 0;
+
+		Subdivide(left, first, middle - first);
+		Subdivide(left + 1, middle, first + count - middle);
+	}
+
+	void SceneRayQuery::RefitOrRebuild()
+	{
+		Refit();
+
+		// Refitting keeps the old topology, rebuild once it got much worse than a fresh tree
+		if (GetTreeCost() > m_BuildCost * 2.0f)
+			Build();
+	}
+
+	void SceneRayQuery::Refit()
+	{
+		X2_PROFILE_FUNC();
+
+		// Children are always stored after their parent
+		for (int32_t i = (int32_t)m_Nodes.size() - 1; i >= 0; i--)
+		{
+			Node& node = m_Nodes[i];
+			node.Bounds = Utils::GetEmptyBounds();
+
+			if (node.Count)
+			{
+				for (uint32_t j = node.First; j < node.First + node.Count; j++)
+					node.Bounds.Grow(m_Instances[m_InstanceOrder[j]].Bounds);
+			}
+			else
+			{
+				node.Bounds.Grow(m_Nodes[node.First].Bounds);
+				node.Bounds.Grow(m_Nodes[node.First + 1].Bounds);
+			}
+		}
+	}
+
+	float SceneRayQuery::GetTreeCost() const
+	{
+		float cost = 0.0f;
+		for (const Node& node : m_Nodes)
+			cost += node.Bounds.GetSurfaceArea() * (node.Count ? node.Count : 1);
+		return cost;
+	}
+
+	const glm::mat4& SceneRayQuery::GetInverseTransform(Instance& instance)
+	{
+		if (!instance.InverseValid)
+		{
+			instance.InverseTransform = glm::inverse(instance.Transform);
+			instance.InverseValid = true;
+		}
+		return instance.InverseTransform;
+	}
+
+	bool SceneRayQuery::IntersectInstance(Instance& instance, const Volume::Ray& ray, float maxDistance, bool anyHit, uint32_t& outTriangle, float& outDistance)
+	{
+		const glm::mat4& inverseTransform = GetInverseTransform(instance);
+
+		// The direction isn't normalized, so distances stay comparable between instances
+		Volume::Ray localRay(glm::vec3(inverseTransform * glm::vec4(ray.origin, 1.0f)), glm::mat3(inverseTransform) * ray.direction);
+
+		if (m_TriangleStack.size() < s_TriangleStackSize)
+			m_TriangleStack.resize(s_TriangleStackSize);
+
+		const Volume::BVH4& bvh = instance.MeshSource->GetSubmeshBVH(instance.SubmeshIndex);
+		if (anyHit)
+			return bvh.GetIntersectionAny(m_TriangleStack, localRay, maxDistance);
+
+		Volume::BVHTriangle triangle;
+		glm::vec3 intersection;
+		if (!bvh.GetIntersection(m_TriangleStack, localRay, triangle, intersection, maxDistance))
+			return false;
+
+		outTriangle = triangle.idx;
+		outDistance = intersection.x;
+		return true;
+	}
+
+	uint32_t SceneRayQuery::IntersectInstance(Instance& instance, const Volume::Ray* rays, uint32_t rayMask, float* closest, uint32_t* outTriangles)
+	{
+		constexpr uint32_t maxPacketSize = Volume::BVH4::maxPacketSize;
+
+		const glm::mat4& inverseTransform = GetInverseTransform(instance);
+
+		// The packet only holds the rays that reached this instance
+		Volume::Ray localRays[maxPacketSize];
+		uint32_t rayIndices[maxPacketSize];
+		uint32_t localCount = 0;
+		float maxDistance = 0.0f;
+		for (uint32_t r = 0; r < maxPacketSize; r++)
+		{
+			if (!(rayMask & (1u << r)))
+				continue;
+
+			localRays[localCount] = Volume::Ray(glm::vec3(inverseTransform * glm::vec4(rays[r].origin, 1.0f)), glm::mat3(inverseTransform) * rays[r].direction);
+			rayIndices[localCount++] = r;
+			maxDistance = glm::max(maxDistance, closest[r]);
+		}
+
+		// The packet shares one maximum distance, hits beyond a ray's own closest one are dropped below
+		Volume::BVHTriangle triangles[maxPacketSize];
+		glm::vec3 intersections[maxPacketSize];
+		const Volume::BVH4& bvh = instance.MeshSource->GetSubmeshBVH(instance.SubmeshIndex);
+		const uint32_t hitMask = bvh.GetIntersections(m_PacketTriangleStack, localRays, localCount, triangles, intersections, maxDistance);
+
+		uint32_t closerMask = 0;
+		for (uint32_t i = 0; i < localCount; i++)
+		{
+			const uint32_t r = rayIndices[i];
+			if (!(hitMask & (1u << i)) || intersections[i].x >= closest[r])
+				continue;
+
+			closest[r] = intersections[i].x;
+			outTriangles[r] = triangles[i].idx;
+			closerMask |= 1u << r;
+		}
+		return closerMask;
+	}
+
+	bool SceneRayQuery::CastRay(const Volume::Ray& ray, Hit& outHit, float maxDistance)
+	{
+		X2_PROFILE_FUNC();
+
+		if (m_Nodes.empty())
+			return false;
+
+		Volume::Ray worldRay = ray;
+		float closest = maxDistance;
+		uint32_t closestInstance = UINT32_MAX;
+		uint32_t closestTriangle = 0;
+
+		// Nearer children are visited first, so most of the far ones can be skipped
+		m_NodeStack.clear();
+
+		float rootDistance;
+		if (worldRay.Intersects(m_Nodes[0].Bounds, 0.0f, closest, rootDistance))
+			m_NodeStack.emplace_back(0, rootDistance);
+
+		while (!m_NodeStack.empty())
+		{
+			const auto [nodeIndex, distance] = m_NodeStack.back();
+			m_NodeStack.pop_back();
+
+			if (distance > closest)
+				continue;
+
+			const Node& node = m_Nodes[nodeIndex];
+			if (node.Count)
+			{
+				for (uint32_t i = node.First; i < node.First + node.Count; i++)
+				{
+					uint32_t triangle;
+					float hitDistance;
+					if (IntersectInstance(m_Instances[m_InstanceOrder[i]], ray, closest, false, triangle, hitDistance))
+					{
+						closest = hitDistance;
+						closestInstance = m_InstanceOrder[i];
+						closestTriangle = triangle;
+					}
+				}
+				continue;
+			}
+
+			float leftDistance, rightDistance;
+			const bool hitLeft = worldRay.Intersects(m_Nodes[node.First].Bounds, 0.0f, closest, leftDistance);
+			const bool hitRight = worldRay.Intersects(m_Nodes[node.First + 1].Bounds, 0.0f, closest, rightDistance);
+
+			if (hitLeft && hitRight)
+			{
+				if (leftDistance < rightDistance)
+				{
+					m_NodeStack.emplace_back(node.First + 1, rightDistance);
+					m_NodeStack.emplace_back(node.First, leftDistance);
+				}
+				else
+				{
+					m_NodeStack.emplace_back(node.First, leftDistance);
+					m_NodeStack.emplace_back(node.First + 1, rightDistance);
+				}
+			}
+			else if (hitLeft)
+			{
+				m_NodeStack.emplace_back(node.First, leftDistance);
+			}
+			else if (hitRight)
+			{
+				m_NodeStack.emplace_back(node.First + 1, rightDistance);
+			}
+		}
+
+		if (closestInstance == UINT32_MAX)
+			return false;
+
+		const Instance& instance = m_Instances[closestInstance];
+		outHit.Entity = { instance.Entity, m_Scene };
+		outHit.MeshSource = instance.MeshSource;
+		outHit.SubmeshIndex = instance.SubmeshIndex;
+		outHit.TriangleIndex = closestTriangle;
+		outHit.Distance = closest;
+		return true;
+	}
+
+	bool SceneRayQuery::CastRayAny(const Volume::Ray& ray, float maxDistance)
+	{
+		X2_PROFILE_FUNC();
+
+		if (m_Nodes.empty())
+			return false;
+
+		Volume::Ray worldRay = ray;
+
+		m_NodeStack.clear();
+		m_NodeStack.emplace_back(0, 0.0f);
+		while (!m_NodeStack.empty())
+		{
+			const Node& node = m_Nodes[m_NodeStack.back().first];
+			m_NodeStack.pop_back();
+
+			if (!worldRay.Intersects(node.Bounds, 0.0f, maxDistance))
+				continue;
+
+			if (!node.Count)
+			{
+				m_NodeStack.emplace_back(node.First, 0.0f);
+				m_NodeStack.emplace_back(node.First + 1, 0.0f);
+				continue;
+			}
+
+			for (uint32_t i = node.First; i < node.First + node.Count; i++)
+			{
+				uint32_t triangle;
+				float distance;
+				if (IntersectInstance(m_Instances[m_InstanceOrder[i]], ray, maxDistance, true, triangle, distance))
+					return true;
+			}
+		}
+
+		return false;
+	}
+
+	uint32_t SceneRayQuery::CastRays(const Volume::Ray* rays, uint32_t rayCount, Hit* outHits, float maxDistance)
+	{
+		X2_PROFILE_FUNC();
+
+		constexpr uint32_t maxPacketSize = Volume::BVH4::maxPacketSize;
+		X2_CORE_ASSERT(rayCount <= maxPacketSize, "Packet is too large");
+
+		if (m_Nodes.empty() || !rayCount)
+			return 0;
+
+		Volume::Ray worldRays[maxPacketSize];
+		float closest[maxPacketSize];
+		uint32_t closestInstances[maxPacketSize];
+		uint32_t closestTriangles[maxPacketSize];
+		for (uint32_t r = 0; r < rayCount; r++)
+		{
+			worldRays[r] = rays[r];
+			closest[r] = maxDistance;
+			closestInstances[r] = UINT32_MAX;
+		}
+
+		// Slab tests the rays of rayMask against the node, returns the ones that hit and their nearest entry
+		auto intersectNode = [&](const Node& node, uint32_t rayMask, float& outDistance)
+		{
+			uint32_t hitMask = 0;
+			outDistance = std::numeric_limits<float>::max();
+			for (uint32_t r = 0; r < rayCount; r++)
+			{
+				float distance;
+				if ((rayMask & (1u << r)) && worldRays[r].Intersects(node.Bounds, 0.0f, closest[r], distance))
+				{
+					hitMask |= 1u << r;
+					outDistance = glm::min(outDistance, distance);
+				}
+			}
+			return hitMask;
+		};
+
+		// Same as CastRay, but every entry carries the rays that hit the node and the others skip it
+		m_PacketNodeStack.clear();
+
+		float rootDistance;
+		const uint32_t rootMask = intersectNode(m_Nodes[0], (1u << rayCount) - 1u, rootDistance);
+		if (rootMask)
+			m_PacketNodeStack.push_back({ 0, rootMask, rootDistance });
+
+		while (!m_PacketNodeStack.empty())
+		{
+			const PacketStackEntry entry = m_PacketNodeStack.back();
+			m_PacketNodeStack.pop_back();
+
+			// Rays that found something closer since the node was pushed are done with it
+			uint32_t rayMask = 0;
+			for (uint32_t r = 0; r < rayCount; r++)
+			{
+				if ((entry.RayMask & (1u << r)) && entry.Distance <= closest[r])
+					rayMask |= 1u << r;
+			}
+
+			if (!rayMask)
+				continue;
+
+			const Node& node = m_Nodes[entry.Node];
+			if (node.Count)
+			{
+				for (uint32_t i = node.First; i < node.First + node.Count; i++)
+				{
+					const uint32_t closerMask = IntersectInstance(m_Instances[m_InstanceOrder[i]], rays, rayMask, closest, closestTriangles);
+					for (uint32_t r = 0; r < rayCount; r++)
+					{
+						if (closerMask & (1u << r))
+							closestInstances[r] = m_InstanceOrder[i];
+					}
+				}
+				continue;
+			}
+
+			float leftDistance, rightDistance;
+			const uint32_t leftMask = intersectNode(m_Nodes[node.First], rayMask, leftDistance);
+			const uint32_t rightMask = intersectNode(m_Nodes[node.First + 1], rayMask, rightDistance);
+
+			// The child the packet enters first is popped first
+			const bool leftFirst = leftDistance < rightDistance;
+			if (leftFirst && rightMask)
+				m_PacketNodeStack.push_back({ node.First + 1, rightMask, rightDistance });
+			if (leftMask)
+				m_PacketNodeStack.push_back({ node.First, leftMask, leftDistance });
+			if (!leftFirst && rightMask)
+				m_PacketNodeStack.push_back({ node.First + 1, rightMask, rightDistance });
+		}
+
+		uint32_t hitMask = 0;
+		for (uint32_t r = 0; r < rayCount; r++)
+		{
+			if (closestInstances[r] == UINT32_MAX)
+				continue;
+
+			const Instance& instance = m_Instances[closestInstances[r]];
+			Hit& hit = outHits[r];
+			hit.Entity = { instance.Entity, m_Scene };
+			hit.MeshSource = instance.MeshSource;
+			hit.SubmeshIndex = instance.SubmeshIndex;
+			hit.TriangleIndex = closestTriangles[r];
+			hit.Distance = closest[r];
+			hitMask |= 1u << r;
+		}
+
+		return hitMask;
+	}
+
+}
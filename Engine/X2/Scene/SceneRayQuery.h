@@ -0,0 +1,109 @@
+#pragma once
+
+#include "Entity.h"
+
+#include "X2/Math/AABB.h"
+#include "X2/Math/BVH.h"
+#include "X2/Math/Ray.h"
+
+#include <limits>
+#include <vector>
+
+namespace X2 {
+
+	//
+	// Ray queries against the mesh instances of a scene. Every MeshSource owns a BVH per submesh
+	// (the bottom level), this keeps a BVH over the instances on top of it. Update() keeps the top
+	// level as long as the scene's versions say nothing changed, refits it when only transforms
+	// changed and gathers the instances again when meshes were added, removed or reloaded.
+	//
+	class SceneRayQuery
+	{
+	public:
+		struct Hit
+		{
+			X2::Entity Entity;
+			Ref<X2::MeshSource> MeshSource;
+			uint32_t SubmeshIndex = 0;
+			uint32_t TriangleIndex = 0; // Within the submesh
+			float Distance = 0.0f; // In units of the ray direction
+		};
+	public:
+		// Brings the tree up to date with the MeshComponent and StaticMeshComponent instances of the scene
+		void Update(Scene* scene);
+
+		bool CastRay(const Volume::Ray& ray, Hit& outHit, float maxDistance = std::numeric_limits<float>::max());
+		bool CastRayAny(const Volume::Ray& ray, float maxDistance = std::numeric_limits<float>::max());
+
+		// Traces up to Volume::BVH4::maxPacketSize rays as one packet, for rays with a similar origin and
+		// direction. Returns a mask of the rays that hit, outHits is only written for those.
+		uint32_t CastRays(const Volume::Ray* rays, uint32_t rayCount, Hit* outHits, float maxDistance = std::numeric_limits<float>::max());
+
+		void Clear();
+	private:
+		struct Instance
+		{
+			entt::entity Entity;
+			Ref<X2::MeshSource> MeshSource;
+			uint32_t SubmeshIndex;
+
+			glm::mat4 LocalTransform; // Submesh transform of static meshes, applied after the entity's
+			glm::mat4 Transform;
+			glm::mat4 InverseTransform;
+			bool InverseValid = false;
+
+			Volume::AABB Bounds; // World space
+		};
+
+		struct Node
+		{
+			Volume::AABB Bounds;
+			uint32_t First = 0; // First instance of a leaf, left child of an inner node (the right one follows it)
+			uint32_t Count = 0; // Instances of a leaf, 0 for inner nodes
+		};
+
+		void Gather();
+		// Pulls the entity transforms from the scene, returns whether any instance moved
+		bool UpdateTransforms();
+		void SetTransform(Instance& instance, const glm::mat4& transform);
+
+		void Build();
+		void Refit();
+		void RefitOrRebuild();
+		void Subdivide(uint32_t nodeIndex, uint32_t first, uint32_t count);
+		float GetTreeCost() const;
+
+		// Tests the instance's bottom level with the ray moved into submesh space
+		bool IntersectInstance(Instance& instance, const Volume::Ray& ray, float maxDistance, bool anyHit, uint32_t& outTriangle, float& outDistance);
+		// Packet version, returns the rays in rayMask that found a hit closer than their closest distance
+		uint32_t IntersectInstance(Instance& instance, const Volume::Ray* rays, uint32_t rayMask, float* closest, uint32_t* outTriangles);
+		const glm::mat4& GetInverseTransform(Instance& instance);
+	private:
+		Scene* m_Scene = nullptr;
+		UUID m_SceneID = 0;
+
+		// Scene and asset manager versions the instances were gathered at
+		uint64_t m_TransformVersion = 0;
+		uint64_t m_MeshVersion = 0;
+		uint32_t m_AssetsVersion = 0;
+
+		std::vector<Instance> m_Instances;
+		std::vector<uint32_t> m_InstanceOrder; // Instances referenced by the leaves
+		std::vector<Node> m_Nodes;
+
+		float m_BuildCost = 0.0f;
+
+		std::vector<std::pair<uint32_t, float>> m_NodeStack; // Node and the distance the ray enters it
+		std::vector<std::pair<int32_t, float>> m_TriangleStack;
+
+		struct PacketStackEntry
+		{
+			uint32_t Node;
+			uint32_t RayMask; // Rays that hit the node
+			float Distance; // Nearest entry distance of these rays
+		};
+		std::vector<PacketStackEntry> m_PacketNodeStack;
+		std::vector<Volume::BVH4::PacketStackEntry> m_PacketTriangleStack;
+	};
+
+}
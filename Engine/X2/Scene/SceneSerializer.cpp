@@ -9,6 +9,8 @@
 
 #include "X2/Asset/AssetManager.h"
 
+#include "X2/Core/Debug/Profiler.h"
+
 //#include "X2/Audio/AudioComponent.h"
 //#include "X2/Audio/AudioEngine.h"
 
@@ -38,6 +40,197 @@
 
 namespace X2 {
 
+	namespace Utils {
+
+		// Binary scenes store every component field as one column: a uint32_t element count followed by the raw elements
+		template<typename T>
+		static void WriteSceneColumn(StreamWriter& stream, const std::vector<T>& column)
+		{
+			static_assert(std::is_trivially_copyable<T>(), "Scene columns are written as raw memory");
+
+			stream.WriteRaw<uint32_t>((uint32_t)column.size());
+			if (!column.empty())
+				stream.WriteData((const char*)column.data(), sizeof(T) * column.size());
+		}
+
+		template<typename T>
+		static bool ReadSceneColumn(StreamReader& stream, std::vector<T>& column, uint32_t size)
+		{
+			static_assert(std::is_trivially_copyable<T>(), "Scene columns are read as raw memory");
+
+			uint32_t storedSize = 0;
+			if (!stream.ReadData((char*)&storedSize, sizeof(uint32_t)) || storedSize != size)
+				return false;
+
+			column.resize(size);
+			return size == 0 || stream.ReadData((char*)column.data(), sizeof(T) * size);
+		}
+
+		// Writes the indices (into the UUID sorted entity list) of the entities that have TComponent
+		template<typename TComponent>
+		static std::vector<const TComponent*> WriteSceneComponents(StreamWriter& stream, entt::registry& registry, const std::vector<entt::entity>& entities)
+		{
+			std::vector<uint32_t> indices;
+			std::vector<const TComponent*> components;
+			for (uint32_t i = 0; i < (uint32_t)entities.size(); i++)
+			{
+				if (registry.has<TComponent>(entities[i]))
+				{
+					indices.push_back(i);
+					components.push_back(&registry.get<TComponent>(entities[i]));
+				}
+			}
+
+			stream.WriteRaw<uint32_t>((uint32_t)indices.size());
+			WriteSceneColumn(stream, indices);
+			return components;
+		}
+
+		// Components are added to all their entities in one batch, the field columns that follow fill them in
+		template<typename TComponent>
+		static bool ReadSceneComponents(StreamReader& stream, entt::registry& registry, const std::vector<entt::entity>& entities, std::vector<TComponent*>& outComponents)
+		{
+			uint32_t count = 0;
+			if (!stream.ReadData((char*)&count, sizeof(uint32_t)) || count > entities.size())
+				return false;
+
+			std::vector<uint32_t> indices;
+			if (!ReadSceneColumn(stream, indices, count))
+				return false;
+
+			std::vector<entt::entity> componentEntities;
+			componentEntities.reserve(count);
+			for (uint32_t index : indices)
+			{
+				if (index >= entities.size())
+					return false;
+
+				entt::entity entity = entities[index];
+				if (!registry.has<TComponent>(entity))
+					componentEntities.push_back(entity);
+			}
+			registry.insert<TComponent>(componentEntities.begin(), componentEntities.end());
+
+			outComponents.clear();
+			outComponents.reserve(count);
+			for (uint32_t index : indices)
+				outComponents.push_back(&registry.get<TComponent>(entities[index]));
+
+			return true;
+		}
+
+		template<typename TField, typename TComponent, typename GetFn>
+		static void WriteSceneField(StreamWriter& stream, const std::vector<const TComponent*>& components, GetFn&& getField)
+		{
+			std::vector<TField> column;
+			column.reserve(components.size());
+			for (const TComponent* component : components)
+				column.push_back((TField)getField(*component));
+
+			WriteSceneColumn(stream, column);
+		}
+
+		template<typename TField, typename TComponent, typename SetFn>
+		static bool ReadSceneField(StreamReader& stream, const std::vector<TComponent*>& components, SetFn&& setField)
+		{
+			std::vector<TField> column;
+			if (!ReadSceneColumn(stream, column, (uint32_t)components.size()))
+				return false;
+
+			for (size_t i = 0; i < components.size(); i++)
+				setField(*components[i], column[i]);
+
+			return true;
+		}
+
+		// Variable length fields (children, bones, material tables) are a count column plus one flattened value column
+		template<typename TComponent, typename AppendFn>
+		static void WriteSceneLists(StreamWriter& stream, const std::vector<const TComponent*>& components, AppendFn&& appendList)
+		{
+			std::vector<uint32_t> counts;
+			std::vector<uint64_t> values;
+			counts.reserve(components.size());
+			for (const TComponent* component : components)
+			{
+				size_t first = values.size();
+				appendList(*component, values);
+				counts.push_back((uint32_t)(values.size() - first));
+			}
+
+			WriteSceneColumn(stream, counts);
+			WriteSceneColumn(stream, values);
+		}
+
+		template<typename TComponent, typename SetFn>
+		static bool ReadSceneLists(StreamReader& stream, const std::vector<TComponent*>& components, SetFn&& setList)
+		{
+			std::vector<uint32_t> counts;
+			if (!ReadSceneColumn(stream, counts, (uint32_t)components.size()))
+				return false;
+
+			uint64_t totalCount = 0;
+			for (uint32_t count : counts)
+				totalCount += count;
+			if (totalCount > std::numeric_limits<uint32_t>::max())
+				return false;
+
+			std::vector<uint64_t> values;
+			if (!ReadSceneColumn(stream, values, (uint32_t)totalCount))
+				return false;
+
+			const uint64_t* list = values.data();
+			for (size_t i = 0; i < components.size(); i++)
+			{
+				setList(*components[i], list, counts[i]);
+				list += counts[i];
+			}
+
+			return true;
+		}
+
+		// Strings are a length column plus all characters in one string
+		template<typename TComponent, typename GetFn>
+		static void WriteSceneStrings(StreamWriter& stream, const std::vector<const TComponent*>& components, GetFn&& getString)
+		{
+			std::vector<uint32_t> lengths;
+			std::string characters;
+			lengths.reserve(components.size());
+			for (const TComponent* component : components)
+			{
+				const std::string& string = getString(*component);
+				lengths.push_back((uint32_t)string.size());
+				characters += string;
+			}
+
+			WriteSceneColumn(stream, lengths);
+			stream.WriteString(characters);
+		}
+
+		template<typename TComponent, typename SetFn>
+		static bool ReadSceneStrings(StreamReader& stream, const std::vector<TComponent*>& components, SetFn&& setString)
+		{
+			std::vector<uint32_t> lengths;
+			if (!ReadSceneColumn(stream, lengths, (uint32_t)components.size()))
+				return false;
+
+			std::string characters;
+			stream.ReadString(characters);
+
+			size_t offset = 0;
+			for (size_t i = 0; i < components.size(); i++)
+			{
+				if (lengths[i] > characters.size() - offset)
+					return false;
+
+				setString(*components[i], characters.substr(offset, lengths[i]));
+				offset += lengths[i];
+			}
+
+			return offset == characters.size();
+		}
+
+	}
+
 	SceneSerializer::SceneSerializer(Scene* scene)
 		: m_Scene(scene)
 	{
@@ -1667,25 +1860,402 @@ namespace X2 {
 		return false;
 	}
 
-	bool SceneSerializer::SerializeToAssetPack(FileStreamWriter& stream, AssetSerializationInfo& outInfo)
+	bool SceneSerializer::SerializeToBinary(StreamWriter& stream)
 	{
-		YAML::Emitter out;
-		SerializeToYAML(out);
+		X2_PROFILE_FUNC();
+
+		auto& registry = m_Scene->m_Registry;
+
+		// Same UUID order as the YAML path, component tables refer to entities by their index in this order
+		std::map<UUID, entt::entity> sortedEntityMap;
+		auto idComponentView = registry.view<IDComponent>();
+		for (auto entity : idComponentView)
+			sortedEntityMap[idComponentView.get<IDComponent>(entity).ID] = entity;
+
+		std::vector<entt::entity> entities;
+		std::vector<uint64_t> entityIDs;
+		entities.reserve(sortedEntityMap.size());
+		entityIDs.reserve(sortedEntityMap.size());
+		for (auto [id, entity] : sortedEntityMap)
+		{
+			entityIDs.push_back(id);
+			entities.push_back(entity);
+		}
+
+		stream.WriteRaw<BinarySceneHeader>(BinarySceneHeader());
+		stream.WriteString(m_Scene->GetName());
+		stream.WriteRaw<uint32_t>((uint32_t)entities.size());
+		Utils::WriteSceneColumn(stream, entityIDs);
+
+		// The component tables below must stay in the same order as in DeserializeFromBinary(),
+		// changing the layout requires bumping BinarySceneHeader::Version
+
+		{
+			auto components = Utils::WriteSceneComponents<TagComponent>(stream, registry, entities);
+			Utils::WriteSceneStrings(stream, components, [](const TagComponent& c) -> const std::string& { return c.Tag; });
+		}
+
+		{
+			auto components = Utils::WriteSceneComponents<RelationshipComponent>(stream, registry, entities);
+			Utils::WriteSceneField<uint64_t>(stream, components, [](const RelationshipComponent& c) { return (uint64_t)c.ParentHandle; });
+			Utils::WriteSceneLists(stream, components, [](const RelationshipComponent& c, std::vector<uint64_t>& values)
+				{
+					for (UUID child : c.Children)
+						values.push_back(child);
+				});
+		}
+
+		{
+			auto components = Utils::WriteSceneComponents<PrefabComponent>(stream, registry, entities);
+			Utils::WriteSceneField<uint64_t>(stream, components, [](const PrefabComponent& c) { return (uint64_t)c.PrefabID; });
+			Utils::WriteSceneField<uint64_t>(stream, components, [](const PrefabComponent& c) { return (uint64_t)c.EntityID; });
+		}
+
+		{
+			auto components = Utils::WriteSceneComponents<TransformComponent>(stream, registry, entities);
+			Utils::WriteSceneField<glm::vec3>(stream, components, [](const TransformComponent& c) { return c.Translation; });
+			Utils::WriteSceneField<glm::vec3>(stream, components, [](const TransformComponent& c) { return c.GetRotationEuler(); });
+			Utils::WriteSceneField<glm::vec3>(stream, components, [](const TransformComponent& c) { return c.Scale; });
+		}
+
+		auto appendMaterialTable = [](const Ref<MaterialTable>& materialTable, std::vector<uint64_t>& values)
+		{
+			for (uint32_t i = 0; i < materialTable->GetMaterialCount(); i++)
+				values.push_back(materialTable->HasMaterial(i) ? materialTable->GetMaterial(i) : (AssetHandle)0);
+		};
+
+		{
+			auto components = Utils::WriteSceneComponents<MeshComponent>(stream, registry, entities);
+			Utils::WriteSceneField<uint64_t>(stream, components, [](const MeshComponent& c) { return (uint64_t)c.Mesh; });
+			Utils::WriteSceneField<uint32_t>(stream, components, [](const MeshComponent& c) { return c.SubmeshIndex; });
+			Utils::WriteSceneLists(stream, components, [&](const MeshComponent& c, std::vector<uint64_t>& values) { appendMaterialTable(c.MaterialTable, values); });
+			Utils::WriteSceneLists(stream, components, [](const MeshComponent& c, std::vector<uint64_t>& values)
+				{
+					for (UUID bone : c.BoneEntityIds)
+						values.push_back(bone);
+				});
+			Utils::WriteSceneField<uint8_t>(stream, components, [](const MeshComponent& c) { return c.Visible; });
+		}
+
+		{
+			auto components = Utils::WriteSceneComponents<StaticMeshComponent>(stream, registry, entities);
+			Utils::WriteSceneField<uint64_t>(stream, components, [](const StaticMeshComponent& c) { return (uint64_t)c.StaticMesh; });
+			Utils::WriteSceneLists(stream, components, [&](const StaticMeshComponent& c, std::vector<uint64_t>& values) { appendMaterialTable(c.MaterialTable, values); });
+			Utils::WriteSceneField<uint8_t>(stream, components, [](const StaticMeshComponent& c) { return c.Visible; });
+		}
+
+		{
+			auto components = Utils::WriteSceneComponents<CameraComponent>(stream, registry, entities);
+			Utils::WriteSceneField<int32_t>(stream, components, [](const CameraComponent& c) { return (int32_t)c.Camera.GetProjectionType(); });
+			Utils::WriteSceneField<float>(stream, components, [](const CameraComponent& c) { return c.Camera.GetDegPerspectiveVerticalFOV(); });
+			Utils::WriteSceneField<float>(stream, components, [](const CameraComponent& c) { return c.Camera.GetPerspectiveNearClip(); });
+			Utils::WriteSceneField<float>(stream, components, [](const CameraComponent& c) { return c.Camera.GetPerspectiveFarClip(); });
+			Utils::WriteSceneField<float>(stream, components, [](const CameraComponent& c) { return c.Camera.GetOrthographicSize(); });
+			Utils::WriteSceneField<float>(stream, components, [](const CameraComponent& c) { return c.Camera.GetOrthographicNearClip(); });
+			Utils::WriteSceneField<float>(stream, components, [](const CameraComponent& c) { return c.Camera.GetOrthographicFarClip(); });
+			Utils::WriteSceneField<uint8_t>(stream, components, [](const CameraComponent& c) { return c.Primary; });
+		}
 
+		{
+			auto components = Utils::WriteSceneComponents<DirectionalLightComponent>(stream, registry, entities);
+			Utils::WriteSceneField<float>(stream, components, [](const DirectionalLightComponent& c) { return c.Intensity; });
+			Utils::WriteSceneField<glm::vec3>(stream, components, [](const DirectionalLightComponent& c) { return c.Radiance; });
+			Utils::WriteSceneField<uint8_t>(stream, components, [](const DirectionalLightComponent& c) { return c.CastShadows; });
+			Utils::WriteSceneField<uint8_t>(stream, components, [](const DirectionalLightComponent& c) { return c.SoftShadows; });
+			Utils::WriteSceneField<float>(stream, components, [](const DirectionalLightComponent& c) { return c.LightSize; });
+			Utils::WriteSceneField<float>(stream, components, [](const DirectionalLightComponent& c) { return c.ShadowAmount; });
+		}
+
+		{
+			auto components = Utils::WriteSceneComponents<PointLightComponent>(stream, registry, entities);
+			Utils::WriteSceneField<glm::vec3>(stream, components, [](const PointLightComponent& c) { return c.Radiance; });
+			Utils::WriteSceneField<float>(stream, components, [](const PointLightComponent& c) { return c.Intensity; });
+			Utils::WriteSceneField<uint8_t>(stream, components, [](const PointLightComponent& c) { return c.CastsShadows; });
+			Utils::WriteSceneField<uint8_t>(stream, components, [](const PointLightComponent& c) { return c.SoftShadows; });
+			Utils::WriteSceneField<float>(stream, components, [](const PointLightComponent& c) { return c.LightSize; });
+			Utils::WriteSceneField<float>(stream, components, [](const PointLightComponent& c) { return c.Radius; });
+			Utils::WriteSceneField<float>(stream, components, [](const PointLightComponent& c) { return c.MinRadius; });
+			Utils::WriteSceneField<float>(stream, components, [](const PointLightComponent& c) { return c.Falloff; });
+		}
+
+		{
+			auto components = Utils::WriteSceneComponents<SpotLightComponent>(stream, registry, entities);
+			Utils::WriteSceneField<glm::vec3>(stream, components, [](const SpotLightComponent& c) { return c.Direction; });
+			Utils::WriteSceneField<glm::vec3>(stream, components, [](const SpotLightComponent& c) { return c.Radiance; });
+			Utils::WriteSceneField<float>(stream, components, [](const SpotLightComponent& c) { return c.Intensity; });
+			Utils::WriteSceneField<uint8_t>(stream, components, [](const SpotLightComponent& c) { return c.CastsShadows; });
+			Utils::WriteSceneField<uint8_t>(stream, components, [](const SpotLightComponent& c) { return c.SoftShadows; });
+			Utils::WriteSceneField<float>(stream, components, [](const SpotLightComponent& c) { return c.Angle; });
+			Utils::WriteSceneField<float>(stream, components, [](const SpotLightComponent& c) { return c.Range; });
+			Utils::WriteSceneField<float>(stream, components, [](const SpotLightComponent& c) { return c.Falloff; });
+			Utils::WriteSceneField<float>(stream, components, [](const SpotLightComponent& c) { return c.AngleAttenuation; });
+		}
+
+		{
+			auto components = Utils::WriteSceneComponents<SkyLightComponent>(stream, registry, entities);
+			Utils::WriteSceneField<uint64_t>(stream, components, [](const SkyLightComponent& c) { return AssetManager::IsMemoryAsset(c.SceneEnvironment) ? (uint64_t)0 : (uint64_t)c.SceneEnvironment; });
+			Utils::WriteSceneField<float>(stream, components, [](const SkyLightComponent& c) { return c.Intensity; });
+			Utils::WriteSceneField<float>(stream, components, [](const SkyLightComponent& c) { return c.Lod; });
+			Utils::WriteSceneField<uint8_t>(stream, components, [](const SkyLightComponent& c) { return c.DynamicSky; });
+			Utils::WriteSceneField<glm::vec3>(stream, components, [](const SkyLightComponent& c) { return c.TurbidityAzimuthInclination; });
+		}
+
+		Utils::WriteSceneComponents<FogVolumeComponent>(stream, registry, entities);
+
+		{
+			auto components = Utils::WriteSceneComponents<SpriteRendererComponent>(stream, registry, entities);
+			Utils::WriteSceneField<glm::vec4>(stream, components, [](const SpriteRendererComponent& c) { return c.Color; });
+			Utils::WriteSceneField<uint64_t>(stream, components, [](const SpriteRendererComponent& c) { return (uint64_t)c.Texture; });
+			Utils::WriteSceneField<float>(stream, components, [](const SpriteRendererComponent& c) { return c.TilingFactor; });
+			Utils::WriteSceneField<glm::vec2>(stream, components, [](const SpriteRendererComponent& c) { return c.UVStart; });
+			Utils::WriteSceneField<glm::vec2>(stream, components, [](const SpriteRendererComponent& c) { return c.UVEnd; });
+		}
+
+		{
+			auto components = Utils::WriteSceneComponents<CharacterControllerComponent>(stream, registry, entities);
+			Utils::WriteSceneField<uint32_t>(stream, components, [](const CharacterControllerComponent& c) { return c.LayerID; });
+			Utils::WriteSceneField<uint8_t>(stream, components, [](const CharacterControllerComponent& c) { return c.DisableGravity; });
+			Utils::WriteSceneField<float>(stream, components, [](const CharacterControllerComponent& c) { return c.SlopeLimitDeg; });
+			Utils::WriteSceneField<float>(stream, components, [](const CharacterControllerComponent& c) { return c.StepOffset; });
+		}
+
+		return stream.IsStreamGood();
+	}
+
+	bool SceneSerializer::DeserializeFromBinary(StreamReader& stream)
+	{
+		X2_PROFILE_FUNC();
+
+		BinarySceneHeader header;
+		if (!stream.ReadData((char*)&header, sizeof(BinarySceneHeader)) || memcmp(header.HEADER, BinarySceneHeader().HEADER, 4) != 0)
+		{
+			X2_CORE_ERROR_TAG("SceneSerializer", "Invalid binary scene header");
+			return false;
+		}
+
+		if (header.Version != BinarySceneHeader().Version)
+		{
+			X2_CORE_ERROR_TAG("SceneSerializer", "Binary scene version {} is not supported (expected {})", header.Version, BinarySceneHeader().Version);
+			return false;
+		}
+
+		std::string sceneName;
+		stream.ReadString(sceneName);
+		X2_CORE_INFO_TAG("AssetManager", "Deserializing scene '{0}'", sceneName);
+		m_Scene->SetName(sceneName);
+
+		uint32_t entityCount = 0;
+		std::vector<uint64_t> entityIDs;
+		if (!stream.ReadData((char*)&entityCount, sizeof(uint32_t)) || !Utils::ReadSceneColumn(stream, entityIDs, entityCount))
+			return false;
+
+		auto& registry = m_Scene->m_Registry;
+
+		// Create all entities at once, with the components CreateEntityWithID() gives every entity
+		std::vector<entt::entity> entities(entityCount);
+		registry.create(entities.begin(), entities.end());
+
+		std::vector<IDComponent> idComponents(entityCount);
+		for (uint32_t i = 0; i < entityCount; i++)
+			idComponents[i].ID = entityIDs[i];
+
+		registry.insert<IDComponent>(entities.begin(), entities.end(), idComponents.begin(), idComponents.end());
+		registry.insert<TransformComponent>(entities.begin(), entities.end());
+		registry.insert<RelationshipComponent>(entities.begin(), entities.end());
+
+		m_Scene->m_EntityIDMap.reserve(m_Scene->m_EntityIDMap.size() + entityCount);
+		for (uint32_t i = 0; i < entityCount; i++)
+		{
+			X2_CORE_ASSERT(m_Scene->m_EntityIDMap.find(entityIDs[i]) == m_Scene->m_EntityIDMap.end());
+			m_Scene->m_EntityIDMap[entityIDs[i]] = Entity{ entities[i], m_Scene };
+		}
+
+		bool success = true;
+
+		{
+			std::vector<TagComponent*> components;
+			success = success && Utils::ReadSceneComponents(stream, registry, entities, components)
+				&& Utils::ReadSceneStrings(stream, components, [](TagComponent& c, std::string&& tag) { c.Tag = std::move(tag); });
+		}
+
+		{
+			std::vector<RelationshipComponent*> components;
+			success = success && Utils::ReadSceneComponents(stream, registry, entities, components)
+				&& Utils::ReadSceneField<uint64_t>(stream, components, [](RelationshipComponent& c, uint64_t parent) { c.ParentHandle = parent; })
+				&& Utils::ReadSceneLists(stream, components, [](RelationshipComponent& c, const uint64_t* children, uint32_t count) { c.Children.assign(children, children + count); });
+		}
+
+		{
+			std::vector<PrefabComponent*> components;
+			success = success && Utils::ReadSceneComponents(stream, registry, entities, components)
+				&& Utils::ReadSceneField<uint64_t>(stream, components, [](PrefabComponent& c, uint64_t prefab) { c.PrefabID = prefab; })
+				&& Utils::ReadSceneField<uint64_t>(stream, components, [](PrefabComponent& c, uint64_t entity) { c.EntityID = entity; });
+		}
+
+		{
+			std::vector<TransformComponent*> components;
+			success = success && Utils::ReadSceneComponents(stream, registry, entities, components)
+				&& Utils::ReadSceneField<glm::vec3>(stream, components, [](TransformComponent& c, const glm::vec3& translation) { c.Translation = translation; })
+				&& Utils::ReadSceneField<glm::vec3>(stream, components, [](TransformComponent& c, const glm::vec3& rotation) { c.SetRotationEuler(rotation); })
+				&& Utils::ReadSceneField<glm::vec3>(stream, components, [](TransformComponent& c, const glm::vec3& scale) { c.Scale = scale; });
+		}
+
+		auto setMaterialTable = [](Ref<MaterialTable>& materialTable, const uint64_t* materials, uint32_t count)
+		{
+			for (uint32_t i = 0; i < count; i++)
+			{
+				AssetHandle materialAsset = materials[i];
+				if (materialAsset && AssetManager::IsAssetHandleValid(materialAsset))
+					materialTable->SetMaterial(i, materialAsset);
+			}
+		};
+
+		{
+			std::vector<MeshComponent*> components;
+			success = success && Utils::ReadSceneComponents(stream, registry, entities, components)
+				&& Utils::ReadSceneField<uint64_t>(stream, components, [](MeshComponent& c, uint64_t mesh)
+					{
+						AssetHandle assetHandle = mesh;
+						if (AssetManager::IsAssetHandleValid(assetHandle) && AssetManager::GetAssetType(assetHandle) == AssetType::Mesh)
+							c.Mesh = assetHandle;
+					})
+				&& Utils::ReadSceneField<uint32_t>(stream, components, [](MeshComponent& c, uint32_t submeshIndex) { c.SubmeshIndex = submeshIndex; })
+				&& Utils::ReadSceneLists(stream, components, [&](MeshComponent& c, const uint64_t* materials, uint32_t count) { setMaterialTable(c.MaterialTable, materials, count); })
+				&& Utils::ReadSceneLists(stream, components, [](MeshComponent& c, const uint64_t* bones, uint32_t count) { c.BoneEntityIds.assign(bones, bones + count); })
+				&& Utils::ReadSceneField<uint8_t>(stream, components, [](MeshComponent& c, uint8_t visible) { c.Visible = visible; });
+		}
+
+		{
+			std::vector<StaticMeshComponent*> components;
+			success = success && Utils::ReadSceneComponents(stream, registry, entities, components)
+				&& Utils::ReadSceneField<uint64_t>(stream, components, [](StaticMeshComponent& c, uint64_t staticMesh)
+					{
+						AssetHandle assetHandle = staticMesh;
+						if (AssetManager::IsAssetHandleValid(assetHandle))
+							c.StaticMesh = assetHandle;
+					})
+				&& Utils::ReadSceneLists(stream, components, [&](StaticMeshComponent& c, const uint64_t* materials, uint32_t count) { setMaterialTable(c.MaterialTable, materials, count); })
+				&& Utils::ReadSceneField<uint8_t>(stream, components, [](StaticMeshComponent& c, uint8_t visible) { c.Visible = visible; });
+		}
+
+		{
+			std::vector<CameraComponent*> components;
+			success = success && Utils::ReadSceneComponents(stream, registry, entities, components)
+				&& Utils::ReadSceneField<int32_t>(stream, components, [](CameraComponent& c, int32_t type) { c.Camera.SetProjectionType((SceneCamera::ProjectionType)type); })
+				&& Utils::ReadSceneField<float>(stream, components, [](CameraComponent& c, float fov) { c.Camera.SetDegPerspectiveVerticalFOV(fov); })
+				&& Utils::ReadSceneField<float>(stream, components, [](CameraComponent& c, float nearClip) { c.Camera.SetPerspectiveNearClip(nearClip); })
+				&& Utils::ReadSceneField<float>(stream, components, [](CameraComponent& c, float farClip) { c.Camera.SetPerspectiveFarClip(farClip); })
+				&& Utils::ReadSceneField<float>(stream, components, [](CameraComponent& c, float size) { c.Camera.SetOrthographicSize(size); })
+				&& Utils::ReadSceneField<float>(stream, components, [](CameraComponent& c, float nearClip) { c.Camera.SetOrthographicNearClip(nearClip); })
+				&& Utils::ReadSceneField<float>(stream, components, [](CameraComponent& c, float farClip) { c.Camera.SetOrthographicFarClip(farClip); })
+				&& Utils::ReadSceneField<uint8_t>(stream, components, [](CameraComponent& c, uint8_t primary) { c.Primary = primary; });
+		}
+
+		{
+			std::vector<DirectionalLightComponent*> components;
+			success = success && Utils::ReadSceneComponents(stream, registry, entities, components)
+				&& Utils::ReadSceneField<float>(stream, components, [](DirectionalLightComponent& c, float intensity) { c.Intensity = intensity; })
+				&& Utils::ReadSceneField<glm::vec3>(stream, components, [](DirectionalLightComponent& c, const glm::vec3& radiance) { c.Radiance = radiance; })
+				&& Utils::ReadSceneField<uint8_t>(stream, components, [](DirectionalLightComponent& c, uint8_t castShadows) { c.CastShadows = castShadows; })
+				&& Utils::ReadSceneField<uint8_t>(stream, components, [](DirectionalLightComponent& c, uint8_t softShadows) { c.SoftShadows = softShadows; })
+				&& Utils::ReadSceneField<float>(stream, components, [](DirectionalLightComponent& c, float lightSize) { c.LightSize = lightSize; })
+				&& Utils::ReadSceneField<float>(stream, components, [](DirectionalLightComponent& c, float shadowAmount) { c.ShadowAmount = shadowAmount; });
+		}
+
+		{
+			std::vector<PointLightComponent*> components;
+			success = success && Utils::ReadSceneComponents(stream, registry, entities, components)
+				&& Utils::ReadSceneField<glm::vec3>(stream, components, [](PointLightComponent& c, const glm::vec3& radiance) { c.Radiance = radiance; })
+				&& Utils::ReadSceneField<float>(stream, components, [](PointLightComponent& c, float intensity) { c.Intensity = intensity; })
+				&& Utils::ReadSceneField<uint8_t>(stream, components, [](PointLightComponent& c, uint8_t castsShadows) { c.CastsShadows = castsShadows; })
+				&& Utils::ReadSceneField<uint8_t>(stream, components, [](PointLightComponent& c, uint8_t softShadows) { c.SoftShadows = softShadows; })
+				&& Utils::ReadSceneField<float>(stream, components, [](PointLightComponent& c, float lightSize) { c.LightSize = lightSize; })
+				&& Utils::ReadSceneField<float>(stream, components, [](PointLightComponent& c, float radius) { c.Radius = radius; })
+				&& Utils::ReadSceneField<float>(stream, components, [](PointLightComponent& c, float minRadius) { c.MinRadius = minRadius; })
+				&& Utils::ReadSceneField<float>(stream, components, [](PointLightComponent& c, float falloff) { c.Falloff = falloff; });
+		}
+
+		{
+			std::vector<SpotLightComponent*> components;
+			success = success && Utils::ReadSceneComponents(stream, registry, entities, components)
+				&& Utils::ReadSceneField<glm::vec3>(stream, components, [](SpotLightComponent& c, const glm::vec3& direction) { c.Direction = direction; })
+				&& Utils::ReadSceneField<glm::vec3>(stream, components, [](SpotLightComponent& c, const glm::vec3& radiance) { c.Radiance = radiance; })
+				&& Utils::ReadSceneField<float>(stream, components, [](SpotLightComponent& c, float intensity) { c.Intensity = intensity; })
+				&& Utils::ReadSceneField<uint8_t>(stream, components, [](SpotLightComponent& c, uint8_t castsShadows) { c.CastsShadows = castsShadows; })
+				&& Utils::ReadSceneField<uint8_t>(stream, components, [](SpotLightComponent& c, uint8_t softShadows) { c.SoftShadows = softShadows; })
+				&& Utils::ReadSceneField<float>(stream, components, [](SpotLightComponent& c, float angle) { c.Angle = angle; })
+				&& Utils::ReadSceneField<float>(stream, components, [](SpotLightComponent& c, float range) { c.Range = range; })
+				&& Utils::ReadSceneField<float>(stream, components, [](SpotLightComponent& c, float falloff) { c.Falloff = falloff; })
+				&& Utils::ReadSceneField<float>(stream, components, [](SpotLightComponent& c, float angleAttenuation) { c.AngleAttenuation = angleAttenuation; });
+		}
+
+		{
+			std::vector<SkyLightComponent*> components;
+			success = success && Utils::ReadSceneComponents(stream, registry, entities, components)
+				&& Utils::ReadSceneField<uint64_t>(stream, components, [](SkyLightComponent& c, uint64_t environment)
+					{
+						AssetHandle assetHandle = environment;
+						if (AssetManager::IsAssetHandleValid(assetHandle))
+							c.SceneEnvironment = assetHandle;
+					})
+				&& Utils::ReadSceneField<float>(stream, components, [](SkyLightComponent& c, float intensity) { c.Intensity = intensity; })
+				&& Utils::ReadSceneField<float>(stream, components, [](SkyLightComponent& c, float lod) { c.Lod = lod; })
+				&& Utils::ReadSceneField<uint8_t>(stream, components, [](SkyLightComponent& c, uint8_t dynamicSky) { c.DynamicSky = dynamicSky; })
+				&& Utils::ReadSceneField<glm::vec3>(stream, components, [](SkyLightComponent& c, const glm::vec3& turbidityAzimuthInclination)
+					{
+						// Matches the YAML path, static skies keep the default
+						if (c.DynamicSky)
+							c.TurbidityAzimuthInclination = turbidityAzimuthInclination;
+					});
+		}
+
+		{
+			std::vector<FogVolumeComponent*> components;
+			success = success && Utils::ReadSceneComponents(stream, registry, entities, components);
+		}
+
+		{
+			std::vector<SpriteRendererComponent*> components;
+			success = success && Utils::ReadSceneComponents(stream, registry, entities, components)
+				&& Utils::ReadSceneField<glm::vec4>(stream, components, [](SpriteRendererComponent& c, const glm::vec4& color) { c.Color = color; })
+				&& Utils::ReadSceneField<uint64_t>(stream, components, [](SpriteRendererComponent& c, uint64_t texture) { c.Texture = texture; })
+				&& Utils::ReadSceneField<float>(stream, components, [](SpriteRendererComponent& c, float tilingFactor) { c.TilingFactor = tilingFactor; })
+				&& Utils::ReadSceneField<glm::vec2>(stream, components, [](SpriteRendererComponent& c, const glm::vec2& uvStart) { c.UVStart = uvStart; })
+				&& Utils::ReadSceneField<glm::vec2>(stream, components, [](SpriteRendererComponent& c, const glm::vec2& uvEnd) { c.UVEnd = uvEnd; });
+		}
+
+		{
+			std::vector<CharacterControllerComponent*> components;
+			success = success && Utils::ReadSceneComponents(stream, registry, entities, components)
+				&& Utils::ReadSceneField<uint32_t>(stream, components, [](CharacterControllerComponent& c, uint32_t layerID) { c.LayerID = layerID; })
+				&& Utils::ReadSceneField<uint8_t>(stream, components, [](CharacterControllerComponent& c, uint8_t disableGravity) { c.DisableGravity = disableGravity; })
+				&& Utils::ReadSceneField<float>(stream, components, [](CharacterControllerComponent& c, float slopeLimit) { c.SlopeLimitDeg = slopeLimit; })
+				&& Utils::ReadSceneField<float>(stream, components, [](CharacterControllerComponent& c, float stepOffset) { c.StepOffset = stepOffset; });
+		}
+
+		if (!success)
+		{
+			X2_CORE_ERROR_TAG("SceneSerializer", "Binary scene '{}' is truncated or corrupt", sceneName);
+			return false;
+		}
+
+		// Entities were created in UUID order, same as DeserializeFromYAML()
+		m_Scene->SortEntities();
+		return true;
+	}
+
+	bool SceneSerializer::SerializeToAssetPack(FileStreamWriter& stream, AssetSerializationInfo& outInfo)
+	{
 		outInfo.Offset = stream.GetStreamPosition();
-		std::string yamlString = out.c_str();
-		stream.WriteString(yamlString);
+		bool success = SerializeToBinary(stream);
 		outInfo.Size = stream.GetStreamPosition() - outInfo.Offset;
-		return true;
+		return success;
 	}
 
 	bool SceneSerializer::DeserializeFromAssetPack(FileStreamReader& stream, const AssetPackFile::SceneInfo& sceneInfo)
 	{
 		stream.SetStreamPosition(sceneInfo.PackedOffset);
-		std::string sceneYAML;
-		stream.ReadString(sceneYAML);
-
-		return DeserializeFromYAML(sceneYAML);
+		return DeserializeFromBinary(stream);
 	}
 
 	bool SceneSerializer::DeserializeReferencedPrefabs(const std::filesystem::path& filepath, std::unordered_set<AssetHandle>& outPrefabs)
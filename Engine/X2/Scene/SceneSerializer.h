@@ -25,6 +25,11 @@ namespace X2 {
 		bool Deserialize(const std::filesystem::path& filepath);
 		bool DeserializeRuntime(const std::filesystem::path& filepath);
 
+		// Versioned binary layout used by asset packs. Component fields are stored as columns (SoA)
+		// so loading reads each field in one go instead of walking a YAML tree per entity
+		bool SerializeToBinary(StreamWriter& stream);
+		bool DeserializeFromBinary(StreamReader& stream);
+
 		bool SerializeToAssetPack(FileStreamWriter& stream, AssetSerializationInfo& outInfo);
 		bool DeserializeFromAssetPack(FileStreamReader& stream, const AssetPackFile::SceneInfo& sceneInfo);
 
@@ -37,6 +42,12 @@ namespace X2 {
 		inline static std::string_view DefaultExtension = ".hscene";
 
 	private:
+		struct BinarySceneHeader
+		{
+			const char HEADER[4] = { 'X','2','S','B' };
+			uint32_t Version = 1;
+		};
+
 		Scene* m_Scene;
 	};
 
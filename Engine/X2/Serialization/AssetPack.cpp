@@ -2,6 +2,8 @@
 #include "AssetPack.h"
 
 //#include "X2/Core/Platform.h"
+#include "X2/Core/Debug/Profiler.h"
+#include "X2/Core/JobSystem.h"
 
 #include "X2/Asset/AssetManager.h"
 #include "X2/Scene/Scene.h"
@@ -13,6 +15,17 @@
 
 namespace X2 {
 
+	namespace Utils {
+
+		// Assets whose deserializer only allocates CPU memory and defers GPU work through Renderer::Submit.
+		// Meshes and materials resolve other assets through AssetManager, environments upload cube maps immediately
+		static bool IsParallelLoadSafe(AssetType type)
+		{
+			return type == AssetType::Texture;
+		}
+
+	}
+
 	AssetPack::AssetPack(const std::filesystem::path& path)
 		: m_Path(path)
 	{
@@ -52,7 +65,7 @@ namespace X2 {
 
 		const AssetPackFile::SceneInfo& sceneInfo = it->second;
 
-		FileStreamReader stream(m_Path);
+		FileStreamReader stream(m_PackFile);
 		Ref<Scene> scene = AssetImporter::DeserializeSceneFromAssetPack(stream, sceneInfo);
 		scene->Handle = sceneHandle;
 		return scene;
@@ -96,8 +109,29 @@ namespace X2 {
 				return nullptr;
 		}
 
-		FileStreamReader stream(m_Path);
-		Ref<Asset> asset = AssetImporter::DeserializeFromAssetPack(stream, *assetInfo);
+		FileStreamReader stream(m_PackFile);
+		return DeserializeAsset(stream, assetHandle, *assetInfo);
+	}
+
+	Ref<Asset> AssetPack::DeserializeAsset(FileStreamReader& stream, AssetHandle assetHandle, const AssetPackFile::AssetInfo& assetInfo)
+	{
+		Ref<Asset> asset;
+		if (assetInfo.GetCompression() == AssetPackFile::CompressionType::None)
+		{
+			asset = AssetImporter::DeserializeFromAssetPack(stream, assetInfo);
+		}
+		else
+		{
+			Buffer data;
+			if (!AssetPackSerializer::DecompressAsset(stream, assetInfo, data))
+				return nullptr;
+
+			// Deserializers seek to PackedOffset, so the decoded data is read as if it sat there in the file
+			FileStreamReader dataStream(data, assetInfo.PackedOffset);
+			asset = AssetImporter::DeserializeFromAssetPack(dataStream, assetInfo);
+			data.Release();
+		}
+
 		//X2_CORE_VERIFY(asset);
 		if (!asset)
 			return nullptr;
@@ -106,11 +140,71 @@ namespace X2 {
 		return asset;
 	}
 
+	std::unordered_map<AssetHandle, Ref<Asset>> AssetPack::LoadSceneAssetsParallel(AssetHandle sceneHandle, const std::unordered_set<AssetHandle>& skip)
+	{
+		X2_PROFILE_FUNC();
+
+		std::unordered_map<AssetHandle, Ref<Asset>> result;
+
+		auto it = m_File.Index.Scenes.find(sceneHandle);
+		if (it == m_File.Index.Scenes.end())
+			return result;
+
+		std::vector<std::pair<AssetHandle, const AssetPackFile::AssetInfo*>> work;
+		for (const auto& [assetHandle, assetInfo] : it->second.Assets)
+		{
+			if (Utils::IsParallelLoadSafe((AssetType)assetInfo.Type) && skip.find(assetHandle) == skip.end())
+				work.emplace_back(assetHandle, &assetInfo);
+		}
+
+		if (work.empty())
+			return result;
+
+		// Each task walks its own slice with a private reader over the shared mapping
+		const uint32_t taskCount = std::min((uint32_t)work.size(), JobSystem::GetWorkerCount() + 1);
+		std::vector<std::vector<Ref<Asset>>> taskAssets(taskCount);
+		JobSystem::ParallelFor(taskCount, 1, [this, &work, &taskAssets, taskCount](uint32_t begin, uint32_t end)
+		{
+			for (uint32_t task = begin; task < end; task++)
+			{
+				FileStreamReader stream(m_PackFile);
+				for (size_t i = task; i < work.size(); i += taskCount)
+					taskAssets[task].push_back(DeserializeAsset(stream, work[i].first, *work[i].second));
+			}
+		});
+
+		for (const std::vector<Ref<Asset>>& assets : taskAssets)
+		{
+			for (size_t i = 0; i < assets.size(); i++)
+			{
+				if (assets[i])
+					result[assets[i]->Handle] = assets[i];
+			}
+		}
+
+		return result;
+	}
+
 	bool AssetPack::IsAssetHandleValid(AssetHandle assetHandle) const
 	{
 		return m_AssetHandleIndex.find(assetHandle) != m_AssetHandleIndex.end();
 	}
 
+	AssetType AssetPack::GetAssetType(AssetHandle assetHandle) const
+	{
+		if (m_File.Index.Scenes.find(assetHandle) != m_File.Index.Scenes.end())
+			return AssetType::Scene;
+
+		for (const auto& [handle, sceneInfo] : m_File.Index.Scenes)
+		{
+			auto assetIt = sceneInfo.Assets.find(assetHandle);
+			if (assetIt != sceneInfo.Assets.end())
+				return (AssetType)assetIt->second.Type;
+		}
+
+		return AssetType::None;
+	}
+
 	bool AssetPack::IsAssetHandleValid(AssetHandle sceneHandle, AssetHandle assetHandle) const
 	{
 		auto sceneIterator = m_File.Index.Scenes.find(sceneHandle);
@@ -123,7 +217,7 @@ namespace X2 {
 
 	Buffer AssetPack::ReadAppBinary()
 	{
-		FileStreamReader stream(m_Path);
+		FileStreamReader stream(m_PackFile);
 		stream.SetStreamPosition(m_File.Index.PackedAppBinaryOffset);
 		Buffer buffer;
 		stream.ReadBuffer(buffer);
@@ -151,12 +245,15 @@ namespace X2 {
 		std::unordered_set<AssetHandle> fullAssetList;
 		const AssetRegistry& registry = Project::GetEditorAssetManager()->GetAssetRegistry();
 
-		uint32_t sceneCount = 0;
-		for (const auto& [handle, metadata] : registry)
-		{
-			if (metadata.Type == AssetType::Scene)
-				sceneCount++;
-		}
+		// Copied out of the registry, loading the scenes below goes back into it
+		std::vector<AssetMetadata> scenes;
+		registry.ForEach([&scenes](const AssetMetadata& metadata)
+			{
+				if (metadata.Type == AssetType::Scene)
+					scenes.push_back(metadata);
+			});
+
+		uint32_t sceneCount = (uint32_t)scenes.size();
 
 		float progressIncrement = 0.5f / (float)sceneCount;
 
@@ -172,65 +269,63 @@ namespace X2 {
 		//std::unordered_set<AssetHandle> audioFiles = AssetManager::GetAllAssetsWithType<AudioFile>();
 		//fullAssetList.insert(audioFiles.begin(), audioFiles.end());
 
-		for (const auto& [handle, metadata] : registry)
+		for (const AssetMetadata& metadata : scenes)
 		{
-			if (metadata.Type == AssetType::Scene)
+			AssetHandle handle = metadata.Handle;
+			Ref<Scene> scene = CreateRef<Scene>("AssetPack", true, false);
+			SceneSerializer serializer(scene.get());
+			X2_CORE_TRACE("Deserializing Scene: {}", metadata.FilePath);
+			if (serializer.Deserialize(Project::GetAssetDirectory() / metadata.FilePath))
 			{
-				Ref<Scene> scene = CreateRef<Scene>("AssetPack", true, false);
-				SceneSerializer serializer(scene.get());
-				X2_CORE_TRACE("Deserializing Scene: {}", metadata.FilePath);
-				if (serializer.Deserialize(Project::GetAssetDirectory() / metadata.FilePath))
-				{
-					std::unordered_set<AssetHandle> sceneAssetList = scene->GetAssetList();
-					X2_CORE_TRACE("  Scene has {} used assets", sceneAssetList.size());
+				std::unordered_set<AssetHandle> sceneAssetList = scene->GetAssetList();
+				X2_CORE_TRACE("  Scene has {} used assets", sceneAssetList.size());
 
-					std::unordered_set<AssetHandle> sceneAssetListWithoutPrefabs = sceneAssetList;
-					for (AssetHandle assetHandle : sceneAssetListWithoutPrefabs)
+				std::unordered_set<AssetHandle> sceneAssetListWithoutPrefabs = sceneAssetList;
+				for (AssetHandle assetHandle : sceneAssetListWithoutPrefabs)
+				{
+					const auto& metadata = Project::GetEditorAssetManager()->GetMetadata(assetHandle);
+					if (metadata.Type == AssetType::Prefab)
 					{
-						const auto& metadata = Project::GetEditorAssetManager()->GetMetadata(assetHandle);
-						if (metadata.Type == AssetType::Prefab)
-						{
-							Ref<Prefab> prefab = AssetManager::GetAsset<Prefab>(assetHandle);
-							std::unordered_set<AssetHandle> childPrefabAssetList = prefab->GetAssetList(true);
-							sceneAssetList.insert(childPrefabAssetList.begin(), childPrefabAssetList.end());
-						}
+						Ref<Prefab> prefab = AssetManager::GetAsset<Prefab>(assetHandle);
+						std::unordered_set<AssetHandle> childPrefabAssetList = prefab->GetAssetList(true);
+						sceneAssetList.insert(childPrefabAssetList.begin(), childPrefabAssetList.end());
 					}
+				}
 
-				/*	sceneAssetList.insert(audioAssets.begin(), audioAssets.end());
-					sceneAssetList.insert(soundGraphs.begin(), soundGraphs.end());
-					sceneAssetList.insert(audioFiles.begin(), audioFiles.end());*/
-
-					AssetPackFile::SceneInfo& sceneInfo = assetPackFile.Index.Scenes[handle];
-					for (AssetHandle assetHandle : sceneAssetList)
-					{
-						AssetPackFile::AssetInfo& assetInfo = sceneInfo.Assets[assetHandle];
-						const auto& assetMetadata = Project::GetEditorAssetManager()->GetMetadata(assetHandle);
-						assetInfo.Type = (uint16_t)assetMetadata.Type;
-
-						// For AnimationController asset, we need to make sure each of the "states" that it refers
-						// to has been loaded in order that we can then serialize it to asset pack correctly.
-						// (as otherwise the lazy-loaded skeleton assets don't end up in the asset pack)
-						
-						//if (assetMetadata.Type == AssetType::AnimationController) {
-						//	Ref<AnimationController> controller = AssetManager::GetAsset<AnimationController>(assetHandle);
-						//	for (size_t stateIndex = 0; stateIndex < controller->GetNumStates(); ++stateIndex)
-						//	{
-						//		const auto& state = controller->GetAnimationState(stateIndex);
-
-						//		// GetAnimation() will either load skeleton from DCC, or push given skeleton into the animation asset
-						//		const auto& anim = state->GetAnimationAsset()->GetAnimation(state->GetAnimationIndex(), controller->GetSkeletonAsset()->GetSkeleton());
-						//	}
-						//}
-					}
+			/*	sceneAssetList.insert(audioAssets.begin(), audioAssets.end());
+				sceneAssetList.insert(soundGraphs.begin(), soundGraphs.end());
+				sceneAssetList.insert(audioFiles.begin(), audioFiles.end());*/
 
-					fullAssetList.insert(sceneAssetList.begin(), sceneAssetList.end());
-				}
-				else
+				AssetPackFile::SceneInfo& sceneInfo = assetPackFile.Index.Scenes[handle];
+				for (AssetHandle assetHandle : sceneAssetList)
 				{
-					X2_CONSOLE_LOG_ERROR("Failed to deserialize Scene: {} ({})", metadata.FilePath, handle);
+					AssetPackFile::AssetInfo& assetInfo = sceneInfo.Assets[assetHandle];
+					const auto& assetMetadata = Project::GetEditorAssetManager()->GetMetadata(assetHandle);
+					assetInfo.Type = (uint16_t)assetMetadata.Type;
+
+					// For AnimationController asset, we need to make sure each of the "states" that it refers
+					// to has been loaded in order that we can then serialize it to asset pack correctly.
+					// (as otherwise the lazy-loaded skeleton assets don't end up in the asset pack)
+					
+					//if (assetMetadata.Type == AssetType::AnimationController) {
+					//	Ref<AnimationController> controller = AssetManager::GetAsset<AnimationController>(assetHandle);
+					//	for (size_t stateIndex = 0; stateIndex < controller->GetNumStates(); ++stateIndex)
+					//	{
+					//		const auto& state = controller->GetAnimationState(stateIndex);
+
+					//		// GetAnimation() will either load skeleton from DCC, or push given skeleton into the animation asset
+					//		const auto& anim = state->GetAnimationAsset()->GetAnimation(state->GetAnimationIndex(), controller->GetSkeletonAsset()->GetSkeleton());
+					//	}
+					//}
 				}
-				progress = progress + progressIncrement;
+
+				fullAssetList.insert(sceneAssetList.begin(), sceneAssetList.end());
+			}
+			else
+			{
+				X2_CONSOLE_LOG_ERROR("Failed to deserialize Scene: {} ({})", metadata.FilePath, handle);
 			}
+			progress = progress + progressIncrement;
 		}
 
 #if 0
@@ -280,6 +375,11 @@ namespace X2 {
 		if (!success)
 			return nullptr;
 
+		success = assetPack->m_PackFile.Open(assetPack->m_Path);
+		X2_CORE_VERIFY(success);
+		if (!success)
+			return nullptr;
+
 		// Populate asset handle index
 		const auto& index = assetPack->m_File.Index;
 		for (const auto& [sceneHandle, sceneInfo] : index.Scenes)
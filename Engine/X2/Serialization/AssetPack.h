@@ -4,6 +4,7 @@
 #include <map>
 
 #include "X2/Core/UUID.h"
+#include "X2/Utilities/FileSystem.h"
 #include "X2/Asset/Asset.h"
 #include "X2/Scene/Scene.h"
 
@@ -24,8 +25,12 @@ namespace X2 {
 
 		Ref<Scene> LoadScene(AssetHandle sceneHandle);
 		Ref<Asset> LoadAsset(AssetHandle sceneHandle, AssetHandle assetHandle);
+		// Decodes the scene's assets that are safe to load off the main thread, in parallel
+		std::unordered_map<AssetHandle, Ref<Asset>> LoadSceneAssetsParallel(AssetHandle sceneHandle, const std::unordered_set<AssetHandle>& skip);
 
 		bool IsAssetHandleValid(AssetHandle assetHandle) const;
+		// From the index, without loading the asset
+		AssetType GetAssetType(AssetHandle assetHandle) const;
 		bool IsAssetHandleValid(AssetHandle sceneHandle, AssetHandle assetHandle) const;
 
 		Buffer ReadAppBinary();
@@ -38,9 +43,14 @@ namespace X2 {
 		static Ref<AssetPack> CreateFromActiveProject(std::atomic<float>& progress);
 		static Ref<AssetPack> Load(const std::filesystem::path& path);
 		static Ref<AssetPack> LoadActiveProject();
+	private:
+		// Handles compressed assets, which are decoded into memory and read from there
+		Ref<Asset> DeserializeAsset(FileStreamReader& stream, AssetHandle assetHandle, const AssetPackFile::AssetInfo& assetInfo);
 	private:
 		std::filesystem::path m_Path;
 		AssetPackFile m_File;
+		// Shared by every reader, assets are decoded in place from it
+		MappedFile m_PackFile;
 
 		AssetPackSerializer m_Serializer;
 
@@ -8,12 +8,33 @@ namespace X2 {
 
 	struct AssetPackFile
 	{
+		// Stored in the low bits of AssetInfo::Flags
+		enum class CompressionType : uint16_t
+		{
+			None = 0,
+			LZ4 = 1
+		};
+		static constexpr uint16_t CompressionMask = 0xf;
+
+		// Compressed assets start with this header, followed by a uint32_t compressed size per chunk
+		// and the chunks themselves. Chunks are independent so they can be decoded in parallel
+		struct CompressedAssetHeader
+		{
+			uint64_t UncompressedSize;
+			uint32_t ChunkSize;
+			uint32_t ChunkCount;
+		};
+		// Set on a chunk size when the chunk did not compress and is stored as is
+		static constexpr uint32_t StoredChunkFlag = 0x80000000;
+
 		struct AssetInfo
 		{
 			uint64_t PackedOffset;
 			uint64_t PackedSize;
 			uint16_t Type;
 			uint16_t Flags; // compressed type, etc.
+
+			CompressionType GetCompression() const { return (CompressionType)(Flags & CompressionMask); }
 		};
 
 		struct SceneInfo
@@ -33,8 +54,8 @@ namespace X2 {
 
 		struct FileHeader
 		{
-			const char HEADER[4] = { 'H','Z','A','P' };
-			uint32_t Version = 2;
+			const char HEADER[4] = { 'X','2','A','P' };
+			uint32_t Version = 4;
 			uint64_t BuildVersion = 0; // Usually date/time format (eg. 202210061535)
 		};
 
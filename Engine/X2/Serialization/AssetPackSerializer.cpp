@@ -3,6 +3,9 @@
 #include "X2/Asset/AssetImporter.h"
 
 #include "X2/Serialization/FileStream.h"
+#include "X2/Core/Compression.h"
+#include "X2/Core/JobSystem.h"
+#include "X2/Core/Debug/Profiler.h"
 
 #include <filesystem>
 #include <fstream>
@@ -10,6 +13,36 @@
 
 namespace X2 {
 
+	namespace Utils {
+
+		// Large enough to compress well, small enough that one big mesh or texture spreads over every core
+		static constexpr uint32_t s_CompressionChunkSize = 256 * 1024;
+
+		static AssetPackFile::CompressionType GetAssetPackCompression(AssetType type)
+		{
+			// The bulk of a pack, everything else is small enough that compression only costs load latency
+			switch (type)
+			{
+				case AssetType::MeshSource:
+				case AssetType::Texture:
+				case AssetType::EnvMap:
+					return AssetPackFile::CompressionType::LZ4;
+			}
+			return AssetPackFile::CompressionType::None;
+		}
+
+		template<typename Func>
+		static void ParallelForChunks(uint32_t chunkCount, Func&& func)
+		{
+			JobSystem::ParallelFor(chunkCount, 1, [&func](uint32_t begin, uint32_t end)
+			{
+				for (uint32_t chunk = begin; chunk < end; chunk++)
+					func(chunk);
+			});
+		}
+
+	}
+
 	static void CreateDirectoriesIfNeeded(const std::filesystem::path& path)
 	{
 		std::filesystem::path directory = path.parent_path();
@@ -39,7 +72,9 @@ namespace X2 {
 		uint64_t indexTableSize = CalculateIndexTableSize(file);
 		serializer.WriteZero(indexTableSize);
 
-		std::unordered_map<AssetHandle, AssetSerializationInfo> serializedAssets;
+		std::unordered_map<AssetHandle, AssetPackFile::AssetInfo> serializedAssets;
+		std::vector<uint8_t> assetData;
+		uint64_t uncompressedSize = 0, compressedSize = 0;
 
 		float progressIncrement = 0.4f / (float)file.Index.Scenes.size();
 
@@ -64,17 +99,44 @@ namespace X2 {
 				if (serializedAssets.find(assetHandle) != serializedAssets.end())
 				{
 					// Has already been serialized
-					serializationInfo = serializedAssets.at(assetHandle);
-					file.Index.Scenes[sceneHandle].Assets[assetHandle].PackedOffset = serializationInfo.Offset;
-					file.Index.Scenes[sceneHandle].Assets[assetHandle].PackedSize = serializationInfo.Size;
+					const AssetPackFile::AssetInfo& serializedInfo = serializedAssets.at(assetHandle);
+					assetInfo.PackedOffset = serializedInfo.PackedOffset;
+					assetInfo.PackedSize = serializedInfo.PackedSize;
+					assetInfo.Flags = serializedInfo.Flags;
 				}
 				else
 				{
-					// Serialize asset
-					AssetImporter::SerializeToAssetPack(assetHandle, serializer, serializationInfo);
-					file.Index.Scenes[sceneHandle].Assets[assetHandle].PackedOffset = serializationInfo.Offset;
-					file.Index.Scenes[sceneHandle].Assets[assetHandle].PackedSize = serializationInfo.Size;
-					serializedAssets[assetHandle] = serializationInfo;
+					AssetPackFile::CompressionType compression = Utils::GetAssetPackCompression((AssetType)assetInfo.Type);
+					if (compression == AssetPackFile::CompressionType::None)
+					{
+						// Serialize asset
+						AssetImporter::SerializeToAssetPack(assetHandle, serializer, serializationInfo);
+						assetInfo.Flags = 0;
+					}
+					else
+					{
+						// Serialize into memory at the offset it will be read back from, then compress
+						FileStreamWriter memoryStream(assetData, serializer.GetStreamPosition());
+						AssetImporter::SerializeToAssetPack(assetHandle, memoryStream, serializationInfo);
+						uncompressedSize += assetData.size();
+
+						uint64_t packedSize = WriteCompressed(serializer, assetData, compression);
+						if (packedSize)
+						{
+							serializationInfo.Size = packedSize;
+							assetInfo.Flags = (uint16_t)compression;
+						}
+						else
+						{
+							serializer.WriteData((const char*)assetData.data(), assetData.size());
+							assetInfo.Flags = 0;
+						}
+						compressedSize += serializationInfo.Size;
+					}
+
+					assetInfo.PackedOffset = serializationInfo.Offset;
+					assetInfo.PackedSize = serializationInfo.Size;
+					serializedAssets[assetHandle] = assetInfo;
 				}
 			}
 
@@ -82,6 +144,7 @@ namespace X2 {
 		}
 
 		X2_CORE_TRACE("Serialized {} assets into AssetPack", serializedAssets.size());
+		X2_CORE_TRACE("  compressible assets: {} bytes -> {} bytes", uncompressedSize, compressedSize);
 
 		serializer.SetStreamPosition(indexPos);
 		serializer.WriteRaw<uint64_t>(file.Index.PackedAppBinaryOffset);
@@ -117,6 +180,12 @@ namespace X2 {
 		if (!validHeader)
 			return false;
 
+		if (file.Header.Version != AssetPackFile::FileHeader().Version)
+		{
+			X2_CORE_ERROR("AssetPack version {} is not supported (expected {}), rebuild the asset pack", file.Header.Version, AssetPackFile::FileHeader().Version);
+			return false;
+		}
+
 		// Read app binary info
 		stream.ReadRaw<uint64_t>(file.Index.PackedAppBinaryOffset);
 		stream.ReadRaw<uint64_t>(file.Index.PackedAppBinarySize);
@@ -140,6 +209,127 @@ namespace X2 {
 		return true;
 	}
 
+	bool AssetPackSerializer::DecompressAsset(FileStreamReader& stream, const AssetPackFile::AssetInfo& assetInfo, Buffer& outData)
+	{
+		X2_PROFILE_FUNC();
+
+		X2_CORE_VERIFY(assetInfo.GetCompression() == AssetPackFile::CompressionType::LZ4);
+
+		stream.SetStreamPosition(assetInfo.PackedOffset);
+		AssetPackFile::CompressedAssetHeader header;
+		if (assetInfo.PackedSize < sizeof(header) || !stream.ReadData((char*)&header, sizeof(header)) || header.ChunkCount == 0 || header.ChunkSize == 0)
+			return false;
+
+		// Everything below is sized from the header, check it against the asset's recorded size before allocating.
+		// Every chunk takes at least its 4 byte entry in the size table.
+		const uint64_t payloadSize = assetInfo.PackedSize - sizeof(header);
+		if ((uint64_t)header.ChunkCount * sizeof(uint32_t) > payloadSize)
+			return false;
+
+		if (header.UncompressedSize == 0 || header.UncompressedSize > Compression::GetLZ4MaxDecodedSize(payloadSize)
+			|| (header.UncompressedSize + header.ChunkSize - 1) / header.ChunkSize != header.ChunkCount)
+		{
+			X2_CORE_ERROR("AssetPack: invalid compressed asset header at offset {}", assetInfo.PackedOffset);
+			return false;
+		}
+
+		// Copied out, the table is not necessarily aligned in the file
+		std::vector<uint32_t> chunkSizes(header.ChunkCount);
+		if (!stream.ReadData((char*)chunkSizes.data(), sizeof(uint32_t) * header.ChunkCount))
+			return false;
+
+		// Locate every chunk up front so they decode independently
+		std::vector<const uint8_t*> chunks(header.ChunkCount);
+		for (uint32_t chunk = 0; chunk < header.ChunkCount; chunk++)
+		{
+			chunks[chunk] = stream.ReadView(chunkSizes[chunk] & ~AssetPackFile::StoredChunkFlag);
+			if (!chunks[chunk])
+				return false;
+		}
+
+		outData.Allocate(header.UncompressedSize);
+
+		std::atomic<bool> success = true;
+		Utils::ParallelForChunks(header.ChunkCount, [&](uint32_t chunk)
+		{
+			uint64_t offset = (uint64_t)chunk * header.ChunkSize;
+			uint64_t size = std::min<uint64_t>(header.ChunkSize, header.UncompressedSize - std::min(offset, header.UncompressedSize));
+			uint8_t* destination = (uint8_t*)outData.Data + offset;
+
+			uint32_t packedSize = chunkSizes[chunk] & ~AssetPackFile::StoredChunkFlag;
+			if (chunkSizes[chunk] & AssetPackFile::StoredChunkFlag)
+			{
+				if (packedSize != size)
+					success = false;
+				else
+					memcpy(destination, chunks[chunk], size);
+			}
+			else if (!Compression::DecompressLZ4(chunks[chunk], packedSize, destination, size))
+			{
+				success = false;
+			}
+		});
+
+		if (!success)
+		{
+			X2_CORE_ERROR("AssetPack: failed to decompress asset at offset {}", assetInfo.PackedOffset);
+			outData.Release();
+			return false;
+		}
+		return true;
+	}
+
+	uint64_t AssetPackSerializer::WriteCompressed(FileStreamWriter& stream, const std::vector<uint8_t>& data, AssetPackFile::CompressionType compression)
+	{
+		X2_PROFILE_FUNC();
+
+		X2_CORE_VERIFY(compression == AssetPackFile::CompressionType::LZ4);
+
+		if (data.empty())
+			return 0;
+
+		AssetPackFile::CompressedAssetHeader header;
+		header.UncompressedSize = data.size();
+		header.ChunkSize = Utils::s_CompressionChunkSize;
+		header.ChunkCount = (uint32_t)((data.size() + header.ChunkSize - 1) / header.ChunkSize);
+
+		std::vector<std::vector<uint8_t>> chunks(header.ChunkCount);
+		std::vector<uint32_t> chunkSizes(header.ChunkCount);
+		Utils::ParallelForChunks(header.ChunkCount, [&](uint32_t chunk)
+		{
+			uint64_t offset = (uint64_t)chunk * header.ChunkSize;
+			uint64_t size = std::min<uint64_t>(header.ChunkSize, data.size() - offset);
+
+			std::vector<uint8_t>& compressed = chunks[chunk];
+			compressed.resize(Compression::GetLZ4Bound(size));
+			uint64_t compressedSize = Compression::CompressLZ4(data.data() + offset, size, compressed.data(), compressed.size());
+			if (compressedSize == 0 || compressedSize >= size)
+			{
+				compressed.assign(data.begin() + offset, data.begin() + offset + size);
+				chunkSizes[chunk] = (uint32_t)size | AssetPackFile::StoredChunkFlag;
+			}
+			else
+			{
+				compressed.resize(compressedSize);
+				chunkSizes[chunk] = (uint32_t)compressedSize;
+			}
+		});
+
+		uint64_t packedSize = sizeof(header) + sizeof(uint32_t) * chunkSizes.size();
+		for (const auto& compressed : chunks)
+			packedSize += compressed.size();
+
+		if (packedSize >= data.size())
+			return 0;
+
+		stream.WriteRaw(header);
+		stream.WriteData((const char*)chunkSizes.data(), sizeof(uint32_t) * chunkSizes.size());
+		for (const auto& compressed : chunks)
+			stream.WriteData((const char*)compressed.data(), compressed.size());
+
+		return packedSize;
+	}
+
 	uint64_t AssetPackSerializer::CalculateIndexTableSize(const AssetPackFile& file)
 	{
 		uint64_t appInfoSize = sizeof(uint64_t) * 2;
@@ -6,13 +6,21 @@
 
 namespace X2 {
 
+	class FileStreamWriter;
+	class FileStreamReader;
+
 	class AssetPackSerializer
 	{
 	public:
 		static void Serialize(const std::filesystem::path& path, AssetPackFile& file, Buffer appBinary, std::atomic<float>& progress);
 		static bool DeserializeIndex(const std::filesystem::path& path, AssetPackFile& file);
+
+		// Decodes a compressed asset into outData (allocated here, owned by the caller)
+		static bool DecompressAsset(FileStreamReader& stream, const AssetPackFile::AssetInfo& assetInfo, Buffer& outData);
 	private:
 		static uint64_t CalculateIndexTableSize(const AssetPackFile& file);
+		// Returns the number of bytes written, 0 if the data does not get smaller and should be stored as is
+		static uint64_t WriteCompressed(FileStreamWriter& stream, const std::vector<uint8_t>& data, AssetPackFile::CompressionType compression);
 	};
 
 }
@@ -11,13 +11,50 @@ namespace X2
 		m_Stream = std::ofstream(path, std::ifstream::out | std::ifstream::binary);
 	}
 
+	FileStreamWriter::FileStreamWriter(std::vector<uint8_t>& memory, uint64_t baseOffset)
+		: m_Memory(&memory), m_BaseOffset(baseOffset)
+	{
+		m_Memory->clear();
+	}
+
 	FileStreamWriter::~FileStreamWriter()
 	{
-		m_Stream.close();
+		if (!m_Memory)
+			m_Stream.close();
+	}
+
+	uint64_t FileStreamWriter::GetStreamPosition()
+	{
+		if (m_Memory)
+			return m_BaseOffset + m_MemoryPosition;
+
+		return m_Stream.tellp();
+	}
+
+	void FileStreamWriter::SetStreamPosition(uint64_t position)
+	{
+		if (m_Memory)
+		{
+			X2_CORE_ASSERT(position >= m_BaseOffset);
+			m_MemoryPosition = position - m_BaseOffset;
+			return;
+		}
+
+		m_Stream.seekp(position);
 	}
 
 	bool FileStreamWriter::WriteData(const char* data, size_t size)
 	{
+		if (m_Memory)
+		{
+			if (m_MemoryPosition + size > m_Memory->size())
+				m_Memory->resize(m_MemoryPosition + size);
+
+			memcpy(m_Memory->data() + m_MemoryPosition, data, size);
+			m_MemoryPosition += size;
+			return true;
+		}
+
 		m_Stream.write(data, size);
 		return true;
 	}
@@ -27,18 +64,70 @@ namespace X2
 	FileStreamReader::FileStreamReader(const std::filesystem::path& path)
 		: m_Path(path)
 	{
-		m_Stream = std::ifstream(path, std::ifstream::in | std::ifstream::binary);
+		if (m_File.Open(path))
+		{
+			m_Data = m_File.GetData();
+			m_Size = m_File.GetSize();
+			m_Good = true;
+		}
+	}
+
+	FileStreamReader::FileStreamReader(const MappedFile& file)
+		: m_Data(file.GetData()), m_Size(file.GetSize()), m_Good(file.IsOpen()), m_PersistentViews(true)
+	{
+	}
+
+	FileStreamReader::FileStreamReader(Buffer data, uint64_t baseOffset)
+		: m_Data((const uint8_t*)data.Data), m_Size(data.Size), m_BaseOffset(baseOffset), m_Good(data.Data != nullptr)
+	{
 	}
 
 	FileStreamReader::~FileStreamReader()
 	{
-		m_Stream.close();
+		m_File.Close();
+	}
+
+	void FileStreamReader::SetStreamPosition(uint64_t position)
+	{
+		if (position < m_BaseOffset)
+		{
+			m_Good = false;
+			return;
+		}
+
+		m_Position = position - m_BaseOffset;
 	}
 
 	bool FileStreamReader::ReadData(char* destination, size_t size)
 	{
-		m_Stream.read(destination, size);
+		const uint8_t* source = ReadView(size);
+		if (!source)
+			return false;
+
+		memcpy(destination, source, size);
 		return true;
 	}
 
+	const uint8_t* FileStreamReader::ReadView(uint64_t size)
+	{
+		if (!m_Good || m_Position > m_Size || size > m_Size - m_Position)
+		{
+			m_Good = false;
+			return nullptr;
+		}
+
+		const uint8_t* view = m_Data + m_Position;
+		m_Position += size;
+		return view;
+	}
+
+	Buffer FileStreamReader::ReadBufferView(uint32_t size)
+	{
+		if (size == 0)
+			ReadData((char*)&size, sizeof(uint32_t));
+
+		const uint8_t* view = ReadView(size);
+		return view ? Buffer(view, size) : Buffer();
+	}
+
 } 
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "StreamWriter.h"
 #include "StreamReader.h"
 #include "X2/Core/Buffer.h"
+#include "X2/Utilities/FileSystem.h"
 
 #include <filesystem>
 #include <fstream>
@@ -15,36 +16,61 @@ namespace X2
 	{
 	public:
 		FileStreamWriter(const std::filesystem::path& path);
+		// Writes into memory as if it were the file starting at baseOffset, so the data can be transformed before it reaches disk
+		FileStreamWriter(std::vector<uint8_t>& memory, uint64_t baseOffset);
 		FileStreamWriter(const FileStreamWriter&) = delete;
 		virtual ~FileStreamWriter();
 
-		bool IsStreamGood() const final { return m_Stream.good(); }
-		uint64_t GetStreamPosition() final { return m_Stream.tellp(); }
-		void SetStreamPosition(uint64_t position) final { m_Stream.seekp(position); }
+		bool IsStreamGood() const final { return m_Memory || m_Stream.good(); }
+		uint64_t GetStreamPosition() final;
+		void SetStreamPosition(uint64_t position) final;
 		bool WriteData(const char* data, size_t size) final;
 
 	private:
 		std::filesystem::path m_Path;
 		std::ofstream m_Stream;
+
+		std::vector<uint8_t>* m_Memory = nullptr;
+		uint64_t m_BaseOffset = 0;
+		uint64_t m_MemoryPosition = 0;
 	};
 
 	//==============================================================================
 	/// FileStreamReader
+	// Reads from a memory mapping of the file, so payloads can be used in place through ReadView/ReadBufferView
 	class FileStreamReader : public StreamReader
 	{
 	public:
 		FileStreamReader(const std::filesystem::path& path);
+		// Reads a mapping owned by the caller, which has to outlive the reader and any views taken from it
+		FileStreamReader(const MappedFile& file);
+		// Reads a buffer as if it were the file starting at baseOffset, used for decompressed pack data
+		FileStreamReader(Buffer data, uint64_t baseOffset);
 		FileStreamReader(const FileStreamReader&) = delete;
 		~FileStreamReader();
 
-		bool IsStreamGood() const final { return m_Stream.good(); }
-		uint64_t GetStreamPosition() override { return m_Stream.tellg(); }
-		void SetStreamPosition(uint64_t position) override { m_Stream.seekg(position); }
+		bool IsStreamGood() const final { return m_Good; }
+		uint64_t GetStreamPosition() override { return m_BaseOffset + m_Position; }
+		void SetStreamPosition(uint64_t position) override;
 		bool ReadData(char* destination, size_t size) override;
 
+		// Returns a pointer into the mapping and advances the stream, nullptr if the file is too short
+		const uint8_t* ReadView(uint64_t size);
+		// Same layout as ReadBuffer, but the returned Buffer points into the mapping and must not be released
+		Buffer ReadBufferView(uint32_t size = 0);
+		// True when views stay valid after the reader is gone, i.e. it reads a mapping owned by the caller
+		bool HasPersistentViews() const { return m_PersistentViews; }
+
 	private:
 		std::filesystem::path m_Path;
-		std::ifstream m_Stream;
+		MappedFile m_File;
+
+		const uint8_t* m_Data = nullptr;
+		uint64_t m_Size = 0;
+		uint64_t m_BaseOffset = 0;
+		uint64_t m_Position = 0;
+		bool m_Good = false;
+		bool m_PersistentViews = false;
 	};
 
 } 
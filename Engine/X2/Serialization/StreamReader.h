@@ -101,11 +101,18 @@ namespace X2
 
 			array.resize(size);
 
-			for (uint32_t i = 0; i < size; i++)
+			if constexpr (std::is_trivial<T>())
 			{
-				if constexpr (std::is_trivial<T>())
-					ReadRaw<T>(array[i]);
-				else
+				// Same layout as element by element, but one read
+				if (size)
+				{
+					bool success = ReadData((char*)array.data(), sizeof(T) * size);
+					X2_CORE_ASSERT(success);
+				}
+			}
+			else
+			{
+				for (uint32_t i = 0; i < size; i++)
 					ReadObject<T>(array[i]);
 			}
 		}
@@ -456,6 +456,87 @@ namespace X2 {
 		return buffer;
 	}
 
+	MappedFile::MappedFile(const std::filesystem::path& filepath)
+	{
+		Open(filepath);
+	}
+
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+	MappedFile::MappedFile(MappedFile&& other) noexcept
+	{
+		*this = std::move(other);
+	}
+
+	MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Close();
+			std::swap(m_FileHandle, other.m_FileHandle);
+			std::swap(m_MappingHandle, other.m_MappingHandle);
+			std::swap(m_Data, other.m_Data);
+			std::swap(m_Size, other.m_Size);
+		}
+		return *this;
+	}
+
+	bool MappedFile::Open(const std::filesystem::path& filepath)
+	{
+		Close();
+
+		HANDLE file = CreateFileW(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+		{
+			// Empty files can't be mapped
+			CloseHandle(file);
+			return false;
+		}
+
+		HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (!mapping)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (!data)
+		{
+			CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+
+		m_FileHandle = file;
+		m_MappingHandle = mapping;
+		m_Data = (const uint8_t*)data;
+		m_Size = (uint64_t)size.QuadPart;
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (m_Data)
+			UnmapViewOfFile(m_Data);
+		if (m_MappingHandle)
+			CloseHandle(m_MappingHandle);
+		if (m_FileHandle)
+			CloseHandle(m_FileHandle);
+
+		m_FileHandle = nullptr;
+		m_MappingHandle = nullptr;
+		m_Data = nullptr;
+		m_Size = 0;
+	}
+
 	std::filesystem::path FileSystem::GetPersistentStoragePath()
 	{
 		if (!s_PersistentStoragePath.empty())
@@ -34,6 +34,33 @@ namespace X2 {
 		std::string OldName = "";
 	};
 
+	// Read-only memory mapping of a whole file. The view stays valid until the object is
+	// closed or destroyed; an empty or missing file maps to no data.
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		explicit MappedFile(const std::filesystem::path& filepath);
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+
+		bool Open(const std::filesystem::path& filepath);
+		void Close();
+
+		bool IsOpen() const { return m_Data != nullptr; }
+		const uint8_t* GetData() const { return m_Data; }
+		uint64_t GetSize() const { return m_Size; }
+	private:
+		void* m_FileHandle = nullptr;
+		void* m_MappingHandle = nullptr;
+		const uint8_t* m_Data = nullptr;
+		uint64_t m_Size = 0;
+	};
+
 	class FileSystem
 	{
 	public:
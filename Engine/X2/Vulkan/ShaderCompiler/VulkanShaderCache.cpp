@@ -1,160 +1,353 @@
 #include "Precompiled.h"
 #include "VulkanShaderCache.h"
 #include "X2/Core/Hash.h"
-#include "X2/Vulkan/VulkanShaderUtils.h"
-
-#include "yaml-cpp/yaml.h"
-#include "X2/Utilities/SerializationMacros.h"
+#include "X2/Utilities/FileSystem.h"
+#include "X2/Core/Debug/Profiler.h"
 
 #include "ShaderPreprocessing/ShaderPreprocessor.h"
 
+#include <mutex>
+
 namespace X2 {
 
-	static const char* s_ShaderRegistryPath = "Resources/Cache/Shader/ShaderRegistry.cache";
+	static const char* s_ShaderRegistryPath = "Resources/Cache/Shader/ShaderRegistry.bin";
 
+	// Registry file layout:
+	//   RegistryHeader
+	//   RegistryEntry[SlotCount]     open addressing table, linear probing, Stage == 0 marks an empty slot
+	//   RegistryInclude[IncludeCount]
+	//   char[StringTableSize]        paths, referenced by offset and length
+	static constexpr uint32_t s_RegistryMagic = 0x52533258; // "X2SR"
+	static constexpr uint32_t s_RegistryVersion = 1;
 
-	VkShaderStageFlagBits VulkanShaderCache::HasChanged(VulkanShaderCompiler* shader)
+	struct RegistryHeader
 	{
-		std::map<std::string, std::map<VkShaderStageFlagBits, StageData>> shaderCache;
-
-		Deserialize(shaderCache);
+		uint32_t Magic;
+		uint32_t Version;
+		uint32_t EntryCount;
+		uint32_t SlotCount;
+		uint32_t IncludeCount;
+		uint32_t StringTableSize;
+	};
+
+	struct RegistryEntry
+	{
+		uint32_t PathHash;
+		uint32_t Stage;
+		uint32_t PathOffset;
+		uint32_t PathLength;
+		uint32_t StageHash;
+		uint32_t FirstInclude;
+		uint32_t IncludeCount;
+	};
+
+	struct RegistryInclude
+	{
+		uint32_t PathOffset;
+		uint32_t PathLength;
+		uint32_t IncludeDepth;
+		uint32_t HashValue;
+		uint32_t Flags;
+	};
+
+	enum RegistryIncludeFlags : uint32_t
+	{
+		IncludeFlag_Relative = 1 << 0,
+		IncludeFlag_Guarded = 1 << 1
+	};
 
-		VkShaderStageFlagBits changedStages = {};
-		const bool shaderNotCached = shaderCache.find(shader->m_ShaderSourcePath.string()) == shaderCache.end();
+	namespace Utils {
 
-		for (const auto& [stage, stageSource] : shader->m_ShaderSource)
+		static uint32_t GetRegistrySlot(uint32_t pathHash, uint32_t stage, uint32_t slotCount)
 		{
-			// Keep in mind that we're using the [] operator.
-			// Which means that we add the stage if it's not already there.
-			if (shaderNotCached || shader->m_StagesMetadata.at(stage) != shaderCache[shader->m_ShaderSourcePath.string()][stage])
-			{
-				shaderCache[shader->m_ShaderSourcePath.string()][stage] = shader->m_StagesMetadata.at(stage);
-				*(int*)&changedStages |= stage;
-			}
+			return (pathHash ^ (stage * 0x9e3779b1u)) & (slotCount - 1);
 		}
 
-		// Update cache in case we added a stage but didn't remove the deleted(in file) stages
-		shaderCache.at(shader->m_ShaderSourcePath.string()) = shader->m_StagesMetadata;
+	}
 
-		if (changedStages)
-		{
-			Serialize(shaderCache);
-		}
+	static std::mutex s_RegistryMutex;
+	static MappedFile s_Registry;
+	static bool s_RegistryMapped = false;
+	static uint32_t s_BatchDepth = 0;
 
-		return changedStages;
+	// Shaders recompiled since the registry was last written, all stages of a shader are replaced
+	static std::map<std::string, std::map<VkShaderStageFlagBits, StageData>> s_PendingShaders;
+
+	static const RegistryEntry* GetEntries(const RegistryHeader* header)
+	{
+		return (const RegistryEntry*)(header + 1);
+	}
+
+	static const RegistryInclude* GetIncludes(const RegistryHeader* header)
+	{
+		return (const RegistryInclude*)(GetEntries(header) + header->SlotCount);
 	}
 
+	static const char* GetStrings(const RegistryHeader* header)
+	{
+		return (const char*)(GetIncludes(header) + header->IncludeCount);
+	}
 
-	void VulkanShaderCache::Serialize(const std::map<std::string, std::map<VkShaderStageFlagBits, StageData>>& shaderCache)
+	// Checks the layout and every offset of the mapped registry once, lookups index it without checks after that
+	static bool ValidateRegistry()
 	{
-		YAML::Emitter out;
+		if (s_Registry.GetSize() < sizeof(RegistryHeader))
+			return false;
 
-		out << YAML::BeginMap << YAML::Key << "ShaderRegistry" << YAML::BeginSeq;// ShaderRegistry_
+		const RegistryHeader* header = (const RegistryHeader*)s_Registry.GetData();
+		if (header->Magic != s_RegistryMagic || header->Version != s_RegistryVersion)
+			return false;
 
-		for (auto& [filepath, shader] : shaderCache)
+		const uint64_t expectedSize = sizeof(RegistryHeader) + (uint64_t)header->SlotCount * sizeof(RegistryEntry)
+			+ (uint64_t)header->IncludeCount * sizeof(RegistryInclude) + header->StringTableSize;
+		if (header->SlotCount == 0 || (header->SlotCount & (header->SlotCount - 1)) || s_Registry.GetSize() != expectedSize)
+			return false;
+
+		auto isInStringTable = [header](uint32_t offset, uint32_t length)
 		{
-			out << YAML::BeginMap; // Shader_
+			return (uint64_t)offset + length <= header->StringTableSize;
+		};
 
-			out << YAML::Key << "ShaderPath" << YAML::Value << filepath;
+		const RegistryEntry* entries = GetEntries(header);
+		for (uint32_t slot = 0; slot < header->SlotCount; slot++)
+		{
+			const RegistryEntry& entry = entries[slot];
+			if (entry.Stage == 0)
+				continue;
 
-			out << YAML::Key << "Stages" << YAML::BeginSeq; // Stages_
+			if (!isInStringTable(entry.PathOffset, entry.PathLength) || (uint64_t)entry.FirstInclude + entry.IncludeCount > header->IncludeCount)
+				return false;
+		}
+
+		const RegistryInclude* includes = GetIncludes(header);
+		for (uint32_t i = 0; i < header->IncludeCount; i++)
+		{
+			if (!isInStringTable(includes[i].PathOffset, includes[i].PathLength))
+				return false;
+		}
+
+		return true;
+	}
 
-			for (auto& [stage, stageData] : shader)
+	static const RegistryHeader* GetRegistry()
+	{
+		if (!s_RegistryMapped)
+		{
+			s_RegistryMapped = true;
+			if (s_Registry.Open(s_ShaderRegistryPath) && !ValidateRegistry())
 			{
-				out << YAML::BeginMap; // Stage_
+				// Every shader then counts as changed, and the registry written after they are compiled replaces this one
+				X2_CORE_WARN("[ShaderCache] Shader Registry is outdated or invalid, rebuilding it.");
+				s_Registry.Close();
+				FileSystem::DeleteFile(s_ShaderRegistryPath);
+			}
+		}
 
-				out << YAML::Key << "Stage" << YAML::Value << ShaderUtils::ShaderStageToString(stage);
-				out << YAML::Key << "StageHash" << YAML::Value << stageData.HashValue;
+		return s_Registry.IsOpen() ? (const RegistryHeader*)s_Registry.GetData() : nullptr;
+	}
 
-				out << YAML::Key << "Headers" << YAML::BeginSeq; // Headers_
-				for (auto& header : stageData.Headers)
-				{
+	static StageData ReadStageData(const RegistryHeader* header, const RegistryEntry& entry)
+	{
+		const RegistryInclude* includes = GetIncludes(header);
+		const char* strings = GetStrings(header);
+
+		StageData stageData;
+		stageData.HashValue = entry.StageHash;
+		for (uint32_t i = 0; i < entry.IncludeCount; i++)
+		{
+			const RegistryInclude& include = includes[entry.FirstInclude + i];
+			stageData.Headers.emplace(IncludeData{ std::string(strings + include.PathOffset, include.PathLength), include.IncludeDepth,
+				(include.Flags & IncludeFlag_Relative) != 0, (include.Flags & IncludeFlag_Guarded) != 0, include.HashValue });
+		}
+		return stageData;
+	}
 
-					out << YAML::BeginMap;
+	VkShaderStageFlagBits VulkanShaderCache::HasChanged(VulkanShaderCompiler* shader)
+	{
+		std::scoped_lock<std::mutex> lock(s_RegistryMutex);
 
-					X2_SERIALIZE_PROPERTY(HeaderPath, header.IncludedFilePath.string(), out);
-					X2_SERIALIZE_PROPERTY(IncludeDepth, header.IncludeDepth, out);
-					X2_SERIALIZE_PROPERTY(IsRelative, header.IsRelative, out);
-					X2_SERIALIZE_PROPERTY(IsGaurded, header.IsGuarded, out);
-					X2_SERIALIZE_PROPERTY(HashValue, header.HashValue, out);
+		const std::string shaderPath = shader->m_ShaderSourcePath.string();
 
-					out << YAML::EndMap;
-				}
-				out << YAML::EndSeq; // Headers_
+		VkShaderStageFlagBits changedStages = {};
+		for (const auto& [stage, stageSource] : shader->m_ShaderSource)
+		{
+			StageData cachedStage;
+			if (!FindStage(shaderPath, stage, cachedStage) || shader->m_StagesMetadata.at(stage) != cachedStage)
+				*(int*)&changedStages |= stage;
+		}
 
-				out << YAML::EndMap; // Stage_
-			}
-			out << YAML::EndSeq; // Stages_
-			out << YAML::EndMap; // Shader_
+		if (changedStages)
+		{
+			// Replaces all stages, so stages deleted from the file are dropped as well
+			s_PendingShaders[shaderPath] = shader->m_StagesMetadata;
 
+			if (s_BatchDepth == 0)
+				Serialize();
 		}
-		out << YAML::EndSeq; // ShaderRegistry_
-		out << YAML::EndMap; // File_
 
-		std::ofstream fout(s_ShaderRegistryPath);
-		fout << out.c_str();
+		return changedStages;
+	}
+
+	void VulkanShaderCache::BeginBatch()
+	{
+		std::scoped_lock<std::mutex> lock(s_RegistryMutex);
+		s_BatchDepth++;
 	}
 
-	void VulkanShaderCache::Deserialize(std::map<std::string, std::map<VkShaderStageFlagBits, StageData>>& shaderCache)
+	void VulkanShaderCache::EndBatch()
 	{
-		// Read registry
-		std::ifstream stream(s_ShaderRegistryPath);
-		if (!stream.good())
-			return;
+		std::scoped_lock<std::mutex> lock(s_RegistryMutex);
+		X2_CORE_ASSERT(s_BatchDepth > 0, "EndBatch without BeginBatch");
 
-		std::stringstream strStream;
-		strStream << stream.rdbuf();
+		if (--s_BatchDepth == 0 && !s_PendingShaders.empty())
+			Serialize();
+	}
 
-		YAML::Node data = YAML::Load(strStream.str());
-		auto handles = data["ShaderRegistry"];
-		if (handles.IsNull())
+	bool VulkanShaderCache::FindStage(const std::string& shaderPath, VkShaderStageFlagBits stage, StageData& outStageData)
+	{
+		auto pending = s_PendingShaders.find(shaderPath);
+		if (pending != s_PendingShaders.end())
 		{
-			X2_CORE_ERROR("[ShaderCache] Shader Registry is invalid.");
-			return;
+			auto pendingStage = pending->second.find(stage);
+			if (pendingStage == pending->second.end())
+				return false;
+
+			outStageData = pendingStage->second;
+			return true;
 		}
 
-		// Old format
-		if (handles.IsMap())
+		const RegistryHeader* header = GetRegistry();
+		if (!header)
+			return false;
+
+		const RegistryEntry* entries = GetEntries(header);
+		const char* strings = GetStrings(header);
+
+		// At most SlotCount probes, a registry without an empty slot must not loop forever
+		const uint32_t pathHash = Hash::GenerateFNVHash(shaderPath);
+		uint32_t slot = Utils::GetRegistrySlot(pathHash, stage, header->SlotCount);
+		for (uint32_t probe = 0; probe < header->SlotCount; probe++, slot = (slot + 1) & (header->SlotCount - 1))
 		{
-			X2_CORE_ERROR("[ShaderCache] Old Shader Registry format.");
-			return;
+			const RegistryEntry& entry = entries[slot];
+			if (entry.Stage == 0)
+				return false;
+
+			if (entry.PathHash == pathHash && entry.Stage == (uint32_t)stage && std::string_view(strings + entry.PathOffset, entry.PathLength) == shaderPath)
+			{
+				outStageData = ReadStageData(header, entry);
+				return true;
+			}
 		}
 
-		for (auto shader : handles)
+		return false;
+	}
+
+	void VulkanShaderCache::Serialize()
+	{
+		X2_PROFILE_FUNC();
+
+		// Merge the mapped registry with the recompiled shaders
+		std::map<std::string, std::map<VkShaderStageFlagBits, StageData>> shaderCache;
+		if (const RegistryHeader* header = GetRegistry())
 		{
-			std::string path;
-			X2_DESERIALIZE_PROPERTY(ShaderPath, path, shader, std::string());
-			for (auto stage : shader["Stages"]) //Stages
+			const RegistryEntry* entries = GetEntries(header);
+			const char* strings = GetStrings(header);
+			for (uint32_t slot = 0; slot < header->SlotCount; slot++)
 			{
-				std::string stageType;
-				uint32_t stageHash;
-				X2_DESERIALIZE_PROPERTY(Stage, stageType, stage, std::string());
-				X2_DESERIALIZE_PROPERTY(StageHash, stageHash, stage, 0u);
+				const RegistryEntry& entry = entries[slot];
+				if (entry.Stage == 0)
+					continue;
 
-				auto& stageCache = shaderCache[path][ShaderUtils::ShaderTypeFromString(stageType)];
-				stageCache.HashValue = stageHash;
+				std::string path(strings + entry.PathOffset, entry.PathLength);
+				if (s_PendingShaders.find(path) == s_PendingShaders.end())
+					shaderCache[path][(VkShaderStageFlagBits)entry.Stage] = ReadStageData(header, entry);
+			}
+		}
 
-				for (auto header : stage["Headers"])
-				{
-					std::string headerPath;
-					uint32_t includeDepth;
-					bool isRelative;
-					bool isGuarded;
-					uint32_t hashValue;
-					X2_DESERIALIZE_PROPERTY(HeaderPath, headerPath, header, std::string());
-					X2_DESERIALIZE_PROPERTY(IncludeDepth, includeDepth, header, 0u);
-					X2_DESERIALIZE_PROPERTY(IsRelative, isRelative, header, false);
-					X2_DESERIALIZE_PROPERTY(IsGaurded, isGuarded, header, false);
-					X2_DESERIALIZE_PROPERTY(HashValue, hashValue, header, 0u);
-
-					stageCache.Headers.emplace(IncludeData{ headerPath, includeDepth, isRelative, isGuarded, hashValue });
+		for (auto& [path, stages] : s_PendingShaders)
+			shaderCache[path] = std::move(stages);
+		s_PendingShaders.clear();
 
-				}
+		// The file can't be replaced while it is mapped
+		s_Registry.Close();
+		s_RegistryMapped = false;
 
-			}
+		uint32_t entryCount = 0;
+		for (const auto& [path, stages] : shaderCache)
+			entryCount += (uint32_t)stages.size();
 
+		uint32_t slotCount = 16;
+		while (slotCount < entryCount * 2)
+			slotCount <<= 1;
+
+		std::vector<RegistryEntry> entries(slotCount, RegistryEntry{});
+		std::vector<RegistryInclude> includes;
+		std::string strings;
+
+		auto addString = [&strings](const std::string& string)
+		{
+			const uint32_t offset = (uint32_t)strings.size();
+			strings += string;
+			return offset;
+		};
+
+		for (const auto& [path, stages] : shaderCache)
+		{
+			const uint32_t pathHash = Hash::GenerateFNVHash(path);
+			const uint32_t pathOffset = addString(path);
+
+			for (const auto& [stage, stageData] : stages)
+			{
+				uint32_t slot = Utils::GetRegistrySlot(pathHash, stage, slotCount);
+				while (entries[slot].Stage != 0)
+					slot = (slot + 1) & (slotCount - 1);
+
+				RegistryEntry& entry = entries[slot];
+				entry.PathHash = pathHash;
+				entry.Stage = (uint32_t)stage;
+				entry.PathOffset = pathOffset;
+				entry.PathLength = (uint32_t)path.size();
+				entry.StageHash = stageData.HashValue;
+				entry.FirstInclude = (uint32_t)includes.size();
+				entry.IncludeCount = (uint32_t)stageData.Headers.size();
+
+				for (const IncludeData& header : stageData.Headers)
+				{
+					const std::string headerPath = header.IncludedFilePath.string();
+
+					RegistryInclude& include = includes.emplace_back();
+					include.PathOffset = addString(headerPath);
+					include.PathLength = (uint32_t)headerPath.size();
+					include.IncludeDepth = (uint32_t)header.IncludeDepth;
+					include.HashValue = header.HashValue;
+					include.Flags = (header.IsRelative ? IncludeFlag_Relative : 0) | (header.IsGuarded ? IncludeFlag_Guarded : 0);
+				}
+			}
 		}
 
+		RegistryHeader header;
+		header.Magic = s_RegistryMagic;
+		header.Version = s_RegistryVersion;
+		header.EntryCount = entryCount;
+		header.SlotCount = slotCount;
+		header.IncludeCount = (uint32_t)includes.size();
+		header.StringTableSize = (uint32_t)strings.size();
+
+		std::vector<uint8_t> data(sizeof(RegistryHeader) + entries.size() * sizeof(RegistryEntry) + includes.size() * sizeof(RegistryInclude) + strings.size());
+		uint8_t* writePtr = data.data();
+		auto write = [&writePtr](const void* source, size_t size)
+		{
+			if (size)
+				memcpy(writePtr, source, size);
+			writePtr += size;
+		};
+		write(&header, sizeof(RegistryHeader));
+		write(entries.data(), entries.size() * sizeof(RegistryEntry));
+		write(includes.data(), includes.size() * sizeof(RegistryInclude));
+		write(strings.data(), strings.size());
+
+		if (!FileSystem::WriteBytes(s_ShaderRegistryPath, Buffer(data.data(), data.size())))
+			X2_CORE_ERROR("[ShaderCache] Failed to write Shader Registry {}", s_ShaderRegistryPath);
 	}
 
 }
@@ -7,13 +7,22 @@
 
 namespace X2 {
 
+	//
+	// Registry of the stage metadata (source and header hashes) each shader was last compiled
+	// with. It is stored as a binary hash table that is memory mapped and probed in place, keyed
+	// by source path and stage. Changes are kept in memory and written out once per batch.
+	//
 	class VulkanShaderCache
 	{
 	public:
 		static VkShaderStageFlagBits HasChanged(VulkanShaderCompiler* shader);
+
+		// Defers writing the registry until the matching EndBatch(), used while loading the shader library
+		static void BeginBatch();
+		static void EndBatch();
 	private:
-		static void Serialize(const std::map<std::string, std::map<VkShaderStageFlagBits, StageData>>& shaderCache);
-		static void Deserialize(std::map<std::string, std::map<VkShaderStageFlagBits, StageData>>& shaderCache);
+		static bool FindStage(const std::string& shaderPath, VkShaderStageFlagBits stage, StageData& outStageData);
+		static void Serialize();
 	};
 
 }
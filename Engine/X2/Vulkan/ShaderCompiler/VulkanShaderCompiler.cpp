@@ -15,6 +15,8 @@
 #include <libshaderc_util/file_finder.h>
 
 #include "X2/Core/Hash.h"
+#include "X2/Core/JobSystem.h"
+#include "X2/Core/Debug/Profiler.h"
 
 #include "X2/Vulkan/VulkanShader.h"
 #include "X2/Vulkan/VulkanContext.h"
@@ -77,6 +79,15 @@ namespace X2 {
 	}
 
 	bool VulkanShaderCompiler::Reload(bool forceCompile)
+	{
+		if (!CompileStages(forceCompile))
+			return false;
+
+		LoadReflectionData(forceCompile);
+		return true;
+	}
+
+	bool VulkanShaderCompiler::CompileStages(bool forceCompile)
 	{
 		m_ShaderSource.clear();
 		m_StagesMetadata.clear();
@@ -89,24 +100,26 @@ namespace X2 {
 
 		X2_CORE_TRACE_TAG("Renderer", "Compiling shader: {}", m_ShaderSourcePath.string());
 		m_ShaderSource = PreProcess(source);
-		const VkShaderStageFlagBits changedStages = VulkanShaderCache::HasChanged(this);
+		m_ChangedStages = VulkanShaderCache::HasChanged(this);
 
-		bool compileSucceeded = CompileOrGetVulkanBinaries(m_SPIRVDebugData, m_SPIRVData, changedStages, forceCompile);
+		bool compileSucceeded = CompileOrGetVulkanBinaries(m_SPIRVDebugData, m_SPIRVData, m_ChangedStages, forceCompile);
 		if (!compileSucceeded)
 		{
 			X2_CORE_ASSERT(false);
 			return false;
 		}
 
+		return true;
+	}
 
-		// Reflection
-		if (forceCompile || changedStages || !TryReadCachedReflectionData())
+	void VulkanShaderCompiler::LoadReflectionData(bool forceCompile)
+	{
+		// Reflection merges buffers into the shared uniform/storage buffer tables, so it stays on one thread
+		if (forceCompile || m_ChangedStages || !TryReadCachedReflectionData())
 		{
 			ReflectAllShaderStages(m_SPIRVDebugData);
 			SerializeReflectionData();
 		}
-
-		return true;
 	}
 
 	void VulkanShaderCompiler::ClearUniformBuffers()
@@ -131,7 +144,8 @@ namespace X2 {
 	{
 		std::map<VkShaderStageFlagBits, std::string> shaderSources = ShaderPreprocessor::PreprocessShader<ShaderUtils::SourceLang::GLSL>(source, m_AcknowledgedMacros);
 
-		static shaderc::Compiler compiler;
+		// One compiler per thread, shaders are compiled in parallel by CompileBatch
+		thread_local shaderc::Compiler compiler;
 
 		shaderc_util::FileFinder fileFinder;
 		fileFinder.search_path().emplace_back(std::string(PROJECT_ROOT)+"Resources/Shaders/Include/GLSL/"); //Main include directory
@@ -171,7 +185,7 @@ namespace X2 {
 
 		if (m_Language == ShaderUtils::SourceLang::GLSL)
 		{
-			static shaderc::Compiler compiler;
+			thread_local shaderc::Compiler compiler;
 			shaderc::CompileOptions shaderCOptions;
 			shaderCOptions.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_2);
 			shaderCOptions.SetWarningsAsErrors();
@@ -194,27 +208,62 @@ namespace X2 {
 	}
 
 	Ref<VulkanShader> VulkanShaderCompiler::Compile(const std::filesystem::path& shaderSourcePath, bool forceCompile, bool disableOptimization)
+	{
+		Ref<VulkanShaderCompiler> compiler = CreateRef<VulkanShaderCompiler>(shaderSourcePath, disableOptimization);
+		compiler->Reload(forceCompile);
+
+		return CreateShader(*compiler);
+	}
+
+	std::vector<Ref<VulkanShader>> VulkanShaderCompiler::CompileBatch(const std::vector<std::filesystem::path>& shaderSourcePaths, bool forceCompile)
+	{
+		X2_PROFILE_FUNC();
+
+		std::vector<Ref<VulkanShaderCompiler>> compilers;
+		compilers.reserve(shaderSourcePaths.size());
+		for (const auto& shaderSourcePath : shaderSourcePaths)
+			compilers.push_back(CreateRef<VulkanShaderCompiler>(shaderSourcePath));
+
+		// Preprocessing and shaderc dominate, run them on all cores
+		std::vector<uint8_t> compileSucceeded(compilers.size(), 0);
+		JobSystem::ParallelFor((uint32_t)compilers.size(), 1, [&](uint32_t begin, uint32_t end)
+			{
+				for (uint32_t i = begin; i < end; i++)
+					compileSucceeded[i] = compilers[i]->CompileStages(forceCompile);
+			});
+
+		std::vector<Ref<VulkanShader>> shaders;
+		shaders.reserve(compilers.size());
+		for (size_t i = 0; i < compilers.size(); i++)
+		{
+			if (compileSucceeded[i])
+				compilers[i]->LoadReflectionData(forceCompile);
+
+			shaders.push_back(CreateShader(*compilers[i]));
+		}
+
+		return shaders;
+	}
+
+	Ref<VulkanShader> VulkanShaderCompiler::CreateShader(const VulkanShaderCompiler& compiler)
 	{
 		// Set name
-		std::string path = shaderSourcePath.string();
+		std::string path = compiler.m_ShaderSourcePath.string();
 		size_t found = path.find_last_of("/\\");
 		std::string name = found != std::string::npos ? path.substr(found + 1) : path;
 		found = name.find_last_of('.');
 		name = found != std::string::npos ? name.substr(0, found) : name;
 
 		Ref<VulkanShader> shader = CreateRef<VulkanShader>();
-		shader->m_AssetPath = shaderSourcePath;
+		shader->m_AssetPath = compiler.m_ShaderSourcePath;
 		shader->m_Name = name;
-		shader->m_DisableOptimization = disableOptimization;
-
-		Ref<VulkanShaderCompiler> compiler = CreateRef<VulkanShaderCompiler>(shaderSourcePath, disableOptimization);
-		compiler->Reload(forceCompile);
+		shader->m_DisableOptimization = compiler.m_DisableOptimization;
 
-		shader->LoadAndCreateShaders(compiler->GetSPIRVData());
-		shader->SetReflectionData(compiler->m_ReflectionData);
+		shader->LoadAndCreateShaders(compiler.GetSPIRVData());
+		shader->SetReflectionData(compiler.m_ReflectionData);
 		shader->CreateDescriptors();
 
-		Renderer::AcknowledgeParsedGlobalMacros(compiler->GetAcknowledgedMacros(), shader.get());
+		Renderer::AcknowledgeParsedGlobalMacros(compiler.GetAcknowledgedMacros(), shader.get());
 		Renderer::OnShaderReloaded(shader->GetHash());
 		return shader;
 	}
@@ -46,8 +46,15 @@ namespace X2 {
 		static void ClearUniformBuffers();
 
 		static Ref<VulkanShader> Compile(const std::filesystem::path& shaderSourcePath, bool forceCompile = false, bool disableOptimization = false);
+		// Preprocesses and compiles the shaders on worker threads, reflection and module creation
+		// then run on the calling thread in the given order
+		static std::vector<Ref<VulkanShader>> CompileBatch(const std::vector<std::filesystem::path>& shaderSourcePaths, bool forceCompile = false);
 		static bool TryRecompile(VulkanShader* shader);
 	private:
+		bool CompileStages(bool forceCompile);
+		void LoadReflectionData(bool forceCompile);
+		static Ref<VulkanShader> CreateShader(const VulkanShaderCompiler& compiler);
+
 		std::map<VkShaderStageFlagBits, std::string> PreProcess(const std::string& source);
 		std::map<VkShaderStageFlagBits, std::string> PreProcessGLSL(const std::string& source);
 
@@ -86,6 +93,7 @@ namespace X2 {
 		ShaderUtils::SourceLang m_Language;
 
 		std::map<VkShaderStageFlagBits, StageData> m_StagesMetadata;
+		VkShaderStageFlagBits m_ChangedStages = {};
 		
 		friend class VulkanShader;
 		friend class VulkanShaderCache;
@@ -4,6 +4,8 @@
 #include "X2/Renderer/Renderer.h"
 
 #include "VulkanContext.h"
+#include "VulkanPipelineCache.h"
+#include "VulkanStagingUploader.h"
 //#include "VulkanDiagnostics.h"
 
 #include "X2/Core/Timer.h"
@@ -32,7 +34,6 @@ namespace X2 {
 				{
 					auto device = VulkanContext::GetCurrentDevice()->GetVulkanDevice();
 					vkDestroyPipeline(device, instance->m_ComputePipeline, nullptr);
-					vkDestroyPipelineCache(device, instance->m_PipelineCache, nullptr);
 					vkDestroyPipelineLayout(device, instance->m_ComputePipelineLayout, nullptr);
 				}
 			
@@ -42,11 +43,10 @@ namespace X2 {
 
 	VulkanComputePipeline::~VulkanComputePipeline()
 	{
-		Renderer::SubmitResourceFree([layout = m_ComputePipelineLayout, cache = m_PipelineCache, pipeline = m_ComputePipeline, name = m_Shader->GetName()]()mutable {
+		Renderer::SubmitResourceFree([layout = m_ComputePipelineLayout, pipeline = m_ComputePipeline, name = m_Shader->GetName()]()mutable {
 
 			auto device = VulkanContext::GetCurrentDevice()->GetVulkanDevice();
 			vkDestroyPipeline(device, pipeline, nullptr);
-			vkDestroyPipelineCache(device, cache, nullptr);
 			vkDestroyPipelineLayout(device, layout, nullptr);
 
 			});
@@ -93,12 +93,7 @@ namespace X2 {
 		const auto& shaderStages = m_Shader->GetPipelineShaderStageCreateInfos();
 		computePipelineCreateInfo.stage = shaderStages[0];
 
-		VkPipelineCacheCreateInfo pipelineCacheCreateInfo = {};
-		pipelineCacheCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
-
-		VK_CHECK_RESULT(vkCreatePipelineCache(device, &pipelineCacheCreateInfo, nullptr, &m_PipelineCache));
-
-		VK_CHECK_RESULT(vkCreateComputePipelines(device, m_PipelineCache, 1, &computePipelineCreateInfo, nullptr, &m_ComputePipeline));
+		VK_CHECK_RESULT(VulkanPipelineCache::CreateComputePipeline(computePipelineCreateInfo, m_ComputePipeline));
 		
 		//X2_CORE_INFO("Renderer: Create m_ComputePipeline: {0} pipeline = {1}", m_Shader->GetName(), (const void*)m_ComputePipeline);
 
@@ -139,6 +134,8 @@ namespace X2 {
 		vkWaitForFences(device, 1, &s_ComputeFence, VK_TRUE, UINT64_MAX);
 		vkResetFences(device, 1, &s_ComputeFence);
 
+		VulkanStagingUploader::FlushForQueue(computeQueue);
+
 		VkSubmitInfo computeSubmitInfo{};
 		computeSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 		computeSubmitInfo.commandBufferCount = 1;
@@ -220,6 +217,8 @@ namespace X2 {
 			vkWaitForFences(device, 1, &s_ComputeFence, VK_TRUE, UINT64_MAX);
 			vkResetFences(device, 1, &s_ComputeFence);
 
+			VulkanStagingUploader::FlushForQueue(computeQueue);
+
 			VkSubmitInfo computeSubmitInfo{};
 			computeSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 			computeSubmitInfo.commandBufferCount = 1;
@@ -37,7 +37,6 @@ namespace X2 {
 		Ref<VulkanShader> m_Shader;
 
 		VkPipelineLayout m_ComputePipelineLayout = nullptr;
-		VkPipelineCache m_PipelineCache = nullptr;
 		VkPipeline m_ComputePipeline = nullptr;
 
 		VkCommandBuffer m_ActiveComputeCommandBuffer = nullptr;
@@ -5,6 +5,8 @@
 #include "VulkanContext.h"
 #include "Vulkan.h"
 #include "VulkanImage.h"
+#include "VulkanPipelineCache.h"
+#include "VulkanStagingUploader.h"
 
 #include <GLFW/glfw3.h>
 
@@ -135,6 +137,8 @@ namespace X2 {
 	{
 		auto vkDestroyDebugUtilsMessengerEXT = (PFN_vkDestroyDebugUtilsMessengerEXT)vkGetInstanceProcAddr(s_VulkanInstance, "vkDestroyDebugUtilsMessengerEXT");
 		vkDestroyDebugUtilsMessengerEXT(s_VulkanInstance, m_DebugUtilsMessenger, nullptr);
+		VulkanStagingUploader::Shutdown();
+		VulkanPipelineCache::Shutdown();
 		VulkanAllocator::Shutdown();
 		
 		m_Device->Destroy();
@@ -271,6 +275,8 @@ namespace X2 {
 		m_Device = std::make_unique<VulkanDevice>(m_PhysicalDevice.get(), enabledFeatures);
 
 		VulkanAllocator::Init(m_Device.get());
+		VulkanPipelineCache::Init(m_Device.get());
+		VulkanStagingUploader::Init(m_Device.get());
 
 	}
 
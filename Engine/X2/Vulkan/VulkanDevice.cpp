@@ -2,6 +2,7 @@
 #include "VulkanDevice.h"
 
 #include "VulkanContext.h"
+#include "VulkanStagingUploader.h"
 
 #include "vk_mem_alloc.h"
 
@@ -455,6 +456,9 @@ namespace X2
 		VkFence fence;
 		VK_CHECK_RESULT(vkCreateFence(vulkanDevice, &fenceCreateInfo, nullptr, &fence));
 
+		// Batched uploads recorded so far must land before this command buffer runs
+		VulkanStagingUploader::FlushForQueue(queue);
+
 		{
 			static std::mutex submissionLock;
 			std::scoped_lock<std::mutex> lock(submissionLock);
@@ -18,6 +18,7 @@
 #include "X2/Renderer/Renderer.h"
 
 #include "X2/Vulkan/VulkanContext.h"
+#include "X2/Vulkan/VulkanPipelineCache.h"
 
 namespace X2 {
 
@@ -143,7 +144,7 @@ namespace X2 {
 				init_info.Device = device;
 				init_info.QueueFamily = VulkanContext::GetCurrentDevice()->GetPhysicalDevice()->GetQueueFamilyIndices().Graphics;
 				init_info.Queue = VulkanContext::GetCurrentDevice()->GetGraphicsQueue();
-				init_info.PipelineCache = nullptr;
+				init_info.PipelineCache = VulkanPipelineCache::GetPipelineCache();
 				init_info.DescriptorPool = instance->m_imguiDescriptorPool;
 				init_info.Allocator = nullptr;
 				init_info.MinImageCount = 2;
@@ -589,6 +589,11 @@ bool X2::Utils::IsIntegerBased(const ImageFormat format)
 	case ImageFormat::RGB:
 	case ImageFormat::SRGB:
 	case ImageFormat::DEPTH24STENCIL8:
+	case ImageFormat::BC1:
+	case ImageFormat::BC3:
+	case ImageFormat::BC4:
+	case ImageFormat::BC5:
+	case ImageFormat::BC7:
 		return false;
 	}
 	X2_CORE_ASSERT(false);
@@ -602,6 +607,13 @@ uint32_t X2::Utils::CalculateMipCount(uint32_t width, uint32_t height)
 
 uint32_t X2::Utils::GetImageMemorySize(ImageFormat format, uint32_t width, uint32_t height)
 {
+	if (IsCompressedFormat(format))
+	{
+		// 4x4 blocks, partial blocks at the edges are padded
+		const uint32_t blockSize = (format == ImageFormat::BC1 || format == ImageFormat::BC4) ? 8 : 16;
+		return ((width + 3) / 4) * ((height + 3) / 4) * blockSize;
+	}
+
 	return width * height * GetImageFormatBPP(format);
 }
 
@@ -613,6 +625,20 @@ bool X2::Utils::IsDepthFormat(ImageFormat format)
 	return false;
 }
 
+bool X2::Utils::IsCompressedFormat(ImageFormat format)
+{
+	switch (format)
+	{
+	case ImageFormat::BC1:
+	case ImageFormat::BC3:
+	case ImageFormat::BC4:
+	case ImageFormat::BC5:
+	case ImageFormat::BC7:
+		return true;
+	}
+	return false;
+}
+
 VkFormat X2::Utils::VulkanImageFormat(ImageFormat format)
 {
 	switch (format)
@@ -633,6 +659,11 @@ VkFormat X2::Utils::VulkanImageFormat(ImageFormat format)
 	case ImageFormat::DEPTH32FSTENCIL8UINT: return VK_FORMAT_D32_SFLOAT_S8_UINT;
 	case ImageFormat::DEPTH32F:				return VK_FORMAT_D32_SFLOAT;
 	case ImageFormat::DEPTH24STENCIL8:		return VulkanContext::GetCurrentDevice()->GetPhysicalDevice()->GetDepthFormat();
+	case ImageFormat::BC1:					return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+	case ImageFormat::BC3:					return VK_FORMAT_BC3_UNORM_BLOCK;
+	case ImageFormat::BC4:					return VK_FORMAT_BC4_UNORM_BLOCK;
+	case ImageFormat::BC5:					return VK_FORMAT_BC5_UNORM_BLOCK;
+	case ImageFormat::BC7:					return VK_FORMAT_BC7_UNORM_BLOCK;
 	}
 	X2_CORE_ASSERT(false);
 	return VK_FORMAT_UNDEFINED;
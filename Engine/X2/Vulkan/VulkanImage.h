@@ -32,6 +32,13 @@ namespace X2 {
 		DEPTH32F,
 		DEPTH24STENCIL8,
 
+		// Block compressed, produced by the asset pack builder
+		BC1,
+		BC3,
+		BC4,
+		BC5,
+		BC7,
+
 		// Defaults
 		Depth = DEPTH24STENCIL8,
 	};
@@ -214,6 +221,7 @@ namespace X2 {
 		uint32_t CalculateMipCount(uint32_t width, uint32_t height);
 		uint32_t GetImageMemorySize(ImageFormat format, uint32_t width, uint32_t height);
 		bool IsDepthFormat(ImageFormat format);
+		bool IsCompressedFormat(ImageFormat format);
 		VkFormat VulkanImageFormat(ImageFormat format);
 
 
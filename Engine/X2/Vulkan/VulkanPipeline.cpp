@@ -6,6 +6,7 @@
 #include "VulkanFramebuffer.h"
 #include "VulkanUniformBuffer.h"
 #include "VulkanRenderPass.h"
+#include "VulkanPipelineCache.h"
 
 #include "X2/Renderer/Renderer.h"
 
@@ -74,11 +75,10 @@ namespace X2 {
 
 	VulkanPipeline::~VulkanPipeline()
 	{
-		Renderer::SubmitResourceFree([pipeline = m_VulkanPipeline, pipelineCache = m_PipelineCache, pipelineLayout = m_PipelineLayout]()
+		Renderer::SubmitResourceFree([pipeline = m_VulkanPipeline, pipelineLayout = m_PipelineLayout]()
 			{
 				const auto vulkanDevice = VulkanContext::GetCurrentDevice()->GetVulkanDevice();
 				vkDestroyPipeline(vulkanDevice, pipeline, nullptr);
-				vkDestroyPipelineCache(vulkanDevice, pipelineCache, nullptr);
 				vkDestroyPipelineLayout(vulkanDevice, pipelineLayout, nullptr);
 			});
 	}
@@ -93,7 +93,6 @@ namespace X2 {
 				if (instance->m_VulkanPipeline)
 				{
 					vkDestroyPipeline(device, instance->m_VulkanPipeline, nullptr);
-					vkDestroyPipelineCache(device, instance->m_PipelineCache, nullptr);
 					vkDestroyPipelineLayout(device, instance->m_PipelineLayout, nullptr);
 
 				}
@@ -342,13 +341,8 @@ namespace X2 {
 				pipelineCreateInfo.renderPass = framebuffer->GetRenderPass();
 				pipelineCreateInfo.pDynamicState = &dynamicState;
 
-				// What is this pipeline cache?
-				VkPipelineCacheCreateInfo pipelineCacheCreateInfo = {};
-				pipelineCacheCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
-				VK_CHECK_RESULT(vkCreatePipelineCache(device, &pipelineCacheCreateInfo, nullptr, &instance->m_PipelineCache));
-
-				// Create rendering pipeline using the specified states
-				VK_CHECK_RESULT(vkCreateGraphicsPipelines(device, instance->m_PipelineCache, 1, &pipelineCreateInfo, nullptr, &instance->m_VulkanPipeline));
+				// Create rendering pipeline using the specified states, through the shared on-disk cache
+				VK_CHECK_RESULT(VulkanPipelineCache::CreateGraphicsPipeline(pipelineCreateInfo, instance->m_VulkanPipeline));
 				//X2_CORE_INFO("Renderer: Create Pipeline: {0} pipeline = {1}", instance->m_Specification.DebugName, (const void*)instance->m_VulkanPipeline);
 
 				VKUtils::SetDebugUtilsObjectName(device, VK_OBJECT_TYPE_PIPELINE, instance->m_Specification.DebugName, instance->m_VulkanPipeline);
@@ -98,7 +98,6 @@ namespace X2 {
 
 		VkPipelineLayout m_PipelineLayout = nullptr;
 		VkPipeline m_VulkanPipeline = nullptr;
-		VkPipelineCache m_PipelineCache = nullptr;
 		VulkanShader::ShaderMaterialDescriptorSet m_DescriptorSets;
 	};
 
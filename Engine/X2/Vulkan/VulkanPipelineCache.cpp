@@ -0,0 +1,241 @@
+#include "Precompiled.h"
+#include "VulkanPipelineCache.h"
+
+#include "X2/Core/Timer.h"
+#include "X2/Core/Debug/Profiler.h"
+#include "X2/Utilities/FileSystem.h"
+
+#include <mutex>
+
+namespace X2 {
+
+	static const char* s_PipelineCachePath = "Resources/Cache/Pipeline/PipelineCache.bin";
+
+	// The driver puts its own header in front of the data, but that one has no driver version,
+	// which is exactly what changes between driver updates
+	static constexpr uint32_t s_PipelineCacheMagic = 0x43503258; // "X2PC"
+	static constexpr uint32_t s_PipelineCacheVersion = 1;
+
+	struct PipelineCacheHeader
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		uint32_t VendorID;
+		uint32_t DeviceID;
+		uint32_t DriverVersion;
+		uint8_t PipelineCacheUUID[VK_UUID_SIZE];
+		uint64_t DataSize;
+	};
+
+	struct VulkanPipelineCacheData
+	{
+		VulkanDevice* Device = nullptr;
+		VkPipelineCache PipelineCache = nullptr;
+
+		std::mutex StatsMutex;
+		PipelineCacheStats Stats;
+	};
+
+	static VulkanPipelineCacheData* s_Data = nullptr;
+
+	namespace Utils {
+
+		static PipelineCacheHeader GetPipelineCacheHeader(const VkPhysicalDeviceProperties& properties, uint64_t dataSize)
+		{
+			PipelineCacheHeader header;
+			header.Magic = s_PipelineCacheMagic;
+			header.Version = s_PipelineCacheVersion;
+			header.VendorID = properties.vendorID;
+			header.DeviceID = properties.deviceID;
+			header.DriverVersion = properties.driverVersion;
+			memcpy(header.PipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+			header.DataSize = dataSize;
+			return header;
+		}
+
+		static bool IsPipelineCacheCompatible(const PipelineCacheHeader& header, const VkPhysicalDeviceProperties& properties)
+		{
+			return header.Magic == s_PipelineCacheMagic
+				&& header.Version == s_PipelineCacheVersion
+				&& header.VendorID == properties.vendorID
+				&& header.DeviceID == properties.deviceID
+				&& header.DriverVersion == properties.driverVersion
+				&& memcmp(header.PipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+		}
+
+	}
+
+	void VulkanPipelineCache::Init(VulkanDevice* device)
+	{
+		X2_PROFILE_FUNC();
+
+		s_Data = hnew VulkanPipelineCacheData();
+		s_Data->Device = device;
+
+		const VkPhysicalDeviceProperties& properties = device->GetPhysicalDevice()->GetProperties();
+
+		Buffer fileData;
+		if (FileSystem::Exists(std::filesystem::path(s_PipelineCachePath)))
+			fileData = FileSystem::ReadBytes(s_PipelineCachePath);
+
+		VkPipelineCacheCreateInfo pipelineCacheCreateInfo = {};
+		pipelineCacheCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+
+		if (fileData.Size >= sizeof(PipelineCacheHeader))
+		{
+			PipelineCacheHeader header;
+			memcpy(&header, fileData.Data, sizeof(PipelineCacheHeader));
+
+			if (!Utils::IsPipelineCacheCompatible(header, properties))
+			{
+				X2_CORE_WARN_TAG("Renderer", "Pipeline cache was created by a different device or driver, starting with an empty cache");
+			}
+			else if (header.DataSize != fileData.Size - sizeof(PipelineCacheHeader))
+			{
+				X2_CORE_ERROR_TAG("Renderer", "Pipeline cache {} is truncated, starting with an empty cache", s_PipelineCachePath);
+			}
+			else
+			{
+				pipelineCacheCreateInfo.initialDataSize = (size_t)header.DataSize;
+				pipelineCacheCreateInfo.pInitialData = (const uint8_t*)fileData.Data + sizeof(PipelineCacheHeader);
+			}
+		}
+
+		VkDevice vulkanDevice = device->GetVulkanDevice();
+		if (vkCreatePipelineCache(vulkanDevice, &pipelineCacheCreateInfo, nullptr, &s_Data->PipelineCache) != VK_SUCCESS)
+		{
+			// Drivers should ignore data they can't use, but don't rely on it
+			X2_CORE_WARN_TAG("Renderer", "Driver rejected the pipeline cache data, starting with an empty cache");
+			pipelineCacheCreateInfo.initialDataSize = 0;
+			pipelineCacheCreateInfo.pInitialData = nullptr;
+			VK_CHECK_RESULT(vkCreatePipelineCache(vulkanDevice, &pipelineCacheCreateInfo, nullptr, &s_Data->PipelineCache));
+		}
+		else if (pipelineCacheCreateInfo.initialDataSize)
+		{
+			X2_CORE_INFO_TAG("Renderer", "Loaded pipeline cache ({} bytes)", pipelineCacheCreateInfo.initialDataSize);
+		}
+
+		fileData.Release();
+	}
+
+	void VulkanPipelineCache::Shutdown()
+	{
+		Save();
+
+		vkDestroyPipelineCache(s_Data->Device->GetVulkanDevice(), s_Data->PipelineCache, nullptr);
+
+		delete s_Data;
+		s_Data = nullptr;
+	}
+
+	void VulkanPipelineCache::Save()
+	{
+		X2_PROFILE_FUNC();
+
+		VkDevice device = s_Data->Device->GetVulkanDevice();
+
+		size_t dataSize = 0;
+		VK_CHECK_RESULT(vkGetPipelineCacheData(device, s_Data->PipelineCache, &dataSize, nullptr));
+
+		std::vector<uint8_t> data(sizeof(PipelineCacheHeader) + dataSize);
+		if (dataSize)
+		{
+			// Pipelines created since the size query make the data grow, VK_INCOMPLETE still leaves a valid cache
+			VkResult result = vkGetPipelineCacheData(device, s_Data->PipelineCache, &dataSize, data.data() + sizeof(PipelineCacheHeader));
+			if (result != VK_SUCCESS && result != VK_INCOMPLETE)
+			{
+				X2_CORE_ERROR_TAG("Renderer", "Failed to read back the pipeline cache");
+				return;
+			}
+			data.resize(sizeof(PipelineCacheHeader) + dataSize);
+		}
+
+		const PipelineCacheHeader header = Utils::GetPipelineCacheHeader(s_Data->Device->GetPhysicalDevice()->GetProperties(), dataSize);
+		memcpy(data.data(), &header, sizeof(PipelineCacheHeader));
+
+		std::filesystem::path filepath = s_PipelineCachePath;
+		FileSystem::CreateDirectory(filepath.parent_path());
+		if (!FileSystem::WriteBytes(filepath, Buffer(data.data(), data.size())))
+		{
+			X2_CORE_ERROR_TAG("Renderer", "Failed to write pipeline cache {}", s_PipelineCachePath);
+			return;
+		}
+
+		const PipelineCacheStats stats = GetStats();
+		X2_CORE_INFO_TAG("Renderer", "Saved pipeline cache ({} bytes). Hits: {} ({:.2f}ms), misses: {} ({:.2f}ms)",
+			dataSize, stats.Hits, stats.HitTime, stats.Misses, stats.MissTime);
+	}
+
+	VkPipelineCache VulkanPipelineCache::GetPipelineCache()
+	{
+		return s_Data->PipelineCache;
+	}
+
+	VkResult VulkanPipelineCache::CreateGraphicsPipeline(const VkGraphicsPipelineCreateInfo& createInfo, VkPipeline& outPipeline)
+	{
+		X2_PROFILE_FUNC();
+
+		VkPipelineCreationFeedback feedback = {};
+		VkPipelineCreationFeedbackCreateInfo feedbackCreateInfo = {};
+		feedbackCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO;
+		feedbackCreateInfo.pNext = createInfo.pNext;
+		feedbackCreateInfo.pPipelineCreationFeedback = &feedback;
+
+		VkGraphicsPipelineCreateInfo pipelineCreateInfo = createInfo;
+		pipelineCreateInfo.pNext = &feedbackCreateInfo;
+
+		Timer timer;
+		VkResult result = vkCreateGraphicsPipelines(s_Data->Device->GetVulkanDevice(), s_Data->PipelineCache, 1, &pipelineCreateInfo, nullptr, &outPipeline);
+		if (result == VK_SUCCESS)
+			RecordCreation(feedback, timer.ElapsedMillis());
+
+		return result;
+	}
+
+	VkResult VulkanPipelineCache::CreateComputePipeline(const VkComputePipelineCreateInfo& createInfo, VkPipeline& outPipeline)
+	{
+		X2_PROFILE_FUNC();
+
+		VkPipelineCreationFeedback feedback = {};
+		VkPipelineCreationFeedbackCreateInfo feedbackCreateInfo = {};
+		feedbackCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO;
+		feedbackCreateInfo.pNext = createInfo.pNext;
+		feedbackCreateInfo.pPipelineCreationFeedback = &feedback;
+
+		VkComputePipelineCreateInfo pipelineCreateInfo = createInfo;
+		pipelineCreateInfo.pNext = &feedbackCreateInfo;
+
+		Timer timer;
+		VkResult result = vkCreateComputePipelines(s_Data->Device->GetVulkanDevice(), s_Data->PipelineCache, 1, &pipelineCreateInfo, nullptr, &outPipeline);
+		if (result == VK_SUCCESS)
+			RecordCreation(feedback, timer.ElapsedMillis());
+
+		return result;
+	}
+
+	PipelineCacheStats VulkanPipelineCache::GetStats()
+	{
+		std::scoped_lock<std::mutex> lock(s_Data->StatsMutex);
+		return s_Data->Stats;
+	}
+
+	void VulkanPipelineCache::RecordCreation(const VkPipelineCreationFeedback& feedback, float time)
+	{
+		// Without valid feedback there is no telling, count it as a miss
+		const bool hit = (feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT)
+			&& (feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT);
+
+		std::scoped_lock<std::mutex> lock(s_Data->StatsMutex);
+		if (hit)
+		{
+			s_Data->Stats.Hits++;
+			s_Data->Stats.HitTime += time;
+		}
+		else
+		{
+			s_Data->Stats.Misses++;
+			s_Data->Stats.MissTime += time;
+		}
+	}
+
+}
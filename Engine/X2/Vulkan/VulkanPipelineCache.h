@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Vulkan.h"
+#include "VulkanDevice.h"
+
+namespace X2 {
+
+	struct PipelineCacheStats
+	{
+		uint32_t Hits = 0;
+		uint32_t Misses = 0;
+		float HitTime = 0.0f; // ms
+		float MissTime = 0.0f; // ms
+	};
+
+	//
+	// Renderer-wide VkPipelineCache shared by all graphics and compute pipelines. The cache data is
+	// loaded at startup and written back at shutdown, it is discarded when it was saved by a different
+	// device or driver version. Creation feedback tells whether each pipeline came from the cache.
+	//
+	class VulkanPipelineCache
+	{
+	public:
+		static void Init(VulkanDevice* device);
+		static void Shutdown();
+
+		// Writes the current cache contents, also called from Shutdown()
+		static void Save();
+
+		static VkPipelineCache GetPipelineCache();
+
+		static VkResult CreateGraphicsPipeline(const VkGraphicsPipelineCreateInfo& createInfo, VkPipeline& outPipeline);
+		static VkResult CreateComputePipeline(const VkComputePipelineCreateInfo& createInfo, VkPipeline& outPipeline);
+
+		static PipelineCacheStats GetStats();
+	private:
+		static void RecordCreation(const VkPipelineCreationFeedback& feedback, float time);
+	};
+
+}
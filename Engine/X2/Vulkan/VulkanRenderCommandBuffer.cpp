@@ -6,6 +6,7 @@
 #include "X2/Core/Application.h"
 
 #include "VulkanContext.h"'
+#include "VulkanStagingUploader.h"
 
 #include "X2/Renderer/Renderer.h"
 
@@ -235,6 +236,8 @@ namespace X2 {
 
 				X2_CORE_TRACE_TAG("Renderer", "Submitting Render Command Buffer {}", instance->m_DebugName);
 
+				VulkanStagingUploader::Flush();
+
 				VK_CHECK_RESULT(vkQueueSubmit(device->GetGraphicsQueue(), 1, &submitInfo, instance->m_WaitFences[frameIndex]));
 
 				// Retrieve timestamp query results
@@ -1548,6 +1548,48 @@ namespace X2 {
 			});
 	}
 
+	void VulkanRenderer::SetRenderArea(Ref<VulkanRenderCommandBuffer> renderCommandBuffer, uint32_t x, uint32_t y, uint32_t width, uint32_t height)
+	{
+		Renderer::Submit([renderCommandBuffer, x, y, width, height]()
+			{
+				VkCommandBuffer commandBuffer = renderCommandBuffer->GetActiveCommandBuffer();
+
+				VkViewport viewport = {};
+				viewport.x = (float)x;
+				viewport.y = (float)y;
+				viewport.width = (float)width;
+				viewport.height = (float)height;
+				viewport.minDepth = 0.0f;
+				viewport.maxDepth = 1.0f;
+				vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+				VkRect2D scissor = {};
+				scissor.offset = { (int32_t)x, (int32_t)y };
+				scissor.extent = { width, height };
+				vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+			});
+	}
+
+	void VulkanRenderer::ClearDepthArea(Ref<VulkanRenderCommandBuffer> renderCommandBuffer, uint32_t x, uint32_t y, uint32_t width, uint32_t height, float depth)
+	{
+		Renderer::Submit([renderCommandBuffer, x, y, width, height, depth]()
+			{
+				VkCommandBuffer commandBuffer = renderCommandBuffer->GetActiveCommandBuffer();
+
+				VkClearAttachment attachment = {};
+				attachment.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+				attachment.clearValue.depthStencil = { depth, 0 };
+
+				VkClearRect clearRect = {};
+				clearRect.rect.offset = { (int32_t)x, (int32_t)y };
+				clearRect.rect.extent = { width, height };
+				clearRect.baseArrayLayer = 0;
+				clearRect.layerCount = 1;
+
+				vkCmdClearAttachments(commandBuffer, 1, &attachment, 1, &clearRect);
+			});
+	}
+
 	Ref<Environment> VulkanRenderer::CreateEnvironmentMap(const std::string& filepath)
 	{
 		if (!Renderer::GetConfig().ComputeEnvironmentMaps)
@@ -38,6 +38,8 @@ namespace X2 {
 
 		virtual void BeginRenderPass(Ref<VulkanRenderCommandBuffer> renderCommandBuffer, const Ref<VulkanRenderPass>& renderPass, bool explicitClear = false) ;
 		virtual void EndRenderPass(Ref<VulkanRenderCommandBuffer> renderCommandBuffer) ;
+		virtual void SetRenderArea(Ref<VulkanRenderCommandBuffer> renderCommandBuffer, uint32_t x, uint32_t y, uint32_t width, uint32_t height) ;
+		virtual void ClearDepthArea(Ref<VulkanRenderCommandBuffer> renderCommandBuffer, uint32_t x, uint32_t y, uint32_t width, uint32_t height, float depth) ;
 		virtual void SubmitFullscreenQuad(Ref<VulkanRenderCommandBuffer> renderCommandBuffer, Ref<VulkanPipeline> pipeline, Ref<VulkanUniformBufferSet> uniformBufferSet, Ref<VulkanMaterial> material) ;
 		virtual void SubmitFullscreenQuad(Ref<VulkanRenderCommandBuffer> renderCommandBuffer, Ref<VulkanPipeline> pipeline, Ref<VulkanUniformBufferSet> uniformBufferSet, Ref<VulkanStorageBufferSet> storageBufferSet, Ref<VulkanMaterial> material) ;
 		virtual void SubmitFullscreenQuadWithOverrides(Ref<VulkanRenderCommandBuffer> renderCommandBuffer, Ref<VulkanPipeline> pipeline, Ref<VulkanUniformBufferSet> uniformBufferSet, Ref<VulkanMaterial> material, Buffer vertexShaderOverrides, Buffer fragmentShaderOverrides) ;
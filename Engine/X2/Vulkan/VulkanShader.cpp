@@ -2,6 +2,7 @@
 #include "VulkanShader.h"
 
 #include "ShaderCompiler/VulkanShaderCompiler.h"
+#include "ShaderCompiler/VulkanShaderCache.h"
 
 #include <filesystem>
 
@@ -13,6 +14,7 @@
 #include "VulkanShaderUtils.h"
 
 #include "X2/Core/Hash.h"
+#include "X2/Core/Debug/Profiler.h"
 
 #include "X2/ImGui/ImGui.h"
 
@@ -601,6 +603,28 @@ namespace X2 {
 		m_Shaders[name] = shader;
 	}
 
+	void ShaderLibrary::LoadBatch(const std::vector<std::string>& paths, bool forceCompile)
+	{
+		X2_PROFILE_FUNC();
+
+		std::vector<std::filesystem::path> sourcePaths;
+		for (const std::string& path : paths)
+		{
+			if (!forceCompile && m_ShaderPack && m_ShaderPack->Contains(path))
+				Add(m_ShaderPack->LoadShader(path));
+			else
+				sourcePaths.emplace_back(path);
+		}
+
+		// The shader registry is written once for the whole batch
+		VulkanShaderCache::BeginBatch();
+		std::vector<Ref<VulkanShader>> shaders = VulkanShaderCompiler::CompileBatch(sourcePaths, forceCompile);
+		VulkanShaderCache::EndBatch();
+
+		for (const Ref<VulkanShader>& shader : shaders)
+			Add(shader);
+	}
+
 	void ShaderLibrary::Load(std::string_view name, const std::string& path)
 	{
 		X2_CORE_ASSERT(m_Shaders.find(std::string(name)) == m_Shaders.end());
@@ -213,6 +213,8 @@ namespace X2 {
 		void Add(const Ref<VulkanShader>& shader);
 		void Load(std::string_view path, bool forceCompile = false, bool disableOptimization = false);
 		void Load(std::string_view name, const std::string& path);
+		// Compiles all shaders not found in the shader pack in parallel, see VulkanShaderCompiler::CompileBatch
+		void LoadBatch(const std::vector<std::string>& paths, bool forceCompile = false);
 		void LoadShaderPack(const std::filesystem::path& path);
 
 		const Ref<VulkanShader>& Get(const std::string& name) const;
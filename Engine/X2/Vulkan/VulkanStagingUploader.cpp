@@ -0,0 +1,331 @@
+#include "Precompiled.h"
+#include "VulkanStagingUploader.h"
+
+#include "VulkanAllocator.h"
+#include "VulkanContext.h"
+
+#include "X2/Renderer/Renderer.h"
+#include "X2/Core/Debug/Profiler.h"
+
+#include <mutex>
+#include <unordered_set>
+
+namespace X2 {
+
+	// Staging memory per frame in flight, uploads that don't fit get a buffer of their own
+	static constexpr VkDeviceSize s_FrameStagingSize = 32 * 1024 * 1024;
+
+	struct StagingFrame
+	{
+		VkCommandPool CommandPool = nullptr;
+
+		// One command buffer and fence per submission, reused once the frame is retired
+		std::vector<VkCommandBuffer> CommandBuffers;
+		std::vector<VkFence> Fences;
+		uint32_t SubmitCount = 0;
+
+		VkDeviceSize Head = 0;
+		std::vector<std::pair<VkBuffer, VmaAllocation>> DedicatedBuffers;
+	};
+
+	struct VulkanStagingUploaderData
+	{
+		VulkanDevice* Device = nullptr;
+
+		VkBuffer StagingBuffer = nullptr;
+		VmaAllocation StagingAllocation = nullptr;
+		uint8_t* StagingData = nullptr;
+		VkDeviceSize Alignment = 16;
+
+		std::vector<StagingFrame> Frames;
+		uint32_t FrameIndex = 0;
+
+		VkCommandBuffer RecordingCommandBuffer = nullptr;
+		// Destinations copied to since the last barrier, copies to the same buffer must not overlap in flight
+		std::unordered_set<VkBuffer> WrittenBuffers;
+
+		std::mutex Mutex;
+	};
+
+	static VulkanStagingUploaderData* s_Data = nullptr;
+
+	namespace Utils {
+
+		static VkDeviceSize AlignStagingOffset(VkDeviceSize offset, VkDeviceSize alignment)
+		{
+			return (offset + alignment - 1) & ~(alignment - 1);
+		}
+
+		static void InsertStagingMemoryBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStage, VkAccessFlags srcAccess, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess)
+		{
+			VkMemoryBarrier memoryBarrier{};
+			memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			memoryBarrier.srcAccessMask = srcAccess;
+			memoryBarrier.dstAccessMask = dstAccess;
+			vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+		}
+
+		// Everything below expects s_Data->Mutex to be held
+
+		static VkCommandBuffer GetRecordingCommandBuffer()
+		{
+			if (s_Data->RecordingCommandBuffer)
+				return s_Data->RecordingCommandBuffer;
+
+			VkDevice device = s_Data->Device->GetVulkanDevice();
+			StagingFrame& frame = s_Data->Frames[s_Data->FrameIndex];
+			if (frame.SubmitCount == frame.CommandBuffers.size())
+			{
+				VkCommandBufferAllocateInfo allocateInfo{};
+				allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+				allocateInfo.commandPool = frame.CommandPool;
+				allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+				allocateInfo.commandBufferCount = 1;
+				VK_CHECK_RESULT(vkAllocateCommandBuffers(device, &allocateInfo, &frame.CommandBuffers.emplace_back()));
+
+				VkFenceCreateInfo fenceCreateInfo{};
+				fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+				VK_CHECK_RESULT(vkCreateFence(device, &fenceCreateInfo, nullptr, &frame.Fences.emplace_back()));
+			}
+
+			VkCommandBuffer commandBuffer = frame.CommandBuffers[frame.SubmitCount];
+
+			VkCommandBufferBeginInfo beginInfo{};
+			beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+			VK_CHECK_RESULT(vkBeginCommandBuffer(commandBuffer, &beginInfo));
+
+			// Work submitted earlier may still read what the copies overwrite
+			InsertStagingMemoryBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, VK_PIPELINE_STAGE_TRANSFER_BIT, 0);
+
+			s_Data->RecordingCommandBuffer = commandBuffer;
+			return commandBuffer;
+		}
+
+		static void SubmitRecordingCommandBuffer()
+		{
+			VkCommandBuffer commandBuffer = s_Data->RecordingCommandBuffer;
+			if (!commandBuffer)
+				return;
+
+			// Barriers cover later submissions to the same queue too, so the uploads are visible to everything after
+			InsertStagingMemoryBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+				VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT);
+			VK_CHECK_RESULT(vkEndCommandBuffer(commandBuffer));
+
+			StagingFrame& frame = s_Data->Frames[s_Data->FrameIndex];
+
+			VkSubmitInfo submitInfo{};
+			submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			submitInfo.commandBufferCount = 1;
+			submitInfo.pCommandBuffers = &commandBuffer;
+			VK_CHECK_RESULT(vkQueueSubmit(s_Data->Device->GetGraphicsQueue(), 1, &submitInfo, frame.Fences[frame.SubmitCount]));
+
+			frame.SubmitCount++;
+			s_Data->RecordingCommandBuffer = nullptr;
+			s_Data->WrittenBuffers.clear();
+		}
+
+		static void RetireStagingFrame(StagingFrame& frame)
+		{
+			VkDevice device = s_Data->Device->GetVulkanDevice();
+
+			if (frame.SubmitCount)
+			{
+				VK_CHECK_RESULT(vkWaitForFences(device, frame.SubmitCount, frame.Fences.data(), VK_TRUE, UINT64_MAX));
+				VK_CHECK_RESULT(vkResetFences(device, frame.SubmitCount, frame.Fences.data()));
+				VK_CHECK_RESULT(vkResetCommandPool(device, frame.CommandPool, 0));
+				frame.SubmitCount = 0;
+			}
+
+			VulkanAllocator allocator("Staging");
+			for (auto& [buffer, allocation] : frame.DedicatedBuffers)
+			{
+				allocator.UnmapMemory(allocation);
+				allocator.DestroyBuffer(buffer, allocation);
+			}
+			frame.DedicatedBuffers.clear();
+			frame.Head = 0;
+		}
+
+		static void AllocateStaging(const void* data, VkDeviceSize size, VkBuffer& outBuffer, VkDeviceSize& outOffset)
+		{
+			VulkanAllocator allocator("Staging");
+
+			if (size > s_FrameStagingSize)
+			{
+				VkBufferCreateInfo bufferCreateInfo{};
+				bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+				bufferCreateInfo.size = size;
+				bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+				bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+				VkBuffer buffer;
+				VmaAllocation allocation = allocator.AllocateBuffer(bufferCreateInfo, VMA_MEMORY_USAGE_CPU_TO_GPU, buffer);
+				memcpy(allocator.MapMemory<uint8_t>(allocation), data, size);
+				vmaFlushAllocation(VulkanAllocator::GetVMAAllocator(), allocation, 0, size);
+				s_Data->Frames[s_Data->FrameIndex].DedicatedBuffers.emplace_back(buffer, allocation);
+
+				outBuffer = buffer;
+				outOffset = 0;
+				return;
+			}
+
+			StagingFrame& frame = s_Data->Frames[s_Data->FrameIndex];
+			VkDeviceSize offset = AlignStagingOffset(frame.Head, s_Data->Alignment);
+			if (offset + size > s_FrameStagingSize)
+			{
+				// More than a frame's worth of uploads (usually while loading), wait for the region to free up
+				SubmitRecordingCommandBuffer();
+				RetireStagingFrame(frame);
+				offset = 0;
+			}
+			frame.Head = offset + size;
+
+			const VkDeviceSize bufferOffset = s_Data->FrameIndex * s_FrameStagingSize + offset;
+			memcpy(s_Data->StagingData + bufferOffset, data, size);
+			vmaFlushAllocation(VulkanAllocator::GetVMAAllocator(), s_Data->StagingAllocation, bufferOffset, size);
+
+			outBuffer = s_Data->StagingBuffer;
+			outOffset = bufferOffset;
+		}
+
+	}
+
+	void VulkanStagingUploader::Init(VulkanDevice* device)
+	{
+		s_Data = hnew VulkanStagingUploaderData();
+		s_Data->Device = device;
+
+		const VkPhysicalDeviceLimits& limits = device->GetPhysicalDevice()->GetLimits();
+		s_Data->Alignment = std::max<VkDeviceSize>(s_Data->Alignment, limits.optimalBufferCopyOffsetAlignment);
+
+		const uint32_t framesInFlight = Renderer::GetConfig().FramesInFlight;
+
+		VulkanAllocator allocator("Staging");
+
+		VkBufferCreateInfo bufferCreateInfo{};
+		bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferCreateInfo.size = s_FrameStagingSize * framesInFlight;
+		bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+		bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		s_Data->StagingAllocation = allocator.AllocateBuffer(bufferCreateInfo, VMA_MEMORY_USAGE_CPU_TO_GPU, s_Data->StagingBuffer);
+		s_Data->StagingData = allocator.MapMemory<uint8_t>(s_Data->StagingAllocation);
+
+		VkDevice vulkanDevice = device->GetVulkanDevice();
+		VKUtils::SetDebugUtilsObjectName(vulkanDevice, VK_OBJECT_TYPE_BUFFER, "Staging ring", s_Data->StagingBuffer);
+
+		VkCommandPoolCreateInfo commandPoolCreateInfo{};
+		commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		commandPoolCreateInfo.queueFamilyIndex = device->GetPhysicalDevice()->GetQueueFamilyIndices().Graphics;
+		commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+		s_Data->Frames.resize(framesInFlight);
+		for (StagingFrame& frame : s_Data->Frames)
+			VK_CHECK_RESULT(vkCreateCommandPool(vulkanDevice, &commandPoolCreateInfo, nullptr, &frame.CommandPool));
+	}
+
+	void VulkanStagingUploader::Shutdown()
+	{
+		FlushAndWait();
+
+		VkDevice device = s_Data->Device->GetVulkanDevice();
+		for (StagingFrame& frame : s_Data->Frames)
+		{
+			for (VkFence fence : frame.Fences)
+				vkDestroyFence(device, fence, nullptr);
+			vkDestroyCommandPool(device, frame.CommandPool, nullptr);
+		}
+
+		VulkanAllocator allocator("Staging");
+		allocator.UnmapMemory(s_Data->StagingAllocation);
+		allocator.DestroyBuffer(s_Data->StagingBuffer, s_Data->StagingAllocation);
+
+		delete s_Data;
+		s_Data = nullptr;
+	}
+
+	void VulkanStagingUploader::BeginFrame(uint32_t frameIndex)
+	{
+		X2_PROFILE_FUNC();
+
+		std::scoped_lock<std::mutex> lock(s_Data->Mutex);
+
+		// Anything recorded since Present() belongs to the previous frame's region
+		Utils::SubmitRecordingCommandBuffer();
+
+		s_Data->FrameIndex = frameIndex;
+		Utils::RetireStagingFrame(s_Data->Frames[frameIndex]);
+	}
+
+	void VulkanStagingUploader::UploadBuffer(VkBuffer destination, const void* data, VkDeviceSize size, VkDeviceSize destinationOffset)
+	{
+		X2_PROFILE_FUNC();
+
+		std::scoped_lock<std::mutex> lock(s_Data->Mutex);
+
+		VkBuffer stagingBuffer;
+		VkDeviceSize stagingOffset;
+		Utils::AllocateStaging(data, size, stagingBuffer, stagingOffset);
+
+		VkCommandBuffer commandBuffer = Utils::GetRecordingCommandBuffer();
+		if (!s_Data->WrittenBuffers.insert(destination).second)
+		{
+			Utils::InsertStagingMemoryBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+			s_Data->WrittenBuffers = { destination };
+		}
+
+		VkBufferCopy copyRegion{};
+		copyRegion.srcOffset = stagingOffset;
+		copyRegion.dstOffset = destinationOffset;
+		copyRegion.size = size;
+		vkCmdCopyBuffer(commandBuffer, stagingBuffer, destination, 1, &copyRegion);
+	}
+
+	void VulkanStagingUploader::Upload(const void* data, VkDeviceSize size, const RecordFn& recordFn)
+	{
+		X2_PROFILE_FUNC();
+
+		std::scoped_lock<std::mutex> lock(s_Data->Mutex);
+
+		VkBuffer stagingBuffer;
+		VkDeviceSize stagingOffset;
+		Utils::AllocateStaging(data, size, stagingBuffer, stagingOffset);
+
+		recordFn(Utils::GetRecordingCommandBuffer(), stagingBuffer, stagingOffset);
+	}
+
+	void VulkanStagingUploader::Flush()
+	{
+		if (!s_Data)
+			return;
+
+		std::scoped_lock<std::mutex> lock(s_Data->Mutex);
+		Utils::SubmitRecordingCommandBuffer();
+	}
+
+	void VulkanStagingUploader::FlushAndWait()
+	{
+		if (!s_Data)
+			return;
+
+		X2_PROFILE_FUNC();
+
+		std::scoped_lock<std::mutex> lock(s_Data->Mutex);
+		Utils::SubmitRecordingCommandBuffer();
+		for (StagingFrame& frame : s_Data->Frames)
+			Utils::RetireStagingFrame(frame);
+	}
+
+	void VulkanStagingUploader::FlushForQueue(VkQueue queue)
+	{
+		if (!s_Data)
+			return;
+
+		if (queue == s_Data->Device->GetGraphicsQueue())
+			Flush();
+		else
+			FlushAndWait();
+	}
+
+}
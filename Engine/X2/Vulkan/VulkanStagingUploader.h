@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Vulkan.h"
+#include "VulkanDevice.h"
+
+#include <functional>
+
+namespace X2 {
+
+	//
+	// Batches host to device uploads instead of giving each one its own staging buffer and a blocking
+	// submit. Data is copied into a persistently mapped staging buffer with one region per frame in
+	// flight, and the copies are recorded into a shared command buffer. Pending copies are submitted
+	// (without waiting) before anything else goes to the graphics queue, and a frame's staging region
+	// is reused once the fences of the uploads it made have signaled.
+	//
+	class VulkanStagingUploader
+	{
+	public:
+		// Records commands that read size bytes of staging data at stagingOffset in stagingBuffer
+		using RecordFn = std::function<void(VkCommandBuffer commandBuffer, VkBuffer stagingBuffer, VkDeviceSize stagingOffset)>;
+	public:
+		static void Init(VulkanDevice* device);
+		static void Shutdown();
+
+		// Retires the uploads made the last time this frame index was in use
+		static void BeginFrame(uint32_t frameIndex);
+
+		static void UploadBuffer(VkBuffer destination, const void* data, VkDeviceSize size, VkDeviceSize destinationOffset = 0);
+		// For uploads that need more than a copy, e.g. image layout transitions around the copy
+		static void Upload(const void* data, VkDeviceSize size, const RecordFn& recordFn);
+
+		// Submits pending uploads to the graphics queue, must be called before any other graphics queue submission
+		static void Flush();
+		// Submits pending uploads and waits for all of them
+		static void FlushAndWait();
+		// Flush() for graphics queue submissions, FlushAndWait() for the others since the uploads are not ordered with them
+		static void FlushForQueue(VkQueue queue);
+	};
+
+}
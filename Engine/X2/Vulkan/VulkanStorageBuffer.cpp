@@ -2,6 +2,7 @@
 #include "VulkanStorageBuffer.h"
 
 #include "VulkanContext.h"
+#include "VulkanStagingUploader.h"
 
 #include "X2/Renderer/Renderer.h"
 
@@ -67,34 +68,8 @@ namespace X2 {
 
 	void VulkanStorageBuffer::RT_SetData(const void* data, uint32_t size, uint32_t offset)
 	{
-		VulkanAllocator allocator("Staging");
-
-		VkBufferCreateInfo bufferInfo = {};
-		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-		bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-		bufferInfo.size = size;
-
-		VkBuffer stagingBuffer;
-		auto stagingAlloc = allocator.AllocateBuffer(bufferInfo, VMA_MEMORY_USAGE_CPU_TO_GPU, stagingBuffer);
-
-		uint8_t* pData = allocator.MapMemory<uint8_t>(stagingAlloc);
-		memcpy(pData, data, size);
-		allocator.UnmapMemory(stagingAlloc);
-
-		{
-			VkCommandBuffer commandBuffer = VulkanContext::GetCurrentDevice()->GetCommandBuffer(true);
-
-			VkBufferCopy copyRegion = {
-				0,
-				offset,
-				size
-			};
-			vkCmdCopyBuffer(commandBuffer, stagingBuffer, m_Buffer, 1, &copyRegion);
-
-			VulkanContext::GetCurrentDevice()->FlushCommandBuffer(commandBuffer);
-		}
-
-		allocator.DestroyBuffer(stagingBuffer, stagingAlloc);
+		// Lands before the next graphics queue submission
+		VulkanStagingUploader::UploadBuffer(m_Buffer, data, size, offset);
 	}
 
 	void VulkanStorageBuffer::Resize(uint32_t newSize)
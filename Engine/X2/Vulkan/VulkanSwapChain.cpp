@@ -1,5 +1,6 @@
 #include "Precompiled.h"
 #include "VulkanSwapChain.h"
+#include "VulkanStagingUploader.h"
 
 #include "X2/Core/Application.h"
 #include "X2/Core/Debug/Profiler.h"
@@ -504,6 +505,9 @@ namespace X2 {
 	{
 		X2_SCOPE_PERF("VulkanSwapChain::BeginFrame");
 
+		// Before the release queue, resources freed this frame may still be the target of its uploads
+		VulkanStagingUploader::BeginFrame(m_CurrentBufferIndex);
+
 		// Resource release queue
 		auto& queue = Renderer::GetRenderResourceReleaseQueue(m_CurrentBufferIndex);
 		queue.Execute();
@@ -532,6 +536,8 @@ namespace X2 {
 		submitInfo.pCommandBuffers = &m_CommandBuffers[m_CurrentBufferIndex].CommandBuffer;
 		submitInfo.commandBufferCount = 1;
 
+		VulkanStagingUploader::Flush();
+
 		VK_CHECK_RESULT(vkResetFences(m_Device->GetVulkanDevice(), 1, &m_WaitFences[m_CurrentBufferIndex]));
 		VK_CHECK_RESULT(vkQueueSubmit(m_Device->GetGraphicsQueue(), 1, &submitInfo, m_WaitFences[m_CurrentBufferIndex]));
 
@@ -3,6 +3,7 @@
 
 #include "VulkanContext.h"
 #include "VulkanRenderer.h"
+#include "VulkanStagingUploader.h"
 
 #include "VulkanImage.h"
 #include "X2/Asset/TextureImporter.h"
@@ -39,6 +40,9 @@ namespace X2 {
 
 		static size_t GetMemorySize(ImageFormat format, uint32_t width, uint32_t height)
 		{
+			if (IsCompressedFormat(format))
+				return GetImageMemorySize(format, width, height);
+
 			switch (format)
 			{
 			case ImageFormat::RED16UI: return width * height * sizeof(uint16_t);
@@ -55,6 +59,14 @@ namespace X2 {
 			return 0;
 		}
 
+		static size_t GetMipChainMemorySize(ImageFormat format, uint32_t width, uint32_t height, uint32_t mips)
+		{
+			size_t size = 0;
+			for (uint32_t mip = 0; mip < mips; mip++)
+				size += GetMemorySize(format, std::max(width >> mip, 1u), std::max(height >> mip, 1u));
+			return size;
+		}
+
 		static bool ValidateSpecification(const TextureSpecification& specification)
 		{
 			bool result = true;
@@ -100,7 +112,7 @@ namespace X2 {
 			});
 	}
 
-	VulkanTexture2D::VulkanTexture2D(const TextureSpecification& specification, Buffer data)
+	VulkanTexture2D::VulkanTexture2D(const TextureSpecification& specification, Buffer data, bool copyData)
 		: m_Specification(specification)
 	{
 		if (m_Specification.Height == 0)
@@ -117,8 +129,9 @@ namespace X2 {
 		else if (data)
 		{
 			Utils::ValidateSpecification(m_Specification);
-			auto size = (uint32_t)Utils::GetMemorySize(m_Specification.Format, m_Specification.Width, m_Specification.Height);
-			m_ImageData = Buffer::Copy(data.Data, size);
+			auto size = (uint32_t)Utils::GetMipChainMemorySize(m_Specification.Format, m_Specification.Width, m_Specification.Height, m_Specification.StoredMips);
+			m_OwnsImageData = copyData;
+			m_ImageData = copyData ? Buffer::Copy(data.Data, size) : Buffer(data.Data, size);
 		}
 		else
 		{
@@ -150,7 +163,8 @@ namespace X2 {
 		if (m_Image)
 			m_Image->Release();
 
-		m_ImageData.Release();
+		if (m_OwnsImageData)
+			m_ImageData.Release();
 	}
 
 	void VulkanTexture2D::Resize(const glm::uvec2& size)
@@ -180,6 +194,9 @@ namespace X2 {
 		m_Image->Release();
 		uint32_t mipCount = m_Specification.GenerateMips ? GetMipLevelCount() : 1;
 
+		// Upload the whole chain when it was stored with the texture, otherwise mip 0 only
+		const uint32_t uploadedMips = m_ImageData && m_Specification.StoredMips >= mipCount ? mipCount : 1;
+
 		ImageSpecification& imageSpec = m_Image->GetSpecification();
 		imageSpec.Format = m_Specification.Format;
 		imageSpec.Width = m_Specification.Width;
@@ -197,122 +214,114 @@ namespace X2 {
 		{
 			VkDeviceSize size = m_ImageData.Size;
 
-			VulkanAllocator allocator("Texture2D");
-
-			// Create staging buffer
-			VkBufferCreateInfo bufferCreateInfo{};
-			bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-			bufferCreateInfo.size = size;
-			bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-			bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-			VkBuffer stagingBuffer;
-			VmaAllocation stagingBufferAllocation = allocator.AllocateBuffer(bufferCreateInfo, VMA_MEMORY_USAGE_CPU_TO_GPU, stagingBuffer);
-
-			// Copy data to staging buffer
-			uint8_t* destData = allocator.MapMemory<uint8_t>(stagingBufferAllocation);
 			X2_CORE_ASSERT(m_ImageData.Data);
-			memcpy(destData, m_ImageData.Data, size);
-			allocator.UnmapMemory(stagingBufferAllocation);
-
-			VkCommandBuffer copyCmd = device->GetCommandBuffer(true);
 
-			// Image memory barriers for the texture image
-
-			// The sub resource range describes the regions of the image that will be transitioned using the memory barriers below
-			VkImageSubresourceRange subresourceRange = {};
-			// Image only contains color data
-			subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-			// Start at first mip level
-			subresourceRange.baseMipLevel = 0;
-			subresourceRange.levelCount = 1;
-			subresourceRange.layerCount = 1;
-
-			// Transition the texture image layout to transfer target, so we can safely copy our buffer data to it.
-			VkImageMemoryBarrier imageMemoryBarrier{};
-			imageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-			imageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-			imageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-			imageMemoryBarrier.image = info.Image;
-			imageMemoryBarrier.subresourceRange = subresourceRange;
-			imageMemoryBarrier.srcAccessMask = 0;
-			imageMemoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-			imageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-			imageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-
-			// Insert a memory dependency at the proper pipeline stages that will execute the image layout transition 
-			// Source pipeline stage is host write/read exection (VK_PIPELINE_STAGE_HOST_BIT)
-			// Destination pipeline stage is copy command exection (VK_PIPELINE_STAGE_TRANSFER_BIT)
-			vkCmdPipelineBarrier(
-				copyCmd,
-				VK_PIPELINE_STAGE_HOST_BIT,
-				VK_PIPELINE_STAGE_TRANSFER_BIT,
-				0,
-				0, nullptr,
-				0, nullptr,
-				1, &imageMemoryBarrier);
-
-			VkBufferImageCopy bufferCopyRegion = {};
-			bufferCopyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-			bufferCopyRegion.imageSubresource.mipLevel = 0;
-			bufferCopyRegion.imageSubresource.baseArrayLayer = 0;
-			bufferCopyRegion.imageSubresource.layerCount = 1;
-			bufferCopyRegion.imageExtent.width = m_Specification.Width;
-			bufferCopyRegion.imageExtent.height = m_Specification.Height;
-			bufferCopyRegion.imageExtent.depth = 1;
-			bufferCopyRegion.bufferOffset = 0;
-
-			// Copy mip levels from staging buffer
-			vkCmdCopyBufferToImage(
-				copyCmd,
-				stagingBuffer,
-				info.Image,
-				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-				1,
-				&bufferCopyRegion);
+			// Recorded into the batched uploads, GenerateMips() flushes them ahead of its own command buffer
+			VulkanStagingUploader::Upload(m_ImageData.Data, size, [&](VkCommandBuffer copyCmd, VkBuffer stagingBuffer, VkDeviceSize stagingOffset)
+				{
+					// Image memory barriers for the texture image
+
+					// The sub resource range describes the regions of the image that will be transitioned using the memory barriers below
+					VkImageSubresourceRange subresourceRange = {};
+					// Image only contains color data
+					subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+					// Start at first mip level
+					subresourceRange.baseMipLevel = 0;
+					subresourceRange.levelCount = uploadedMips;
+					subresourceRange.layerCount = 1;
+
+					// Transition the texture image layout to transfer target, so we can safely copy our buffer data to it.
+					VkImageMemoryBarrier imageMemoryBarrier{};
+					imageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+					imageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+					imageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+					imageMemoryBarrier.image = info.Image;
+					imageMemoryBarrier.subresourceRange = subresourceRange;
+					imageMemoryBarrier.srcAccessMask = 0;
+					imageMemoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+					imageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+					imageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+
+					// Insert a memory dependency at the proper pipeline stages that will execute the image layout transition 
+					// Source pipeline stage is host write/read exection (VK_PIPELINE_STAGE_HOST_BIT)
+					// Destination pipeline stage is copy command exection (VK_PIPELINE_STAGE_TRANSFER_BIT)
+					vkCmdPipelineBarrier(
+						copyCmd,
+						VK_PIPELINE_STAGE_HOST_BIT,
+						VK_PIPELINE_STAGE_TRANSFER_BIT,
+						0,
+						0, nullptr,
+						0, nullptr,
+						1, &imageMemoryBarrier);
+
+					std::vector<VkBufferImageCopy> bufferCopyRegions(uploadedMips);
+					VkDeviceSize bufferOffset = 0;
+					for (uint32_t mip = 0; mip < uploadedMips; mip++)
+					{
+						const uint32_t mipWidth = std::max(m_Specification.Width >> mip, 1u);
+						const uint32_t mipHeight = std::max(m_Specification.Height >> mip, 1u);
+
+						VkBufferImageCopy& bufferCopyRegion = bufferCopyRegions[mip];
+						bufferCopyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+						bufferCopyRegion.imageSubresource.mipLevel = mip;
+						bufferCopyRegion.imageSubresource.baseArrayLayer = 0;
+						bufferCopyRegion.imageSubresource.layerCount = 1;
+						bufferCopyRegion.imageExtent.width = mipWidth;
+						bufferCopyRegion.imageExtent.height = mipHeight;
+						bufferCopyRegion.imageExtent.depth = 1;
+						bufferCopyRegion.bufferOffset = stagingOffset + bufferOffset;
+
+						bufferOffset += Utils::GetMemorySize(m_Specification.Format, mipWidth, mipHeight);
+					}
+					X2_CORE_ASSERT(bufferOffset <= size);
+
+					// Copy mip levels from staging buffer
+					vkCmdCopyBufferToImage(
+						copyCmd,
+						stagingBuffer,
+						info.Image,
+						VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+						(uint32_t)bufferCopyRegions.size(),
+						bufferCopyRegions.data());
 
 #if 0
-			// Once the data has been uploaded we transfer to the texture image to the shader read layout, so it can be sampled from
-			imageMemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-			imageMemoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-			imageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-			imageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-
-			// Insert a memory dependency at the proper pipeline stages that will execute the image layout transition 
-			// Source pipeline stage stage is copy command exection (VK_PIPELINE_STAGE_TRANSFER_BIT)
-			// Destination pipeline stage fragment shader access (VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT)
-			vkCmdPipelineBarrier(
-				copyCmd,
-				VK_PIPELINE_STAGE_TRANSFER_BIT,
-				VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-				0,
-				0, nullptr,
-				0, nullptr,
-				1, &imageMemoryBarrier);
+					// Once the data has been uploaded we transfer to the texture image to the shader read layout, so it can be sampled from
+					imageMemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+					imageMemoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+					imageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+					imageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+					// Insert a memory dependency at the proper pipeline stages that will execute the image layout transition 
+					// Source pipeline stage stage is copy command exection (VK_PIPELINE_STAGE_TRANSFER_BIT)
+					// Destination pipeline stage fragment shader access (VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT)
+					vkCmdPipelineBarrier(
+						copyCmd,
+						VK_PIPELINE_STAGE_TRANSFER_BIT,
+						VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+						0,
+						0, nullptr,
+						0, nullptr,
+						1, &imageMemoryBarrier);
 
 #endif
 
-			if (mipCount > 1) // Mips to generate
-			{
-				Utils::InsertImageMemoryBarrier(copyCmd, info.Image,
-					VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
-					VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-					VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
-					subresourceRange);
-			}
-			else
-			{
-				Utils::InsertImageMemoryBarrier(copyCmd, info.Image,
-					VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT,
-					VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, image->GetDescriptorInfo().imageLayout,
-					VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-					subresourceRange);
-			}
-
-
-			device->FlushCommandBuffer(copyCmd);
-
-			// Clean up staging resources
-			allocator.DestroyBuffer(stagingBuffer, stagingBufferAllocation);
+					if (mipCount > uploadedMips) // Mips to generate
+					{
+						Utils::InsertImageMemoryBarrier(copyCmd, info.Image,
+							VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+							VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+							VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+							subresourceRange);
+					}
+					else
+					{
+						Utils::InsertImageMemoryBarrier(copyCmd, info.Image,
+							VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT,
+							VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, image->GetDescriptorInfo().imageLayout,
+							VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+							subresourceRange);
+					}
+				});
 		}
 		else
 		{
@@ -380,6 +389,9 @@ namespace X2 {
 			view.viewType = VK_IMAGE_VIEW_TYPE_2D;
 			view.format = Utils::VulkanImageFormat(m_Specification.Format);
 			view.components = { VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G, VK_COMPONENT_SWIZZLE_B, VK_COMPONENT_SWIZZLE_A };
+			// Single channel textures are packed as BC4, read them back as grayscale
+			if (m_Specification.Format == ImageFormat::BC4)
+				view.components = { VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_ONE };
 			// The subresource range describes the set of mip levels (and array layers) that can be accessed through this image view
 			// It's possible to create multiple image views for a single image referring to different (and/or overlapping) ranges of the image
 			view.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
@@ -395,12 +407,14 @@ namespace X2 {
 			image->UpdateDescriptor();
 		}
 
-		if (m_ImageData && m_Specification.GenerateMips && mipCount > 1)
+		if (m_ImageData && m_Specification.GenerateMips && mipCount > uploadedMips)
 			GenerateMips();
 
 		// TODO(Yan): option for local storage
-		m_ImageData.Release();
+		if (m_OwnsImageData)
+			m_ImageData.Release();
 		m_ImageData = Buffer();
+		m_OwnsImageData = true;
 	}
 
 	void VulkanTexture2D::Bind(uint32_t slot) const
@@ -427,6 +441,10 @@ namespace X2 {
 
 	uint32_t VulkanTexture2D::GetMipLevelCount() const
 	{
+		// Block compressed images can't be blitted to, so their mips can't be generated
+		if (Utils::IsCompressedFormat(m_Specification.Format))
+			return std::min(m_Specification.StoredMips, Utils::CalculateMipCount(m_Specification.Width, m_Specification.Height));
+
 		return Utils::CalculateMipCount(m_Specification.Width, m_Specification.Height);
 	}
 
@@ -710,85 +728,68 @@ namespace X2 {
 		// Copy data if present
 		if (m_LocalStorage)
 		{
-			// Create staging buffer
-			VkBufferCreateInfo bufferCreateInfo{};
-			bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-			bufferCreateInfo.size = m_LocalStorage.Size;
-			bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-			bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-			VkBuffer stagingBuffer;
-			VmaAllocation stagingBufferAllocation = allocator.AllocateBuffer(bufferCreateInfo, VMA_MEMORY_USAGE_CPU_TO_GPU, stagingBuffer);
-
-			// Copy data to staging buffer
-			uint8_t* destData = allocator.MapMemory<uint8_t>(stagingBufferAllocation);
-			memcpy(destData, m_LocalStorage.Data, m_LocalStorage.Size);
-			allocator.UnmapMemory(stagingBufferAllocation);
-
-			VkCommandBuffer copyCmd = device->GetCommandBuffer(true);
-
-			// Image memory barriers for the texture image
-
-			// The sub resource range describes the regions of the image that will be transitioned using the memory barriers below
-			VkImageSubresourceRange subresourceRange = {};
-			// Image only contains color data
-			subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-			// Start at first mip level
-			subresourceRange.baseMipLevel = 0;
-			subresourceRange.levelCount = 1;
-			subresourceRange.layerCount = 6;
-
-			// Transition the texture image layout to transfer target, so we can safely copy our buffer data to it.
-			VkImageMemoryBarrier imageMemoryBarrier{};
-			imageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-			imageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-			imageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-			imageMemoryBarrier.image = m_Image;
-			imageMemoryBarrier.subresourceRange = subresourceRange;
-			imageMemoryBarrier.srcAccessMask = 0;
-			imageMemoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-			imageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-			imageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-
-			// Insert a memory dependency at the proper pipeline stages that will execute the image layout transition 
-			// Source pipeline stage is host write/read exection (VK_PIPELINE_STAGE_HOST_BIT)
-			// Destination pipeline stage is copy command exection (VK_PIPELINE_STAGE_TRANSFER_BIT)
-			vkCmdPipelineBarrier(
-				copyCmd,
-				VK_PIPELINE_STAGE_HOST_BIT,
-				VK_PIPELINE_STAGE_TRANSFER_BIT,
-				0,
-				0, nullptr,
-				0, nullptr,
-				1, &imageMemoryBarrier);
-
-			VkBufferImageCopy bufferCopyRegion = {};
-			bufferCopyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-			bufferCopyRegion.imageSubresource.mipLevel = 0;
-			bufferCopyRegion.imageSubresource.baseArrayLayer = 0;
-			bufferCopyRegion.imageSubresource.layerCount = 6;
-			bufferCopyRegion.imageExtent.width = m_Specification.Width;
-			bufferCopyRegion.imageExtent.height = m_Specification.Height;
-			bufferCopyRegion.imageExtent.depth = 1;
-			bufferCopyRegion.bufferOffset = 0;
-
-			// Copy mip levels from staging buffer
-			vkCmdCopyBufferToImage(
-				copyCmd,
-				stagingBuffer,
-				m_Image,
-				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-				1,
-				&bufferCopyRegion);
-
-			Utils::InsertImageMemoryBarrier(copyCmd, m_Image,
-				VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
-				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-				VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
-				subresourceRange);
-
-			device->FlushCommandBuffer(copyCmd);
-
-			allocator.DestroyBuffer(stagingBuffer, stagingBufferAllocation);
+			VulkanStagingUploader::Upload(m_LocalStorage.Data, m_LocalStorage.Size, [&](VkCommandBuffer copyCmd, VkBuffer stagingBuffer, VkDeviceSize stagingOffset)
+				{
+					// Image memory barriers for the texture image
+
+					// The sub resource range describes the regions of the image that will be transitioned using the memory barriers below
+					VkImageSubresourceRange subresourceRange = {};
+					// Image only contains color data
+					subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+					// Start at first mip level
+					subresourceRange.baseMipLevel = 0;
+					subresourceRange.levelCount = 1;
+					subresourceRange.layerCount = 6;
+
+					// Transition the texture image layout to transfer target, so we can safely copy our buffer data to it.
+					VkImageMemoryBarrier imageMemoryBarrier{};
+					imageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+					imageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+					imageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+					imageMemoryBarrier.image = m_Image;
+					imageMemoryBarrier.subresourceRange = subresourceRange;
+					imageMemoryBarrier.srcAccessMask = 0;
+					imageMemoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+					imageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+					imageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+
+					// Insert a memory dependency at the proper pipeline stages that will execute the image layout transition 
+					// Source pipeline stage is host write/read exection (VK_PIPELINE_STAGE_HOST_BIT)
+					// Destination pipeline stage is copy command exection (VK_PIPELINE_STAGE_TRANSFER_BIT)
+					vkCmdPipelineBarrier(
+						copyCmd,
+						VK_PIPELINE_STAGE_HOST_BIT,
+						VK_PIPELINE_STAGE_TRANSFER_BIT,
+						0,
+						0, nullptr,
+						0, nullptr,
+						1, &imageMemoryBarrier);
+
+					VkBufferImageCopy bufferCopyRegion = {};
+					bufferCopyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+					bufferCopyRegion.imageSubresource.mipLevel = 0;
+					bufferCopyRegion.imageSubresource.baseArrayLayer = 0;
+					bufferCopyRegion.imageSubresource.layerCount = 6;
+					bufferCopyRegion.imageExtent.width = m_Specification.Width;
+					bufferCopyRegion.imageExtent.height = m_Specification.Height;
+					bufferCopyRegion.imageExtent.depth = 1;
+					bufferCopyRegion.bufferOffset = stagingOffset;
+
+					// Copy mip levels from staging buffer
+					vkCmdCopyBufferToImage(
+						copyCmd,
+						stagingBuffer,
+						m_Image,
+						VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+						1,
+						&bufferCopyRegion);
+
+					Utils::InsertImageMemoryBarrier(copyCmd, m_Image,
+						VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+						VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+						VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+						subresourceRange);
+				});
 		}
 
 		VkCommandBuffer layoutCmd = device->GetCommandBuffer(true);
@@ -1176,97 +1177,77 @@ namespace X2 {
 	{
 		X2_CORE_VERIFY(buffer.Size == m_GPUAllocationSize);
 
-		auto device = VulkanContext::GetCurrentDevice();
-		auto vulkanDevice = device->GetVulkanDevice();
-		VulkanAllocator allocator("TextureCube");
-
-		// Create staging buffer
-		VkBufferCreateInfo bufferCreateInfo{};
-		bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-		bufferCreateInfo.size = m_GPUAllocationSize;
-		bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-		bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-		VkBuffer stagingBuffer;
-		VmaAllocation stagingBufferAllocation = allocator.AllocateBuffer(bufferCreateInfo, VMA_MEMORY_USAGE_CPU_TO_GPU, stagingBuffer);
-
-		// Copy data from staging buffer
-		uint8_t* dstData = allocator.MapMemory<uint8_t>(stagingBufferAllocation);
-		memcpy(dstData, buffer.Data, m_GPUAllocationSize);
-		allocator.UnmapMemory(stagingBufferAllocation);
-
-		uint32_t mipWidth = m_Specification.Width, mipHeight = m_Specification.Height;
-
-		VkCommandBuffer copyCmd = device->GetCommandBuffer(true);
-		uint64_t mipDataOffset = 0;
-		for (uint32_t mip = 0; mip < mips; mip++)
-		{
-			// Image memory barriers for the texture image
-			// The sub resource range describes the regions of the image that will be transitioned using the memory barriers below
-			VkImageSubresourceRange subresourceRange = {};
-			// Image only contains color data
-			subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-			// Start at first mip level
-			subresourceRange.baseMipLevel = mip;
-			subresourceRange.levelCount = 1;
-			subresourceRange.layerCount = 6;
-
-			VkImageMemoryBarrier imageMemoryBarrier{};
-			imageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-			imageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-			imageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-			imageMemoryBarrier.image = m_Image;
-			imageMemoryBarrier.subresourceRange = subresourceRange;
-			imageMemoryBarrier.srcAccessMask = 0;
-			imageMemoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-			imageMemoryBarrier.oldLayout = m_DescriptorImageInfo.imageLayout;
-			imageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-
-			// Insert a memory dependency at the proper pipeline stages that will execute the image layout transition 
-			// Source pipeline stage is host write/read exection (VK_PIPELINE_STAGE_HOST_BIT)
-			// Destination pipeline stage is copy command exection (VK_PIPELINE_STAGE_TRANSFER_BIT)
-			vkCmdPipelineBarrier(
-				copyCmd,
-				VK_PIPELINE_STAGE_HOST_BIT,
-				VK_PIPELINE_STAGE_TRANSFER_BIT,
-				0,
-				0, nullptr,
-				0, nullptr,
-				1, &imageMemoryBarrier);
-
-			VkBufferImageCopy bufferCopyRegion = {};
-			bufferCopyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-			bufferCopyRegion.imageSubresource.mipLevel = mip;
-			bufferCopyRegion.imageSubresource.baseArrayLayer = 0;
-			bufferCopyRegion.imageSubresource.layerCount = 6;
-			bufferCopyRegion.imageExtent.width = mipWidth;
-			bufferCopyRegion.imageExtent.height = mipHeight;
-			bufferCopyRegion.imageExtent.depth = 1;
-			bufferCopyRegion.bufferOffset = mipDataOffset;
-
-			vkCmdCopyBufferToImage(
-				copyCmd,
-				stagingBuffer,
-				m_Image,
-				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-				1,
-				&bufferCopyRegion);
-
-			uint64_t mipDataSize = mipWidth * mipHeight * sizeof(float) * 4 * 6;
-			mipDataOffset += mipDataSize;
-
-			mipWidth /= 2;
-			mipHeight /= 2;
-
-			Utils::InsertImageMemoryBarrier(copyCmd, m_Image,
-				VK_ACCESS_TRANSFER_WRITE_BIT, 0,
-				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, m_DescriptorImageInfo.imageLayout,
-				VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-				subresourceRange);
-		}
-		device->FlushCommandBuffer(copyCmd);
-
-		allocator.DestroyBuffer(stagingBuffer, stagingBufferAllocation);
+		// Recorded into the batched uploads like Invalidate(), the data is copied into staging memory right away
+		VulkanStagingUploader::Upload(buffer.Data, m_GPUAllocationSize, [&](VkCommandBuffer copyCmd, VkBuffer stagingBuffer, VkDeviceSize stagingOffset)
+			{
+				uint32_t mipWidth = m_Specification.Width, mipHeight = m_Specification.Height;
+				uint64_t mipDataOffset = 0;
+				for (uint32_t mip = 0; mip < mips; mip++)
+				{
+					// Image memory barriers for the texture image
+					// The sub resource range describes the regions of the image that will be transitioned using the memory barriers below
+					VkImageSubresourceRange subresourceRange = {};
+					// Image only contains color data
+					subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+					// Start at first mip level
+					subresourceRange.baseMipLevel = mip;
+					subresourceRange.levelCount = 1;
+					subresourceRange.layerCount = 6;
+
+					VkImageMemoryBarrier imageMemoryBarrier{};
+					imageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+					imageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+					imageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+					imageMemoryBarrier.image = m_Image;
+					imageMemoryBarrier.subresourceRange = subresourceRange;
+					imageMemoryBarrier.srcAccessMask = 0;
+					imageMemoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+					imageMemoryBarrier.oldLayout = m_DescriptorImageInfo.imageLayout;
+					imageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+
+					// Insert a memory dependency at the proper pipeline stages that will execute the image layout transition 
+					// Source pipeline stage is host write/read exection (VK_PIPELINE_STAGE_HOST_BIT)
+					// Destination pipeline stage is copy command exection (VK_PIPELINE_STAGE_TRANSFER_BIT)
+					vkCmdPipelineBarrier(
+						copyCmd,
+						VK_PIPELINE_STAGE_HOST_BIT,
+						VK_PIPELINE_STAGE_TRANSFER_BIT,
+						0,
+						0, nullptr,
+						0, nullptr,
+						1, &imageMemoryBarrier);
+
+					VkBufferImageCopy bufferCopyRegion = {};
+					bufferCopyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+					bufferCopyRegion.imageSubresource.mipLevel = mip;
+					bufferCopyRegion.imageSubresource.baseArrayLayer = 0;
+					bufferCopyRegion.imageSubresource.layerCount = 6;
+					bufferCopyRegion.imageExtent.width = mipWidth;
+					bufferCopyRegion.imageExtent.height = mipHeight;
+					bufferCopyRegion.imageExtent.depth = 1;
+					bufferCopyRegion.bufferOffset = stagingOffset + mipDataOffset;
+
+					vkCmdCopyBufferToImage(
+						copyCmd,
+						stagingBuffer,
+						m_Image,
+						VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+						1,
+						&bufferCopyRegion);
+
+					uint64_t mipDataSize = mipWidth * mipHeight * sizeof(float) * 4 * 6;
+					mipDataOffset += mipDataSize;
+
+					mipWidth /= 2;
+					mipHeight /= 2;
+
+					Utils::InsertImageMemoryBarrier(copyCmd, m_Image,
+						VK_ACCESS_TRANSFER_WRITE_BIT, 0,
+						VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, m_DescriptorImageInfo.imageLayout,
+						VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+						subresourceRange);
+				}
+			});
 	}
 
 }
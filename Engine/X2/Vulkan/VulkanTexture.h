@@ -18,6 +18,9 @@ namespace X2 {
 		TextureFilter SamplerFilter = TextureFilter::Linear;
 
 		bool GenerateMips = true;
+		// Mip levels contained in the data buffer, largest first. Missing mips are generated on the GPU,
+		// except for block compressed formats which only get the stored ones.
+		uint32_t StoredMips = 1;
 		bool SRGB = false;
 		bool Storage = false;
 		bool StoreLocally = false;
@@ -51,7 +54,8 @@ namespace X2 {
 	{
 	public:
 		VulkanTexture2D(const TextureSpecification& specification, const std::filesystem::path& filepath, bool flip = false);
-		VulkanTexture2D(const TextureSpecification& specification, Buffer data = Buffer());
+		// copyData false uploads from data in place, it then has to stay valid until the render thread ran Invalidate
+		VulkanTexture2D(const TextureSpecification& specification, Buffer data = Buffer(), bool copyData = true);
 		~VulkanTexture2D() override;
 		virtual void Resize(const glm::uvec2& size);
 		virtual void Resize(uint32_t width, uint32_t height);
@@ -88,6 +92,7 @@ namespace X2 {
 		TextureSpecification m_Specification;
 
 		Buffer m_ImageData;
+		bool m_OwnsImageData = true;
 
 		Ref<VulkanImage2D> m_Image;
 	};
@@ -18,7 +18,7 @@
 #define EPSILON 0.0001f
 
 layout(set = 0, binding = 5) uniform sampler2DArray u_ShadowMapTexture;
-layout(set = 0, binding = 6) uniform sampler2DArray u_SpotShadowMapTexture;
+layout(set = 0, binding = 6) uniform sampler2D u_SpotShadowMapTexture;
 layout(set = 0, binding = 7) uniform sampler2D u_BlueNoise;
 
 
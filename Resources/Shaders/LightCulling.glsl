@@ -161,8 +161,10 @@ void main()
 
 		if( intersect(tileFrustum , sV))
 		{
+			// Scenes can have more lights than a tile can hold, the rest are dropped
 			uint offset = atomicAdd(visiblePointLightCount, 1);
-		    visiblePointLightIndices[offset] = int(lightIndex);
+			if (offset < MAX_LIGHT_COUNT)
+				visiblePointLightIndices[offset] = int(lightIndex);
 		}
     }
 
@@ -188,7 +190,8 @@ void main()
 		if(intersect( tileFrustum , pyramid))
 		{
 			uint offset = atomicAdd(visibleSpotLightCount, 1);
-			visibleSpotLightIndices[offset] = int(lightIndex);
+			if (offset < MAX_LIGHT_COUNT)
+				visibleSpotLightIndices[offset] = int(lightIndex);
 		}
 
 		IsectPyramid i_pyramid = isect_data_setup(pyramid);
@@ -202,27 +205,29 @@ void main()
     if (gl_LocalInvocationIndex == 0)
     {
 		const uint offset = index * MAX_LIGHT_COUNT; // Determine position in global buffer
-		for (uint i = 0; i < visiblePointLightCount; i++) 
+		const uint pointLightCount = min(visiblePointLightCount, MAX_LIGHT_COUNT);
+		const uint spotLightCount = min(visibleSpotLightCount, MAX_LIGHT_COUNT);
+		for (uint i = 0; i < pointLightCount; i++) 
 		{
 			s_VisiblePointLightIndicesBuffer.Indices[offset + i] = visiblePointLightIndices[i];
 		}
 
-		for (uint i = 0; i < visibleSpotLightCount; i++) {
+		for (uint i = 0; i < spotLightCount; i++) {
 			s_VisibleSpotLightIndicesBuffer.Indices[offset + i] = visibleSpotLightIndices[i];
 		}
 
-		if (visiblePointLightCount != MAX_LIGHT_COUNT)
+		if (pointLightCount != MAX_LIGHT_COUNT)
 		{
 		    // Unless we have totally filled the entire array, mark it's end with -1
 		    // Final shader step will use this to determine where to stop (without having to pass the light count)
-			s_VisiblePointLightIndicesBuffer.Indices[offset + visiblePointLightCount] = -1;
+			s_VisiblePointLightIndicesBuffer.Indices[offset + pointLightCount] = -1;
 		}
 
-		if (visibleSpotLightCount != MAX_LIGHT_COUNT)
+		if (spotLightCount != MAX_LIGHT_COUNT)
 		{
 			// Unless we have totally filled the entire array, mark it's end with -1
 			// Final shader step will use this to determine where to stop (without having to pass the light count)
-			s_VisibleSpotLightIndicesBuffer.Indices[offset + visibleSpotLightCount] = -1;
+			s_VisibleSpotLightIndicesBuffer.Indices[offset + spotLightCount] = -1;
 		}
     }
 }
\ No newline at end of file
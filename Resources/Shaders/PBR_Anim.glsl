@@ -158,7 +158,7 @@ layout(set = 1, binding = 11) uniform sampler2D u_BRDFLUTTexture;
 
 // Shadow maps
 layout(set = 1, binding = 12) uniform sampler2DArray u_ShadowMapTexture;
-layout(set = 1, binding = 21) uniform sampler2DArray u_SpotShadowTexture;
+layout(set = 1, binding = 21) uniform sampler2D u_SpotShadowTexture;
 
 layout(push_constant) uniform Material
 {
@@ -235,7 +235,9 @@ void main()
 	m_Params.Normal = normalize(Input.Normal);
 	if (u_MaterialUniforms.UseNormalMap)
 	{
-		m_Params.Normal = normalize(texture(u_NormalTexture, Input.TexCoord).rgb * 2.0f - 1.0f);
+		// Only xy are stored (BC5 in asset packs), z is reconstructed
+		vec2 normalXY = texture(u_NormalTexture, Input.TexCoord).rg * 2.0f - 1.0f;
+		m_Params.Normal = normalize(vec3(normalXY, sqrt(max(1.0f - dot(normalXY, normalXY), 0.0f))));
 		m_Params.Normal = normalize(Input.WorldNormals * m_Params.Normal);
 	}
 	// View normals
@@ -34,7 +34,7 @@ void main()
 		vec4(a_MRow0.w, a_MRow1.w, a_MRow2.w, 1.0)
 	);
 
-	gl_Position = u_PointLights.Mats[u_Renderer.LightDirIndex] * transform * vec4(a_Position, 1.0);
+	gl_Position = u_PointLightShadows.Mats[u_Renderer.LightDirIndex] * transform * vec4(a_Position, 1.0);
 }
 
 #version 450 core